@@ -243,11 +243,13 @@
  *   147 : Pt100 with 4k7 pullup
  *   110 : Pt100 with 1k pullup (non standard)
  *
+ *  1000 : Custom thermistor, table built at compile time from the constants below
+ *
  *         Use these for Testing or Development purposes. NEVER for production machine.
  *   998 : Dummy Table that ALWAYS reads 25°C or the temperature defined below.
  *   999 : Dummy Table that ALWAYS reads 100°C or the temperature defined below.
  *
- * :{ '0': "Not used", '1':"100k / 4.7k - EPCOS", '2':"200k / 4.7k - ATC Semitec 204GT-2", '3':"Mendel-parts / 4.7k", '4':"10k !! do not use for a hotend. Bad resolution at high temp. !!", '5':"100K / 4.7k - ATC Semitec 104GT-2 (Used in ParCan & J-Head)", '6':"100k / 4.7k EPCOS - Not as accurate as Table 1", '7':"100k / 4.7k Honeywell 135-104LAG-J01", '8':"100k / 4.7k 0603 SMD Vishay NTCS0603E3104FXT", '9':"100k / 4.7k GE Sensing AL03006-58.2K-97-G1", '10':"100k / 4.7k RS 198-961", '11':"100k / 4.7k beta 3950 1%", '12':"100k / 4.7k 0603 SMD Vishay NTCS0603E3104FXT (calibrated for Makibox hot bed)", '13':"100k Hisens 3950  1% up to 300°C for hotend 'Simple ONE ' & hotend 'All In ONE'", '20':"PT100 (Ultimainboard V2.x)", '51':"100k / 1k - EPCOS", '52':"200k / 1k - ATC Semitec 204GT-2", '55':"100k / 1k - ATC Semitec 104GT-2 (Used in ParCan & J-Head)", '60':"100k Maker's Tool Works Kapton Bed Thermistor beta=3950", '66':"Dyze Design 4.7M High Temperature thermistor", '70':"the 100K thermistor found in the bq Hephestos 2", '71':"100k / 4.7k Honeywell 135-104LAF-J01", '147':"Pt100 / 4.7k", '1047':"Pt1000 / 4.7k", '110':"Pt100 / 1k (non-standard)", '1010':"Pt1000 / 1k (non standard)", '-3':"Thermocouple + MAX31855 (only for sensor 0)", '-2':"Thermocouple + MAX6675 (only for sensor 0)", '-1':"Thermocouple + AD595",'998':"Dummy 1", '999':"Dummy 2" }
+ * :{ '0': "Not used", '1':"100k / 4.7k - EPCOS", '2':"200k / 4.7k - ATC Semitec 204GT-2", '3':"Mendel-parts / 4.7k", '4':"10k !! do not use for a hotend. Bad resolution at high temp. !!", '5':"100K / 4.7k - ATC Semitec 104GT-2 (Used in ParCan & J-Head)", '6':"100k / 4.7k EPCOS - Not as accurate as Table 1", '7':"100k / 4.7k Honeywell 135-104LAG-J01", '8':"100k / 4.7k 0603 SMD Vishay NTCS0603E3104FXT", '9':"100k / 4.7k GE Sensing AL03006-58.2K-97-G1", '10':"100k / 4.7k RS 198-961", '11':"100k / 4.7k beta 3950 1%", '12':"100k / 4.7k 0603 SMD Vishay NTCS0603E3104FXT (calibrated for Makibox hot bed)", '13':"100k Hisens 3950  1% up to 300°C for hotend 'Simple ONE ' & hotend 'All In ONE'", '20':"PT100 (Ultimainboard V2.x)", '51':"100k / 1k - EPCOS", '52':"200k / 1k - ATC Semitec 204GT-2", '55':"100k / 1k - ATC Semitec 104GT-2 (Used in ParCan & J-Head)", '60':"100k Maker's Tool Works Kapton Bed Thermistor beta=3950", '66':"Dyze Design 4.7M High Temperature thermistor", '70':"the 100K thermistor found in the bq Hephestos 2", '71':"100k / 4.7k Honeywell 135-104LAF-J01", '147':"Pt100 / 4.7k", '1047':"Pt1000 / 4.7k", '110':"Pt100 / 1k (non-standard)", '1010':"Pt1000 / 1k (non standard)", '1000':"Custom (constants below)", '-3':"Thermocouple + MAX31855 (only for sensor 0)", '-2':"Thermocouple + MAX6675 (only for sensor 0)", '-1':"Thermocouple + AD595",'998':"Dummy 1", '999':"Dummy 2" }
  */
 #define TEMP_SENSOR_0 1
 #define TEMP_SENSOR_1 0
@@ -259,6 +261,20 @@
 #define DUMMY_THERMISTOR_998_VALUE 25
 #define DUMMY_THERMISTOR_999_VALUE 100
 
+// Custom thermistor constants, for use with 1000. Beta model, or Steinhart-Hart
+// when CUSTOM_THERMISTOR_SH_A/B/C are set. The table runs from MINTEMP to MAXTEMP
+// (keep these outside HEATER_n_MINTEMP and _MAXTEMP), with entries as far apart
+// as MAX_ERROR (°C, including the rounding to whole degrees) allows.
+#define CUSTOM_THERMISTOR_PULLUP    4700    // Ohms
+#define CUSTOM_THERMISTOR_R25     100000    // Ohms at 25°C
+#define CUSTOM_THERMISTOR_BETA      3950
+//#define CUSTOM_THERMISTOR_SH_A 0.000722378300319346
+//#define CUSTOM_THERMISTOR_SH_B 0.000216301852054578
+//#define CUSTOM_THERMISTOR_SH_C 9.2641025635702e-08
+#define CUSTOM_THERMISTOR_MINTEMP      0
+#define CUSTOM_THERMISTOR_MAXTEMP    300
+#define CUSTOM_THERMISTOR_MAX_ERROR  1.0
+
 // Use temp sensor 1 as a redundant sensor with sensor 0. If the readings
 // from the two sensors differ too much the print will be aborted.
 //#define TEMP_SENSOR_1_AS_REDUNDANT
@@ -311,6 +327,7 @@
   #define PID_FUNCTIONAL_RANGE 10 // If the temperature difference between the target temperature and the actual temperature
                                   // is more than PID_FUNCTIONAL_RANGE then the PID will be shut off and the heater will be set to min/max.
   #define K1 0.95 //smoothing factor within the PID
+  #define PID_IN_ISR // Run the hotend PID in fixed point from the temperature ISR, once per sample set (PID_dT)
 
   // If you are using a pre-configured hotend then you can use one of the value sets by uncommenting it
   // Ultimaker
@@ -459,6 +476,18 @@
   // in ultralcd.cpp@lcd_delta_calibrate_menu()
   //#define DELTA_CALIBRATION_MENU
 
+  // G33 probes the bed and fits the delta geometry by least squares.
+  // Needs a bed probe. Save the result with M500.
+  #define DELTA_AUTO_CALIBRATION
+  #if ENABLED(DELTA_AUTO_CALIBRATION)
+    #define DELTA_CALIBRATION_RADIUS (DELTA_PRINTABLE_RADIUS - 28) // mm, outer ring. Keep the probe inside the printable area.
+    #define DELTA_CALIBRATION_DEFAULT_FACTORS 4  // G33 F: 3, 4, 6 or 7
+    #define DELTA_CALIBRATION_OUTER_POINTS 6     // G33 P
+    #define DELTA_CALIBRATION_INNER_POINTS 6     // G33 Q, at half the radius
+    #define DELTA_CALIBRATION_MAX_POINTS 19      // Bounds the solver's RAM use
+    #define DELTA_CALIBRATION_MAX_ITERATIONS 8
+  #endif
+
   // After homing move down to a height where XY movement is unconstrained
   #define DELTA_HOME_TO_SAFE_ZONE
 
@@ -639,6 +668,14 @@
 // Use double touch for probing
 //#define PROBE_DOUBLE_TOUCH
 
+// Plan the whole G29 probe route first, then queue the raise, travel and a fast
+// approach to just above the last probed height in one go for each point.
+#define PROBE_PIPELINE
+#if ENABLED(PROBE_PIPELINE)
+  #define PROBE_APPROACH_MARGIN 2     // (mm) Fast approach stops this far above the previous point
+  #define PROBE_VERIFY_DEVIATION 0.3  // (mm) Re-probe points this far from the mean of their neighbors
+#endif
+
 // Allen key retractable z-probe as seen on many Kossel delta printers - http://reprap.org/wiki/Kossel#Automatic_bed_leveling_probe
 // Deploys by touching z-axis belt. Retracts by pushing the probe down. Uses Z_MIN_PIN.
 //#define Z_PROBE_ALLEN_KEY
@@ -118,6 +118,22 @@
     #define DEFAULT_Kc (100) //heating power=Kc*(e_speed)
     #define LPQ_MAX_LEN 50
   #endif
+
+  /**
+   * Feed-forward: heater power for the load the planner is about to put
+   * on the hotend, added to the PID output before the temperature sags.
+   * The queued blocks, up to PID_FEEDFORWARD_LEAD seconds of them, give
+   * the filament feed and the part fan speed; each scales a coefficient
+   * in PID output units (0-PID_MAX). Set them with M306 E<per mm/s>
+   * F<at full fan> and store them with M500. tools/ff_calibrate.py
+   * measures them on the printer.
+   */
+  //#define PID_FEEDFORWARD
+  #if ENABLED(PID_FEEDFORWARD)
+    #define DEFAULT_FF_EXTRUSION 0.0  // PID output per mm/s of filament
+    #define DEFAULT_FF_FAN 0.0        // PID output with the part fan at full speed
+    #define PID_FEEDFORWARD_LEAD 2.0  // (s) How far ahead to look in the planner buffer
+  #endif
 #endif
 
 /**
@@ -135,6 +151,28 @@
   #define AUTOTEMP_OLDWEIGHT 0.98
 #endif
 
+/**
+ * Heat-up Planner:
+ * Heat the bed and hotends together instead of one wait after the other.
+ * While M190 or M109 waits, the targets of M104/M109/M140/M190 queued
+ * behind it (up to the next G command) are set right away. A hotend target
+ * is held back until the bed, at its measured rate, is about as far from
+ * its target as the hotend is, so both arrive together and the hotend
+ * doesn't sit hot and ooze. The commands still run in order.
+ *
+ * The heaters share HEATER_POWER_BUDGET watts: hotends get what they ask
+ * for and the bed's duty is cut to what is left.
+ * Needs a heated bed with a temperature sensor.
+ */
+//#define HEATUP_PLANNER
+#if ENABLED(HEATUP_PLANNER)
+  #define HEATER_POWER_BUDGET 240   // (W) For the heaters, what the PSU has left after motors and electronics
+  #define HOTEND_HEATER_POWER 40    // (W) Of each hotend heater at full duty
+  #define BED_HEATER_POWER 220      // (W) Of the bed heater at full duty
+  #define HEATUP_HOTEND_RATE 2.0    // (°C/s) Average hotend heat-up rate
+  #define HEATUP_LEAD_TIME 10       // (s) Start the hotend this much earlier
+#endif
+
 //Show Temperature ADC value
 //The M105 command return, besides traditional information, the ADC value read from temperature sensors.
 //#define SHOW_TEMP_ADC_VALUES
@@ -444,6 +482,62 @@
   // using:
   //#define MENU_ADDAUTOSTART
 
+  // Index the entries of the current folder in RAM (3 bytes each) so the
+  // SD menu and M23 don't re-read the folder from the start for every file.
+  #define SDCARD_DIR_INDEX
+  #if ENABLED(SDCARD_DIR_INDEX)
+    #define SD_DIR_INDEX_SIZE 128 // Entries beyond this are looked up on the card
+  #endif
+
+  // Take the progress and remaining time of SD prints from M73 P<percent> R<minutes>
+  // marks in the file (see tools/print_time.py --annotate) instead of the file position.
+  // M27 then also reports the remaining time.
+  #define SD_PRINT_TIME_ESTIMATE
+
+  // Save the SD print state (file position of the command that is moving, position,
+  // temperatures, fans) to a file on the card every SD_CHECKPOINT_INTERVAL seconds
+  // and when the print is stopped from the LCD. Each save is a single block write.
+  // After a power loss or a stop, M1000 reheats, homes and continues from that command.
+  // Up to SD_CHECKPOINT_INTERVAL seconds of moves before the power loss are redone.
+  #define SD_CHECKPOINT
+  #if ENABLED(SD_CHECKPOINT)
+    #define SD_CHECKPOINT_FILE "resume.dat" // In the root folder of the card
+    #define SD_CHECKPOINT_INTERVAL 30       // (seconds)
+    #define SD_CHECKPOINT_Z_CLEARANCE 5     // (mm) Move back in from this high above the print
+    #define SD_CHECKPOINT_PURGE 5           // (mm) Filament to extrude before moving back in
+  #endif
+
+  // Print the files listed in a manifest on the card back to back with M1001.
+  // Each manifest line is "<file> [copies]", files in the root folder given
+  // by their 8.3 names (e.g. "BRACKE~1.GCO"), as long names are not looked up.
+  // The next file is opened while the current one prints and its temperatures
+  // are read from its start. From SD_JOB_PREHEAT_PERCENT on the heaters are
+  // raised to those, the job's own heater-off commands are ignored and the
+  // next job starts without releasing the steppers.
+  #define SD_JOB_QUEUE
+  #if ENABLED(SD_JOB_QUEUE)
+    #define SD_JOB_MANIFEST "jobs.txt"
+    #define SD_JOB_PREHEAT_PERCENT 95 // Uses the M73 progress with SD_PRINT_TIME_ESTIMATE
+    #define SD_JOB_HEADER_BYTES 2048  // Look this far into the next file for M104/M109/M140/M190
+  #endif
+
+  // With "M28 S<bytes> <file>" the file is allocated in one piece up front and
+  // the received lines go to the card in whole blocks with a single multiple
+  // block write, so the FAT and folder are only written at the start and at M29.
+  // Lines beyond the announced size are appended the normal way. Blocks are
+  // staged in the SD volume cache, so no RAM is added.
+  #define SD_FAST_UPLOAD
+
+  // Receive files to the card in binary packets with M1002, without line numbers,
+  // checksums or an "ok" per line. Packets carry a CRC32, several can be on their
+  // way and the data may be LZ compressed. See file_transfer.h and tools/sd_upload.py.
+  #define BINARY_FILE_TRANSFER
+  #if ENABLED(BINARY_FILE_TRANSFER)
+    #define BINARY_FILE_TRANSFER_CHUNK 55   // Payload bytes per packet, two packets must fit in the serial RX buffer
+    #define BINARY_FILE_TRANSFER_LZ         // Accept compressed data (256 bytes more stack during M1002)
+    #define BINARY_FILE_TRANSFER_TIMEOUT 5  // (seconds) Give up when the host goes quiet
+  #endif
+
   // Show a progress bar on HD44780 LCDs for SD printing
   //#define LCD_PROGRESS_BAR
 
@@ -610,6 +704,11 @@
 // Set this if you find stepping unreliable, or if using a very fast CPU.
 #define MINIMUM_STEPPER_PULSE 0 // (µs) The smallest stepper pulse allowed
 
+// Write the step and dir pins of axes that share an AVR port with one masked
+// port write, so their pulses are simultaneous and the stepper ISR is shorter.
+// The grouping is taken from the board's pins file at compile time.
+#define COMBINED_STEP_WRITES
+
 // @section temperature
 
 // Control heater 0 and heater 1 in parallel.
@@ -644,6 +743,14 @@
 // :[0, 2, 4, 8, 16, 32, 64, 128, 256]
 #define TX_BUFFER_SIZE 0
 
+// Transmit Queue Size (use instead of TX_BUFFER_SIZE)
+// Output is queued as entries sent by the UART interrupt. An entry is a
+// PROGMEM string, which is never copied to RAM, or up to 4 bytes from RAM.
+// An "ok" or an echo/error prefix takes one entry, a number one per 4 digits.
+// Costs 5 bytes of RAM per entry (+4). Set to 0 to disable.
+// :[0, 2, 4, 8, 16, 32, 64, 128]
+#define TX_QUEUE_SIZE 16
+
 // Enable an emergency-command parser to intercept certain commands as they
 // enter the serial receive buffer, so they cannot be blocked.
 // Currently handles M108, M112, M410
@@ -1093,11 +1200,38 @@
 /**
  * Auto-report temperatures with M155 S<seconds>
  */
-//#define AUTO_REPORT_TEMPERATURES
+#define AUTO_REPORT_TEMPERATURES
+
+/**
+ * Auto-report the stepper position with M154 S<seconds>
+ * and the SD print status with M27 S<seconds>
+ *
+ * Reports are sent from idle() at the interval the host asks for, so
+ * the host can stop polling M114 and M27 through the command queue.
+ * S0 (the default) stops a report.
+ */
+#define AUTO_REPORT_POSITION
+#define AUTO_REPORT_SD_STATUS
+
+/**
+ * Cooperative scheduler for idle()
+ *
+ * Runs the idle-time tasks (heaters, inactivity, keepalive, LCD, ...) against a
+ * time budget. While the planner is close to running dry and commands are
+ * waiting, the LCD and other deferrable tasks are postponed (never beyond their
+ * deadline) so parsing and planning get the CPU first.
+ * Per-task run time statistics are reported with M102. M102 R resets them.
+ */
+#define IDLE_TASK_SCHEDULER
+#if ENABLED(IDLE_TASK_SCHEDULER)
+  #define IDLE_TIME_BUDGET_US     2000  // (µs) Deferrable tasks are skipped once idle() has used this much
+  #define IDLE_PLANNER_LOW_WATER     4  // Defer the LCD while fewer blocks than this are planned
+  #define IDLE_LCD_MAX_DEFER       500  // (ms) Update the LCD at least this often
+#endif
 
 /**
  * Include capabilities in M115 output
  */
-//#define EXTENDED_CAPABILITIES_REPORT
+#define EXTENDED_CAPABILITIES_REPORT
 
 #endif // CONFIGURATION_ADV_H
@@ -103,7 +103,11 @@ FORCE_INLINE void serial_echopair_P(const char* s_P, void *v) { serial_echopair_
 
 // Things to write to serial from Program memory. Saves 400 to 2k of RAM.
 FORCE_INLINE void serialprintPGM(const char* str) {
-  while (char ch = pgm_read_byte(str++)) MYSERIAL.write(ch);
+  #if !defined(USBCON) && TX_QUEUE_SIZE > 0
+    MYSERIAL.writePGM(str);
+  #else
+    while (char ch = pgm_read_byte(str++)) MYSERIAL.write(ch);
+  #endif
 }
 
 void idle(
@@ -229,6 +233,10 @@ void kill(const char*);
 
 void quickstop_stepper();
 
+#if ENABLED(SD_CHECKPOINT)
+  void save_sd_checkpoint(const bool stop=false);
+#endif
+
 #if ENABLED(FILAMENT_RUNOUT_SENSOR)
   void handle_filament_runout();
 #endif
@@ -244,6 +252,7 @@ bool enqueue_and_echo_command(const char* cmd, bool say_ok=false); //put a singl
 void enqueue_and_echo_command_now(const char* cmd); // enqueue now, only return when the command has been enqueued
 void enqueue_and_echo_commands_P(const char* cmd); //put one or many ASCII commands at the end of the current buffer, read from flash
 void clear_command_queue();
+void process_command(char* cmd, char* end); // run one command from text that needn't end with a nul
 
 extern millis_t previous_cmd_ms;
 inline void refresh_cmd_timeout() { previous_cmd_ms = millis(); }
@@ -317,6 +326,7 @@ float code_value_temp_diff();
 
 #if ENABLED(DELTA)
   extern float endstop_adj[ABC],
+               delta_tower_angle_trim[ABC],
                delta_radius,
                delta_diagonal_rod,
                delta_segments_per_second,
@@ -324,6 +334,7 @@ float code_value_temp_diff();
                delta_diagonal_rod_trim_tower_2,
                delta_diagonal_rod_trim_tower_3;
   void recalc_delta_settings(float radius, float diagonal_rod);
+  void forward_kinematics_DELTA(float z1, float z2, float z3);
 #elif IS_SCARA
   void forward_kinematics_SCARA(const float &a, const float &b);
 #endif
@@ -158,8 +158,27 @@
   }
 #endif  // SOFTWARE_SPI
 //------------------------------------------------------------------------------
+#if ENABLED(HEATER_0_USES_MAX6675)
+  volatile bool Sd2Card::spiBusy = false;
+#endif
+/** Send a byte with the card deselected, still holding the bus */
+static void spiSendDeselected(uint8_t b) {
+#if ENABLED(HEATER_0_USES_MAX6675)
+  Sd2Card::spiBusy = true;
+  spiSend(b);
+  Sd2Card::spiBusy = false;
+#else
+  spiSend(b);
+#endif
+}
+//------------------------------------------------------------------------------
 // send command and return error code.  Return zero for OK
 uint8_t Sd2Card::cardCommand(uint8_t cmd, uint32_t arg) {
+#if ENABLED(SD_FAST_UPLOAD)
+  // any other command ends a multiple block write, writeData() resumes it
+  if (writeStreaming_) writeStop();
+#endif
+
   // select card
   chipSelectLow();
 
@@ -216,9 +235,15 @@ uint32_t Sd2Card::cardSize() {
 //------------------------------------------------------------------------------
 void Sd2Card::chipSelectHigh() {
   digitalWrite(chipSelectPin_, HIGH);
+#if ENABLED(HEATER_0_USES_MAX6675)
+  spiBusy = false;
+#endif
 }
 //------------------------------------------------------------------------------
 void Sd2Card::chipSelectLow() {
+#if ENABLED(HEATER_0_USES_MAX6675)
+  spiBusy = true;
+#endif
   #if DISABLED(SOFTWARE_SPI)
     spiInit(spiRate_);
   #endif  // SOFTWARE_SPI
@@ -295,6 +320,9 @@ bool Sd2Card::eraseSingleBlockEnable() {
 bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
   errorCode_ = type_ = 0;
   chipSelectPin_ = chipSelectPin;
+#if ENABLED(SD_FAST_UPLOAD)
+  writeStreaming_ = false;
+#endif
   // 16-bit init start time allows over a minute
   uint16_t t0 = (uint16_t)millis();
   uint32_t arg;
@@ -319,7 +347,7 @@ bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
   #endif  // SOFTWARE_SPI
 
   // must supply min of 74 clock cycles with CS high.
-  for (uint8_t i = 0; i < 10; i++) spiSend(0XFF);
+  for (uint8_t i = 0; i < 10; i++) spiSendDeselected(0XFF);
 
   // command to go idle in SPI mode
   while ((status_ = cardCommand(CMD0, 0)) != R1_IDLE_STATE) {
@@ -503,12 +531,12 @@ bool Sd2Card::readData(uint8_t* dst, uint16_t count) {
 #endif
   chipSelectHigh();
   // Send an additional dummy byte, required by Toshiba Flash Air SD Card
-  spiSend(0XFF);
+  spiSendDeselected(0XFF);
   return true;
 fail:
   chipSelectHigh();
   // Send an additional dummy byte, required by Toshiba Flash Air SD Card
-  spiSend(0XFF);
+  spiSendDeselected(0XFF);
   return false;
 }
 //------------------------------------------------------------------------------
@@ -636,13 +664,22 @@ fail:
  * \param[in] src Pointer to the location of the data to be written.
  * \return The value one, true, is returned for success and
  * the value zero, false, is returned for failure.
+ *
+ * \note With SD_FAST_UPLOAD a sequence ended by another command is
+ * started again at the next block.
  */
 bool Sd2Card::writeData(const uint8_t* src) {
+#if ENABLED(SD_FAST_UPLOAD)
+  if (!writeStreaming_ && !writeStart(writeStreamBlock_, 0)) return false;
+#endif
   chipSelectLow();
   // wait for previous write to finish
   if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
   if (!writeData(WRITE_MULTIPLE_TOKEN, src)) goto fail;
   chipSelectHigh();
+#if ENABLED(SD_FAST_UPLOAD)
+  writeStreamBlock_++;
+#endif
   return true;
 fail:
   error(SD_CARD_ERROR_WRITE_MULTIPLE);
@@ -685,6 +722,9 @@ bool Sd2Card::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
     error(SD_CARD_ERROR_ACMD23);
     goto fail;
   }
+#if ENABLED(SD_FAST_UPLOAD)
+  writeStreamBlock_ = blockNumber;
+#endif
   // use address if not SDHC card
   if (type() != SD_CARD_TYPE_SDHC) blockNumber <<= 9;
   if (cardCommand(CMD25, blockNumber)) {
@@ -692,6 +732,9 @@ bool Sd2Card::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
     goto fail;
   }
   chipSelectHigh();
+#if ENABLED(SD_FAST_UPLOAD)
+  writeStreaming_ = true;
+#endif
   return true;
 fail:
   chipSelectHigh();
@@ -704,6 +747,10 @@ fail:
  * the value zero, false, is returned for failure.
  */
 bool Sd2Card::writeStop() {
+#if ENABLED(SD_FAST_UPLOAD)
+  if (!writeStreaming_) return true;
+  writeStreaming_ = false;
+#endif
   chipSelectLow();
   if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
   spiSend(STOP_TRAN_TOKEN);
@@ -132,6 +132,50 @@ bool SdBaseFile::contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock) {
     }
   }
 
+fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+uint32_t SdBaseFile::indexFirstCluster_ = 0;
+uint8_t SdBaseFile::indexShift_;
+uint32_t SdBaseFile::indexCluster_[SD_SEEK_INDEX_SIZE];
+
+/** Prepare a file opened for reading for fast seeks.
+ *
+ * A contiguous file is flagged so seekSet() can compute any cluster.
+ * For a fragmented file the chain is walked once and every n-th cluster
+ * is kept in the shared index, replacing the index of any other file.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ * Reasons for failure include the file is not open for reading only
+ * or an I/O error occurred.
+ */
+bool SdBaseFile::buildSeekIndex() {
+  uint32_t bgnBlock, endBlock, clusters, c;
+  if (!isFile() || (flags_ & O_ACCMODE) != O_READ) goto fail;
+  if (firstCluster_ == 0 || fileSize_ == 0) return true;
+
+  if (contiguousRange(&bgnBlock, &endBlock)) {
+    flags_ |= F_FILE_CONTIGUOUS;
+    return true;
+  }
+
+  clusters = ((fileSize_ - 1) >> (vol_->clusterSizeShift_ + 9)) + 1;
+  indexShift_ = 0;
+  while (((clusters - 1) >> indexShift_) >= SD_SEEK_INDEX_SIZE) indexShift_++;
+
+  indexFirstCluster_ = 0;
+  c = firstCluster_;
+  for (uint32_t n = 0; ; n++) {
+    if (!(n & ((1UL << indexShift_) - 1))) indexCluster_[n >> indexShift_] = c;
+    if (n + 1 == clusters) break;
+    if (!vol_->fatGet(c, &c)) goto fail;
+    if (vol_->isEOC(c)) goto fail;
+  }
+  indexFirstCluster_ = firstCluster_;
+  return true;
+
 fail:
   return false;
 }
@@ -1467,14 +1511,24 @@ bool SdBaseFile::seekSet(uint32_t pos) {
   nCur = (curPosition_ - 1) >> (vol_->clusterSizeShift_ + 9);
   nNew = (pos - 1) >> (vol_->clusterSizeShift_ + 9);
 
+  if (flags_ & F_FILE_CONTIGUOUS) {
+    curCluster_ = firstCluster_ + nNew;
+    curPosition_ = pos;
+    goto done;
+  }
+
   if (nNew < nCur || curPosition_ == 0) {
     // must follow chain from first cluster
     curCluster_ = firstCluster_;
+    nCur = 0;
   }
-  else {
-    // advance from curPosition
-    nNew -= nCur;
+  if (indexFirstCluster_ == firstCluster_ && (nNew >> indexShift_) > (nCur >> indexShift_)) {
+    // start from the last indexed cluster before the new position
+    nCur = nNew >> indexShift_;
+    curCluster_ = indexCluster_[nCur];
+    nCur <<= indexShift_;
   }
+  nNew -= nCur;
   while (nNew--) {
     if (!vol_->fatGet(curCluster_, &curCluster_)) goto fail;
   }
@@ -1492,6 +1546,43 @@ void SdBaseFile::setpos(filepos_t* pos) {
   curCluster_ = pos->cluster;
 }
 //------------------------------------------------------------------------------
+#if ENABLED(SD_FAST_UPLOAD)
+/** Get the cache to fill a block of a multiple block write, the way
+ * write() fills a partial block. Any other card access in between writes
+ * the block out and takes the cache, so a block already started is read
+ * back from the card.
+ *
+ * \param[in] block The block being filled.
+ * \param[in] started True if part of the block has been stored.
+ *
+ * \return Pointer to the block data or zero for an I/O error.
+ */
+uint8_t* SdBaseFile::streamCache(uint32_t block, bool started) {
+  if (vol_->cacheBlockNumber() != block) {
+    if (started) {
+      if (!vol_->cacheRawBlock(block, SdVolume::CACHE_FOR_WRITE)) return 0;
+    }
+    else {
+      if (!vol_->cacheFlush()) return 0;
+      vol_->cacheSetBlockNumber(block, true);
+    }
+  }
+  return vol_->cache()->data;
+}
+//------------------------------------------------------------------------------
+/** Send the block in the cache as the next block of the multiple block
+ * write and release the cache.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdBaseFile::streamCachedBlock() {
+  bool ok = vol_->sdCard()->writeData(vol_->cache()->data);
+  vol_->cacheSetBlockNumber(0XFFFFFFFF, false);
+  return ok;
+}
+#endif  // SD_FAST_UPLOAD
+//------------------------------------------------------------------------------
 /** The sync() call causes all modified data and directory fields
  * to be written to the storage device.
  *
@@ -1675,6 +1766,9 @@ bool SdBaseFile::truncate(uint32_t length) {
   // position to last cluster in truncated file
   if (!seekSet(length)) goto fail;
 
+  // the clusters freed below may end up in another file
+  indexFirstCluster_ = 0;
+
   if (length == 0) {
     // free all clusters
     if (!vol_->freeChain(firstCluster_)) goto fail;
@@ -211,10 +211,15 @@ class SdBaseFile {
    */
   void setpos(filepos_t* pos);
   //----------------------------------------------------------------------------
+  bool buildSeekIndex();
   bool close();
   bool contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock);
   bool createContiguous(SdBaseFile* dirFile,
                         const char* path, uint32_t size);
+#if ENABLED(SD_FAST_UPLOAD)
+  uint8_t* streamCache(uint32_t block, bool started);
+  bool streamCachedBlock();
+#endif
   /** \return The current cluster number for a file or directory. */
   uint32_t curCluster() const {return curCluster_;}
   /** \return The current position for a file or directory. */
@@ -340,9 +345,16 @@ class SdBaseFile {
   // bits defined in flags_
   // should be 0X0F
   static uint8_t const F_OFLAG = (O_ACCMODE | O_APPEND | O_SYNC);
+  // clusters are consecutive, set by buildSeekIndex()
+  static uint8_t const F_FILE_CONTIGUOUS = 0X40;
   // sync of directory entry required
   static uint8_t const F_FILE_DIR_DIRTY = 0X80;
 
+  // cluster index of one fragmented file, see buildSeekIndex()
+  static uint32_t indexFirstCluster_;  // file the index belongs to, 0 for none
+  static uint8_t indexShift_;          // log2 of the clusters between two entries
+  static uint32_t indexCluster_[SD_SEEK_INDEX_SIZE];
+
   // private data
   uint8_t   flags_;         // See above for definition of flags_ bits
   uint8_t   fstate_;        // error and eof indicator
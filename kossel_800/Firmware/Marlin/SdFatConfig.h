@@ -71,6 +71,17 @@
   #define ALLOW_DEPRECATED_FUNCTIONS 1
   //------------------------------------------------------------------------------
   /**
+  * Number of entries in the cluster index used by SdBaseFile::seekSet().
+  *
+  * SdBaseFile::buildSeekIndex() records every n-th cluster of a fragmented
+  * file, with n chosen so that SD_SEEK_INDEX_SIZE entries cover the file.
+  * A seek then follows at most n FAT links. Contiguous files need no index.
+  *
+  * One index is shared by all files and costs 4 bytes of SRAM per entry.
+  */
+  #define SD_SEEK_INDEX_SIZE 16
+  //------------------------------------------------------------------------------
+  /**
   * Allow FAT12 volumes if FAT12_SUPPORT is nonzero.
   * FAT12 has not been well tested.
   */
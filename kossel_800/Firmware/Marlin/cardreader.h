@@ -28,23 +28,55 @@
 #if ENABLED(SDSUPPORT)
 
 #define MAX_DIR_DEPTH 10          // Maximum folder depth
+#define SD_PROCEDURE_DEPTH 1      // Files called from the printed file with M32 P, nested
+#define MAXPATHNAMELENGTH (FILENAME_LENGTH*MAX_DIR_DEPTH + MAX_DIR_DEPTH + 1)
 
 #include "SdFile.h"
 
 #include "types.h"
 #include "enum.h"
 
+#if ENABLED(SD_CHECKPOINT)
+  /**
+   * State of an SD print, saved at the start of SD_CHECKPOINT_FILE.
+   * The absolute paths of the files from the printed one down to the
+   * one at 'depth' follow it, MAXPATHNAMELENGTH bytes each.
+   */
+  typedef struct {
+    uint16_t magic;                     // SD_CHECKPOINT_MAGIC while the print can be resumed
+    uint32_t sdpos;                     // Start of the command whose block was executing
+    uint8_t depth;                      // M32 procedure depth of the file holding that command
+    uint32_t return_sdpos[SD_PROCEDURE_DEPTH]; // Where each calling file carries on
+    float position[XYZE],               // Where the steppers were at that moment
+          feedrate_mm_s;
+    int16_t target_temperature[HOTENDS],
+            target_temperature_bed;
+    #if FAN_COUNT > 0
+      uint8_t fan_speed[FAN_COUNT];
+    #endif
+    uint8_t active_extruder;
+    bool relative_mode, axis_relative_modes[XYZE];
+  } sd_checkpoint_t;
+
+  #define SD_CHECKPOINT_MAGIC (0x5043 ^ sizeof(sd_checkpoint_t)) // Refuse checkpoints of another layout
+  static_assert(sizeof(sd_checkpoint_t) + (SD_PROCEDURE_DEPTH + 1) * (MAXPATHNAMELENGTH) <= 512, "The SD checkpoint must fit in one block.");
+#endif
+
 class CardReader {
 public:
   CardReader();
 
   void initsd();
   void write_command(char *buf);
+  bool write_data(const char *buf, const uint16_t len);
   //files auto[0-9].g on the sd card are performed in a row
   //this is to delay autostart and hence the initialisaiton of the sd card to some seconds after the normal init, so the device is available quick after a reset
 
   void checkautostart(bool x);
   void openFile(char* name, bool read, bool push_current=false);
+  #if ENABLED(SD_FAST_UPLOAD)
+    void openUpload(char* name, const uint32_t size);
+  #endif
   void openLogFile(char* name);
   void removeFile(char* name);
   void closefile(bool store_location=false);
@@ -55,6 +87,24 @@ public:
   void getStatus();
   void printingHasFinished();
 
+  #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+    void setEstimate(const uint8_t percent, const uint16_t minutes);
+    uint32_t remainingSeconds();
+  #endif
+
+  #if ENABLED(SD_JOB_QUEUE)
+    void startJobQueue(const char *manifest);
+    void endJobQueue();
+    void checkJobQueue();
+  #endif
+
+  #if ENABLED(SD_CHECKPOINT)
+    bool writeCheckpoint(sd_checkpoint_t &state);
+    bool readCheckpoint(sd_checkpoint_t &state, char path[][MAXPATHNAMELENGTH]);
+    FORCE_INLINE uint8_t procedureDepth() { return file_subcall_ctr; }
+    void clearCheckpoint();
+  #endif
+
   #if ENABLED(LONG_FILENAME_HOST_SUPPORT)
     void printLongPath(char *path);
   #endif
@@ -62,6 +112,10 @@ public:
   void getfilename(uint16_t nr, const char* const match=NULL);
   uint16_t getnrfilenames();
 
+  #if ENABLED(SDCARD_DIR_INDEX)
+    FORCE_INLINE void invalidateDirIndex() { dirIndexValid = false; }
+  #endif
+
   void getAbsFilename(char *t);
 
   void ls();
@@ -74,7 +128,19 @@ public:
   FORCE_INLINE bool eof() { return sdpos >= filesize; }
   FORCE_INLINE int16_t get() { sdpos = file.curPosition(); return (int16_t)file.read(); }
   FORCE_INLINE void setIndex(long index) { sdpos = index; file.seekSet(index); }
-  FORCE_INLINE uint8_t percentDone() { return (isFileOpen() && filesize) ? sdpos / ((filesize + 99) / 100) : 0; }
+  FORCE_INLINE uint32_t getIndex() { return sdpos; }
+  FORCE_INLINE uint8_t percentDone() {
+    #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+      if (estimateValid && isFileOpen()) return estimatePercent;
+    #endif
+    return (isFileOpen() && filesize) ? sdpos / ((filesize + 99) / 100) : 0;
+  }
+  #if ENABLED(SD_JOB_QUEUE)
+    // Near the end of a job with another one queued, heaters stay on
+    FORCE_INLINE bool jobQueueHoldsHeat() {
+      return jobQueueActive && (jobCopies || nextJobReady) && percentDone() >= (SD_JOB_PREHEAT_PERCENT);
+    }
+  #endif
   FORCE_INLINE char* getWorkDirName() { workDir.getFilename(filename); return filename; }
 
 public:
@@ -87,9 +153,8 @@ private:
   Sd2Card card;
   SdVolume volume;
   SdFile file;
+  bool fileInRoot; // file was opened from the root folder, not workDir
 
-  #define SD_PROCEDURE_DEPTH 1
-  #define MAXPATHNAMELENGTH (FILENAME_LENGTH*MAX_DIR_DEPTH + MAX_DIR_DEPTH + 1)
   uint8_t file_subcall_ctr;
   uint32_t filespos[SD_PROCEDURE_DEPTH];
   char proc_filenames[SD_PROCEDURE_DEPTH][MAXPATHNAMELENGTH];
@@ -103,6 +168,63 @@ private:
   uint16_t nrFiles; //counter for the files in the current directory and recycled as position counter for getting the nrFiles'th name in the directory.
   char* diveDirName;
   void lsDive(const char *prepend, SdFile parent, const char * const match=NULL);
+
+  #if ENABLED(SDCARD_DIR_INDEX)
+    // Where each item of workDir starts (in 32-byte entries, long name included)
+    // and a hash of its 8.3 name, so lookups need a single readDir().
+    typedef struct {
+      uint16_t entry;
+      uint8_t hash;
+    } dir_index_t;
+
+    dir_index_t dirIndex[SD_DIR_INDEX_SIZE];
+    uint16_t dirIndexCount; // Items in workDir, may exceed SD_DIR_INDEX_SIZE
+    bool dirIndexValid;
+
+    void buildDirIndex();
+    bool readIndexedEntry(const uint16_t i);
+  #endif
+
+  #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+    // Last M73 mark of the file being printed
+    bool estimateValid;
+    uint8_t estimatePercent;
+    uint16_t estimateMinutes;
+    millis_t estimateMillis;
+
+    FORCE_INLINE void clearEstimate() { estimateValid = false; estimateMinutes = 0; }
+  #endif
+
+  #if ENABLED(SD_JOB_QUEUE)
+    SdFile jobManifest,                 // Read one job ahead
+           nextJob;                     // Opened while the current job prints
+    char nextJobName[FILENAME_LENGTH];
+    uint16_t jobCopies, nextJobCopies;  // Runs left after the current one
+    int16_t nextJobHotend, nextJobBed;  // First temperatures set in nextJob, 0 if none
+    bool jobQueueActive, nextJobReady, jobPreheated;
+
+    bool loadNextJob();
+    void readJobTemperatures();
+    void startNextJob();
+  #endif
+
+  #if ENABLED(SD_FAST_UPLOAD)
+    // M28 S<size> sends whole blocks straight to a file allocated in one piece
+    uint32_t uploadBlock; // Block being filled in the volume cache
+    uint16_t uploadFill;  // Bytes of uploadBlock received so far
+    uint32_t uploadSize,  // Announced size, 0 when not uploading
+             uploadPos;   // Bytes received, uploadFill included
+
+    bool startUpload(const char* fname);
+    void uploadWrite(const char* buf, uint16_t len);
+    bool finishUpload();
+  #endif
+
+  #if ENABLED(SD_CHECKPOINT)
+    SdFile checkpointFile; // Open while printing, rewritten in place
+
+    void openCheckpoint();
+  #endif
 };
 
 extern CardReader card;
@@ -0,0 +1,265 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Marlin.h"
+
+#if ENABLED(BINARY_FILE_TRANSFER)
+
+#include "file_transfer.h"
+#include "cardreader.h"
+#include "language.h"
+
+// The RX ring holds one byte less than its size
+#define BFT_WINDOW (RX_BUFFER_SIZE - 1)
+
+#if 2 * (BINARY_FILE_TRANSFER_CHUNK + 8) > BFT_WINDOW
+  #error "Two BINARY_FILE_TRANSFER_CHUNK packets (8 bytes more each) must fit in RX_BUFFER_SIZE - 1."
+#endif
+
+#define BFT_SYNC 0xA5
+
+// After an error the input is dropped until it stays quiet this long (ms)
+#define BFT_QUIET_MS 100
+
+// CRC32 (IEEE) a nibble at a time, 64 bytes of table
+static const uint32_t crc_nibble[16] PROGMEM = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32(uint32_t crc, const uint8_t *buf, uint16_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    crc = (crc >> 4) ^ pgm_read_dword(&crc_nibble[crc & 0x0F]);
+    crc = (crc >> 4) ^ pgm_read_dword(&crc_nibble[crc & 0x0F]);
+  }
+  return ~crc;
+}
+
+bool FileTransfer::receiving = false;
+
+void FileTransfer::receive() {
+  uint8_t count = 0;
+  bool hunting = true;
+  expected = 0;
+  receiving = true;
+
+  SERIAL_PROTOCOLPGM(MSG_BFT_READY);
+  SERIAL_PROTOCOL(BFT_WINDOW);
+  SERIAL_PROTOCOLPGM(" chunk:");
+  SERIAL_PROTOCOL(BINARY_FILE_TRANSFER_CHUNK);
+  #if ENABLED(BINARY_FILE_TRANSFER_LZ)
+    SERIAL_PROTOCOLLNPGM(" lz:1");
+  #else
+    SERIAL_PROTOCOLLNPGM(" lz:0");
+  #endif
+
+  millis_t timeout = millis() + (BINARY_FILE_TRANSFER_TIMEOUT) * 1000UL;
+  for (;;) {
+    if (!MYSERIAL.available()) {
+      if (ELAPSED(millis(), timeout)) {
+        fail(PSTR("timeout"));
+        break;
+      }
+      idle();
+      continue;
+    }
+    timeout = millis() + (BINARY_FILE_TRANSFER_TIMEOUT) * 1000UL;
+
+    const uint8_t c = MYSERIAL.read();
+    if (hunting) {
+      if (c == BFT_SYNC) {
+        hunting = false;
+        count = 0;
+      }
+      continue;
+    }
+    packet[count++] = c;
+    if (count == 3 && packet[2] > BINARY_FILE_TRANSFER_CHUNK) {
+      hunting = true; // Not a packet header after all
+      resend();
+      continue;
+    }
+    if (count < 7 || count < 7 + packet[2]) continue;
+
+    hunting = true;
+    if (!handle()) break;
+    idle();
+  }
+  receiving = false;
+}
+
+/**
+ * Act on a whole packet. False ends the transfer.
+ */
+bool FileTransfer::handle() {
+  const uint8_t n = packet[2], seq = packet[1];
+  uint32_t sent;
+  memcpy(&sent, &packet[3 + n], sizeof(sent));
+  if (crc32(0, packet, 3 + n) != sent) {
+    resend();
+    return true;
+  }
+
+  if (packet[0] == 'A') return fail(PSTR("abort")); // In any order
+
+  if (seq != expected) {
+    if ((uint8_t)(expected - seq) <= 128)
+      reply(PSTR(MSG_BFT_ACK), expected - 1); // Sent again before our ack arrived
+    else
+      resend();
+    return true;
+  }
+
+  switch (packet[0]) {
+    case 'O':
+      if (card.saving) return fail(PSTR("open"));
+      if (!open()) return false;
+      break;
+    case 'D':
+      if (!card.saving) return fail(PSTR("open"));
+      if (!(
+        #if ENABLED(BINARY_FILE_TRANSFER_LZ)
+          lz ? inflate(&packet[3], n) :
+        #endif
+        store(&packet[3], n)
+      )) return fail(PSTR("write"));
+      break;
+    case 'C':
+      return close();
+    default:
+      return fail(PSTR("type"));
+  }
+
+  expected++;
+  reply(PSTR(MSG_BFT_ACK), seq);
+  return true;
+}
+
+bool FileTransfer::open() {
+  const uint8_t n = packet[2];
+  if (n < 6) return fail(PSTR("open"));
+  memcpy(&size, &packet[3], sizeof(size));
+  const uint8_t flags = packet[7];
+  #if ENABLED(BINARY_FILE_TRANSFER_LZ)
+    lz = TEST(flags, 0);
+    pos = flushed = 0;
+  #else
+    if (TEST(flags, 0)) return fail(PSTR("lz"));
+  #endif
+  written = crc = 0;
+
+  packet[3 + n] = '\0'; // Over the CRC, already checked
+  char * const path = (char*)&packet[8];
+  #if ENABLED(SD_FAST_UPLOAD)
+    card.openUpload(path, size);
+  #else
+    card.openFile(path, false);
+  #endif
+  return card.saving || fail(PSTR("open"));
+}
+
+bool FileTransfer::close() {
+  uint32_t sent;
+  memcpy(&sent, &packet[3], sizeof(sent));
+  card.closefile();
+  if (packet[2] != 4 || written != size || crc != sent) return fail(PSTR("crc"));
+  SERIAL_PROTOCOLLNPGM(MSG_BFT_DONE);
+  return false;
+}
+
+bool FileTransfer::store(const uint8_t *buf, const uint16_t len) {
+  crc = crc32(crc, buf, len);
+  written += len;
+  return card.write_data((const char*)buf, len);
+}
+
+#if ENABLED(BINARY_FILE_TRANSFER_LZ)
+
+  bool FileTransfer::emit(const uint8_t c) {
+    history[pos] = c;
+    if (++pos) return true;
+    const uint8_t from = flushed;
+    flushed = 0;
+    return store(&history[from], 256 - from);
+  }
+
+  bool FileTransfer::inflate(const uint8_t *src, const uint8_t n) {
+    const uint8_t * const end = src + n;
+    while (src < end) {
+      uint8_t flags = *src++;
+      for (uint8_t i = 8; i-- && src < end; flags >>= 1) {
+        if (TEST(flags, 0)) {
+          if (end - src < 2) return false;
+          const uint8_t back = *src++; // Distance - 1
+          for (uint16_t len = *src++ + 3; len--;)
+            if (!emit(history[(uint8_t)(pos - back - 1)])) return false;
+        }
+        else if (!emit(*src++))
+          return false;
+      }
+    }
+    const uint8_t from = flushed;
+    flushed = pos;
+    return pos == from || store(&history[from], pos - from);
+  }
+
+#endif // BINARY_FILE_TRANSFER_LZ
+
+void FileTransfer::resend() {
+  reply(PSTR(MSG_BFT_RESEND), expected);
+  drain();
+}
+
+bool FileTransfer::fail(const char * const why) {
+  if (card.saving) card.closefile();
+  SERIAL_PROTOCOLPGM(MSG_BFT_ERROR);
+  serialprintPGM(why);
+  SERIAL_EOL;
+  drain(); // Nothing the host had on its way reaches the command queue
+  return false;
+}
+
+/**
+ * Drop the input until the host has been quiet for BFT_QUIET_MS, then
+ * tell it to go on. The host stops sending when it reads resend or error.
+ */
+void FileTransfer::drain() {
+  millis_t quiet = millis() + BFT_QUIET_MS;
+  while (PENDING(millis(), quiet)) {
+    if (MYSERIAL.available()) {
+      (void)MYSERIAL.read();
+      quiet = millis() + BFT_QUIET_MS;
+    }
+    else
+      idle();
+  }
+  SERIAL_PROTOCOLLNPGM(MSG_BFT_SYNC);
+}
+
+void FileTransfer::reply(const char * const pstr, const uint8_t value) {
+  serialprintPGM(pstr);
+  SERIAL_PROTOCOLLN((int)value);
+}
+
+#endif // BINARY_FILE_TRANSFER
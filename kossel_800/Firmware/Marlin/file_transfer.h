@@ -0,0 +1,104 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FILE_TRANSFER_H
+#define FILE_TRANSFER_H
+
+#include "MarlinConfig.h"
+
+/**
+ * Binary file transfer to the SD card
+ *
+ * M1002 answers "BFT:1 window:<bytes> chunk:<bytes> lz:<0|1>" and then
+ * reads packets straight from the serial port, bypassing the command
+ * queue, until the file is closed, the host aborts or stays quiet for
+ * BINARY_FILE_TRANSFER_TIMEOUT seconds. The "ok" for M1002 follows.
+ *
+ * Packet (little endian):
+ *
+ *   0xA5  type  seq  n  payload[n]  crc32
+ *
+ *   type   'O' open:  file size (4 bytes), flags (1: LZ), path
+ *          'D' data:  file bytes, or LZ groups with the LZ flag
+ *          'C' close: CRC32 of the whole file (4 bytes)
+ *          'A' abort, with any seq
+ *   seq    0 for the open packet, then +1 per packet
+ *   n      Up to 'chunk' payload bytes
+ *   crc32  IEEE CRC32 of type, seq, n and the payload
+ *
+ * Replies are text lines among the usual serial output:
+ *
+ *   "BFT ack:<seq>"      Packets up to seq are written
+ *   "BFT resend:<seq>"   A packet was corrupt or lost, send again from seq
+ *   "BFT done"           Closed with the right size and CRC
+ *   "BFT error:<why>"    The transfer is over (open, write, crc, lz, timeout, abort)
+ *   "BFT sync"           Follows resend and error once the input is drained
+ *
+ * The host may have up to 'window' bytes sent and not acknowledged. That
+ * is the serial receive buffer, so nothing is lost while a block goes to
+ * the card, and idle() leaves it alone until the transfer is over. After
+ * a resend request or an error the printer throws away what arrives until
+ * the line has been quiet for BFT_QUIET_MS, so nothing still in flight is
+ * taken for a new packet or for G-code. The host stops sending when it
+ * reads either line and waits for "BFT sync".
+ *
+ * LZ data comes in groups of a flag byte and up to 8 items, low bit
+ * first. A 0 bit is a literal byte, a 1 bit a match of two bytes: distance
+ * minus 1 and length minus 3, copied from the last 256 bytes of the file.
+ * Groups don't span packets.
+ *
+ * See tools/sd_upload.py for a client.
+ */
+class FileTransfer {
+  public:
+    static bool receiving; // The serial input is the transfer's, not the command queue's
+
+    void receive();
+
+  private:
+    uint8_t packet[3 + BINARY_FILE_TRANSFER_CHUNK + 4]; // type, seq, n, payload, crc32
+    uint8_t expected;   // seq of the next packet
+    uint32_t size,      // Announced by the open packet
+             written,
+             crc;       // Of the bytes written so far
+
+    #if ENABLED(BINARY_FILE_TRANSFER_LZ)
+      bool lz;
+      uint8_t history[256], // The last 256 bytes of the file
+              pos,          // Next byte of history
+              flushed;      // history from here to pos isn't written yet
+
+      bool emit(const uint8_t c);
+      bool inflate(const uint8_t *src, const uint8_t n);
+    #endif
+
+    bool handle();
+    bool open();
+    bool close();
+    bool store(const uint8_t *buf, const uint16_t len);
+    void resend();
+    bool fail(const char * const why);
+    static void drain();
+    static void reply(const char * const pstr, const uint8_t value);
+};
+
+#endif // FILE_TRANSFER_H
@@ -78,6 +78,7 @@ Planner planner;
  * A ring buffer of moves described in steps
  */
 block_t Planner::block_buffer[BLOCK_BUFFER_SIZE];
+block_plan_t Planner::block_plan[BLOCK_BUFFER_SIZE];
 volatile uint8_t Planner::block_buffer_head = 0,           // Index of the next block to be pushed
                  Planner::block_buffer_tail = 0;
 
@@ -89,8 +90,8 @@ float Planner::max_feedrate_mm_s[XYZE_N], // Max speeds in mm per second
   uint8_t Planner::last_extruder = 0;     // Respond to extruder change
 #endif
 
-uint32_t Planner::max_acceleration_steps_per_s2[XYZE_N],
-         Planner::max_acceleration_mm_per_s2[XYZE_N]; // Use M201 to override by software
+unsigned long Planner::max_acceleration_steps_per_s2[XYZE_N],
+              Planner::max_acceleration_mm_per_s2[XYZE_N]; // Use M201 to override by software
 
 millis_t Planner::min_segment_time;
 float Planner::min_feedrate_mm_s,
@@ -100,6 +101,11 @@ float Planner::min_feedrate_mm_s,
       Planner::max_jerk[XYZE],       // The largest speed change requiring no acceleration
       Planner::min_travel_feedrate_mm_s;
 
+#if ENABLED(SD_CHECKPOINT)
+  uint32_t Planner::command_sdpos = NO_SD_POS;
+  uint8_t Planner::command_sddepth = 0;
+#endif
+
 #if HAS_ABL
   bool Planner::abl_enabled = false; // Flag that auto bed leveling is enabled
 #endif
@@ -174,7 +180,10 @@ void Planner::init() {
  * Calculate trapezoid parameters, multiplying the entry- and exit-speeds
  * by the provided factors.
  */
-void Planner::calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor) {
+void Planner::calculate_trapezoid_for_block(const uint8_t block_index, const float &entry_factor, const float &exit_factor) {
+  block_t* const block = &block_buffer[block_index];
+  block_plan_t* const plan = &block_plan[block_index];
+
   uint32_t initial_rate = ceil(block->nominal_rate * entry_factor),
            final_rate = ceil(block->nominal_rate * exit_factor); // (steps per second)
 
@@ -182,7 +191,7 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
   NOLESS(initial_rate, MINIMAL_STEP_RATE);
   NOLESS(final_rate, MINIMAL_STEP_RATE);
 
-  int32_t accel = block->acceleration_steps_per_s2,
+  int32_t accel = plan->acceleration_steps_per_s2,
           accelerate_steps = ceil(estimate_acceleration_distance(initial_rate, block->nominal_rate, accel)),
           decelerate_steps = floor(estimate_acceleration_distance(block->nominal_rate, final_rate, -accel)),
           plateau_steps = block->step_event_count - accelerate_steps - decelerate_steps;
@@ -193,7 +202,7 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
   if (plateau_steps < 0) {
     accelerate_steps = ceil(intersection_distance(initial_rate, final_rate, accel, block->step_event_count));
     NOLESS(accelerate_steps, 0); // Check limits due to numerical round-off
-    accelerate_steps = min((uint32_t)accelerate_steps, block->step_event_count);//(We can cast here to unsigned, because the above line ensures that we are above zero)
+    NOMORE(accelerate_steps, (int32_t)block->step_event_count);
     plateau_steps = 0;
   }
 
@@ -201,14 +210,14 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
   // block->decelerate_after = accelerate_steps+plateau_steps;
 
   CRITICAL_SECTION_START;  // Fill variables used by the stepper in a critical section
-  if (!TEST(block->flag, BLOCK_BIT_BUSY)) { // Don't update variables if block is busy.
+  if (!TEST(plan->flag, BLOCK_BIT_BUSY)) { // Don't update variables if block is busy.
     block->accelerate_until = accelerate_steps;
     block->decelerate_after = accelerate_steps + plateau_steps;
     block->initial_rate = initial_rate;
     block->final_rate = final_rate;
     #if ENABLED(ADVANCE)
-      block->initial_advance = block->advance * sq(entry_factor);
-      block->final_advance = block->advance * sq(exit_factor);
+      block->initial_advance = plan->advance * sq(entry_factor);
+      block->final_advance = plan->advance * sq(exit_factor);
     #endif
   }
   CRITICAL_SECTION_END;
@@ -224,7 +233,7 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
 
 
 // The kernel called by recalculate() when scanning the plan from last to first entry.
-void Planner::reverse_pass_kernel(block_t* const current, const block_t *next) {
+void Planner::reverse_pass_kernel(block_plan_t* const current, const block_plan_t *next) {
   if (!current || !next) return;
   // If entry speed is already at the maximum entry speed, no need to recheck. Block is cruising.
   // If not, block in state of acceleration or deceleration. Reset entry speed to maximum and
@@ -248,7 +257,7 @@ void Planner::reverse_pass() {
 
   if (movesplanned() > 3) {
 
-    block_t* block[3] = { NULL, NULL, NULL };
+    block_plan_t* block[3] = { NULL, NULL, NULL };
 
     // Make a local copy of block_buffer_tail, because the interrupt can alter it
     // Is a critical section REALLY needed for a single byte change?
@@ -262,14 +271,14 @@ void Planner::reverse_pass() {
       b = prev_block_index(b);
       block[2] = block[1];
       block[1] = block[0];
-      block[0] = &block_buffer[b];
+      block[0] = &block_plan[b];
       reverse_pass_kernel(block[1], block[2]);
     }
   }
 }
 
 // The kernel called by recalculate() when scanning the plan from first to last entry.
-void Planner::forward_pass_kernel(const block_t* previous, block_t* const current) {
+void Planner::forward_pass_kernel(const block_plan_t* previous, block_plan_t* const current) {
   if (!previous) return;
 
   // If the previous block is an acceleration block, but it is not long enough to complete the
@@ -294,12 +303,12 @@ void Planner::forward_pass_kernel(const block_t* previous, block_t* const curren
  * Once in reverse and once forward. This implements the forward pass.
  */
 void Planner::forward_pass() {
-  block_t* block[3] = { NULL, NULL, NULL };
+  block_plan_t* block[3] = { NULL, NULL, NULL };
 
   for (uint8_t b = block_buffer_tail; b != block_buffer_head; b = next_block_index(b)) {
     block[0] = block[1];
     block[1] = block[2];
-    block[2] = &block_buffer[b];
+    block[2] = &block_plan[b];
     forward_pass_kernel(block[0], block[1]);
   }
   forward_pass_kernel(block[1], block[2]);
@@ -311,27 +320,28 @@ void Planner::forward_pass() {
  * recalculate() after updating the blocks.
  */
 void Planner::recalculate_trapezoids() {
-  int8_t block_index = block_buffer_tail;
-  block_t *current, *next = NULL;
+  int8_t block_index = block_buffer_tail, current_index = -1;
+  block_plan_t *current, *next = NULL;
 
   while (block_index != block_buffer_head) {
     current = next;
-    next = &block_buffer[block_index];
+    next = &block_plan[block_index];
     if (current) {
       // Recalculate if current block entry or exit junction speed has changed.
       if (TEST(current->flag, BLOCK_BIT_RECALCULATE) || TEST(next->flag, BLOCK_BIT_RECALCULATE)) {
         // NOTE: Entry and exit factors always > 0 by all previous logic operations.
         float nom = current->nominal_speed;
-        calculate_trapezoid_for_block(current, current->entry_speed / nom, next->entry_speed / nom);
+        calculate_trapezoid_for_block(current_index, current->entry_speed / nom, next->entry_speed / nom);
         CBI(current->flag, BLOCK_BIT_RECALCULATE); // Reset current only to ensure next trapezoid is computed
       }
     }
+    current_index = block_index;
     block_index = next_block_index(block_index);
   }
   // Last/newest block in buffer. Exit speed is set with MINIMUM_PLANNER_SPEED. Always recalculated.
   if (next) {
     float nom = next->nominal_speed;
-    calculate_trapezoid_for_block(next, next->entry_speed / nom, (MINIMUM_PLANNER_SPEED) / nom);
+    calculate_trapezoid_for_block(current_index, next->entry_speed / nom, (MINIMUM_PLANNER_SPEED) / nom);
     CBI(next->flag, BLOCK_BIT_RECALCULATE);
   }
 }
@@ -379,7 +389,7 @@ void Planner::recalculate() {
     for (uint8_t b = block_buffer_tail; b != block_buffer_head; b = next_block_index(b)) {
       block_t* block = &block_buffer[b];
       if (block->steps[X_AXIS] || block->steps[Y_AXIS] || block->steps[Z_AXIS]) {
-        float se = (float)block->steps[E_AXIS] / block->step_event_count * block->nominal_speed; // mm/sec;
+        float se = (float)block->steps[E_AXIS] / block->step_event_count * block_plan[b].nominal_speed; // mm/sec;
         NOLESS(high, se);
       }
     }
@@ -396,6 +406,43 @@ void Planner::recalculate() {
 
 #endif //AUTOTEMP
 
+#if ENABLED(PID_FEEDFORWARD)
+
+  void Planner::upcoming_load(float &e_rate, float &fan) {
+    float time = 0.0, feed = 0.0, cooling = 0.0;
+    for (uint8_t b = block_buffer_tail; b != block_buffer_head && time < (PID_FEEDFORWARD_LEAD); b = next_block_index(b)) {
+      const block_t * const block = &block_buffer[b];
+      const block_plan_t * const plan = &block_plan[b];
+      if (plan->nominal_speed <= 0.0) continue;
+      const float t = plan->millimeters / plan->nominal_speed;
+      time += t;
+      #if FAN_COUNT > 0
+        cooling += plan->fan_speed[0] * t;
+      #endif
+      // Retracts and recovers cancel out, only printing moves melt filament
+      if (block->steps[X_AXIS] || block->steps[Y_AXIS] || block->steps[Z_AXIS]) {
+        #if ENABLED(DISTINCT_E_FACTORS)
+          const uint8_t extruder = block->active_extruder;
+        #endif
+        feed += block->steps[E_AXIS] * steps_to_mm[E_AXIS_N];
+      }
+    }
+    if (time > 0.0) {
+      e_rate = feed / time;
+      fan = cooling / time;
+    }
+    else {
+      e_rate = 0.0;
+      #if FAN_COUNT > 0
+        fan = fanSpeeds[0];
+      #else
+        fan = 0.0;
+      #endif
+    }
+  }
+
+#endif // PID_FEEDFORWARD
+
 /**
  * Maintain fans, paste extruder pressure,
  */
@@ -419,18 +466,17 @@ void Planner::check_axes_activity() {
   if (blocks_queued()) {
 
     #if FAN_COUNT > 0
-      for (uint8_t i = 0; i < FAN_COUNT; i++) tail_fan_speed[i] = block_buffer[block_buffer_tail].fan_speed[i];
+      for (uint8_t i = 0; i < FAN_COUNT; i++) tail_fan_speed[i] = block_plan[block_buffer_tail].fan_speed[i];
     #endif
 
     block_t* block;
 
     #if ENABLED(BARICUDA)
-      block = &block_buffer[block_buffer_tail];
       #if HAS_HEATER_1
-        tail_valve_pressure = block->valve_pressure;
+        tail_valve_pressure = block_plan[block_buffer_tail].valve_pressure;
       #endif
       #if HAS_HEATER_2
-        tail_e_to_p_pressure = block->e_to_p_pressure;
+        tail_e_to_p_pressure = block_plan[block_buffer_tail].e_to_p_pressure;
       #endif
     #endif
 
@@ -651,6 +697,55 @@ void Planner::check_axes_activity() {
  */
 void Planner::_buffer_line(const float &a, const float &b, const float &c, const float &e, float fr_mm_s, const uint8_t extruder) {
 
+  // When changing extruders recalculate steps corresponding to the E position
+  #if ENABLED(DISTINCT_E_FACTORS)
+    if (last_extruder != extruder && axis_steps_per_mm[E_AXIS_N] != axis_steps_per_mm[E_AXIS + last_extruder]) {
+      position[E_AXIS] = lround(position[E_AXIS] * axis_steps_per_mm[E_AXIS_N] * steps_to_mm[E_AXIS + last_extruder]);
+      last_extruder = extruder;
+    }
+  #endif
+
+  // Moves whose step counts would overflow block_t go in as equal collinear
+  // pieces, one after another. Rare: E loading, long homing moves.
+  const uint32_t sa = labs(lround(a * axis_steps_per_mm[X_AXIS]) - position[X_AXIS]),
+                 sb = labs(lround(b * axis_steps_per_mm[Y_AXIS]) - position[Y_AXIS]),
+                 sc = labs(lround(c * axis_steps_per_mm[Z_AXIS]) - position[Z_AXIS]),
+                 se = fabs((lround(e * axis_steps_per_mm[E_AXIS_N]) - position[E_AXIS]) * volumetric_multiplier[extruder] * flow_percentage[extruder] * 0.01);
+  #if IS_CORE
+    const uint32_t most = max(sa + sb + sc, se); // Upper bound for the mixed core motors
+  #else
+    const uint32_t most = MAX4(sa, sb, sc, se);
+  #endif
+  if (most > MAX_BLOCK_STEPS) {
+    // Rounding the ends of a piece can add a step
+    const uint32_t pieces = most / (MAX_BLOCK_STEPS - 1) + 1;
+    const float start[XYZE] = {
+      position[X_AXIS] * steps_to_mm[X_AXIS],
+      position[Y_AXIS] * steps_to_mm[Y_AXIS],
+      position[Z_AXIS] * steps_to_mm[Z_AXIS],
+      position[E_AXIS] * steps_to_mm[E_AXIS_N]
+    };
+    for (uint32_t i = 1; i < pieces; i++) {
+      const float f = (float)i / pieces;
+      _buffer_steps(
+        start[X_AXIS] + (a - start[X_AXIS]) * f,
+        start[Y_AXIS] + (b - start[Y_AXIS]) * f,
+        start[Z_AXIS] + (c - start[Z_AXIS]) * f,
+        start[E_AXIS] + (e - start[E_AXIS]) * f,
+        fr_mm_s, extruder
+      );
+    }
+  }
+  _buffer_steps(a, b, c, e, fr_mm_s, extruder);
+}
+
+/**
+ * Planner::_buffer_steps
+ *
+ * Add a block for a move short enough for block_t's 16-bit step counts.
+ */
+void Planner::_buffer_steps(const float &a, const float &b, const float &c, const float &e, float fr_mm_s, const uint8_t extruder) {
+
   // The target position of the tool in absolute steps
   // Calculate target position in absolute steps
   //this should be done after the wait, because otherwise a M92 code within the gcode disrupts this calculation somehow
@@ -661,14 +756,6 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     lround(e * axis_steps_per_mm[E_AXIS_N])
   };
 
-  // When changing extruders recalculate steps corresponding to the E position
-  #if ENABLED(DISTINCT_E_FACTORS)
-    if (last_extruder != extruder && axis_steps_per_mm[E_AXIS_N] != axis_steps_per_mm[E_AXIS + last_extruder]) {
-      position[E_AXIS] = lround(position[E_AXIS] * axis_steps_per_mm[E_AXIS_N] * steps_to_mm[E_AXIS + last_extruder]);
-      last_extruder = extruder;
-    }
-  #endif
-
   #if ENABLED(LIN_ADVANCE)
     float target_float[XYZE] = {a, b, c, e};
     float de_float = target_float[E_AXIS] - position_float[E_AXIS];
@@ -767,9 +854,10 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
 
   // Prepare to set up new block
   block_t* block = &block_buffer[block_buffer_head];
+  block_plan_t* plan = &block_plan[block_buffer_head];
 
   // Clear all flags, including the "busy" bit
-  block->flag = 0;
+  plan->flag = 0;
 
   // Set direction bits
   block->direction_bits = dm;
@@ -808,12 +896,18 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
   #endif
 
   #if FAN_COUNT > 0
-    for (uint8_t i = 0; i < FAN_COUNT; i++) block->fan_speed[i] = fanSpeeds[i];
+    for (uint8_t i = 0; i < FAN_COUNT; i++) plan->fan_speed[i] = fanSpeeds[i];
   #endif
 
   #if ENABLED(BARICUDA)
-    block->valve_pressure = baricuda_valve_pressure;
-    block->e_to_p_pressure = baricuda_e_to_p_pressure;
+    plan->valve_pressure = baricuda_valve_pressure;
+    plan->e_to_p_pressure = baricuda_e_to_p_pressure;
+  #endif
+
+  #if ENABLED(SD_CHECKPOINT)
+    plan->sdpos = command_sdpos;
+    plan->sddepth = command_sddepth;
+    plan->feedrate_mm_m = min(MMS_TO_MMM(fr_mm_s), 65535);
   #endif
 
   block->active_extruder = extruder;
@@ -960,10 +1054,10 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
   delta_mm[E_AXIS] = esteps_float * steps_to_mm[E_AXIS_N];
 
   if (block->steps[X_AXIS] < MIN_STEPS_PER_SEGMENT && block->steps[Y_AXIS] < MIN_STEPS_PER_SEGMENT && block->steps[Z_AXIS] < MIN_STEPS_PER_SEGMENT) {
-    block->millimeters = fabs(delta_mm[E_AXIS]);
+    plan->millimeters = fabs(delta_mm[E_AXIS]);
   }
   else {
-    block->millimeters = sqrt(
+    plan->millimeters = sqrt(
       #if CORE_IS_XY
         sq(delta_mm[X_HEAD]) + sq(delta_mm[Y_HEAD]) + sq(delta_mm[Z_AXIS])
       #elif CORE_IS_XZ
@@ -975,7 +1069,7 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
       #endif
     );
   }
-  float inverse_millimeters = 1.0 / block->millimeters;  // Inverse millimeters to remove multiple divides
+  float inverse_millimeters = 1.0 / plan->millimeters;  // Inverse millimeters to remove multiple divides
 
   // Calculate moves/second for this move. No divide by zero due to previous checks.
   float inverse_mm_s = fr_mm_s * inverse_millimeters;
@@ -1006,12 +1100,12 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
       inverse_mm_s = 1000000.0 / (1000.0 * (MIN_BLOCK_TIME));
       segment_time = (MIN_BLOCK_TIME) * 1000UL;
     }
-    block->segment_time = segment_time;
+    plan->segment_time = segment_time;
     block_buffer_runtime_us += segment_time;
   #endif
 
-  block->nominal_speed = block->millimeters * inverse_mm_s; // (mm/sec) Always > 0
-  block->nominal_rate = ceil(block->step_event_count * inverse_mm_s); // (step/sec) Always > 0
+  plan->nominal_speed = plan->millimeters * inverse_mm_s; // (mm/sec) Always > 0
+  float nominal_rate = ceil(block->step_event_count * inverse_mm_s); // (step/sec) Always > 0
 
   #if ENABLED(FILAMENT_WIDTH_SENSOR)
     static float filwidth_e_count = 0, filwidth_delay_dist = 0;
@@ -1092,12 +1186,16 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     }
   #endif // XY_FREQUENCY_LIMIT
 
+  // The stepper can't go faster than MAX_STEP_FREQUENCY. Plan for that (and keep the rates in 16 bits).
+  if (nominal_rate * speed_factor > MAX_STEP_FREQUENCY) speed_factor = (MAX_STEP_FREQUENCY) / nominal_rate;
+
   // Correct the speed
   if (speed_factor < 1.0) {
     LOOP_XYZE(i) current_speed[i] *= speed_factor;
-    block->nominal_speed *= speed_factor;
-    block->nominal_rate *= speed_factor;
+    plan->nominal_speed *= speed_factor;
+    nominal_rate *= speed_factor;
   }
+  block->nominal_rate = nominal_rate;
 
   // Compute and limit the acceleration rate for the trapezoid generator.
   float steps_per_mm = block->step_event_count * inverse_millimeters;
@@ -1138,8 +1236,8 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
       LIMIT_ACCEL_FLOAT(E_AXIS,extruder);
     }
   }
-  block->acceleration_steps_per_s2 = accel;
-  block->acceleration = accel / steps_per_mm;
+  plan->acceleration_steps_per_s2 = accel;
+  plan->acceleration = accel / steps_per_mm;
   block->acceleration_rate = (long)(accel * 16777216.0 / ((F_CPU) * 0.125)); // * 8.388608
 
   // Initial limit on the segment entry velocity
@@ -1183,12 +1281,12 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
                         - previous_unit_vec[Z_AXIS] * unit_vec[Z_AXIS] ;
       // Skip and use default max junction speed for 0 degree acute junction.
       if (cos_theta < 0.95) {
-        vmax_junction = min(previous_nominal_speed, block->nominal_speed);
+        vmax_junction = min(previous_nominal_speed, plan->nominal_speed);
         // Skip and avoid divide by zero for straight junctions at 180 degrees. Limit to min() of nominal speeds.
         if (cos_theta > -0.95) {
           // Compute maximum junction velocity based on maximum acceleration and junction deviation
           float sin_theta_d2 = sqrt(0.5 * (1.0 - cos_theta)); // Trig half angle identity. Always positive.
-          NOMORE(vmax_junction, sqrt(block->acceleration * junction_deviation * sin_theta_d2 / (1.0 - sin_theta_d2)));
+          NOMORE(vmax_junction, sqrt(plan->acceleration * junction_deviation * sin_theta_d2 / (1.0 - sin_theta_d2)));
         }
       }
     }
@@ -1203,7 +1301,7 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
   // Exit speed limited by a jerk to full halt of a previous last segment
   static float previous_safe_speed;
 
-  float safe_speed = block->nominal_speed;
+  float safe_speed = plan->nominal_speed;
   bool limited = false;
   LOOP_XYZE(i) {
     float jerk = fabs(current_speed[i]);
@@ -1211,10 +1309,10 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
       // The actual jerk is lower if it has been limited by the XY jerk.
       if (limited) {
         // Spare one division by a following gymnastics:
-        // Instead of jerk *= safe_speed / block->nominal_speed,
+        // Instead of jerk *= safe_speed / plan->nominal_speed,
         // multiply max_jerk[i] by the divisor.
         jerk *= safe_speed;
-        float mjerk = max_jerk[i] * block->nominal_speed;
+        float mjerk = max_jerk[i] * plan->nominal_speed;
         if (jerk > mjerk) safe_speed *= mjerk / jerk;
       }
       else {
@@ -1230,10 +1328,10 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     // then the machine is not coasting anymore and the safe entry / exit velocities shall be used.
 
     // The junction velocity will be shared between successive segments. Limit the junction velocity to their minimum.
-    bool prev_speed_larger = previous_nominal_speed > block->nominal_speed;
-    float smaller_speed_factor = prev_speed_larger ? (block->nominal_speed / previous_nominal_speed) : (previous_nominal_speed / block->nominal_speed);
+    bool prev_speed_larger = previous_nominal_speed > plan->nominal_speed;
+    float smaller_speed_factor = prev_speed_larger ? (plan->nominal_speed / previous_nominal_speed) : (previous_nominal_speed / plan->nominal_speed);
     // Pick the smaller of the nominal speeds. Higher speed shall not be achieved at the junction during coasting.
-    vmax_junction = prev_speed_larger ? block->nominal_speed : previous_nominal_speed;
+    vmax_junction = prev_speed_larger ? plan->nominal_speed : previous_nominal_speed;
     // Factor to multiply the previous / current nominal velocities to get componentwise limited velocities.
     float v_factor = 1.f;
     limited = false;
@@ -1272,21 +1370,21 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     if (previous_safe_speed > vmax_junction_threshold && safe_speed > vmax_junction_threshold) {
       // Not coasting. The machine will stop and start the movements anyway,
       // better to start the segment from start.
-      SBI(block->flag, BLOCK_BIT_START_FROM_FULL_HALT);
+      SBI(plan->flag, BLOCK_BIT_START_FROM_FULL_HALT);
       vmax_junction = safe_speed;
     }
   }
   else {
-    SBI(block->flag, BLOCK_BIT_START_FROM_FULL_HALT);
+    SBI(plan->flag, BLOCK_BIT_START_FROM_FULL_HALT);
     vmax_junction = safe_speed;
   }
 
   // Max entry speed of this block equals the max exit speed of the previous block.
-  block->max_entry_speed = vmax_junction;
+  plan->max_entry_speed = vmax_junction;
 
   // Initialize block entry speed. Compute based on deceleration to user-defined MINIMUM_PLANNER_SPEED.
-  float v_allowable = max_allowable_speed(-block->acceleration, MINIMUM_PLANNER_SPEED, block->millimeters);
-  block->entry_speed = min(vmax_junction, v_allowable);
+  float v_allowable = max_allowable_speed(-plan->acceleration, MINIMUM_PLANNER_SPEED, plan->millimeters);
+  plan->entry_speed = min(vmax_junction, v_allowable);
 
   // Initialize planner efficiency flags
   // Set flag if block will always reach maximum junction speed regardless of entry/exit speeds.
@@ -1296,11 +1394,11 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
   // block nominal speed limits both the current and next maximum junction speeds. Hence, in both
   // the reverse and forward planners, the corresponding block junction speed will always be at the
   // the maximum junction speed and may always be ignored for any speed reduction checks.
-  block->flag |= BLOCK_FLAG_RECALCULATE | (block->nominal_speed <= v_allowable ? BLOCK_FLAG_NOMINAL_LENGTH : 0);
+  plan->flag |= BLOCK_FLAG_RECALCULATE | (plan->nominal_speed <= v_allowable ? BLOCK_FLAG_NOMINAL_LENGTH : 0);
 
   // Update previous path unit_vector and nominal speed
   memcpy(previous_speed, current_speed, sizeof(previous_speed));
-  previous_nominal_speed = block->nominal_speed;
+  previous_nominal_speed = plan->nominal_speed;
   previous_safe_speed = safe_speed;
 
   #if ENABLED(LIN_ADVANCE)
@@ -1319,7 +1417,7 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     }
     else {
       block->use_advance_lead = true;
-      block->abs_adv_steps_multiplier8 = lround(extruder_advance_k * (de_float / mm_D_float) * block->nominal_speed / (float)block->nominal_rate * axis_steps_per_mm[E_AXIS_N] * 256.0);
+      block->abs_adv_steps_multiplier8 = lround(extruder_advance_k * (de_float / mm_D_float) * plan->nominal_speed / (float)block->nominal_rate * axis_steps_per_mm[E_AXIS_N] * 256.0);
     }
 
   #elif ENABLED(ADVANCE)
@@ -1327,25 +1425,25 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     // Calculate advance rate
     if (!esteps || (!block->steps[X_AXIS] && !block->steps[Y_AXIS] && !block->steps[Z_AXIS])) {
       block->advance_rate = 0;
-      block->advance = 0;
+      plan->advance = 0;
     }
     else {
-      long acc_dist = estimate_acceleration_distance(0, block->nominal_rate, block->acceleration_steps_per_s2);
+      long acc_dist = estimate_acceleration_distance(0, block->nominal_rate, plan->acceleration_steps_per_s2);
       float advance = ((STEPS_PER_CUBIC_MM_E) * (EXTRUDER_ADVANCE_K)) * HYPOT(current_speed[E_AXIS], EXTRUSION_AREA) * 256;
-      block->advance = advance;
+      plan->advance = advance;
       block->advance_rate = acc_dist ? advance / (float)acc_dist : 0;
     }
     /**
      SERIAL_ECHO_START;
      SERIAL_ECHOPGM("advance :");
-     SERIAL_ECHO(block->advance/256.0);
+     SERIAL_ECHO(plan->advance/256.0);
      SERIAL_ECHOPGM("advance rate :");
      SERIAL_ECHOLN(block->advance_rate/256.0);
      */
 
   #endif // ADVANCE or LIN_ADVANCE
 
-  calculate_trapezoid_for_block(block, block->entry_speed / block->nominal_speed, safe_speed / block->nominal_speed);
+  calculate_trapezoid_for_block(block_buffer_head, plan->entry_speed / plan->nominal_speed, safe_speed / plan->nominal_speed);
 
   // Move buffer head
   block_buffer_head = next_buffer_head;
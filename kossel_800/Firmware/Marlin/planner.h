@@ -69,26 +69,27 @@ enum BlockFlag {
  * A single entry in the planner buffer.
  * Tracks linear movement over multiple axes.
  *
- * The "nominal" values are as-specified by gcode, and
- * may never actually be reached due to acceleration limits.
+ * Only the fields read by the stepper ISR live here. Everything the
+ * planner needs for look-ahead is kept in the parallel block_plan[] array
+ * (see block_plan_t) so the hot data stays small and the buffer can grow.
+ *
+ * Step counts are 16 bits wide. Planner::_buffer_line splits longer moves.
  */
 typedef struct {
 
-  uint8_t flag;                             // Block flags (See BlockFlag enum above)
-
   unsigned char active_extruder;            // The extruder to move (if E move)
 
   // Fields used by the Bresenham algorithm for tracing the line
-  int32_t steps[NUM_AXIS];                  // Step count along each axis
-  uint32_t step_event_count;                // The number of step events required to complete this block
+  uint16_t steps[NUM_AXIS];                 // Step count along each axis
+  uint16_t step_event_count;                // The number of step events required to complete this block
 
   #if ENABLED(MIXING_EXTRUDER)
     uint32_t mix_event_count[MIXING_STEPPERS]; // Scaled step_event_count for the mixing steppers
   #endif
 
-  int32_t accelerate_until,                 // The index of the step event on which to stop acceleration
-          decelerate_after,                 // The index of the step event on which to start decelerating
-          acceleration_rate;                // The acceleration rate used for acceleration calculation
+  uint16_t accelerate_until,                // The index of the step event on which to stop acceleration
+           decelerate_after;                // The index of the step event on which to start decelerating
+  int32_t acceleration_rate;                // The acceleration rate used for acceleration calculation
 
   uint8_t direction_bits;                   // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
 
@@ -100,9 +101,25 @@ typedef struct {
     int32_t advance_rate;
     volatile int32_t initial_advance;
     volatile int32_t final_advance;
-    float advance;
   #endif
 
+  // Settings for the trapezoid generator (never above MAX_STEP_FREQUENCY)
+  uint16_t nominal_rate,                    // The nominal step rate for this block in step_events/sec
+           initial_rate,                    // The jerk-adjusted step rate at start of block
+           final_rate;                      // The minimal rate at exit
+
+} block_t;
+
+/**
+ * struct block_plan_t
+ *
+ * The planner-only half of a buffer entry, indexed the same as block_buffer[].
+ * The stepper ISR never reads these fields.
+ */
+typedef struct {
+
+  uint8_t flag;                             // Block flags (See BlockFlag enum above)
+
   // Fields used by the motion planner to manage acceleration
   float nominal_speed,                      // The nominal speed for this block in mm/sec
         entry_speed,                        // Entry speed at previous-current junction in mm/sec
@@ -110,25 +127,68 @@ typedef struct {
         millimeters,                        // The total travel of this block in mm
         acceleration;                       // acceleration mm/sec^2
 
-  // Settings for the trapezoid generator
-  uint32_t nominal_rate,                    // The nominal step rate for this block in step_events/sec
-           initial_rate,                    // The jerk-adjusted step rate at start of block
-           final_rate,                      // The minimal rate at exit
-           acceleration_steps_per_s2;       // acceleration steps/sec^2
+  uint32_t acceleration_steps_per_s2;       // acceleration steps/sec^2
+
+  #if ENABLED(ADVANCE)
+    float advance;
+  #endif
 
   #if FAN_COUNT > 0
-    uint16_t fan_speed[FAN_COUNT];
+    uint8_t fan_speed[FAN_COUNT];
   #endif
 
   #if ENABLED(BARICUDA)
-    uint32_t valve_pressure, e_to_p_pressure;
+    uint8_t valve_pressure, e_to_p_pressure;
   #endif
-  
+
   #if ENABLED(ENSURE_SMOOTH_MOVES)
     uint32_t segment_time;
   #endif
 
-} block_t;
+  #if ENABLED(SD_CHECKPOINT)
+    uint32_t sdpos;                         // SD file offset of the command that queued this block, or NO_SD_POS
+    uint8_t sddepth;                        // M32 procedure depth of the file it was read from
+    uint16_t feedrate_mm_m;                 // The feedrate that command asked for
+  #endif
+
+} block_plan_t;
+
+#ifdef __AVR__
+  // Pin the layouts (AVR has no padding) so fields don't creep back into the ISR's data
+  static_assert(sizeof(block_t) == 26
+    #if ENABLED(MIXING_EXTRUDER)
+      + 4 * (MIXING_STEPPERS)
+    #endif
+    #if ENABLED(LIN_ADVANCE)
+      + 5
+    #elif ENABLED(ADVANCE)
+      + 12
+    #endif
+    , "block_t has grown. Keep planner-only fields in block_plan_t.");
+  static_assert(sizeof(block_plan_t) == 25
+    #if ENABLED(ADVANCE)
+      + 4
+    #endif
+    #if FAN_COUNT > 0
+      + FAN_COUNT
+    #endif
+    #if ENABLED(BARICUDA)
+      + 2
+    #endif
+    #if ENABLED(ENSURE_SMOOTH_MOVES)
+      + 4
+    #endif
+    #if ENABLED(SD_CHECKPOINT)
+      + 7
+    #endif
+    , "block_plan_t has grown. Narrow the new field or keep it out of the buffer.");
+#endif
+
+#define MAX_BLOCK_STEPS 65535UL // Limit of the 16-bit step counters in block_t
+
+#if ENABLED(SD_CHECKPOINT)
+  #define NO_SD_POS 0xFFFFFFFFUL // sdpos of commands and blocks that didn't come from the SD print
+#endif
 
 #define BLOCK_MOD(n) ((n)&(BLOCK_BUFFER_SIZE-1))
 
@@ -140,6 +200,7 @@ class Planner {
      * A ring buffer of moves described in steps
      */
     static block_t block_buffer[BLOCK_BUFFER_SIZE];
+    static block_plan_t block_plan[BLOCK_BUFFER_SIZE]; // Planner-only data for each block_buffer entry
     static volatile uint8_t block_buffer_head,  // Index of the next block to be pushed
                             block_buffer_tail;
 
@@ -161,6 +222,11 @@ class Planner {
                  max_jerk[XYZE],       // The largest speed change requiring no acceleration
                  min_travel_feedrate_mm_s;
 
+    #if ENABLED(SD_CHECKPOINT)
+      static uint32_t command_sdpos;      // SD file offset of the command being run, stored in each new block
+      static uint8_t command_sddepth;     // M32 procedure depth of that file
+    #endif
+
     #if HAS_ABL
       static bool abl_enabled;            // Flag that bed leveling is enabled
       static matrix_3x3 bed_level_matrix; // Transform to compensate for bed level
@@ -245,6 +311,15 @@ class Planner {
 
     static bool is_full() { return (block_buffer_tail == BLOCK_MOD(block_buffer_head + 1)); }
 
+    #if ENABLED(PID_FEEDFORWARD)
+      /**
+       * The hotend load ahead: filament feed (mm/s) and part fan speed
+       * (0-255) averaged over the queued blocks, up to PID_FEEDFORWARD_LEAD
+       * seconds of them. With nothing queued, no feed and the fan as set.
+       */
+      static void upcoming_load(float &e_rate, float &fan);
+    #endif
+
     #if PLANNER_LEVELING
 
       #define ARG_X float lx
@@ -380,12 +455,12 @@ class Planner {
      */
     static block_t* get_current_block() {
       if (blocks_queued()) {
-        block_t* block = &block_buffer[block_buffer_tail];
+        block_plan_t* plan = &block_plan[block_buffer_tail];
         #if ENABLED(ENSURE_SMOOTH_MOVES)
-          block_buffer_runtime_us -= block->segment_time; //We can't be sure how long an active block will take, so don't count it.
+          block_buffer_runtime_us -= plan->segment_time; //We can't be sure how long an active block will take, so don't count it.
         #endif
-        SBI(block->flag, BLOCK_BIT_BUSY);
-        return block;
+        SBI(plan->flag, BLOCK_BIT_BUSY);
+        return &block_buffer[block_buffer_tail];
       }
       else
         return NULL;
@@ -416,6 +491,8 @@ class Planner {
 
   private:
 
+    static void _buffer_steps(const float &a, const float &b, const float &c, const float &e, float fr_mm_s, const uint8_t extruder);
+
     /**
      * Get the index of the next / previous block in the ring buffer
      */
@@ -453,10 +530,10 @@ class Planner {
       return sqrt(sq(target_velocity) - 2 * accel * distance);
     }
 
-    static void calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor);
+    static void calculate_trapezoid_for_block(const uint8_t block_index, const float &entry_factor, const float &exit_factor);
 
-    static void reverse_pass_kernel(block_t* const current, const block_t *next);
-    static void forward_pass_kernel(const block_t *previous, block_t* const current);
+    static void reverse_pass_kernel(block_plan_t* const current, const block_plan_t *next);
+    static void forward_pass_kernel(const block_plan_t *previous, block_plan_t* const current);
 
     static void reverse_pass();
     static void forward_pass();
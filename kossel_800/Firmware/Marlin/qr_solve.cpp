@@ -22,7 +22,7 @@
 
 #include "qr_solve.h"
 
-#if ENABLED(AUTO_BED_LEVELING_LINEAR)
+#if ENABLED(AUTO_BED_LEVELING_LINEAR) || ENABLED(DELTA_AUTO_CALIBRATION)
 
 #include <stdlib.h>
 #include <math.h>
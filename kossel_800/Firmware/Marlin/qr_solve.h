@@ -22,7 +22,7 @@
 
 #include "MarlinConfig.h"
 
-#if ENABLED(AUTO_BED_LEVELING_LINEAR)
+#if ENABLED(AUTO_BED_LEVELING_LINEAR) || ENABLED(DELTA_AUTO_CALIBRATION)
 
 void daxpy(int n, float da, float dx[], int incx, float dy[], int incy);
 float ddot(int n, float dx[], int incx, float dy[], int incy);
@@ -91,8 +91,9 @@ volatile uint32_t Stepper::step_events_completed = 0; // The number of step even
 
 #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
 
-  uint8_t Stepper::old_OCR0A = 0;
-  volatile uint8_t Stepper::eISR_Rate = 200; // Keep the ISR at a low rate until needed
+  uint16_t Stepper::nextMainISR = 0,
+           Stepper::nextAdvanceISR = ADV_NEVER,
+           Stepper::eISR_Rate = ADV_NEVER;
 
   #if ENABLED(LIN_ADVANCE)
     volatile int Stepper::e_steps[E_STEPPERS];
@@ -196,6 +197,7 @@ volatile long Stepper::endstops_trigsteps[XYZ];
 // C1 B1 A1 is longIn1
 // D2 C2 B2 A2 is longIn2
 //
+#ifdef __AVR__
 #define MultiU24X32toH16(intRes, longIn1, longIn2) \
   asm volatile ( \
                  "clr r26 \n\t" \
@@ -241,6 +243,9 @@ volatile long Stepper::endstops_trigsteps[XYZ];
                  : \
                  "r26" , "r27" \
                )
+#else // The same in C, for the host build in tools/host
+  #define MultiU24X32toH16(intRes, longIn1, longIn2) intRes = (uint16_t)(((uint64_t)((longIn1) & 0xFFFFFF) * (longIn2) + 0x800000) >> 24)
+#endif
 
 // Some useful constants
 
@@ -278,13 +283,21 @@ void Stepper::wake_up() {
  */
 void Stepper::set_directions() {
 
+  #if ENABLED(COMBINED_STEP_WRITES)
+    // Collect the dir levels and write them one port at a time
+    uint8_t dir_levels = 0;
+    #define _APPLY_DIR_LEVEL(AXIS, V) do{ if (V) SBI(dir_levels, _AXIS(AXIS)); }while(0)
+  #else
+    #define _APPLY_DIR_LEVEL(AXIS, V) AXIS ##_APPLY_DIR(V, false)
+  #endif
+
   #define SET_STEP_DIR(AXIS) \
     if (motor_direction(AXIS ##_AXIS)) { \
-      AXIS ##_APPLY_DIR(INVERT_## AXIS ##_DIR, false); \
+      _APPLY_DIR_LEVEL(AXIS, INVERT_## AXIS ##_DIR); \
       count_direction[AXIS ##_AXIS] = -1; \
     } \
     else { \
-      AXIS ##_APPLY_DIR(!INVERT_## AXIS ##_DIR, false); \
+      _APPLY_DIR_LEVEL(AXIS, !INVERT_## AXIS ##_DIR); \
       count_direction[AXIS ##_AXIS] = 1; \
     }
 
@@ -300,14 +313,26 @@ void Stepper::set_directions() {
 
   #if DISABLED(ADVANCE) && DISABLED(LIN_ADVANCE)
     if (motor_direction(E_AXIS)) {
-      REV_E_DIR();
+      #if ENABLED(COMBINED_E_WRITES)
+        _APPLY_DIR_LEVEL(E, INVERT_E0_DIR);
+      #else
+        REV_E_DIR();
+      #endif
       count_direction[E_AXIS] = -1;
     }
     else {
-      NORM_E_DIR();
+      #if ENABLED(COMBINED_E_WRITES)
+        _APPLY_DIR_LEVEL(E, !INVERT_E0_DIR);
+      #else
+        NORM_E_DIR();
+      #endif
       count_direction[E_AXIS] = 1;
     }
   #endif // !ADVANCE && !LIN_ADVANCE
+
+  #if ENABLED(COMBINED_STEP_WRITES)
+    PORTS_WRITE(DIR, PORT_WRITE_AXES, dir_levels);
+  #endif
 }
 
 #if ENABLED(ENDSTOP_INTERRUPTS_FEATURE)
@@ -328,17 +353,27 @@ void Stepper::set_directions() {
  *  2000     1 KHz - sleep rate
  *  4000   500  Hz - init rate
  */
-ISR(TIMER1_COMPA_vect) { Stepper::isr(); }
+#if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
+  ISR(TIMER1_COMPA_vect) { Stepper::advance_isr_scheduler(); }
+
+  // The scheduler programs Timer 1 and restores the interrupts
+  #define _NEXT_ISR(T) nextMainISR = T
+  #define _ENABLE_ISRs() NOOP
+#else
+  ISR(TIMER1_COMPA_vect) { Stepper::isr(); }
+
+  #define _NEXT_ISR(T) OCR1A = T
+  #define _ENABLE_ISRs() do{ SBI(TIMSK0, OCIE0B); ENABLE_STEPPER_DRIVER_INTERRUPT(); }while(0)
+#endif
 
 void Stepper::isr() {
-  //Disable Timer0 ISRs and enable global ISR again to capture UART events (incoming chars)
-  #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-    CBI(TIMSK0, OCIE0A); //estepper ISR
+  #if DISABLED(ADVANCE) && DISABLED(LIN_ADVANCE)
+    //Disable Timer0 ISRs and enable global ISR again to capture UART events (incoming chars)
+    CBI(TIMSK0, OCIE0B); //Temperature ISR
+    DISABLE_STEPPER_DRIVER_INTERRUPT();
+    sei();
   #endif
-  CBI(TIMSK0, OCIE0B); //Temperature ISR
-  DISABLE_STEPPER_DRIVER_INTERRUPT();
-  sei();
-  
+
   if (cleaning_buffer_counter) {
     --cleaning_buffer_counter;
     current_block = NULL;
@@ -346,13 +381,8 @@ void Stepper::isr() {
     #ifdef SD_FINISHED_RELEASECOMMAND
       if (!cleaning_buffer_counter && (SD_FINISHED_STEPPERRELEASE)) enqueue_and_echo_commands_P(PSTR(SD_FINISHED_RELEASECOMMAND));
     #endif
-    OCR1A = 200; // Run at max speed - 10 KHz
-    //re-enable ISRs
-    #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-      SBI(TIMSK0, OCIE0A);
-    #endif
-    SBI(TIMSK0, OCIE0B);
-    ENABLE_STEPPER_DRIVER_INTERRUPT();
+    _NEXT_ISR(200); // Run at max speed - 10 KHz
+    _ENABLE_ISRs(); // re-enable ISRs
     return;
   }
 
@@ -381,12 +411,8 @@ void Stepper::isr() {
       #if ENABLED(Z_LATE_ENABLE)
         if (current_block->steps[Z_AXIS] > 0) {
           enable_z();
-          OCR1A = 2000; // Run at slow speed - 1 KHz
-          #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-            SBI(TIMSK0, OCIE0A);
-          #endif
-          SBI(TIMSK0, OCIE0B);
-          ENABLE_STEPPER_DRIVER_INTERRUPT();
+          _NEXT_ISR(2000); // Run at slow speed - 1 KHz
+          _ENABLE_ISRs(); // re-enable ISRs
           return;
         }
       #endif
@@ -396,12 +422,8 @@ void Stepper::isr() {
       // #endif
     }
     else {
-      OCR1A = 2000; // Run at slow speed - 1 KHz
-      #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-        SBI(TIMSK0, OCIE0A);
-      #endif
-      SBI(TIMSK0, OCIE0B);
-      ENABLE_STEPPER_DRIVER_INTERRUPT();
+      _NEXT_ISR(2000); // Run at slow speed - 1 KHz
+      _ENABLE_ISRs(); // re-enable ISRs
       return;
     }
   }
@@ -482,17 +504,28 @@ void Stepper::isr() {
     #define _APPLY_STEP(AXIS) AXIS ##_APPLY_STEP
     #define _INVERT_STEP_PIN(AXIS) INVERT_## AXIS ##_STEP_PIN
 
+    #if ENABLED(COMBINED_STEP_WRITES)
+      // Flag the axis here and pulse all flagged axes one port at a time
+      uint8_t step_axes = 0;
+      #define _PULSE_WRITE(AXIS, V) do{ \
+        if (TEST(PORT_WRITE_AXES, _AXIS(AXIS))) SBI(step_axes, _AXIS(AXIS)); \
+        else _APPLY_STEP(AXIS)(V,0); \
+      }while(0)
+    #else
+      #define _PULSE_WRITE(AXIS, V) _APPLY_STEP(AXIS)(V,0)
+    #endif
+
     // Advance the Bresenham counter; start a pulse if the axis needs a step
     #define PULSE_START(AXIS) \
       _COUNTER(AXIS) += current_block->steps[_AXIS(AXIS)]; \
-      if (_COUNTER(AXIS) > 0) { _APPLY_STEP(AXIS)(!_INVERT_STEP_PIN(AXIS),0); }
+      if (_COUNTER(AXIS) > 0) { _PULSE_WRITE(AXIS, !_INVERT_STEP_PIN(AXIS)); }
 
     // Stop an active pulse, reset the Bresenham counter, update the position
     #define PULSE_STOP(AXIS) \
       if (_COUNTER(AXIS) > 0) { \
         _COUNTER(AXIS) -= current_block->step_event_count; \
         count_position[_AXIS(AXIS)] += count_direction[_AXIS(AXIS)]; \
-        _APPLY_STEP(AXIS)(_INVERT_STEP_PIN(AXIS),0); \
+        _PULSE_WRITE(AXIS, _INVERT_STEP_PIN(AXIS)); \
       }
 
     #define CYCLES_EATEN_BY_CODE 240
@@ -530,6 +563,10 @@ void Stepper::isr() {
       #endif
     #endif // !ADVANCE && !LIN_ADVANCE
 
+    #if ENABLED(COMBINED_STEP_WRITES)
+      PORTS_WRITE(STEP, step_axes, ~(STEP_IDLE_LEVELS));
+    #endif
+
     // For a minimum pulse time wait before stopping pulses
     #if STEP_PULSE_CYCLES > CYCLES_EATEN_BY_CODE
       while ((uint32_t)(TCNT0 - pulse_start) < STEP_PULSE_CYCLES - CYCLES_EATEN_BY_CODE) { /* nada */ }
@@ -563,6 +600,10 @@ void Stepper::isr() {
       #endif
     #endif // !ADVANCE && !LIN_ADVANCE
 
+    #if ENABLED(COMBINED_STEP_WRITES)
+      PORTS_WRITE(STEP, step_axes, STEP_IDLE_LEVELS);
+    #endif
+
     if (++step_events_completed >= current_block->step_event_count) {
       all_steps_done = true;
       break;
@@ -586,7 +627,7 @@ void Stepper::isr() {
   
   #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
     // If we have esteps to execute, fire the next advance_isr "now"
-    if (e_steps[TOOL_E_INDEX]) OCR0A = TCNT0 + 2;
+    if (e_steps[TOOL_E_INDEX]) nextAdvanceISR = 0;
   #endif
 
   // Calculate new timer value
@@ -600,7 +641,7 @@ void Stepper::isr() {
 
     // step_rate to timer interval
     uint16_t timer = calc_timer(acc_step_rate);
-    OCR1A = timer;
+    _NEXT_ISR(timer);
     acceleration_time += timer;
 
     #if ENABLED(LIN_ADVANCE)
@@ -637,7 +678,7 @@ void Stepper::isr() {
     #endif // ADVANCE or LIN_ADVANCE
 
     #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-      eISR_Rate = (timer >> 3) * step_loops / abs(e_steps[TOOL_E_INDEX]); //>> 3 is divide by 8. Reason: Timer 1 runs at 16/8=2MHz, Timer 0 at 16/64=0.25MHz. ==> 2/0.25=8.
+      eISR_Rate = adv_rate(e_steps[TOOL_E_INDEX], timer, step_loops);
     #endif
   }
   else if (step_events_completed > (uint32_t)current_block->decelerate_after) {
@@ -653,7 +694,7 @@ void Stepper::isr() {
 
     // step_rate to timer interval
     uint16_t timer = calc_timer(step_rate);
-    OCR1A = timer;
+    _NEXT_ISR(timer);
     deceleration_time += timer;
 
     #if ENABLED(LIN_ADVANCE)
@@ -688,7 +729,7 @@ void Stepper::isr() {
     #endif // ADVANCE or LIN_ADVANCE
 
     #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-      eISR_Rate = (timer >> 3) * step_loops / abs(e_steps[TOOL_E_INDEX]);
+      eISR_Rate = adv_rate(e_steps[TOOL_E_INDEX], timer, step_loops);
     #endif
   }
   else {
@@ -698,39 +739,34 @@ void Stepper::isr() {
       if (current_block->use_advance_lead)
         current_estep_rate[TOOL_E_INDEX] = final_estep_rate;
 
-      eISR_Rate = (OCR1A_nominal >> 3) * step_loops_nominal / abs(e_steps[TOOL_E_INDEX]);
+      eISR_Rate = adv_rate(e_steps[TOOL_E_INDEX], OCR1A_nominal, step_loops_nominal);
 
     #endif
 
-    OCR1A = OCR1A_nominal;
+    _NEXT_ISR(OCR1A_nominal);
     // ensure we're running at the correct step rate, even if we just came off an acceleration
     step_loops = step_loops_nominal;
   }
 
-  NOLESS(OCR1A, TCNT1 + 16);
+  #if DISABLED(ADVANCE) && DISABLED(LIN_ADVANCE)
+    NOLESS(OCR1A, TCNT1 + 16);
+  #endif
 
   // If current block is finished, reset pointer
   if (all_steps_done) {
     current_block = NULL;
     planner.discard_current_block();
   }
-  #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-    SBI(TIMSK0, OCIE0A);
-  #endif
-  SBI(TIMSK0, OCIE0B);
-  ENABLE_STEPPER_DRIVER_INTERRUPT();
+  _ENABLE_ISRs(); // re-enable ISRs
 }
 
 #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
 
-  // Timer interrupt for E. e_steps is set in the main routine;
-  // Timer 0 is shared with millies
-  ISR(TIMER0_COMPA_vect) { Stepper::advance_isr(); }
-
+  // E steps for advance. e_steps is set in the main routine.
+  // Called by advance_isr_scheduler when its interval has elapsed.
   void Stepper::advance_isr() {
 
-    old_OCR0A += eISR_Rate;
-    OCR0A = old_OCR0A;
+    nextAdvanceISR = eISR_Rate;
 
     #define SET_E_STEP_DIR(INDEX) \
       if (e_steps[INDEX]) E## INDEX ##_DIR_WRITE(e_steps[INDEX] < 0 ? INVERT_E## INDEX ##_DIR : !INVERT_E## INDEX ##_DIR)
@@ -795,6 +831,49 @@ void Stepper::isr() {
 
   }
 
+  /**
+   * Timer 1 compare interrupt with ADVANCE or LIN_ADVANCE
+   *
+   * The main step ISR and the E advance steps share Timer 1. Each keeps
+   * the interval to its next run; whichever is due first programs OCR1A
+   * and the other's interval is reduced by the same amount.
+   */
+  void Stepper::advance_isr_scheduler() {
+    // Disable Timer0 ISRs and enable global ISR again to capture UART events (incoming chars)
+    CBI(TIMSK0, OCIE0B); // Temperature ISR
+    DISABLE_STEPPER_DRIVER_INTERRUPT();
+    sei();
+
+    // Run main stepping ISR if flagged
+    if (!nextMainISR) isr();
+
+    // Run Advance stepping ISR if flagged
+    if (!nextAdvanceISR) advance_isr();
+
+    // Is the next advance ISR scheduled before the next main ISR?
+    if (nextAdvanceISR <= nextMainISR) {
+      OCR1A = nextAdvanceISR;
+      // New interval for the next main ISR
+      if (nextMainISR) nextMainISR -= nextAdvanceISR;
+      // Call advance_isr on the next interrupt
+      nextAdvanceISR = 0;
+    }
+    else {
+      OCR1A = nextMainISR;
+      // New interval for the next advance ISR, if any
+      if (nextAdvanceISR != ADV_NEVER) nextAdvanceISR -= nextMainISR;
+      // Call isr on the next interrupt
+      nextMainISR = 0;
+    }
+
+    // Don't run the ISR faster than possible
+    NOLESS(OCR1A, TCNT1 + 16);
+
+    // Restore original ISR settings
+    SBI(TIMSK0, OCIE0B);
+    ENABLE_STEPPER_DRIVER_INTERRUPT();
+  }
+
 #endif // ADVANCE or LIN_ADVANCE
 
 void Stepper::init() {
@@ -973,21 +1052,13 @@ void Stepper::init() {
   ENABLE_STEPPER_DRIVER_INTERRUPT();
 
   #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-
     for (int i = 0; i < E_STEPPERS; i++) {
       e_steps[i] = 0;
       #if ENABLED(LIN_ADVANCE)
         current_adv_steps[i] = 0;
       #endif
     }
-
-    #if defined(TCCR0A) && defined(WGM01)
-      CBI(TCCR0A, WGM01);
-      CBI(TCCR0A, WGM00);
-    #endif
-    SBI(TIMSK0, OCIE0A);
-
-  #endif // ADVANCE or LIN_ADVANCE
+  #endif
 
   endstops.enable(true); // Start with endstops active. After homing they can be disabled
   sei();
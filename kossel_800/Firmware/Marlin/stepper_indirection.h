@@ -429,4 +429,89 @@
   #define REV_E_DIR() E0_DIR_WRITE(INVERT_E0_DIR)
 #endif
 
+/**
+ * Combined port writes
+ *
+ * Step and dir pins that share an AVR port (e.g., X and Y on PORTF with RAMPS)
+ * are written together, so their pulses start and end on the same instruction.
+ * As _TOGGLE does, the write goes to PINx: ones flip those bits of PORTx in
+ * one store. Only the pins not yet at their level are flipped, so the other
+ * bits of the port are never written and an interrupt changing them between
+ * the read of PORTx and the store loses nothing. That keeps the atomicity of
+ * the sbi/cbi of _WRITE without a critical section, and a port on the high
+ * addresses (PORTL for Z on RAMPS) costs no more than one in the I/O space.
+ *
+ * The grouping comes from the board's pins_*.h through fastio.h. Like _WRITE,
+ * it compares constant register addresses, which the compiler folds away.
+ *
+ * E joins the groups only when a single E stepper is pulsed by the main ISR.
+ */
+#if ENABLED(COMBINED_STEP_WRITES)
+
+  #define X_STEP_IO X_STEP_PIN
+  #define Y_STEP_IO Y_STEP_PIN
+  #define Z_STEP_IO Z_STEP_PIN
+  #define E_STEP_IO E0_STEP_PIN
+  #define X_DIR_IO  X_DIR_PIN
+  #define Y_DIR_IO  Y_DIR_PIN
+  #define Z_DIR_IO  Z_DIR_PIN
+  #define E_DIR_IO  E0_DIR_PIN
+
+  #if EXTRUDERS == 1 && DISABLED(MIXING_EXTRUDER) && DISABLED(ADVANCE) && DISABLED(LIN_ADVANCE)
+    #define COMBINED_E_WRITES
+    #define PORT_WRITE_AXES (_BV(X_AXIS) | _BV(Y_AXIS) | _BV(Z_AXIS) | _BV(E_AXIS))
+  #else
+    #define PORT_WRITE_AXES (_BV(X_AXIS) | _BV(Y_AXIS) | _BV(Z_AXIS))
+  #endif
+
+  #define _PIN_PORT(IO) DIO ## IO ## _WPORT
+  #define PIN_PORT(IO) _PIN_PORT(IO)
+  #define _PIN_TOGGLE(IO) DIO ## IO ## _RPORT
+  #define PIN_TOGGLE(IO) _PIN_TOGGLE(IO)
+  #define _PIN_MASK(IO) MASK(DIO ## IO ## _PIN)
+  #define PIN_MASK(IO) _PIN_MASK(IO)
+
+  // True if the STEP (or DIR) pins of axes A and B are on the same port
+  #define SAME_PORT(A, B, PIN) (&PIN_PORT(A ##_## PIN ##_IO) == &PIN_PORT(B ##_## PIN ##_IO))
+
+  // Add the pin of axis B to the write for the port of axis A
+  #define _PORT_GROUP_BIT(A, B, PIN, AXES, LEVELS) \
+    if (SAME_PORT(A, B, PIN) && TEST((AXES) & (PORT_WRITE_AXES), _AXIS(B))) { \
+      mask |= PIN_MASK(B ##_## PIN ##_IO); \
+      if (TEST(LEVELS, _AXIS(B))) set |= PIN_MASK(B ##_## PIN ##_IO); \
+    }
+
+  // One toggle of the pins sharing the port of axis A that differ from their level
+  #define PORT_GROUP_WRITE(A, PIN, AXES, LEVELS) do{ \
+    uint8_t mask = 0, set = 0; \
+    _PORT_GROUP_BIT(A, X, PIN, AXES, LEVELS); \
+    _PORT_GROUP_BIT(A, Y, PIN, AXES, LEVELS); \
+    _PORT_GROUP_BIT(A, Z, PIN, AXES, LEVELS); \
+    _PORT_GROUP_BIT(A, E, PIN, AXES, LEVELS); \
+    if (mask) PIN_TOGGLE(A ##_## PIN ##_IO) = (PIN_PORT(A ##_## PIN ##_IO) ^ set) & mask; \
+  }while(0)
+
+  /**
+   * Drive the STEP or DIR pin of each axis flagged in AXES to the level of
+   * the same bit in LEVELS. Each port is written once, by the first axis
+   * (in X Y Z E order) that has a pin on it.
+   */
+  #define PORTS_WRITE(PIN, AXES, LEVELS) do{ \
+    PORT_GROUP_WRITE(X, PIN, AXES, LEVELS); \
+    if (!SAME_PORT(X, Y, PIN)) \
+      PORT_GROUP_WRITE(Y, PIN, AXES, LEVELS); \
+    if (!SAME_PORT(X, Z, PIN) && !SAME_PORT(Y, Z, PIN)) \
+      PORT_GROUP_WRITE(Z, PIN, AXES, LEVELS); \
+    if (!SAME_PORT(X, E, PIN) && !SAME_PORT(Y, E, PIN) && !SAME_PORT(Z, E, PIN)) \
+      PORT_GROUP_WRITE(E, PIN, AXES, LEVELS); \
+  }while(0)
+
+  // Step pin levels when no pulse is active
+  #define STEP_IDLE_LEVELS ( \
+      (INVERT_X_STEP_PIN ? _BV(X_AXIS) : 0) | (INVERT_Y_STEP_PIN ? _BV(Y_AXIS) : 0) \
+    | (INVERT_Z_STEP_PIN ? _BV(Z_AXIS) : 0) | (INVERT_E_STEP_PIN ? _BV(E_AXIS) : 0) \
+  )
+
+#endif // COMBINED_STEP_WRITES
+
 #endif // STEPPER_INDIRECTION_H
@@ -101,6 +101,11 @@ class Temperature {
       #define scalePID_d(d)   ( (d) / PID_dT )
       #define unscalePID_d(d) ( (d) * PID_dT )
 
+      #if ENABLED(PID_FEEDFORWARD)
+        static float ff_extrusion, // PID output per mm/s of filament
+                     ff_fan;       // PID output with the part fan at full speed
+      #endif
+
     #endif
 
     #if ENABLED(PIDTEMPBED)
@@ -159,6 +164,19 @@ class Temperature {
 
       static float pid_error[HOTENDS];
       static bool pid_reset[HOTENDS];
+
+      #if ENABLED(PID_IN_ISR)
+        // Fixed-point PID state, owned by isr()
+        static long Kp_fx[HOTENDS], Ki_fx[HOTENDS], Kd_fx[HOTENDS],
+                    iState_fx[HOTENDS], iStateMax_fx[HOTENDS], dTerm_fx[HOTENDS], dStepMax_fx[HOTENDS];
+        static int dState_fx[HOTENDS];
+        static volatile bool pid_isr_hold; // Set while M303 drives soft_pwm directly
+      #endif
+
+      #if ENABLED(PID_FEEDFORWARD)
+        static uint8_t feedforward[HOTENDS]; // Added to the PID output, read by isr() too
+        static void update_feedforward();
+      #endif
     #endif
 
     #if ENABLED(PIDTEMPBED)
@@ -211,6 +229,17 @@ class Temperature {
       static uint8_t soft_pwm_fan[FAN_COUNT];
     #endif
 
+    #if ENABLED(HEATUP_PLANNER)
+      static int heatup_target[HOTENDS];  // Hotend targets held back while the bed heats
+      static float bed_heating_rate,      // °C/s, averaged
+                   last_bed_temp;
+      static millis_t next_heatup_ms;
+      static uint8_t bed_pwm_request;     // Bed duty before the power budget
+
+      static void update_heatup();
+      static void limit_bed_power();
+    #endif
+
     #if ENABLED(FILAMENT_WIDTH_SENSOR)
       static int current_raw_filwidth;  //Holds measured filament diameter - one extruder only
     #endif
@@ -321,12 +350,29 @@ class Temperature {
         else if (target_temperature[HOTEND_INDEX] == 0.0f)
           start_preheat_time(HOTEND_INDEX);
       #endif
-      target_temperature[HOTEND_INDEX] = celsius;
+      #if ENABLED(PID_IN_ISR)
+        CRITICAL_SECTION_START; // The PID reads it in isr()
+        target_temperature[HOTEND_INDEX] = celsius;
+        CRITICAL_SECTION_END;
+      #else
+        target_temperature[HOTEND_INDEX] = celsius;
+      #endif
       #if ENABLED(THERMAL_PROTECTION_HOTENDS) && WATCH_TEMP_PERIOD > 0
         start_watching_heater(HOTEND_INDEX);
       #endif
+      #if ENABLED(HEATUP_PLANNER)
+        heatup_target[HOTEND_INDEX] = 0;
+      #endif
     }
 
+    #if ENABLED(HEATUP_PLANNER)
+      /**
+       * Set a higher hotend target now, or once the bed is about
+       * as long from its target as the hotend will take
+       */
+      static void planTargetHotend(const float& celsius, uint8_t e);
+    #endif
+
     static void setTargetBed(const float& celsius) {
       target_temperature_bed = celsius;
       #if ENABLED(THERMAL_PROTECTION_BED) && WATCH_BED_TEMP_PERIOD > 0
@@ -422,12 +468,18 @@ class Temperature {
 
     #if ENABLED(HEATER_0_USES_MAX6675)
       static int read_max6675();
+      static void sample_max6675();
     #endif
 
     static void checkExtruderAutoFans();
 
     static float get_pid_output(int e);
 
+    #if ENABLED(PID_IN_ISR)
+      static int analog2temp_fx(const long raw, const uint8_t e);
+      static void pid_isr_update();
+    #endif
+
     #if ENABLED(PIDTEMPBED)
       static float get_pid_output_bed();
     #endif
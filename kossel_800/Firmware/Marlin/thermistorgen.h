@@ -0,0 +1,163 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * thermistorgen.h - Thermistor tables built by the compiler
+ *
+ * Makes a table in the { raw, °C } layout of thermistortables.h from the
+ * Steinhart-Hart equation 1/T = A + B ln(R) + C ln(R)^3 (the beta model
+ * is C = 0) and the pull-up resistor, as createTemperatureLookupMarlin.py
+ * does offline.
+ *
+ * The entries are evenly spaced, 2^shift raw counts apart, so the segment
+ * holding a reading is found with a shift instead of a search. The spacing
+ * is the widest that keeps linear interpolation between the whole degrees
+ * stored within the allowed error, from mintemp to maxtemp.
+ *
+ * Everything is C++11 constexpr, one return statement per function.
+ */
+
+#ifndef THERMISTORGEN_H_
+#define THERMISTORGEN_H_
+
+namespace ThermistorGen {
+
+  #define TG_MAX_RAW (1024L * (OVERSAMPLENR))
+  #define TG_MIN_SHIFT 4   // 1 ADC count with 16x oversampling
+  #define TG_MAX_SHIFT 10  // 64 ADC counts
+  #define TG_MAX_LEN 255   // heater_ttbllen_map is 8 bit
+
+  struct Model { double a, b, c, pullup; };
+
+  // ln(x): bring x into [0.75, 1.5] by halving or doubling, then 2 atanh((x - 1) / (x + 1))
+  constexpr double atanh_series(const double y2, const double p, const int n) {
+    return n > 15 ? 0.0 : p / n + atanh_series(y2, p * y2, n + 2);
+  }
+  constexpr double ln_near_1(const double y) { return 2.0 * atanh_series(y * y, y, 1); }
+  constexpr double ln(const double x) {
+    return x > 1.5 ? ln(x * 0.5) + 0.693147180559945
+         : x < 0.75 ? ln(x * 2.0) - 0.693147180559945
+         : ln_near_1((x - 1.0) / (x + 1.0));
+  }
+
+  constexpr Model beta_model(const double r25, const double beta, const double pullup) {
+    return { 1.0 / 298.15 - ln(r25) / beta, 1.0 / beta, 0.0, pullup };
+  }
+
+  constexpr double larger(const double a, const double b) { return a > b ? a : b; }
+  constexpr double tabs(const double a) { return a < 0 ? -a : a; }
+  constexpr long lower(const long a, const long b) { return a < b ? a : b; }
+  constexpr long higher(const long a, const long b) { return a > b ? a : b; }
+  constexpr int rounded(const double t) { return t < 0 ? int(t - 0.5) : int(t + 0.5); }
+
+  // °C at a raw reading (R = pullup * raw / (max - raw)), clear of the ends where R is 0 or infinite
+  constexpr double celsius_lnr(const Model &m, const double lnr) {
+    return 1.0 / (m.a + lnr * (m.b + m.c * lnr * lnr)) - 273.15;
+  }
+  constexpr double celsius(const Model &m, const long raw) {
+    return raw < 1 ? celsius(m, 1)
+         : raw > TG_MAX_RAW - 1 ? celsius(m, TG_MAX_RAW - 1)
+         : celsius_lnr(m, ln(m.pullup * raw / (TG_MAX_RAW - raw)));
+  }
+
+  // The lowest raw reading at or below t °C. Hotter reads lower.
+  constexpr long find_raw(const Model &m, const double t, const long lo, const long hi) {
+    return lo >= hi ? lo
+         : celsius(m, (lo + hi) / 2) > t ? find_raw(m, t, (lo + hi) / 2 + 1, hi)
+         : find_raw(m, t, lo, (lo + hi) / 2);
+  }
+  constexpr long raw_at(const Model &m, const double t) { return find_raw(m, t, 1, TG_MAX_RAW); }
+
+  // First entry above maxtemp, last one at or below mintemp
+  constexpr long first_raw(const Model &m, const double hi, const uint8_t shift) {
+    return ((raw_at(m, hi) - 1) >> shift) << shift;
+  }
+  constexpr long last_raw(const Model &m, const double lo, const uint8_t shift) {
+    return ((raw_at(m, lo) + (1L << shift) - 1) >> shift) << shift;
+  }
+  constexpr long length(const Model &m, const double lo, const double hi, const uint8_t shift) {
+    return ((last_raw(m, lo, shift) - first_raw(m, hi, shift)) >> shift) + 1;
+  }
+
+  constexpr int entry_temp(const Model &m, const long raw) { return rounded(celsius(m, raw)); }
+
+  // Interpolated less true °C at raw count x0 + k of a segment, and the step of that to the next count
+  constexpr double deviation(const Model &m, const long x0, const long step, const int t0, const int t1, const long k) {
+    return t0 + (t1 - t0) * double(k) / step - celsius(m, x0 + k);
+  }
+  constexpr double slope(const Model &m, const long x0, const long step, const int t0, const int t1, const long k) {
+    return deviation(m, x0, step, t0, t1, k + 1) - deviation(m, x0, step, t0, t1, k);
+  }
+
+  // The curve bends one way along a segment (where it turns from convex to
+  // concave it is all but straight), so the deviation rises then falls
+  // (bend 1) or falls then rises (bend -1): its peak is the first count
+  // from k0 to k1 where the slope turns, found by bisection. This gives the
+  // worst error over every count a reading can take with ~20 evaluations a
+  // segment, where sweeping them all runs past the compiler's constexpr limits.
+  constexpr long turn(const Model &m, const long x0, const long step, const int t0, const int t1, const long k0, const long k1, const int bend) {
+    return k0 >= k1 ? k0
+         : bend * slope(m, x0, step, t0, t1, (k0 + k1) / 2) > 0 ? turn(m, x0, step, t0, t1, (k0 + k1) / 2 + 1, k1, bend)
+         : turn(m, x0, step, t0, t1, k0, (k0 + k1) / 2, bend);
+  }
+
+  // Worst error at any raw count k0 to k1 of a segment: at either end or at the peak
+  constexpr double span_error(const Model &m, const long x0, const long step, const int t0, const int t1, const long k0, const long k1) {
+    return k1 < k0 ? 0.0
+         : larger(larger(tabs(deviation(m, x0, step, t0, t1, k0)), tabs(deviation(m, x0, step, t0, t1, k1))),
+                  k1 - k0 < 2 ? 0.0 : tabs(deviation(m, x0, step, t0, t1,
+                    turn(m, x0, step, t0, t1, k0, k1, slope(m, x0, step, t0, t1, k0) > slope(m, x0, step, t0, t1, k1 - 1) ? 1 : -1))));
+  }
+  // Worst error over segments j0 to j1 - 1, split in halves to keep the recursion shallow.
+  // Only raw counts from hot to cold, those reading mintemp to maxtemp, count.
+  constexpr double table_error(const Model &m, const long first, const uint8_t shift, const long j0, const long j1, const long hot, const long cold) {
+    return j1 - j0 > 1
+         ? larger(table_error(m, first, shift, j0, (j0 + j1) / 2, hot, cold), table_error(m, first, shift, (j0 + j1) / 2, j1, hot, cold))
+         : span_error(m, first + (j0 << shift), 1L << shift,
+                      entry_temp(m, first + (j0 << shift)), entry_temp(m, first + ((j0 + 1) << shift)),
+                      higher(0, hot - first - (j0 << shift)), lower(1L << shift, cold - first - (j0 << shift)));
+  }
+  constexpr long coldest_raw(const Model &m, const double lo, const long raw) { return celsius(m, raw) < lo ? raw - 1 : raw; }
+  constexpr double error(const Model &m, const double lo, const double hi, const uint8_t shift) {
+    return table_error(m, first_raw(m, hi, shift), shift, 0, length(m, lo, hi, shift) - 1, raw_at(m, hi), coldest_raw(m, lo, raw_at(m, lo)));
+  }
+
+  // The widest spacing that fits the table and meets the error
+  constexpr uint8_t best_shift(const Model &m, const double lo, const double hi, const double err, const uint8_t shift=TG_MAX_SHIFT) {
+    return shift <= TG_MIN_SHIFT || (length(m, lo, hi, shift) <= TG_MAX_LEN && error(m, lo, hi, shift) <= err)
+           ? shift : best_shift(m, lo, hi, err, shift - 1);
+  }
+
+  template<uint8_t N> struct Table { short v[N][2]; };
+
+  template<int... I> struct Seq {};
+  template<int N, int... I> struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+  template<int... I> struct MakeSeq<0, I...> { typedef Seq<I...> type; };
+
+  template<uint8_t N, int... I>
+  constexpr Table<N> build(const Model &m, const long first, const uint8_t shift, Seq<I...>) {
+    return {{ { short(first + ((long)I << shift)), short(entry_temp(m, first + ((long)I << shift))) }... }};
+  }
+
+}
+
+#endif // THERMISTORGEN_H_
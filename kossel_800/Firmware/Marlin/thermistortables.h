@@ -1204,19 +1204,48 @@ const short temptable_1047[][2] PROGMEM = {
 };
 #endif
 
+#if ANY_THERMISTOR_IS(1000) // Custom thermistor, built from the constants in Configuration.h
+  #include "thermistorgen.h"
+  namespace ThermistorGen {
+    constexpr Model custom =
+      #ifdef CUSTOM_THERMISTOR_SH_A
+        { CUSTOM_THERMISTOR_SH_A, CUSTOM_THERMISTOR_SH_B, CUSTOM_THERMISTOR_SH_C, CUSTOM_THERMISTOR_PULLUP };
+      #else
+        beta_model(CUSTOM_THERMISTOR_R25, CUSTOM_THERMISTOR_BETA, CUSTOM_THERMISTOR_PULLUP);
+      #endif
+    constexpr uint8_t custom_shift = best_shift(custom, CUSTOM_THERMISTOR_MINTEMP, CUSTOM_THERMISTOR_MAXTEMP, CUSTOM_THERMISTOR_MAX_ERROR);
+    constexpr long custom_len = length(custom, CUSTOM_THERMISTOR_MINTEMP, CUSTOM_THERMISTOR_MAXTEMP, custom_shift);
+  }
+  static_assert(ThermistorGen::custom_len <= TG_MAX_LEN, "CUSTOM_THERMISTOR_MINTEMP to CUSTOM_THERMISTOR_MAXTEMP needs over 255 entries. Narrow the range.");
+  static_assert(ThermistorGen::error(ThermistorGen::custom, CUSTOM_THERMISTOR_MINTEMP, CUSTOM_THERMISTOR_MAXTEMP, ThermistorGen::custom_shift) <= CUSTOM_THERMISTOR_MAX_ERROR,
+    "CUSTOM_THERMISTOR_MAX_ERROR can't be met with one entry per ADC count. Raise it or narrow the range.");
+  constexpr ThermistorGen::Table<ThermistorGen::custom_len> temptable_1000_data PROGMEM =
+    ThermistorGen::build<ThermistorGen::custom_len>(ThermistorGen::custom,
+      ThermistorGen::first_raw(ThermistorGen::custom, CUSTOM_THERMISTOR_MAXTEMP, ThermistorGen::custom_shift), ThermistorGen::custom_shift,
+      ThermistorGen::MakeSeq<ThermistorGen::custom_len>::type());
+  #define temptable_1000 temptable_1000_data.v
+  #define TEMPTABLE_1000_SHIFT ThermistorGen::custom_shift
+#else
+  #define TEMPTABLE_1000_SHIFT 0
+#endif
 
 #define _TT_NAME(_N) temptable_ ## _N
 #define TT_NAME(_N) _TT_NAME(_N)
 
+// Generated tables are evenly spaced, 2^shift raw counts apart. 0 for the others.
+#define TT_SHIFT(_N) ((_N) == 1000 ? TEMPTABLE_1000_SHIFT : 0)
+
 #ifdef THERMISTORHEATER_0
   #define HEATER_0_TEMPTABLE TT_NAME(THERMISTORHEATER_0)
   #define HEATER_0_TEMPTABLE_LEN COUNT(HEATER_0_TEMPTABLE)
+  #define HEATER_0_TEMPTABLE_SHIFT TT_SHIFT(THERMISTORHEATER_0)
 #else
   #ifdef HEATER_0_USES_THERMISTOR
     #error "No heater 0 thermistor table specified"
   #else  // HEATER_0_USES_THERMISTOR
     #define HEATER_0_TEMPTABLE NULL
     #define HEATER_0_TEMPTABLE_LEN 0
+    #define HEATER_0_TEMPTABLE_SHIFT 0
   #endif // HEATER_0_USES_THERMISTOR
 #endif
 
@@ -1234,12 +1263,14 @@ const short temptable_1047[][2] PROGMEM = {
 #ifdef THERMISTORHEATER_1
   #define HEATER_1_TEMPTABLE TT_NAME(THERMISTORHEATER_1)
   #define HEATER_1_TEMPTABLE_LEN COUNT(HEATER_1_TEMPTABLE)
+  #define HEATER_1_TEMPTABLE_SHIFT TT_SHIFT(THERMISTORHEATER_1)
 #else
   #ifdef HEATER_1_USES_THERMISTOR
     #error "No heater 1 thermistor table specified"
   #else  // HEATER_1_USES_THERMISTOR
     #define HEATER_1_TEMPTABLE NULL
     #define HEATER_1_TEMPTABLE_LEN 0
+    #define HEATER_1_TEMPTABLE_SHIFT 0
   #endif // HEATER_1_USES_THERMISTOR
 #endif
 
@@ -1257,12 +1288,14 @@ const short temptable_1047[][2] PROGMEM = {
 #ifdef THERMISTORHEATER_2
   #define HEATER_2_TEMPTABLE TT_NAME(THERMISTORHEATER_2)
   #define HEATER_2_TEMPTABLE_LEN COUNT(HEATER_2_TEMPTABLE)
+  #define HEATER_2_TEMPTABLE_SHIFT TT_SHIFT(THERMISTORHEATER_2)
 #else
   #ifdef HEATER_2_USES_THERMISTOR
     #error "No heater 2 thermistor table specified"
   #else  // HEATER_2_USES_THERMISTOR
     #define HEATER_2_TEMPTABLE NULL
     #define HEATER_2_TEMPTABLE_LEN 0
+    #define HEATER_2_TEMPTABLE_SHIFT 0
   #endif // HEATER_2_USES_THERMISTOR
 #endif
 
@@ -1280,12 +1313,14 @@ const short temptable_1047[][2] PROGMEM = {
 #ifdef THERMISTORHEATER_3
   #define HEATER_3_TEMPTABLE TT_NAME(THERMISTORHEATER_3)
   #define HEATER_3_TEMPTABLE_LEN COUNT(HEATER_3_TEMPTABLE)
+  #define HEATER_3_TEMPTABLE_SHIFT TT_SHIFT(THERMISTORHEATER_3)
 #else
   #ifdef HEATER_3_USES_THERMISTOR
     #error "No heater 3 thermistor table specified"
   #else  // HEATER_3_USES_THERMISTOR
     #define HEATER_3_TEMPTABLE NULL
     #define HEATER_3_TEMPTABLE_LEN 0
+    #define HEATER_3_TEMPTABLE_SHIFT 0
   #endif // HEATER_3_USES_THERMISTOR
 #endif
 
@@ -1303,6 +1338,7 @@ const short temptable_1047[][2] PROGMEM = {
 #ifdef THERMISTORBED
   #define BEDTEMPTABLE TT_NAME(THERMISTORBED)
   #define BEDTEMPTABLE_LEN COUNT(BEDTEMPTABLE)
+  #define BEDTEMPTABLE_SHIFT TT_SHIFT(THERMISTORBED)
 #else
   #ifdef BED_USES_THERMISTOR
     #error "No bed thermistor table specified"
@@ -574,6 +574,12 @@ void kill_screen(const char* lcd_msg) {
     }
 
     void lcd_sdcard_stop() {
+      #if ENABLED(SD_CHECKPOINT)
+        save_sd_checkpoint(true); // So M1000 can continue the print
+      #endif
+      #if ENABLED(SD_JOB_QUEUE)
+        card.endJobQueue();
+      #endif
       card.stopSDPrint();
       clear_command_queue();
       quickstop_stepper();
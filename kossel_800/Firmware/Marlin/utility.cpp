@@ -33,74 +33,146 @@ void safe_delay(millis_t ms) {
   delay(ms);
 }
 
+/**
+ * Decimal conversion shared by the serial and LCD output
+ *
+ * Numbers up to 16 bits are split two digits at a time with a
+ * multiply and shift and looked up in a table of digit pairs.
+ * Larger ones are divided by 10 with shifts and adds, since
+ * the AVR has no divide instruction.
+ */
+
+static const char digit_pairs[200] PROGMEM = {
+  '0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8', '0','9',
+  '1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7', '1','8', '1','9',
+  '2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6', '2','7', '2','8', '2','9',
+  '3','0', '3','1', '3','2', '3','3', '3','4', '3','5', '3','6', '3','7', '3','8', '3','9',
+  '4','0', '4','1', '4','2', '4','3', '4','4', '4','5', '4','6', '4','7', '4','8', '4','9',
+  '5','0', '5','1', '5','2', '5','3', '5','4', '5','5', '5','6', '5','7', '5','8', '5','9',
+  '6','0', '6','1', '6','2', '6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9',
+  '7','0', '7','1', '7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9',
+  '8','0', '8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+  '9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+// Divide n by 10 and return the remainder
+static FORCE_INLINE uint8_t divmod10(uint32_t &n) {
+  uint32_t q = (n >> 1) + (n >> 2);
+  q += q >> 4;
+  q += q >> 8;
+  q += q >> 16;
+  q >>= 3;
+  uint8_t r = n - ((q << 3) + (q << 1));
+  if (r > 9) { q++; r -= 10; }
+  n = q;
+  return r;
+}
+
+// Exact for all 16-bit values
+#define DIV100(m) (uint16_t)(((uint32_t)((m) >> 2) * 5243U) >> 17)
+#define DIV10(m)  (uint16_t)(((uint32_t)(m) * 0xCCCDU) >> 19)
+
+static FORCE_INLINE void put_pair(char* p, const uint8_t r) {
+  p[0] = pgm_read_byte(&digit_pairs[r * 2]);
+  p[1] = pgm_read_byte(&digit_pairs[r * 2 + 1]);
+}
+
+char* ultostr(uint32_t n, char* end) {
+  while (n > 0xFFFF) *--end = '0' + divmod10(n);
+  uint16_t m = n;
+  while (m >= 100) {
+    const uint16_t q = DIV100(m);
+    end -= 2;
+    put_pair(end, m - q * 100);
+    m = q;
+  }
+  if (m >= 10) {
+    end -= 2;
+    put_pair(end, m);
+  }
+  else
+    *--end = '0' + m;
+  return end;
+}
+
+uint32_t ultodigits(uint32_t n, char* end, uint8_t count) {
+  for (; count && n > 0xFFFF; count--) *--end = '0' + divmod10(n);
+  if (!count) return n;
+  uint16_t m = n;
+  for (; count >= 2; count -= 2) {
+    const uint16_t q = DIV100(m);
+    end -= 2;
+    put_pair(end, m - q * 100);
+    m = q;
+  }
+  if (count) {
+    const uint16_t q = DIV10(m);
+    *--end = '0' + (m - q * 10);
+    m = q;
+  }
+  return m;
+}
+
 #if ENABLED(ULTRA_LCD)
 
   char conv[9];
 
-  #define DIGIT(n) ('0' + (n))
-  #define DIGIMOD(n, f) DIGIT((n)/(f) % 10)
-  #define RJDIGIT(n, f) ((n) >= (f) ? DIGIMOD(n, f) : ' ')
   #define MINUSOR(n, alt) (n >= 0 ? (alt) : (n = -n, '-'))
 
+  // Like ultodigits, but blank the leading zeros if n fits in count digits
+  static void rjdigits(const uint32_t n, char* end, const uint8_t count) {
+    char *p = end - count;
+    if (!ultodigits(n, end, count))
+      while (p < end - 1 && *p == '0') *p++ = ' ';
+  }
+
   // Convert unsigned int to string with 12 format
   char* itostr2(const uint8_t& x) {
-    int xx = x;
-    conv[0] = DIGIMOD(xx, 10);
-    conv[1] = DIGIMOD(xx, 1);
+    ultodigits(x, &conv[2], 2);
     conv[2] = '\0';
     return conv;
   }
 
   // Convert signed int to rj string with 123 or -12 format
   char* itostr3(const int& x) {
-    int xx = x;
-    conv[0] = MINUSOR(xx, RJDIGIT(xx, 100));
-    conv[1] = RJDIGIT(xx, 10);
-    conv[2] = DIGIMOD(xx, 1);
+    if (x < 0) {
+      conv[0] = '-';
+      rjdigits(-x, &conv[3], 2);
+    }
+    else
+      rjdigits(x, &conv[3], 3);
     conv[3] = '\0';
     return conv;
   }
 
   // Convert unsigned int to lj string with 123 format
   char* itostr3left(const int& xx) {
-    char *str = &conv[3];
-    *str = '\0';
-    *(--str) = DIGIMOD(xx, 1);
-    if (xx >= 10) {
-      *(--str) = DIGIMOD(xx, 10);
-      if (xx >= 100)
-        *(--str) = DIGIMOD(xx, 100);
-    }
-    return str;
+    const uint8_t count = xx >= 100 ? 3 : xx >= 10 ? 2 : 1;
+    conv[3] = '\0';
+    ultodigits(xx, &conv[3], count);
+    return &conv[3 - count];
   }
 
   // Convert signed int to rj string with 1234, _123, -123, _-12, or __-1 format
   char *itostr4sign(const int& x) {
     int xx = abs(x);
-    if (x >= 1000) {
-      conv[0] = DIGIMOD(xx, 1000);
-      conv[1] = DIGIMOD(xx, 100);
-      conv[2] = DIGIMOD(xx, 10);
-    }
+    if (x >= 1000)
+      ultodigits(xx, &conv[4], 4);
     else {
-      if (xx >= 100) {
-        conv[0] = x < 0 ? '-' : ' ';
-        conv[1] = DIGIMOD(xx, 100);
-        conv[2] = DIGIMOD(xx, 10);
-      }
+      ultodigits(xx, &conv[4], 3);
+      const char sign = x < 0 ? '-' : ' ';
+      if (xx >= 100)
+        conv[0] = sign;
       else {
         conv[0] = ' ';
-        if (xx >= 10) {
-          conv[1] = x < 0 ? '-' : ' ';
-          conv[2] = DIGIMOD(xx, 10);
-        }
+        if (xx >= 10)
+          conv[1] = sign;
         else {
           conv[1] = ' ';
-          conv[2] = x < 0 ? '-' : ' ';
+          conv[2] = sign;
         }
       }
     }
-    conv[3] = DIGIMOD(xx, 1);
     conv[4] = '\0';
     return conv;
   }
@@ -108,10 +180,8 @@ void safe_delay(millis_t ms) {
   // Convert unsigned float to string with 1.23 format
   char* ftostr12ns(const float& x) {
     long xx = abs(x * 100);
-    conv[0] = DIGIMOD(xx, 100);
+    ultodigits(ultodigits(xx, &conv[4], 2), &conv[1], 1);
     conv[1] = '.';
-    conv[2] = DIGIMOD(xx, 10);
-    conv[3] = DIGIMOD(xx, 1);
     conv[4] = '\0';
     return conv;
   }
@@ -119,12 +189,11 @@ void safe_delay(millis_t ms) {
   // Convert signed float to fixed-length string with 023.45 / -23.45 format
   char *ftostr32(const float& x) {
     long xx = x * 100;
-    conv[0] = MINUSOR(xx, DIGIMOD(xx, 10000));
-    conv[1] = DIGIMOD(xx, 1000);
-    conv[2] = DIGIMOD(xx, 100);
+    const bool neg = xx < 0;
+    if (neg) xx = -xx;
+    ultodigits(ultodigits(xx, &conv[6], 2), &conv[3], 3);
+    if (neg) conv[0] = '-';
     conv[3] = '.';
-    conv[4] = DIGIMOD(xx, 10);
-    conv[5] = DIGIMOD(xx, 1);
     conv[6] = '\0';
     return conv;
   }
@@ -136,10 +205,12 @@ void safe_delay(millis_t ms) {
       int x = fx * 10;
       if (x <= -100 || x >= 1000) return itostr4sign((int)fx);
       int xx = abs(x);
-      conv[0] = x < 0 ? '-' : (xx >= 100 ? DIGIMOD(xx, 100) : ' ');
-      conv[1] = DIGIMOD(xx, 10);
+      ultodigits(ultodigits(xx, &conv[4], 1), &conv[2], 2);
+      if (x < 0)
+        conv[0] = '-';
+      else if (xx < 100)
+        conv[0] = ' ';
       conv[2] = '.';
-      conv[3] = DIGIMOD(xx, 1);
       conv[4] = '\0';
       return conv;
     }
@@ -150,11 +221,8 @@ void safe_delay(millis_t ms) {
   char* ftostr41sign(const float& x) {
     int xx = x * 10;
     conv[0] = MINUSOR(xx, '+');
-    conv[1] = DIGIMOD(xx, 1000);
-    conv[2] = DIGIMOD(xx, 100);
-    conv[3] = DIGIMOD(xx, 10);
+    ultodigits(ultodigits(xx, &conv[6], 1), &conv[4], 3);
     conv[4] = '.';
-    conv[5] = DIGIMOD(xx, 1);
     conv[6] = '\0';
     return conv;
   }
@@ -163,11 +231,8 @@ void safe_delay(millis_t ms) {
   char* ftostr43sign(const float& x, char plus/*=' '*/) {
     long xx = x * 1000;
     conv[0] = xx ? MINUSOR(xx, plus) : ' ';
-    conv[1] = DIGIMOD(xx, 1000);
+    ultodigits(ultodigits(xx, &conv[6], 3), &conv[2], 1);
     conv[2] = '.';
-    conv[3] = DIGIMOD(xx, 100);
-    conv[4] = DIGIMOD(xx, 10);
-    conv[5] = DIGIMOD(xx, 1);
     conv[6] = '\0';
     return conv;
   }
@@ -175,11 +240,7 @@ void safe_delay(millis_t ms) {
   // Convert unsigned float to rj string with 12345 format
   char* ftostr5rj(const float& x) {
     long xx = abs(x);
-    conv[0] = RJDIGIT(xx, 10000);
-    conv[1] = RJDIGIT(xx, 1000);
-    conv[2] = RJDIGIT(xx, 100);
-    conv[3] = RJDIGIT(xx, 10);
-    conv[4] = DIGIMOD(xx, 1);
+    rjdigits(xx, &conv[5], 5);
     conv[5] = '\0';
     return conv;
   }
@@ -188,12 +249,8 @@ void safe_delay(millis_t ms) {
   char* ftostr51sign(const float& x) {
     long xx = x * 10;
     conv[0] = MINUSOR(xx, '+');
-    conv[1] = DIGIMOD(xx, 10000);
-    conv[2] = DIGIMOD(xx, 1000);
-    conv[3] = DIGIMOD(xx, 100);
-    conv[4] = DIGIMOD(xx, 10);
+    ultodigits(ultodigits(xx, &conv[7], 1), &conv[5], 4);
     conv[5] = '.';
-    conv[6] = DIGIMOD(xx, 1);
     conv[7] = '\0';
     return conv;
   }
@@ -202,12 +259,8 @@ void safe_delay(millis_t ms) {
   char* ftostr52sign(const float& x) {
     long xx = x * 100;
     conv[0] = MINUSOR(xx, '+');
-    conv[1] = DIGIMOD(xx, 10000);
-    conv[2] = DIGIMOD(xx, 1000);
-    conv[3] = DIGIMOD(xx, 100);
+    ultodigits(ultodigits(xx, &conv[7], 2), &conv[4], 3);
     conv[4] = '.';
-    conv[5] = DIGIMOD(xx, 10);
-    conv[6] = DIGIMOD(xx, 1);
     conv[7] = '\0';
     return conv;
   }
@@ -216,13 +269,8 @@ void safe_delay(millis_t ms) {
   char* ftostr62sign(const float& x) {
     long xx = abs(x * 100);
     conv[0] = MINUSOR(xx, '+');
-    conv[1] = DIGIMOD(xx, 100000);
-    conv[2] = DIGIMOD(xx, 10000);
-    conv[3] = DIGIMOD(xx, 1000);
-    conv[4] = DIGIMOD(xx, 100);
+    ultodigits(ultodigits(xx, &conv[8], 2), &conv[5], 4);
     conv[5] = '.';
-    conv[6] = DIGIMOD(xx, 10);
-    conv[7] = DIGIMOD(xx, 1);
     conv[8] = '\0';
     return conv;
   }
@@ -230,21 +278,21 @@ void safe_delay(millis_t ms) {
   // Convert signed float to space-padded string with -_23.4_ format
   char* ftostr52sp(const float& x) {
     long xx = x * 100;
-    uint8_t dig;
-    conv[0] = MINUSOR(xx, RJDIGIT(xx, 10000));
-    conv[1] = RJDIGIT(xx, 1000);
-    conv[2] = DIGIMOD(xx, 100);
+    const bool neg = xx < 0;
+    if (neg) xx = -xx;
+    const uint32_t n = ultodigits(xx, &conv[6], 2);
+    if (neg) {
+      conv[0] = '-';
+      rjdigits(n, &conv[3], 2);
+    }
+    else
+      rjdigits(n, &conv[3], 3);
 
-    if ((dig = xx % 10)) {          // second digit after decimal point?
+    if (conv[5] != '0')             // second digit after decimal point?
       conv[3] = '.';
-      conv[4] = DIGIMOD(xx, 10);
-      conv[5] = DIGIT(dig);
-    }
     else {
-      if ((dig = (xx / 10) % 10)) { // first digit after decimal point?
+      if (conv[4] != '0')           // first digit after decimal point?
         conv[3] = '.';
-        conv[4] = DIGIT(dig);
-      }
       else                          // nothing after decimal point
         conv[3] = conv[4] = ' ';
       conv[5] = ' ';
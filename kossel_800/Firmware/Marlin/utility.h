@@ -25,6 +25,13 @@
 
 void safe_delay(millis_t ms);
 
+// Write n in decimal, ending just before 'end'. Return the first digit.
+char* ultostr(uint32_t n, char* end);
+
+// Write the 'count' lowest digits of n, zero padded, ending just before
+// 'end'. Return what is left of n.
+uint32_t ultodigits(uint32_t n, char* end, uint8_t count);
+
 #if ENABLED(ULTRA_LCD)
 
   // Convert unsigned int to string with 12 format
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Measure the hotend feed-forward coefficients of PID_FEEDFORWARD (M306).
+
+Holds the hotend at a temperature with the feed-forward off and reads the
+heater power (the '@:' of M105) once it settles, first with the part fan
+at several speeds, then while filament is pushed through at several rates.
+The slope of a straight line through each series is the extra power per
+mm/s of filament and at full fan, in the PID output units M306 takes
+(twice the '@:' value).
+
+Home the printer and raise the nozzle well clear of the bed first: the
+filament is extruded into the air, about (sum of --rates) x (--settle +
+--measure) mm of it. Needs firmware built with PID_FEEDFORWARD. Linux only.
+
+  tools/ff_calibrate.py -p /dev/ttyACM0 -t 210
+  tools/ff_calibrate.py -p /dev/ttyUSB0 -b 250000 -t 240 --rates 0 2 4 6 --save
+"""
+
+import argparse
+import re
+import sys
+import time
+
+from sd_upload import Link, open_port
+
+REPORT = re.compile(r'T:\s*(-?[\d.]+)\s*/\s*(-?[\d.]+).*?@:(\d+)')
+FULL_POWER = 127  # '@:' at full duty
+
+
+def slope(points):
+  """Least squares slope of (x, y) points."""
+  n = len(points)
+  mx = sum(x for x, _ in points) / n
+  my = sum(y for _, y in points) / n
+  sxx = sum((x - mx) ** 2 for x, _ in points)
+  return sum((x - mx) * (y - my) for x, y in points) / sxx if sxx else 0.0
+
+
+class Extruder:
+  """Keeps about lead seconds of 1 s extrusion moves queued at a rate."""
+
+  def __init__(self, link, rate, lead=3):
+    self.link, self.rate, self.lead = link, rate, lead
+    self.start, self.sent = time.monotonic(), 0
+
+  def feed(self):
+    if self.rate <= 0:
+      return
+    due = int(time.monotonic() - self.start) + self.lead
+    while self.sent < due:
+      self.link.command('G1 E%.3f F%.1f' % (self.rate, self.rate * 60))
+      self.sent += 1
+
+  def left(self):
+    return max(0.0, self.start + self.sent - time.monotonic())
+
+
+def measure(link, extruder, settle, seconds, target):
+  """Average PID output after settle seconds, polling M105 once a second."""
+  powers, errors = [], []
+  begin = time.monotonic()
+  while time.monotonic() - begin < settle + seconds:
+    extruder.feed()
+    for text in link.command('M105'):
+      m = REPORT.search(text)
+      if m and time.monotonic() - begin >= settle:
+        errors.append(abs(float(m.group(1)) - target))
+        powers.append(int(m.group(3)))
+    time.sleep(1.0)
+  if not powers:
+    raise SystemExit('no temperature reports from M105')
+  if max(powers) >= FULL_POWER:
+    raise SystemExit('the heater ran at full power, use lower --rates or --fans')
+  if sum(errors) / len(errors) > 3.0:
+    print('  warning: %.1f C off the target on average' % (sum(errors) / len(errors)), file=sys.stderr)
+  return 2.0 * sum(powers) / len(powers)
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+  parser.add_argument('-p', '--port', required=True, help='serial device of the printer')
+  parser.add_argument('-b', '--baud', type=int, default=115200)
+  parser.add_argument('-t', '--temp', type=float, required=True, help='hotend temperature to calibrate at')
+  parser.add_argument('--fans', type=int, nargs='+', default=[0, 128, 255], help='part fan speeds (0-255)')
+  parser.add_argument('--rates', type=float, nargs='+', default=[0, 1, 2, 3], help='filament feed rates (mm/s)')
+  parser.add_argument('--settle', type=float, default=30, help='seconds to let each step settle')
+  parser.add_argument('--measure', type=float, default=30, help='seconds to average each step over')
+  parser.add_argument('--save', action='store_true', help='store the result with M500')
+  parser.add_argument('-v', '--verbose', action='store_true', help='show the printer\'s replies')
+  args = parser.parse_args(argv)
+
+  link = Link(open_port(args.port, args.baud), args.verbose)
+  before = link.command('M306')
+  if not any(' e:' in line for line in before):
+    raise SystemExit('the firmware has no PID_FEEDFORWARD')
+  old = dict(re.findall(r'([ef]):(-?[\d.]+)', [line for line in before if ' e:' in line][-1]))
+
+  done = False
+  try:
+    link.command('M306 E0 F0')
+    link.command('M83')
+    link.command('M106 S0')
+    print('heating to %.0f C' % args.temp)
+    link.command('M109 S%.0f' % args.temp, timeout=30)
+
+    fan_points = []
+    for speed in args.fans:
+      link.command('M106 S%d' % speed)
+      power = measure(link, Extruder(link, 0), args.settle, args.measure, args.temp)
+      print('  fan %3d: power %.1f' % (speed, power))
+      fan_points.append((speed / 255.0, power))
+    link.command('M106 S0')
+
+    feed_points = []
+    for rate in args.rates:
+      extruder = Extruder(link, rate)
+      power = measure(link, extruder, args.settle, args.measure, args.temp)
+      print('  feed %.2f mm/s: power %.1f' % (rate, power))
+      feed_points.append((rate, power))
+      link.command('M400', timeout=extruder.left() + 10)
+
+    ff_e, ff_f = max(0.0, slope(feed_points)), max(0.0, slope(fan_points))
+    result = 'M306 E%.2f F%.2f' % (ff_e, ff_f)
+    link.command(result)
+    if args.save:
+      link.command('M500')
+    print(result + (' (saved)' if args.save else ' (not saved, send M500 to keep it)'))
+    done = True
+  finally:
+    if not done:
+      link.command('M306 E%s F%s' % (old.get('e', '0'), old.get('f', '0')))
+    link.command('M106 S0')
+    link.command('M104 S0')
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+FAT16 card images for the host build of the firmware.
+
+Makes an image of a FAT16 volume without partition table, with folders and
+files in it, and reads files and listings back, so a test can check what
+the firmware wrote. Short 8.3 names only, like the firmware writes them.
+
+  tools/host/fatimage.py make card.img [--size MB] [host_path=card/path ...]
+  tools/host/fatimage.py ls card.img [/folder]
+  tools/host/fatimage.py get card.img /folder/file.gco out.gcode
+"""
+
+import argparse
+import struct
+import sys
+
+SECTOR = 512
+ATTR_DIR, ATTR_ARCHIVE = 0x10, 0x20
+END = 0xFFFF
+
+
+def short_name(name):
+  """'part.gco' -> b'PART    GCO'"""
+  base, _, ext = name.upper().rpartition('.') if '.' in name else (name.upper(), '', '')
+  if not base or len(base) > 8 or len(ext) > 3:
+    raise ValueError('not an 8.3 name: %s' % name)
+  return base.ljust(8).encode() + ext.ljust(3).encode()
+
+
+def long_name(raw):
+  base, ext = raw[:8].decode().rstrip(), raw[8:].decode().rstrip()
+  return base + ('.' + ext if ext else '')
+
+
+class Volume:
+  """A FAT16 volume in a bytearray, first sector the boot sector."""
+
+  def __init__(self, data):
+    self.data = data
+    (self.bytes_per_sector, self.per_cluster, self.reserved, self.fats, self.root_entries,
+     total16, _, self.fat_sectors) = struct.unpack_from('<HBHBHHBH', data, 11)
+    if self.bytes_per_sector != SECTOR:
+      raise ValueError('not a FAT16 image')
+    self.fat = self.reserved * SECTOR
+    self.root = self.fat + self.fats * self.fat_sectors * SECTOR
+    self.clusters_at = self.root + self.root_entries * 32
+    total = total16 or struct.unpack_from('<I', data, 32)[0]
+    self.cluster_count = (total * SECTOR - self.clusters_at) // self.cluster_bytes + 2
+
+  @classmethod
+  def make(cls, size_mb=32, per_cluster=4):
+    sectors = size_mb * 1024 * 1024 // SECTOR
+    fat_sectors = (sectors // per_cluster * 2 + SECTOR - 1) // SECTOR
+    data = bytearray(sectors * SECTOR)
+    struct.pack_into('<3s8sHBHBHHBHHHII', data, 0, b'\xEB\x3C\x90', b'MARLINHO', SECTOR, per_cluster,
+                     1, 2, 512, sectors if sectors < 0x10000 else 0, 0xF8, fat_sectors, 32, 64, 0,
+                     sectors if sectors >= 0x10000 else 0)
+    struct.pack_into('<BBBI11s8s', data, 36, 0x80, 0, 0x29, 0x12345678, b'HOST CARD  ', b'FAT16   ')
+    data[510:512] = b'\x55\xAA'
+    vol = cls(data)
+    for f in range(vol.fats):
+      struct.pack_into('<HH', data, vol.fat + f * fat_sectors * SECTOR, 0xFFF8, 0xFFFF)
+    return vol
+
+  @property
+  def cluster_bytes(self):
+    return self.per_cluster * SECTOR
+
+  def next_cluster(self, c):
+    return struct.unpack_from('<H', self.data, self.fat + 2 * c)[0]
+
+  def set_next(self, c, n):
+    for f in range(self.fats):
+      struct.pack_into('<H', self.data, self.fat + f * self.fat_sectors * SECTOR + 2 * c, n)
+
+  def chain(self, first):
+    c = first
+    while 2 <= c < 0xFFF8:
+      yield c
+      c = self.next_cluster(c)
+
+  def offset(self, c):
+    return self.clusters_at + (c - 2) * self.cluster_bytes
+
+  def read_chain(self, first, size=None):
+    out = b''.join(bytes(self.data[self.offset(c):self.offset(c) + self.cluster_bytes]) for c in self.chain(first))
+    return out if size is None else out[:size]
+
+  def allocate(self, count):
+    free = [c for c in range(2, self.cluster_count) if self.next_cluster(c) == 0][:count]
+    if len(free) < count:
+      raise ValueError('card full')
+    for a, b in zip(free, free[1:] + [END]):
+      self.set_next(a, b)
+    return free
+
+  # Directories: (offset of each 32 byte entry) for the root or a cluster chain
+  def entry_offsets(self, first):
+    if first == 0:
+      return [self.root + 32 * i for i in range(self.root_entries)]
+    return [self.offset(c) + 32 * i for c in self.chain(first) for i in range(self.cluster_bytes // 32)]
+
+  def entries(self, first):
+    for off in self.entry_offsets(first):
+      raw = bytes(self.data[off:off + 32])
+      if raw[0] == 0:
+        break
+      if raw[0] == 0xE5 or raw[11] == 0x0F or raw[11] & 0x08:
+        continue
+      cluster, size = struct.unpack_from('<H', raw, 26)[0], struct.unpack_from('<I', raw, 28)[0]
+      yield long_name(raw[:11]), raw[11], cluster, size, off
+
+  def lookup(self, path):
+    """(attributes, first cluster, size) of a path, the root is (ATTR_DIR, 0, 0)"""
+    found = (ATTR_DIR, 0, 0)
+    for part in [p for p in path.split('/') if p]:
+      if not found[0] & ATTR_DIR:
+        raise FileNotFoundError(path)
+      match = [e for e in self.entries(found[1]) if e[0].upper() == part.upper()]
+      if not match:
+        raise FileNotFoundError(path)
+      found = match[0][1:4]
+    return found
+
+  def listing(self, path='/'):
+    attr, first, _ = self.lookup(path)
+    if not attr & ATTR_DIR:
+      raise NotADirectoryError(path)
+    return [(name, bool(a & ATTR_DIR), size) for name, a, _, size, _ in self.entries(first) if name not in ('.', '..')]
+
+  def read(self, path):
+    attr, first, size = self.lookup(path)
+    if attr & ATTR_DIR:
+      raise IsADirectoryError(path)
+    return self.read_chain(first, size) if first else b''
+
+  def add_entry(self, parent, raw_name, attr, cluster, size):
+    offsets = self.entry_offsets(parent)
+    free = [o for o in offsets if self.data[o] in (0, 0xE5)]
+    if not free:
+      if parent == 0:
+        raise ValueError('root folder full')
+      last = list(self.chain(parent))[-1]
+      c = self.allocate(1)[0]
+      self.set_next(last, c)
+      self.data[self.offset(c):self.offset(c) + self.cluster_bytes] = bytes(self.cluster_bytes)
+      free = [self.offset(c)]
+    struct.pack_into('<11sBBBHHHHHHHI', self.data, free[0], raw_name, attr, 0, 0, 0, 0x5021, 0x5021, 0,
+                     0, 0x5021, cluster, size)
+
+  def mkdir(self, path):
+    """Makes the folder and any missing parents, returns its first cluster."""
+    first = 0
+    for part in [p for p in path.split('/') if p]:
+      match = [e for e in self.entries(first) if e[0].upper() == part.upper()]
+      if match:
+        first = match[0][2]
+        continue
+      c = self.allocate(1)[0]
+      self.data[self.offset(c):self.offset(c) + self.cluster_bytes] = bytes(self.cluster_bytes)
+      self.add_entry(c, b'.          ', ATTR_DIR, c, 0)
+      self.add_entry(c, b'..         ', ATTR_DIR, first, 0)
+      self.add_entry(first, short_name(part), ATTR_DIR, c, 0)
+      first = c
+    return first
+
+  def write(self, path, content):
+    folder, _, name = path.rpartition('/')
+    parent = self.mkdir(folder)
+    clusters = self.allocate(-(-len(content) // self.cluster_bytes)) if content else [0]
+    for i, c in enumerate(clusters if content else []):
+      chunk = content[i * self.cluster_bytes:(i + 1) * self.cluster_bytes]
+      self.data[self.offset(c):self.offset(c) + len(chunk)] = chunk
+    self.add_entry(parent, short_name(name), ATTR_ARCHIVE, clusters[0], len(content))
+
+
+def load(path):
+  with open(path, 'rb') as f:
+    return Volume(bytearray(f.read()))
+
+
+def save(vol, path):
+  with open(path, 'wb') as f:
+    f.write(vol.data)
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+  sub = parser.add_subparsers(dest='cmd', required=True)
+  p = sub.add_parser('make', help='new image with files in it')
+  p.add_argument('image')
+  p.add_argument('--size', type=int, default=32, help='MB (default 32)')
+  p.add_argument('files', nargs='*', help='host_path=card/path, or card/path/ for a folder')
+  p = sub.add_parser('ls', help='list a folder')
+  p.add_argument('image')
+  p.add_argument('path', nargs='?', default='/')
+  p = sub.add_parser('get', help='copy a file out')
+  p.add_argument('image')
+  p.add_argument('path')
+  p.add_argument('out')
+  args = parser.parse_args(argv)
+
+  if args.cmd == 'make':
+    vol = Volume.make(args.size)
+    for spec in args.files:
+      src, _, dst = spec.rpartition('=')
+      if not src:
+        vol.mkdir(dst)
+      else:
+        with open(src, 'rb') as f:
+          vol.write(dst, f.read())
+    save(vol, args.image)
+  elif args.cmd == 'ls':
+    for name, is_dir, size in load(args.image).listing(args.path):
+      print('%s/' % name if is_dir else '%s %d' % (name, size))
+  else:
+    with open(args.out, 'wb') as f:
+      f.write(load(args.image).read(args.path))
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
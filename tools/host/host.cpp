@@ -0,0 +1,605 @@
+/**
+ * Host build of the firmware: the simulated ATmega2560
+ *
+ * The registers are variables, the Arduino core functions work on them and
+ * the interrupts are plain functions. Whenever the firmware asks for the
+ * time host_tick() catches up with the clock: it feeds the UART from the
+ * serial port and runs the interrupts that are due, as long as the I bit
+ * of SREG and the interrupt's enable bit allow. A timer signal does the
+ * same every 200us, so busy waits for an interrupt end as on the MCU, and
+ * with the I bit clear nothing lands inside a critical section.
+ *
+ *   Timer 0 compare B  every 1024us          Temperature::isr()
+ *   Timer 1 compare A  OCR1A ticks of 0.5us  Stepper::isr()
+ *   USART0 RX / UDRE   at the baud rate      MarlinSerial
+ *
+ * The serial port is stdin/stdout, or a pseudo terminal with -p for host
+ * software that wants a device to open.
+ *
+ * With -s 0 the clock runs free, as fast as the host can compute: the MCU
+ * takes no time for its work and only waits take time. Each time a waiting
+ * firmware looks at the clock, it moves on to the next timer interrupt. A
+ * replayed command starts as work (host_command_start()), and is taken to
+ * wait once it has looked at the clock FREE_WORK_READS times. Work the MCU
+ * would be slow at, like planning a block, is given a time with
+ * host_work_us(): the clock runs on by that much at the next reads, with
+ * the interrupts that fall due on the way.
+ *
+ * Built with HOST_LIBRARY (make pool) there is no main(): host_replay()
+ * runs one replay on the calling thread, for marlin_pool.cpp to load a
+ * copy of the build per replay.
+ */
+
+#include "host.h"
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <util/delay.h>
+
+#include "fastio.h"
+#include "macros.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+//
+// Registers
+//
+volatile uint8_t SREG;
+
+#define HOST_PORT(P) volatile uint8_t PORT##P, DDR##P; HostPIN PIN##P = { PORT##P, 0 };
+HOST_PORT(A) HOST_PORT(B) HOST_PORT(C) HOST_PORT(D) HOST_PORT(E) HOST_PORT(F)
+HOST_PORT(G) HOST_PORT(H) HOST_PORT(J) HOST_PORT(K) HOST_PORT(L)
+
+volatile uint8_t TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCCR1C, TCCR2A, TCCR2B, TCCR3A, TCCR3B, TCCR3C,
+                 TCCR4A, TCCR4B, TCCR4C, TCCR5A, TCCR5B, TCCR5C,
+                 TIMSK0, TIMSK1, TIMSK2, TIMSK3, TIMSK4, TIMSK5, TIFR0, TIFR1, TIFR2, TIFR3, TIFR4, TIFR5,
+                 TCNT0, TCNT2, OCR0A, OCR0B, OCR2A, OCR2B,
+                 ADCSRA, ADCSRB, ADMUX, ADCL, ADCH, DIDR0, DIDR1, DIDR2,
+                 UCSR0B, UCSR0C, UBRR0H, UBRR0L, UCSR1A, UCSR1B, UCSR1C, UDR1, UBRR1H, UBRR1L,
+                 UCSR2A, UCSR2B, UCSR2C, UDR2, UBRR2H, UBRR2L, UCSR3A, UCSR3B, UCSR3C, UDR3, UBRR3H, UBRR3L,
+                 SPCR, SPSR, PCICR, PCMSK0, PCMSK1, PCMSK2, PCIFR, EICRA, EICRB, EIMSK, EIFR,
+                 MCUSR, MCUCR, WDTCSR, GPIOR0, GPIOR1, GPIOR2, TWCR, TWSR, TWBR, TWDR, TWAR, ASSR;
+volatile uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C, OCR4A, OCR4B, OCR4C, OCR5A, OCR5B, OCR5C,
+                  TCNT1, TCNT3, TCNT4, TCNT5, ICR1, ICR3, ICR4, ICR5;
+
+HostUDR UDR0;
+HostUCSRA UCSR0A;
+HostADC ADC;
+
+uint16_t host_adc[16];
+
+// The heap and the end of the static data, for M100
+char *__brkval, __bss_end;
+
+// The interrupts the firmware may define
+extern "C" {
+  void TIMER0_COMPB_vect() __attribute__((weak));
+  void TIMER1_COMPA_vect() __attribute__((weak));
+  void USART0_RX_vect() __attribute__((weak));
+  void USART0_UDRE_vect() __attribute__((weak));
+}
+
+//
+// Ports and pins
+//
+static volatile uint8_t * const port_pin[] = { &PINA.level, &PINB.level, &PINC.level, &PIND.level, &PINE.level, &PINF.level, &PING.level, &PINH.level, &PINJ.level, &PINK.level, &PINL.level },
+                        * const port_out[] = { &PORTA, &PORTB, &PORTC, &PORTD, &PORTE, &PORTF, &PORTG, &PORTH, &PORTJ, &PORTK, &PORTL },
+                        * const port_ddr[] = { &DDRA, &DDRB, &DDRC, &DDRD, &DDRE, &DDRF, &DDRG, &DDRH, &DDRJ, &DDRK, &DDRL };
+#define PORT_COUNT COUNT(port_pin)
+static uint8_t port_input[PORT_COUNT];  // Levels driven from outside
+
+// Arduino pin to port and bit, from the firmware's own fastio.h
+struct pin_map_t { volatile uint8_t *pin; uint8_t bit; };
+#define _PIN_MAP(N) { &DIO##N##_RPORT, DIO##N##_PIN }
+static const pin_map_t pin_map[NUM_DIGITAL_PINS] = {
+  _PIN_MAP(0), _PIN_MAP(1), _PIN_MAP(2), _PIN_MAP(3), _PIN_MAP(4), _PIN_MAP(5), _PIN_MAP(6), _PIN_MAP(7),
+  _PIN_MAP(8), _PIN_MAP(9), _PIN_MAP(10), _PIN_MAP(11), _PIN_MAP(12), _PIN_MAP(13), _PIN_MAP(14), _PIN_MAP(15),
+  _PIN_MAP(16), _PIN_MAP(17), _PIN_MAP(18), _PIN_MAP(19), _PIN_MAP(20), _PIN_MAP(21), _PIN_MAP(22), _PIN_MAP(23),
+  _PIN_MAP(24), _PIN_MAP(25), _PIN_MAP(26), _PIN_MAP(27), _PIN_MAP(28), _PIN_MAP(29), _PIN_MAP(30), _PIN_MAP(31),
+  _PIN_MAP(32), _PIN_MAP(33), _PIN_MAP(34), _PIN_MAP(35), _PIN_MAP(36), _PIN_MAP(37), _PIN_MAP(38), _PIN_MAP(39),
+  _PIN_MAP(40), _PIN_MAP(41), _PIN_MAP(42), _PIN_MAP(43), _PIN_MAP(44), _PIN_MAP(45), _PIN_MAP(46), _PIN_MAP(47),
+  _PIN_MAP(48), _PIN_MAP(49), _PIN_MAP(50), _PIN_MAP(51), _PIN_MAP(52), _PIN_MAP(53), _PIN_MAP(54), _PIN_MAP(55),
+  _PIN_MAP(56), _PIN_MAP(57), _PIN_MAP(58), _PIN_MAP(59), _PIN_MAP(60), _PIN_MAP(61), _PIN_MAP(62), _PIN_MAP(63),
+  _PIN_MAP(64), _PIN_MAP(65), _PIN_MAP(66), _PIN_MAP(67), _PIN_MAP(68), _PIN_MAP(69)
+};
+static uint8_t pwm_value[NUM_DIGITAL_PINS];
+
+static uint8_t port_index(const uint8_t pin) {
+  for (uint8_t p = 0; p < PORT_COUNT; p++) if (port_pin[p] == pin_map[pin].pin) return p;
+  return 0;
+}
+
+// PINx reads the driven level of outputs and the outside level of inputs
+static void sync_pins() {
+  for (uint8_t p = 0; p < PORT_COUNT; p++)
+    *port_pin[p] = (*port_out[p] & *port_ddr[p]) | (port_input[p] & ~*port_ddr[p]);
+}
+
+void host_set_input(const uint8_t pin, const bool level) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  const uint8_t p = port_index(pin);
+  if (level) port_input[p] |= _BV(pin_map[pin].bit); else port_input[p] &= ~_BV(pin_map[pin].bit);
+  sync_pins();
+}
+
+bool host_output(const uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return false;
+  const uint8_t p = port_index(pin);
+  return TEST(*port_out[p] & *port_ddr[p], pin_map[pin].bit);
+}
+
+uint8_t host_pwm(const uint8_t pin) { return pin < NUM_DIGITAL_PINS ? pwm_value[pin] : 0; }
+
+//
+// Clock
+//
+static double speed = 1.0;              // 0 runs free, see above
+static uint64_t start_ns, free_ns, work_ns;
+
+#define FREE_WORK_READS 32
+static uint8_t free_reads = FREE_WORK_READS;
+
+void host_command_start() { free_reads = 0; }
+
+void host_work_us(const double us) { if (!speed) work_ns += us * 1000; }
+
+static uint64_t wall_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Static constructors may be the first to ask
+static uint64_t sim_ns() {
+  if (!speed) return free_ns;
+  const uint64_t wall = wall_ns();
+  if (!start_ns) start_ns = wall;
+  return (uint64_t)((wall - start_ns) * speed);
+}
+
+uint64_t host_micros() { return sim_ns() / 1000; }
+
+//
+// Serial port
+//
+static int serial_in = 0, serial_out = 1;
+static bool serial_eof;
+static uint8_t rx_queue[4096];
+static uint16_t rx_head, rx_tail;       // Read from the port, not yet received by the UART
+static double rx_credit;                // Bytes the line could have carried since the last tick
+static char tx_buffer[256];
+static uint16_t tx_len;
+static uint64_t last_tx_us;
+
+static void tx_flush() {
+  for (uint16_t done = 0; done < tx_len;) {
+    const ssize_t n = write(serial_out, tx_buffer + done, tx_len - done);
+    if (n > 0) done += n;
+    else if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+    else if (n < 0 && errno == EAGAIN) break; // Nobody reads the terminal, like an open line
+  }
+  tx_len = 0;
+}
+
+HostUDR& HostUDR::operator=(const uint8_t c) {
+  tx_buffer[tx_len++] = c;
+  if (c == '\n' || tx_len == sizeof(tx_buffer)) tx_flush();
+  last_tx_us = host_micros();
+  return *this;
+}
+
+static bool rx_ready() { return rx_head != rx_tail && rx_credit >= 1.0; }
+
+HostUDR::operator uint8_t() const {
+  if (rx_head == rx_tail) return 0;
+  const uint8_t c = rx_queue[rx_tail];
+  rx_tail = (rx_tail + 1) % sizeof(rx_queue);
+  rx_credit -= 1.0;
+  return c;
+}
+
+HostUCSRA::operator uint8_t() const {
+  return bits | _BV(UDRE0) | _BV(TXC0) | (rx_ready() ? _BV(RXC0) : 0);
+}
+
+static void serial_read() {
+  if (serial_eof || serial_in < 0) return;
+  for (;;) {
+    const uint16_t next = (rx_head + 1) % sizeof(rx_queue);
+    if (next == rx_tail) return;
+    uint8_t c;
+    const ssize_t n = read(serial_in, &c, 1);
+    if (n == 1) { rx_queue[rx_head] = c; rx_head = next; continue; }
+    if (n == 0) serial_eof = true;
+    return;
+  }
+}
+
+// 10 bits per byte at the rate set in UBRR0
+static double serial_bytes_per_us() {
+  const uint16_t ubrr = (UBRR0H << 8) | UBRR0L;
+  const double baud = (F_CPU) / (TEST(UCSR0A.bits, U2X0) ? 8.0 : 16.0) / (ubrr + 1);
+  return baud / 10.0 / 1000000.0;
+}
+
+//
+// Interrupts
+//
+#define T0_PERIOD_NS 1024000ULL   // Timer 0 overflows every 1024us at 16MHz / 64
+#define T1_TICK_NS 500ULL         // Timer 1 at 16MHz / 8
+#define MAX_LAG_NS 50000000ULL    // Give up catching up after 50ms
+
+static uint64_t t0_next_ns, t1_next_ns, last_tick_ns, last_sleep_ns;
+static bool in_tick;
+static bool wdt_on;
+static uint64_t wdt_last_us, halted_since_us;
+
+static bool enabled(const volatile uint8_t &mask, const uint8_t bit) { return TEST(SREG, SREG_I) && TEST(mask, bit); }
+
+// The MCU clears I on entry and sets it again with reti
+static void call_isr(void (*isr)()) {
+  sync_pins();
+  SREG &= ~_BV(SREG_I);
+  isr();
+  SREG |= _BV(SREG_I);
+}
+
+// The free running clock works off host_work_us() up to the next timer
+// interrupt, else skips to it
+static void run_free_clock() {
+  uint64_t next_ns = t0_next_ns;
+  if (TIMER1_COMPA_vect && enabled(TIMSK1, OCIE1A)) NOMORE(next_ns, t1_next_ns);
+  if (work_ns) {
+    if (next_ns > free_ns) {
+      uint64_t ns = next_ns - free_ns;
+      NOMORE(ns, work_ns);
+      free_ns += ns;
+      work_ns -= ns;
+    }
+    return;
+  }
+  if (free_reads < FREE_WORK_READS) { free_reads++; return; }
+  NOLESS(free_ns, next_ns);
+}
+
+void host_work_done() { while (work_ns) host_tick(); }
+
+void host_tick() {
+  if (in_tick) return;
+  in_tick = true;
+
+  if (!speed) {
+    replay_tick();
+    run_free_clock();
+  }
+
+  const uint64_t now_ns = sim_ns(), now_us = now_ns / 1000;
+  sync_pins();
+
+  // UART: receive at the baud rate, transmit at once
+  if (TEST(UCSR0B, RXEN0)) {
+    serial_read();
+    rx_credit += (now_ns - last_tick_ns) / 1000.0 * serial_bytes_per_us();
+    NOMORE(rx_credit, 64.0);
+    while (rx_ready() && USART0_RX_vect && enabled(UCSR0B, RXCIE0)) call_isr(USART0_RX_vect);
+  }
+  for (uint16_t n = 0; USART0_UDRE_vect && enabled(UCSR0B, UDRIE0) && n < 1000; n++) call_isr(USART0_UDRE_vect);
+  if (tx_len) tx_flush();
+
+  // Timers
+  if (now_ns - t0_next_ns > MAX_LAG_NS && now_ns > t0_next_ns) t0_next_ns = now_ns;
+  while (t0_next_ns <= now_ns) {
+    t0_next_ns += T0_PERIOD_NS;
+    if (TIMER0_COMPB_vect && enabled(TIMSK0, OCIE0B)) {
+      call_isr(TIMER0_COMPB_vect);
+      printer_temp_isr();
+    }
+  }
+
+  if (!TIMER1_COMPA_vect || !enabled(TIMSK1, OCIE1A))
+    t1_next_ns = now_ns + OCR1A * T1_TICK_NS;
+  else {
+    if (now_ns - t1_next_ns > MAX_LAG_NS && now_ns > t1_next_ns) t1_next_ns = now_ns;
+    while (t1_next_ns <= now_ns && enabled(TIMSK1, OCIE1A)) {
+      printer_step_isr(false);
+      call_isr(TIMER1_COMPA_vect);
+      printer_step_isr(true);
+      replay_step_isr();
+      t1_next_ns += (OCR1A ? OCR1A : 0x10000) * T1_TICK_NS;
+    }
+  }
+
+  if (wdt_on && now_us > wdt_last_us + 4000000UL) host_fatal("watchdog reset, the firmware blocked for over 4s");
+
+  // Input is over and the firmware has had its say
+  if (serial_eof && rx_head == rx_tail && now_us > last_tx_us + 2000000UL) host_exit();
+
+  last_tick_ns = now_ns;
+
+  // Leave some of the CPU to the other end of the serial port
+  const uint64_t wall = wall_ns();
+  if (speed && wall - last_sleep_ns > 1000000ULL) {
+    const timespec nap = { 0, 100000 };
+    nanosleep(&nap, NULL);
+    last_sleep_ns = wall_ns();
+  }
+
+  in_tick = false;
+}
+
+static void on_timer_signal(int) { if (TEST(SREG, SREG_I)) host_tick(); }
+
+FILE *host_report = stderr;
+
+#ifdef HOST_LIBRARY
+  static sigjmp_buf end_jump;           // Back to host_replay()
+#endif
+
+// The firmware never expects its destructors to run
+static void end(const int code) {
+  tx_flush();
+  #ifdef HOST_LIBRARY
+    siglongjmp(end_jump, code + 1);
+  #else
+    _exit(code);
+  #endif
+}
+
+void host_fatal(const char *why) {
+  fprintf(host_report, "host: %s\n", why);
+  end(2);
+}
+
+void host_exit() { end(0); }
+
+//
+// Analog to digital converter
+//
+HostADC::operator uint16_t() const {
+  const uint8_t channel = (ADMUX & 0x07) | (TEST(ADCSRB, MUX5) ? 0x08 : 0);
+  return host_adc[channel];
+}
+
+//
+// Arduino core
+//
+unsigned long millis() { host_tick(); return (uint32_t)(host_micros() / 1000); }
+unsigned long micros() { host_tick(); return (uint32_t)host_micros(); }
+
+static void wait_us(const uint64_t us) {
+  const uint64_t end = host_micros() + us;
+  while (host_micros() < end) host_tick();
+}
+void delay(unsigned long ms) { wait_us(ms * 1000ULL); }
+void delayMicroseconds(unsigned int us) { wait_us(us); }
+void _delay_ms(double ms) { wait_us(ms * 1000); }
+void _delay_us(double us) { wait_us(us); }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  const uint8_t p = port_index(pin), m = _BV(pin_map[pin].bit);
+  if (mode == OUTPUT) *port_ddr[p] |= m;
+  else {
+    *port_ddr[p] &= ~m;
+    if (mode == INPUT_PULLUP) *port_out[p] |= m; else *port_out[p] &= ~m;
+  }
+  sync_pins();
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  const uint8_t p = port_index(pin), m = _BV(pin_map[pin].bit);
+  if (val) *port_out[p] |= m; else *port_out[p] &= ~m;
+  pwm_value[pin] = val ? 255 : 0;
+  sync_pins();
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return LOW;
+  sync_pins();
+  return TEST(*pin_map[pin].pin, pin_map[pin].bit) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) { return host_adc[(pin >= 54 ? pin - 54 : pin) & 0x0F]; }
+void analogReference(uint8_t) {}
+
+void analogWrite(uint8_t pin, int val) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, val >= 128);
+  pwm_value[pin] = constrain(val, 0, 255);
+}
+
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+void detachInterrupt(uint8_t) {}
+
+void tone(uint8_t, unsigned int, unsigned long) {}
+void noTone(uint8_t) {}
+
+long random(long howbig) { return howbig ? ::random() % howbig : 0; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { srandom(seed); }
+
+void serial_echopair_P(const char* s_P, unsigned long v);
+void serial_echopair_P(const char* s_P, unsigned int v) { serial_echopair_P(s_P, (unsigned long)v); }
+
+//
+// Watchdog: a reset ends the program. So does a kill(), which waits for
+// the reset with interrupts off.
+//
+void wdt_enable(const uint8_t) { wdt_on = true; wdt_last_us = host_micros(); }
+void wdt_disable() { wdt_on = false; }
+void wdt_reset() {
+  if (!speed) host_tick();              // The free clock moves on only when asked
+  const uint64_t now = host_micros();
+  wdt_last_us = now;
+  if (TEST(SREG, SREG_I))
+    halted_since_us = 0;
+  else if (!halted_since_us)
+    halted_since_us = now;
+  else if (now - halted_since_us > 1000000UL)
+    host_fatal("halted");
+}
+
+//
+// EEPROM, optionally kept in a file
+//
+static uint8_t eeprom[(E2END) + 1];
+static int eeprom_fd = -1;
+
+uint8_t eeprom_read_byte(const uint8_t *pos) {
+  const uintptr_t a = (uintptr_t)pos;
+  return a <= (E2END) ? eeprom[a] : 0xFF;
+}
+
+void eeprom_write_byte(uint8_t *pos, uint8_t value) {
+  const uintptr_t a = (uintptr_t)pos;
+  if (a > (E2END)) return;
+  eeprom[a] = value;
+  if (eeprom_fd >= 0 && pwrite(eeprom_fd, &value, 1, a) != 1) host_fatal("can't write the EEPROM file");
+}
+
+void eeprom_update_byte(uint8_t *pos, uint8_t value) { if (eeprom_read_byte(pos) != value) eeprom_write_byte(pos, value); }
+void eeprom_read_block(void *dst, const void *pos, size_t n) {
+  for (size_t i = 0; i < n; i++) ((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)pos + i);
+}
+void eeprom_write_block(const void *src, void *pos, size_t n) {
+  for (size_t i = 0; i < n; i++) eeprom_write_byte((uint8_t*)pos + i, ((const uint8_t*)src)[i]);
+}
+void eeprom_update_block(const void *src, void *pos, size_t n) {
+  for (size_t i = 0; i < n; i++) eeprom_update_byte((uint8_t*)pos + i, ((const uint8_t*)src)[i]);
+}
+
+//
+// Start up like the Arduino core and run the sketch
+//
+void setup();
+void loop();
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s [-p] [-c card.img] [-e eeprom.bin] [-s speed] [-m machine options] [-g file.gcode]\n"
+    "  -p  serial port on a new pseudo terminal, its path goes to stderr\n"
+    "      (default: stdin and stdout, exit 2s after the end of the input)\n"
+    "  -c  SD card image, a FAT16/FAT32 volume without partition table\n"
+    "  -e  EEPROM file, created when missing\n"
+    "  -s  run the clock this many times as fast as the wall clock,\n"
+    "      0 to let it run free\n"
+    "  -m  key=value,... for the machine, see tools/host/printer.cpp\n"
+    "  -g  replay a G-code file instead of reading the serial port and exit,\n"
+    "      see tools/host/replay.cpp\n", name);
+  exit(1);
+}
+
+static void open_pty() {
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) host_fatal("no pseudo terminal");
+  const char *name = ptsname(master);
+  // Hold the other end open in raw mode so a client can come and go
+  const int slave = open(name, O_RDWR | O_NOCTTY);
+  termios t;
+  if (slave < 0 || tcgetattr(slave, &t)) host_fatal("can't open the pseudo terminal");
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+  serial_in = serial_out = master;
+  fprintf(stderr, "pty: %s\n", name);
+}
+
+// Inputs float high with the pull-ups, nothing pressed or triggered
+static void power_up(const char *machine) {
+  memset(port_input, 0xFF, sizeof(port_input));
+  MCUSR = _BV(PORF);
+  printer_init(machine);
+}
+
+#ifdef HOST_LIBRARY
+
+extern "C" void host_signal() { on_timer_signal(SIGALRM); }
+
+extern "C" int host_replay(const char *gcode, const char *machine, const int out, FILE *report) {
+  speed = 0;
+  serial_in = -1;
+  serial_out = out;
+  host_report = report;
+  memset(eeprom, 0xFF, sizeof(eeprom));
+
+  // The timer signal goes to this thread, whose caller hands it to host_signal()
+  sigevent to_thread = {};
+  to_thread.sigev_notify = SIGEV_THREAD_ID;
+  to_thread.sigev_signo = SIGALRM;
+  to_thread._sigev_un._tid = syscall(SYS_gettid);
+  timer_t timer;
+  if (timer_create(CLOCK_MONOTONIC, &to_thread, &timer)) return 2;
+
+  const int ended = sigsetjmp(end_jump, 1);
+  if (!ended) {
+    power_up(machine);
+    const itimerspec every = { { 0, 200000 }, { 0, 200000 } };
+    timer_settime(timer, 0, &every, NULL);
+    SREG = _BV(SREG_I);
+    setup();
+    replay_file(gcode);
+  }
+  timer_delete(timer);
+  return ended - 1;
+}
+
+#else
+
+int main(int argc, char **argv) {
+  const char *card = NULL, *eeprom_file = NULL, *machine = "", *gcode = NULL;
+  bool pty = false;
+  for (int opt; (opt = getopt(argc, argv, "pc:e:s:m:g:h")) != -1;) {
+    switch (opt) {
+      case 'p': pty = true; break;
+      case 'c': card = optarg; break;
+      case 'e': eeprom_file = optarg; break;
+      case 's': speed = atof(optarg); if (speed < 0) usage(argv[0]); break;
+      case 'm': machine = optarg; break;
+      case 'g': gcode = optarg; break;
+      default: usage(argv[0]);
+    }
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  if (pty) open_pty();
+  if (gcode) serial_in = -1;            // Nothing comes in, the replay doesn't run loop()
+  fcntl(serial_in, F_SETFL, fcntl(serial_in, F_GETFL) | O_NONBLOCK);
+  if (serial_out != serial_in) setvbuf(stdout, NULL, _IONBF, 0);
+
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  if (eeprom_file) {
+    eeprom_fd = open(eeprom_file, O_RDWR | O_CREAT, 0644);
+    if (eeprom_fd < 0) host_fatal("can't open the EEPROM file");
+    if (pread(eeprom_fd, eeprom, sizeof(eeprom), 0) < (ssize_t)sizeof(eeprom))
+      if (pwrite(eeprom_fd, eeprom, sizeof(eeprom), 0) != (ssize_t)sizeof(eeprom)) host_fatal("can't write the EEPROM file");
+  }
+
+  if (card && !sdcard_open(card)) host_fatal("can't open the card image");
+
+  power_up(machine);
+
+  // Interrupts between the firmware's own calls to the clock
+  struct sigaction sa = {};
+  sa.sa_handler = on_timer_signal;
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &sa, NULL);
+  const itimerval every = { { 0, 200 }, { 0, 200 } };
+  setitimer(ITIMER_REAL, &every, NULL);
+
+  SREG = _BV(SREG_I); // init() of the Arduino core ends with sei()
+  setup();
+  if (gcode) replay_file(gcode);
+  for (;;) { loop(); printer_loop(); }
+}
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * Host build of the firmware, see tools/host/Makefile
+ *
+ * Included ahead of every firmware source. The rest is the interface
+ * between the simulated MCU in host.cpp and the machine around it in
+ * printer.cpp and sdcard.cpp.
+ */
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// uint32_t is unsigned int here, which Marlin.h has no overload for
+void serial_echopair_P(const char* s_P, unsigned int v);
+
+#ifdef __cplusplus
+
+// Simulated time since start, running 'speed' times as fast as the wall clock
+// or free (see host.cpp)
+uint64_t host_micros();
+// A command starts, which with the free clock takes no time until it waits
+void host_command_start();
+// With the free clock: the MCU works this long more, before it next waits
+void host_work_us(const double us);
+void host_work_done();                  // Let the clock run until that is over
+
+// Deliver serial input and run the interrupts that are due. The Arduino
+// core functions call it, which is where the firmware waits for things.
+void host_tick();
+
+// Level on a pin as the outside world drives it (pull-ups read high)
+void host_set_input(const uint8_t pin, const bool level);
+// Level the firmware drives on an output pin
+bool host_output(const uint8_t pin);
+// Last analogWrite() value of a pin
+uint8_t host_pwm(const uint8_t pin);
+
+// 10 bit ADC reading of each channel
+extern uint16_t host_adc[16];
+
+// Something the firmware should never do on the target, e.g. block too long
+void host_fatal(const char *why);
+// The end of a replay
+void host_exit();
+// Where host_fatal() and the replay summary go, stderr but for marlin_pool
+extern FILE *host_report;
+
+// The machine: heaters, thermistors, endstops and the probe
+void printer_init(const char *options);
+double printer_option(const char *name); // A -m key=value, see printer.cpp
+void printer_step_isr(const bool done); // Before and after each stepper interrupt
+void printer_temp_isr();                // After each temperature interrupt (1024us)
+void printer_loop();                    // After each run of the firmware's loop()
+
+// Replay of a G-code file straight into the parser, see replay.cpp
+void replay_file(const char *path);     // After setup(), doesn't return
+void replay_tick();                     // Ahead of each free clock tick
+void replay_step_isr();                 // After each stepper interrupt
+
+// The card, an image file of a FAT16 or FAT32 volume without partition table
+bool sdcard_open(const char *path);
+bool sdcard_present();
+
+// The character LCD and the encoder that drives its menus
+void host_lcd_clear();
+void host_lcd_set_cursor(const uint8_t col, const uint8_t row);
+void host_lcd_write(const uint8_t c);
+bool panel_open(const char *path);      // Named pipe of keys, see panel.cpp
+void panel_tick();                      // From the temperature interrupt
+
+#endif
+
+#endif // HOST_H
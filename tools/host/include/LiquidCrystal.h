@@ -0,0 +1,32 @@
+/**
+ * A character LCD for the host build, drawing into the screen of panel.cpp
+ */
+#ifndef HOST_LIQUIDCRYSTAL_H
+#define HOST_LIQUIDCRYSTAL_H
+
+#include <stdint.h>
+#include "Print.h"
+
+class LiquidCrystal : public Print {
+  public:
+    LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+    LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+    LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+    LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+    void begin(uint8_t, uint8_t, uint8_t = 0) { host_lcd_clear(); }
+    void clear() { host_lcd_clear(); }
+    void home() { host_lcd_set_cursor(0, 0); }
+    void noDisplay() {}
+    void display() {}
+    void noCursor() {}
+    void cursor() {}
+    void noBlink() {}
+    void blink() {}
+    void createChar(uint8_t, uint8_t[]) {}
+    void createChar(uint8_t, const uint8_t*) {}
+    void setCursor(uint8_t col, uint8_t row) { host_lcd_set_cursor(col, row); }
+    virtual size_t write(uint8_t c) { host_lcd_write(c); return 1; }
+    using Print::write;
+};
+
+#endif // HOST_LIQUIDCRYSTAL_H
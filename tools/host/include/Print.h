@@ -0,0 +1,57 @@
+/**
+ * Arduino Print for the host build, see tools/host/Makefile
+ *
+ * Only the LCD derives from it here. Output goes through write(), the
+ * number formatting is the usual one.
+ */
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    size_t write(const char *str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    virtual size_t write(const uint8_t *buffer, size_t size) { size_t n = 0; while (size--) n += write(*buffer++); return n; }
+
+    size_t print(const __FlashStringHelper *s) { return write((const char*)s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(const char s[]) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) {
+      if (base == DEC && n < 0) return write('-') + print((unsigned long)-n, base);
+      return print((unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) {
+      char buf[8 * sizeof(long) + 1], *p = &buf[sizeof(buf) - 1];
+      *p = '\0';
+      if (base < 2) base = 10;
+      do { const int d = n % base; *--p = d < 10 ? '0' + d : 'A' + d - 10; n /= base; } while (n);
+      return write(p);
+    }
+    size_t print(double n, int digits = 2) {
+      char buf[40];
+      snprintf(buf, sizeof(buf), "%.*f", digits, n);
+      return write(buf);
+    }
+
+    template<typename T> size_t println(T v) { return print(v) + println(); }
+    template<typename T> size_t println(T v, int f) { return print(v, f) + println(); }
+    size_t println(void) { return write("\r\n"); }
+};
+
+#endif // HOST_PRINT_H
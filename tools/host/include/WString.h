@@ -0,0 +1,22 @@
+/**
+ * The part of the Arduino String class that Marlin names, see tools/host/Makefile
+ */
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string.h>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class String {
+  public:
+    String(const char *s = "") : s_(s) {}
+    unsigned int length() const { return strlen(s_); }
+    char operator[](unsigned int i) const { return s_[i]; }
+    const char* c_str() const { return s_; }
+  private:
+    const char *s_;
+};
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,17 @@
+/**
+ * EEPROM of the host build, 4K in tools/host/host.cpp
+ */
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint8_t eeprom_read_byte(const uint8_t *pos);
+void eeprom_write_byte(uint8_t *pos, uint8_t value);
+void eeprom_update_byte(uint8_t *pos, uint8_t value);
+void eeprom_read_block(void *dst, const void *pos, size_t n);
+void eeprom_write_block(const void *src, void *pos, size_t n);
+void eeprom_update_block(const void *src, void *pos, size_t n);
+
+#endif // HOST_AVR_EEPROM_H
@@ -0,0 +1,19 @@
+/**
+ * Interrupts of the host build
+ *
+ * An ISR is a plain function that tools/host/host.cpp calls while the I bit
+ * of SREG and the interrupt's enable bit are set, at the points where the
+ * firmware asks for the time.
+ */
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector(void)
+#define SIGNAL(vector) extern "C" void vector(void)
+
+#define cli() (SREG &= (uint8_t)~_BV(SREG_I))
+#define sei() (SREG |= (uint8_t)_BV(SREG_I))
+
+#endif // HOST_AVR_INTERRUPT_H
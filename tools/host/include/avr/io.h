@@ -0,0 +1,626 @@
+/**
+ * ATmega2560 registers for the host build, see tools/host/Makefile
+ *
+ * Plain variables, defined in tools/host/host.cpp, except where reading or
+ * writing has to do something: the pin input registers, the UART data and
+ * status registers and the ADC result are objects that talk to the
+ * simulation.
+ */
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#ifndef __AVR_ATmega2560__
+  #define __AVR_ATmega2560__
+#endif
+
+#define _BV(bit) (1 << (bit))
+#define _SFR_BYTE(sfr) (sfr)
+
+#define RAMSTART 0x200
+#define RAMEND 0x21FF
+#define E2END 0xFFF
+#define FLASHEND 0x3FFFF
+
+extern volatile uint8_t SREG;
+#define SREG_I 7
+
+// PINx reads the levels on the pins. Writing ones toggles those bits of
+// PORTx, which fastio.h's TOGGLE and the combined step writes use.
+struct HostPIN {
+  volatile uint8_t &port;
+  mutable volatile uint8_t level;
+  operator uint8_t() const { return level; }
+  HostPIN& operator=(const uint8_t toggle) { port ^= toggle; return *this; }
+  // For fastio.h's address compare, and a constant for the static tables of host.cpp
+  constexpr volatile uint8_t* operator&() const { return &level; }
+};
+
+extern HostPIN PINA;
+extern volatile uint8_t PORTA, DDRA;
+#define PA0 0
+#define PINA0 0
+#define PORTA0 0
+#define DDA0 0
+#define PA1 1
+#define PINA1 1
+#define PORTA1 1
+#define DDA1 1
+#define PA2 2
+#define PINA2 2
+#define PORTA2 2
+#define DDA2 2
+#define PA3 3
+#define PINA3 3
+#define PORTA3 3
+#define DDA3 3
+#define PA4 4
+#define PINA4 4
+#define PORTA4 4
+#define DDA4 4
+#define PA5 5
+#define PINA5 5
+#define PORTA5 5
+#define DDA5 5
+#define PA6 6
+#define PINA6 6
+#define PORTA6 6
+#define DDA6 6
+#define PA7 7
+#define PINA7 7
+#define PORTA7 7
+#define DDA7 7
+extern HostPIN PINB;
+extern volatile uint8_t PORTB, DDRB;
+#define PB0 0
+#define PINB0 0
+#define PORTB0 0
+#define DDB0 0
+#define PB1 1
+#define PINB1 1
+#define PORTB1 1
+#define DDB1 1
+#define PB2 2
+#define PINB2 2
+#define PORTB2 2
+#define DDB2 2
+#define PB3 3
+#define PINB3 3
+#define PORTB3 3
+#define DDB3 3
+#define PB4 4
+#define PINB4 4
+#define PORTB4 4
+#define DDB4 4
+#define PB5 5
+#define PINB5 5
+#define PORTB5 5
+#define DDB5 5
+#define PB6 6
+#define PINB6 6
+#define PORTB6 6
+#define DDB6 6
+#define PB7 7
+#define PINB7 7
+#define PORTB7 7
+#define DDB7 7
+extern HostPIN PINC;
+extern volatile uint8_t PORTC, DDRC;
+#define PC0 0
+#define PINC0 0
+#define PORTC0 0
+#define DDC0 0
+#define PC1 1
+#define PINC1 1
+#define PORTC1 1
+#define DDC1 1
+#define PC2 2
+#define PINC2 2
+#define PORTC2 2
+#define DDC2 2
+#define PC3 3
+#define PINC3 3
+#define PORTC3 3
+#define DDC3 3
+#define PC4 4
+#define PINC4 4
+#define PORTC4 4
+#define DDC4 4
+#define PC5 5
+#define PINC5 5
+#define PORTC5 5
+#define DDC5 5
+#define PC6 6
+#define PINC6 6
+#define PORTC6 6
+#define DDC6 6
+#define PC7 7
+#define PINC7 7
+#define PORTC7 7
+#define DDC7 7
+extern HostPIN PIND;
+extern volatile uint8_t PORTD, DDRD;
+#define PD0 0
+#define PIND0 0
+#define PORTD0 0
+#define DDD0 0
+#define PD1 1
+#define PIND1 1
+#define PORTD1 1
+#define DDD1 1
+#define PD2 2
+#define PIND2 2
+#define PORTD2 2
+#define DDD2 2
+#define PD3 3
+#define PIND3 3
+#define PORTD3 3
+#define DDD3 3
+#define PD4 4
+#define PIND4 4
+#define PORTD4 4
+#define DDD4 4
+#define PD5 5
+#define PIND5 5
+#define PORTD5 5
+#define DDD5 5
+#define PD6 6
+#define PIND6 6
+#define PORTD6 6
+#define DDD6 6
+#define PD7 7
+#define PIND7 7
+#define PORTD7 7
+#define DDD7 7
+extern HostPIN PINE;
+extern volatile uint8_t PORTE, DDRE;
+#define PE0 0
+#define PINE0 0
+#define PORTE0 0
+#define DDE0 0
+#define PE1 1
+#define PINE1 1
+#define PORTE1 1
+#define DDE1 1
+#define PE2 2
+#define PINE2 2
+#define PORTE2 2
+#define DDE2 2
+#define PE3 3
+#define PINE3 3
+#define PORTE3 3
+#define DDE3 3
+#define PE4 4
+#define PINE4 4
+#define PORTE4 4
+#define DDE4 4
+#define PE5 5
+#define PINE5 5
+#define PORTE5 5
+#define DDE5 5
+#define PE6 6
+#define PINE6 6
+#define PORTE6 6
+#define DDE6 6
+#define PE7 7
+#define PINE7 7
+#define PORTE7 7
+#define DDE7 7
+extern HostPIN PINF;
+extern volatile uint8_t PORTF, DDRF;
+#define PF0 0
+#define PINF0 0
+#define PORTF0 0
+#define DDF0 0
+#define PF1 1
+#define PINF1 1
+#define PORTF1 1
+#define DDF1 1
+#define PF2 2
+#define PINF2 2
+#define PORTF2 2
+#define DDF2 2
+#define PF3 3
+#define PINF3 3
+#define PORTF3 3
+#define DDF3 3
+#define PF4 4
+#define PINF4 4
+#define PORTF4 4
+#define DDF4 4
+#define PF5 5
+#define PINF5 5
+#define PORTF5 5
+#define DDF5 5
+#define PF6 6
+#define PINF6 6
+#define PORTF6 6
+#define DDF6 6
+#define PF7 7
+#define PINF7 7
+#define PORTF7 7
+#define DDF7 7
+extern HostPIN PING;
+extern volatile uint8_t PORTG, DDRG;
+#define PG0 0
+#define PING0 0
+#define PORTG0 0
+#define DDG0 0
+#define PG1 1
+#define PING1 1
+#define PORTG1 1
+#define DDG1 1
+#define PG2 2
+#define PING2 2
+#define PORTG2 2
+#define DDG2 2
+#define PG3 3
+#define PING3 3
+#define PORTG3 3
+#define DDG3 3
+#define PG4 4
+#define PING4 4
+#define PORTG4 4
+#define DDG4 4
+#define PG5 5
+#define PING5 5
+#define PORTG5 5
+#define DDG5 5
+#define PG6 6
+#define PING6 6
+#define PORTG6 6
+#define DDG6 6
+#define PG7 7
+#define PING7 7
+#define PORTG7 7
+#define DDG7 7
+extern HostPIN PINH;
+extern volatile uint8_t PORTH, DDRH;
+#define PH0 0
+#define PINH0 0
+#define PORTH0 0
+#define DDH0 0
+#define PH1 1
+#define PINH1 1
+#define PORTH1 1
+#define DDH1 1
+#define PH2 2
+#define PINH2 2
+#define PORTH2 2
+#define DDH2 2
+#define PH3 3
+#define PINH3 3
+#define PORTH3 3
+#define DDH3 3
+#define PH4 4
+#define PINH4 4
+#define PORTH4 4
+#define DDH4 4
+#define PH5 5
+#define PINH5 5
+#define PORTH5 5
+#define DDH5 5
+#define PH6 6
+#define PINH6 6
+#define PORTH6 6
+#define DDH6 6
+#define PH7 7
+#define PINH7 7
+#define PORTH7 7
+#define DDH7 7
+extern HostPIN PINJ;
+extern volatile uint8_t PORTJ, DDRJ;
+#define PJ0 0
+#define PINJ0 0
+#define PORTJ0 0
+#define DDJ0 0
+#define PJ1 1
+#define PINJ1 1
+#define PORTJ1 1
+#define DDJ1 1
+#define PJ2 2
+#define PINJ2 2
+#define PORTJ2 2
+#define DDJ2 2
+#define PJ3 3
+#define PINJ3 3
+#define PORTJ3 3
+#define DDJ3 3
+#define PJ4 4
+#define PINJ4 4
+#define PORTJ4 4
+#define DDJ4 4
+#define PJ5 5
+#define PINJ5 5
+#define PORTJ5 5
+#define DDJ5 5
+#define PJ6 6
+#define PINJ6 6
+#define PORTJ6 6
+#define DDJ6 6
+#define PJ7 7
+#define PINJ7 7
+#define PORTJ7 7
+#define DDJ7 7
+extern HostPIN PINK;
+extern volatile uint8_t PORTK, DDRK;
+#define PK0 0
+#define PINK0 0
+#define PORTK0 0
+#define DDK0 0
+#define PK1 1
+#define PINK1 1
+#define PORTK1 1
+#define DDK1 1
+#define PK2 2
+#define PINK2 2
+#define PORTK2 2
+#define DDK2 2
+#define PK3 3
+#define PINK3 3
+#define PORTK3 3
+#define DDK3 3
+#define PK4 4
+#define PINK4 4
+#define PORTK4 4
+#define DDK4 4
+#define PK5 5
+#define PINK5 5
+#define PORTK5 5
+#define DDK5 5
+#define PK6 6
+#define PINK6 6
+#define PORTK6 6
+#define DDK6 6
+#define PK7 7
+#define PINK7 7
+#define PORTK7 7
+#define DDK7 7
+extern HostPIN PINL;
+extern volatile uint8_t PORTL, DDRL;
+#define PL0 0
+#define PINL0 0
+#define PORTL0 0
+#define DDL0 0
+#define PL1 1
+#define PINL1 1
+#define PORTL1 1
+#define DDL1 1
+#define PL2 2
+#define PINL2 2
+#define PORTL2 2
+#define DDL2 2
+#define PL3 3
+#define PINL3 3
+#define PORTL3 3
+#define DDL3 3
+#define PL4 4
+#define PINL4 4
+#define PORTL4 4
+#define DDL4 4
+#define PL5 5
+#define PINL5 5
+#define PORTL5 5
+#define DDL5 5
+#define PL6 6
+#define PINL6 6
+#define PORTL6 6
+#define DDL6 6
+#define PL7 7
+#define PINL7 7
+#define PORTL7 7
+#define DDL7 7
+
+extern volatile uint8_t TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCCR1C, TCCR2A, TCCR2B, TCCR3A;
+extern volatile uint8_t TCCR3B, TCCR3C, TCCR4A, TCCR4B, TCCR4C, TCCR5A, TCCR5B, TCCR5C;
+extern volatile uint8_t TIMSK0, TIMSK1, TIMSK2, TIMSK3, TIMSK4, TIMSK5, TIFR0, TIFR1;
+extern volatile uint8_t TIFR2, TIFR3, TIFR4, TIFR5, TCNT0, TCNT2, OCR0A, OCR0B;
+extern volatile uint8_t OCR2A, OCR2B, ADCSRA, ADCSRB, ADMUX, ADCL, ADCH, DIDR0;
+extern volatile uint8_t DIDR1, DIDR2, UCSR0B, UCSR0C, UBRR0H, UBRR0L, UCSR1A, UCSR1B;
+extern volatile uint8_t UCSR1C, UDR1, UBRR1H, UBRR1L, UCSR2A, UCSR2B, UCSR2C, UDR2;
+extern volatile uint8_t UBRR2H, UBRR2L, UCSR3A, UCSR3B, UCSR3C, UDR3, UBRR3H, UBRR3L;
+extern volatile uint8_t SPCR, SPSR, PCICR, PCMSK0, PCMSK1, PCMSK2, PCIFR;
+extern volatile uint8_t EICRA, EICRB, EIMSK, EIFR, MCUSR, MCUCR, WDTCSR, GPIOR0;
+extern volatile uint8_t GPIOR1, GPIOR2, TWCR, TWSR, TWBR, TWDR, TWAR, ASSR;
+extern volatile uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C, OCR4A, OCR4B, OCR4C, OCR5A;
+extern volatile uint16_t OCR5B, OCR5C, TCNT1, TCNT3, TCNT4, TCNT5, ICR1, ICR3, ICR4, ICR5;
+
+// UART0 talks to the host side of the serial port
+struct HostUDR {
+  operator uint8_t() const;             // The received byte
+  HostUDR& operator=(const uint8_t c);  // Sends a byte
+};
+struct HostUCSRA {
+  uint8_t bits;
+  operator uint8_t() const;             // Always ready to send, RXC0 while a byte waits
+  HostUCSRA& operator=(const uint8_t v) { bits = v; return *this; }
+  HostUCSRA& operator|=(const uint8_t v) { bits |= v; return *this; }
+  HostUCSRA& operator&=(const uint8_t v) { bits &= v; return *this; }
+};
+extern HostUDR UDR0;
+extern HostUCSRA UCSR0A;
+// MarlinSerial looks for the UART with #ifdef
+#define UBRR0H UBRR0H
+#define UDR0 UDR0
+
+// SPI data register, with the SD card of sdcard.cpp on the other end
+struct HostSPDR {
+  operator uint8_t() const;             // The byte clocked in by the last transfer
+  HostSPDR& operator=(const uint8_t b); // Clocks a byte out and one in, then sets SPIF
+};
+extern HostSPDR SPDR;
+
+// The result of the conversion started on the ADMUX / MUX5 channel
+struct HostADC { operator uint16_t() const; };
+extern HostADC ADC;
+
+
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOIE0 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCIE1C 3
+#define TOIE1 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOIE2 0
+#define OCIE3A 1
+#define OCIE3B 2
+#define OCIE3C 3
+#define OCIE4A 1
+#define OCIE4B 2
+#define OCIE4C 3
+#define OCIE5A 1
+#define OCIE5B 2
+#define OCIE5C 3
+#define OCF0A 1
+#define OCF0B 2
+#define OCF1A 1
+#define OCF1B 2
+#define WGM00 0
+#define WGM01 1
+#define WGM02 3
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define WGM30 0
+#define WGM31 1
+#define WGM32 3
+#define WGM33 4
+#define WGM40 0
+#define WGM41 1
+#define WGM42 3
+#define WGM43 4
+#define WGM50 0
+#define WGM51 1
+#define WGM52 3
+#define WGM53 4
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define COM0A0 6
+#define COM0A1 7
+#define COM0B0 4
+#define COM0B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define COM1B0 4
+#define COM1B1 5
+#define COM1C0 2
+#define COM1C1 3
+#define COM2A0 6
+#define COM2A1 7
+#define COM2B0 4
+#define COM2B1 5
+#define COM3A0 6
+#define COM3A1 7
+#define COM3B0 4
+#define COM3B1 5
+#define COM3C0 2
+#define COM3C1 3
+#define COM4A0 6
+#define COM4A1 7
+#define COM4B0 4
+#define COM4B1 5
+#define COM4C0 2
+#define COM4C1 3
+#define COM5A0 6
+#define COM5A1 7
+#define COM5B0 4
+#define COM5B1 5
+#define COM5C0 2
+#define COM5C1 3
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX5 3
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define MPCM0 0
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ02 2
+#define RXB80 1
+#define TXB80 0
+#define UCSZ01 2
+#define UCSZ00 1
+#define SPIF 7
+#define WCOL 6
+#define SPI2X 0
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define INT0 0
+#define INT1 1
+#define INT2 2
+#define INT3 3
+#define INT4 4
+#define INT5 5
+#define INT6 6
+#define INT7 7
+
+#endif // HOST_AVR_IO_H
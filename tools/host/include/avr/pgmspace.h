@@ -0,0 +1,50 @@
+/**
+ * Program memory is ordinary memory on the host
+ */
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+typedef char prog_char;
+
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+// A word, or a whole pointer from a table of pointers, which the firmware
+// reads as a word because they are one on the AVR
+template<class T> inline typename std::conditional<std::is_pointer<T>::value, T, uint16_t>::type host_pgm_read_word(const T *a) {
+  return *(const typename std::conditional<std::is_pointer<T>::value, T, uint16_t>::type*)a;
+}
+inline uint16_t host_pgm_read_word(const uintptr_t a) { return *(const uint16_t*)a; }
+#define pgm_read_word(a) host_pgm_read_word(a)
+#define pgm_read_dword(a) (*(const uint32_t*)(a))
+#define pgm_read_float(a) (*(const float*)(a))
+#define pgm_read_ptr(a) (*(void* const*)(a))
+#define pgm_read_byte_near(a) pgm_read_byte(a)
+#define pgm_read_word_near(a) pgm_read_word(a)
+#define pgm_read_dword_near(a) pgm_read_dword(a)
+#define pgm_read_float_near(a) pgm_read_float(a)
+#define pgm_read_ptr_near(a) pgm_read_ptr(a)
+
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strcat_P strcat
+#define strchr_P strchr
+#define strrchr_P strrchr
+#define strstr_P strstr
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+#endif // HOST_AVR_PGMSPACE_H
@@ -0,0 +1,10 @@
+/**
+ * Busy waits of the host build, on the simulated clock
+ */
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+void _delay_ms(double ms);
+void _delay_us(double us);
+
+#endif // HOST_UTIL_DELAY_H
@@ -0,0 +1,158 @@
+/**
+ * Host build of the firmware: many replays at once
+ *
+ * The firmware keeps its state in statics (the planner's block buffer and
+ * the stepper's position among them) and the simulated MCU of host.cpp is
+ * made of globals, so one build is one machine. libmarlin.so is that build
+ * with HOST_LIBRARY (make pool). marlin_pool loads a fresh copy of it for
+ * each G-code file, every copy with statics of its own, and replays the
+ * files on a pool of threads as marlin_host -s 0 -g would one by one:
+ *
+ *   marlin_pool -j 8 -m plan=1100 a.gcode b.gcode ...
+ *
+ * For each file, in the order given, stdout gets a line with its name and
+ * then its summary, or what ended it. -o DIR keeps the serial output of
+ * each file in DIR/<name>.out. The exit status is that of the worst replay.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef int (*replay_t)(const char *gcode, const char *machine, int out, FILE *report);
+typedef void (*signal_t)();
+
+static std::string library;             // libmarlin.so, read once
+static const char *machine = "", *out_dir;
+static char **files;
+static int file_count;
+
+struct Result { std::string report; int code; };
+static std::vector<Result> results;
+static std::atomic<int> next_file;
+
+// The timer signal of each replay goes to its own thread
+static thread_local signal_t replay_signal;
+static void on_timer_signal(int) { if (replay_signal) replay_signal(); }
+
+static std::string read_file(const char *path) {
+  std::string data;
+  FILE *f = fopen(path, "rb");
+  if (!f) return data;
+  char buf[65536];
+  for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) data.append(buf, n);
+  fclose(f);
+  return data;
+}
+
+// A copy of the library in a file of its own, so dlopen() doesn't hand back one it has
+static void* load_copy(std::string &error) {
+  const int fd = memfd_create("libmarlin", MFD_CLOEXEC);
+  if (fd < 0 || write(fd, library.data(), library.size()) != (ssize_t)library.size()) {
+    error = strerror(errno);
+    if (fd >= 0) close(fd);
+    return NULL;
+  }
+  char path[32];
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+  void *copy = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!copy) error = dlerror();
+  close(fd);
+  return copy;
+}
+
+static Result replay(const char *gcode) {
+  Result r = { "", 2 };
+  void *copy = load_copy(r.report);
+  if (!copy) { r.report = "marlin_pool: can't load libmarlin.so: " + r.report + "\n"; return r; }
+  const replay_t host_replay = (replay_t)dlsym(copy, "host_replay");
+  replay_signal = (signal_t)dlsym(copy, "host_signal");
+  if (!host_replay || !replay_signal) { r.report = "marlin_pool: not a HOST_LIBRARY build\n"; return r; }
+
+  std::string out_path = "/dev/null";
+  if (out_dir) {
+    std::string name = gcode;
+    out_path = std::string(out_dir) + "/" + basename(&name[0]) + ".out";
+  }
+  const int out = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  char *text = NULL;
+  size_t size = 0;
+  FILE *report = open_memstream(&text, &size);
+  if (out < 0) fprintf(report, "marlin_pool: can't write %s\n", out_path.c_str());
+  else r.code = host_replay(gcode, machine, out, report);
+  replay_signal = NULL;
+  fclose(report);
+  r.report.assign(text, size);
+  free(text);
+  if (out >= 0) close(out);
+  // The copy stays: the firmware never expects its destructors to run
+  return r;
+}
+
+static void worker() {
+  for (int i; (i = next_file++) < file_count;) results[i] = replay(files[i]);
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s [-j threads] [-m machine options] [-o dir] file.gcode...\n"
+    "  -j  replays at once (default: one per CPU)\n"
+    "  -m  key=value,... for the machine, see tools/host/printer.cpp\n"
+    "  -o  keep the serial output of each file in dir/<file>.out\n", name);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  int threads = sysconf(_SC_NPROCESSORS_ONLN);
+  for (int opt; (opt = getopt(argc, argv, "j:m:o:h")) != -1;) {
+    switch (opt) {
+      case 'j': threads = atoi(optarg); if (threads < 1) usage(argv[0]); break;
+      case 'm': machine = optarg; break;
+      case 'o': out_dir = optarg; break;
+      default: usage(argv[0]);
+    }
+  }
+  files = argv + optind;
+  file_count = argc - optind;
+  if (!file_count) usage(argv[0]);
+
+  // libmarlin.so of the same build, next to this program
+  char self[PATH_MAX];
+  const ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+  if (n <= 0) { fprintf(stderr, "marlin_pool: where am I?\n"); return 2; }
+  self[n] = '\0';
+  library = read_file((std::string(dirname(self)) + "/libmarlin.so").c_str());
+  if (library.empty()) { fprintf(stderr, "marlin_pool: no libmarlin.so, see make pool\n"); return 2; }
+
+  signal(SIGPIPE, SIG_IGN);
+  struct sigaction sa = {};
+  sa.sa_handler = on_timer_signal;
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &sa, NULL);
+
+  results.resize(file_count);
+  std::vector<std::thread> pool;
+  for (int i = 0; i < threads && i < file_count; i++) pool.push_back(std::thread(worker));
+  for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+
+  int worst = 0;
+  for (int i = 0; i < file_count; i++) {
+    printf("%s\n%s", files[i], results[i].report.c_str());
+    if (results[i].code > worst) worst = results[i].code;
+  }
+  fflush(stdout);
+  _exit(worst);                         // Not through the destructors of the copies
+}
@@ -0,0 +1,96 @@
+/**
+ * Host build of the firmware: the character LCD and its rotary encoder
+ *
+ * LiquidCrystal of include/ draws into the screen here. With -m panel=path
+ * a test turns the knob and clicks through a named pipe, one key a byte,
+ * each handled after the one before it is done:
+ *
+ *   +  one detent clockwise, down the menu     -  one detent back up
+ *   c  click                                   s  show the screen on stderr
+ *
+ * 's' waits for the menus to redraw and prints "lcd: |row|row|row|row|".
+ * Custom characters (folder, up level, degree...) print as '@'.
+ */
+
+#include "host.h"
+
+#include "Marlin.h"
+#include "ultralcd.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static char screen[4][21];
+static uint8_t cursor_col, cursor_row;
+
+void host_lcd_clear() {
+  memset(screen, ' ', sizeof(screen));
+  for (uint8_t r = 0; r < 4; r++) screen[r][20] = '\0';
+  cursor_col = cursor_row = 0;
+}
+
+void host_lcd_set_cursor(const uint8_t col, const uint8_t row) {
+  cursor_col = col;
+  cursor_row = row;
+}
+
+void host_lcd_write(const uint8_t c) {
+  if (cursor_row < 4 && cursor_col < 20) screen[cursor_row][cursor_col] = c < 8 ? '@' : c;
+  cursor_col++;
+}
+
+#if ENABLED(ULTIPANEL) && BUTTON_EXISTS(EN1) && BUTTON_EXISTS(EN2) && BUTTON_EXISTS(ENC)
+
+  static int keys = -1;
+  static char key;                      // Being handled, 0 for none
+  static uint16_t key_ticks;            // Temperature interrupts into it
+
+  // Gray code of the two encoder switches, bit 0 EN1 and bit 1 EN2 closed.
+  // The firmware counts 0 2 3 1 as clockwise.
+  static const uint8_t detent[] = { 0, 2, 3, 1, 0 };
+
+  static void encoder(const uint8_t phase) {
+    host_set_input(BTN_EN1, !TEST(phase, 0));
+    host_set_input(BTN_EN2, !TEST(phase, 1));
+  }
+
+  bool panel_open(const char *path) {
+    keys = open(path, O_RDWR | O_NONBLOCK);
+    return keys >= 0;
+  }
+
+  // Each phase of a detent lasts 5 interrupts, two button scans of the LCD.
+  // A click holds the button through at least one 100ms LCD update, then
+  // waits out the 500ms the feedback of the click ignores the buttons.
+  void panel_tick() {
+    if (keys < 0) return;
+    if (!key && read(keys, &key, 1) != 1) { key = 0; return; }
+    key_ticks++;
+    bool done = false;
+    switch (key) {
+      case '+': case '-': {
+        const uint8_t step = key_ticks / 5;
+        if (step < COUNT(detent)) encoder(detent[key == '+' ? step : COUNT(detent) - 1 - step]);
+        done = step == COUNT(detent) + 4;
+      } break;
+      case 'c':
+        host_set_input(BTN_ENC, key_ticks > 150);
+        done = key_ticks == 750;
+        break;
+      case 's':
+        if ((done = key_ticks == 300)) {
+          fprintf(stderr, "lcd: |%s|%s|%s|%s|\n", screen[0], screen[1], screen[2], screen[3]);
+          fflush(stderr);
+        }
+        break;
+      default: done = true;
+    }
+    if (done) key = key_ticks = 0;
+  }
+
+#else
+
+  bool panel_open(const char*) { return false; }
+  void panel_tick() {}
+
+#endif
@@ -0,0 +1,268 @@
+/**
+ * Host build of the firmware: the machine around the board
+ *
+ * Heaters warm a lumped thermal mass that loses heat to the air, the fan
+ * adds to the loss, and a beta thermistor behind a pull-up reads the block
+ * with a first order lag. The steppers move carriages that trip the
+ * endstops, and a delta's effector carries the probe down to a flat bed at
+ * Z=0, all on the machine's true geometry, which may differ from the
+ * firmware's configuration by the errors given with -m. So G28, G30 and G33
+ * see the machine they would see on the bench.
+ *
+ * -m takes key=value pairs, separated by commas:
+ *
+ *   power=40 loss=0.12 mass=12    Hotend: heater W, W/K to the air, J/K
+ *   fan=0.1                       Extra W/K with the part fan at full speed
+ *   lag=1.5                       Seconds the thermistor trails the block
+ *   bed_power=200 bed_loss=1.2 bed_mass=600
+ *   ambient=25 noise=0            Room °C, ADC noise in +/- counts
+ *   r25=100000 beta=4092 pullup=4700
+ *   log=path                      Block temperature and heater duty every 100ms
+ *   panel=path                    Named pipe of LCD encoder keys, see panel.cpp
+ *   busy=0                        ms the main loop is kept busy after each run,
+ *                                 as by slow LCD draws or blocking commands
+ *
+ *   plan=0                        Replay with -s 0: us the MCU takes per block
+ *   baud=0                        Replay: the lines come at this rate, each with
+ *                                 an "ok" back, as streamed (0: from the card)
+ *   turnaround=0                  Replay: ms the host takes to send the next line
+ *
+ *   e1= e2= e3=                   Delta: true endstop position errors, mm
+ *   r=                            Error of the diagonal rod to tower radius, mm
+ *   rod=                          Error of the diagonal rod length, mm
+ *   a1= a2= a3=                   Tower angle errors, degrees
+ */
+
+#include "host.h"
+
+#include "Marlin.h"
+#include "planner.h"
+#include "stepper.h"
+
+#include <math.h>
+
+//
+// Options
+//
+struct Option { const char *name; double value; };
+static Option options[] = {
+  { "power", 40 }, { "loss", 0.12 }, { "mass", 12 }, { "fan", 0.1 }, { "lag", 1.5 },
+  { "bed_power", 200 }, { "bed_loss", 1.2 }, { "bed_mass", 600 },
+  { "ambient", 25 }, { "noise", 0 }, { "r25", 100000 }, { "beta", 4092 }, { "pullup", 4700 }, { "busy", 0 },
+  { "plan", 0 }, { "baud", 0 }, { "turnaround", 0 },
+  { "e1", 0 }, { "e2", 0 }, { "e3", 0 }, { "r", 0 }, { "rod", 0 }, { "a1", 0 }, { "a2", 0 }, { "a3", 0 }
+};
+
+double printer_option(const char *name) {
+  for (uint8_t i = 0; i < COUNT(options); i++) if (!strcmp(options[i].name, name)) return options[i].value;
+  return 0;
+}
+
+static FILE *log_file;
+
+static void parse_options(const char *s) {
+  char key[32];
+  while (*s) {
+    const char *eq = strchr(s, '='), *end = strchr(s, ',');
+    if (!end) end = s + strlen(s);
+    if (!eq || eq > end || eq - s >= (int)sizeof(key)) host_fatal("bad -m option, expected key=value");
+    memcpy(key, s, eq - s);
+    key[eq - s] = '\0';
+    if (!strcmp(key, "log")) {
+      char name[256];
+      snprintf(name, sizeof(name), "%.*s", (int)(end - eq - 1), eq + 1);
+      log_file = fopen(name, "w");
+      if (!log_file) host_fatal("can't open the log file");
+    }
+    else if (!strcmp(key, "panel")) {
+      char name[256];
+      snprintf(name, sizeof(name), "%.*s", (int)(end - eq - 1), eq + 1);
+      if (!panel_open(name)) host_fatal("can't open the panel pipe, or no encoder");
+    }
+    else {
+      uint8_t i = 0;
+      while (i < COUNT(options) && strcmp(options[i].name, key)) i++;
+      if (i == COUNT(options)) host_fatal("unknown -m option");
+      options[i].value = atof(eq + 1);
+    }
+    s = *end ? end + 1 : end;
+  }
+}
+
+//
+// Heaters and thermistors
+//
+struct Heater {
+  double temp, sensed;                  // °C of the block and at the thermistor
+  uint32_t on_ticks;                    // For the log
+};
+static Heater hotend, bed;
+static uint32_t temp_ticks;
+
+// ADC counts of the thermistor behind the pull-up
+static uint16_t thermistor_adc(const double celsius) {
+  const double t = celsius + 273.15,
+               r = printer_option("r25") * exp(printer_option("beta") * (1.0 / t - 1.0 / 298.15)),
+               noise = printer_option("noise") ? (random(2001) - 1000) / 1000.0 * printer_option("noise") : 0;
+  const double adc = 1024.0 * r / (r + printer_option("pullup")) + noise;
+  return adc < 0 ? 0 : adc > 1023 ? 1023 : (uint16_t)adc;
+}
+
+static void heat(Heater &h, const bool on, const double power, const double loss, const double mass, const double dt) {
+  h.temp += (on ? power : 0) * dt / mass - loss * (h.temp - printer_option("ambient")) * dt / mass;
+  h.sensed += (h.temp - h.sensed) * dt / printer_option("lag");
+  if (on) h.on_ticks++;
+}
+
+void printer_temp_isr() {
+  const double dt = 1.024e-3;
+
+  double fan = 0;
+  #if HAS_FAN0
+    fan = host_pwm(FAN_PIN) ? host_pwm(FAN_PIN) / 255.0 : host_output(FAN_PIN);
+  #endif
+  heat(hotend, host_output(HEATER_0_PIN), printer_option("power"), printer_option("loss") + printer_option("fan") * fan, printer_option("mass"), dt);
+  host_adc[TEMP_0_PIN] = thermistor_adc(hotend.sensed);
+
+  #if HAS_TEMP_BED && HAS_HEATER_BED
+    heat(bed, host_output(HEATER_BED_PIN), printer_option("bed_power"), printer_option("bed_loss"), printer_option("bed_mass"), dt);
+    host_adc[TEMP_BED_PIN] = thermistor_adc(bed.sensed);
+  #endif
+
+  if (log_file && ++temp_ticks == 100) {
+    fprintf(log_file, "%.3f %.3f %.3f %.2f\n", host_micros() / 1e6, hotend.temp, hotend.sensed, hotend.on_ticks / 100.0);
+    fflush(log_file);                   // A test reads along
+    hotend.on_ticks = temp_ticks = 0;
+  }
+
+  panel_tick();
+}
+
+//
+// The main loop
+//
+void printer_loop() {
+  const uint64_t until = host_micros() + printer_option("busy") * 1000;
+  while (host_micros() < until) host_tick();
+}
+
+//
+// Motion
+//
+static double carriage[XYZ];            // mm, where the steppers have really taken the axes
+static long last_count[XYZ];
+
+#define SET_ENDSTOP(PIN, INVERTING, HIT) host_set_input(PIN, (HIT) != (INVERTING))
+
+#if ENABLED(DELTA)
+
+  static double tower_x[ABC], tower_y[ABC], trigger[ABC], rod;
+
+  // The effector sits rod away from each carriage. Returns false out of reach.
+  static bool effector(double &x, double &y, double &z) {
+    // Carriage 1 at the origin of a frame with carriage 2 on its x axis
+    const double p1[3] = { tower_x[A_AXIS], tower_y[A_AXIS], carriage[A_AXIS] },
+                 p2[3] = { tower_x[B_AXIS], tower_y[B_AXIS], carriage[B_AXIS] },
+                 p3[3] = { tower_x[C_AXIS], tower_y[C_AXIS], carriage[C_AXIS] };
+    double ex[3], ey[3], ez[3], p31[3];
+    const double d = sqrt(sq(p2[0] - p1[0]) + sq(p2[1] - p1[1]) + sq(p2[2] - p1[2]));
+    for (uint8_t i = 0; i < 3; i++) { ex[i] = (p2[i] - p1[i]) / d; p31[i] = p3[i] - p1[i]; }
+    const double i_ = ex[0] * p31[0] + ex[1] * p31[1] + ex[2] * p31[2];
+    for (uint8_t k = 0; k < 3; k++) ey[k] = p31[k] - i_ * ex[k];
+    const double ny = sqrt(sq(ey[0]) + sq(ey[1]) + sq(ey[2]));
+    for (uint8_t k = 0; k < 3; k++) ey[k] /= ny;
+    const double j = ey[0] * p31[0] + ey[1] * p31[1] + ey[2] * p31[2];
+    ez[0] = ex[1] * ey[2] - ex[2] * ey[1];
+    ez[1] = ex[2] * ey[0] - ex[0] * ey[2];
+    ez[2] = ex[0] * ey[1] - ex[1] * ey[0];
+    // All rods the same length, so the spheres' differences are planes
+    const double px = d / 2, py = (sq(i_) + sq(j)) / (2 * j) - i_ / j * px, pz2 = sq(rod) - sq(px) - sq(py);
+    if (pz2 < 0) return false;
+    const double pz = -sqrt(pz2);       // The effector hangs below the carriages
+    x = p1[0] + px * ex[0] + py * ey[0] + pz * ez[0];
+    y = p1[1] + px * ex[1] + py * ey[1] + pz * ez[1];
+    z = p1[2] + px * ex[2] + py * ey[2] + pz * ez[2];
+    return true;
+  }
+
+  static void motion_init() {
+    const double radius = DELTA_RADIUS + printer_option("r"), angle[ABC] = { 210 + printer_option("a1"), 330 + printer_option("a2"), 90 + printer_option("a3") };
+    rod = DELTA_DIAGONAL_ROD + printer_option("rod");
+    const double top = Z_MAX_POS + sqrt(sq(rod) - sq(radius));
+    for (uint8_t i = 0; i < ABC; i++) {
+      tower_x[i] = cos(RADIANS(angle[i])) * radius;
+      tower_y[i] = sin(RADIANS(angle[i])) * radius;
+      trigger[i] = top + printer_option(i == 0 ? "e1" : i == 1 ? "e2" : "e3");
+      carriage[i] = trigger[i] - 20;    // Switched on somewhere below the endstops
+    }
+  }
+
+  static void update_switches() {
+    SET_ENDSTOP(X_MAX_PIN, X_MAX_ENDSTOP_INVERTING, carriage[A_AXIS] >= trigger[A_AXIS]);
+    SET_ENDSTOP(Y_MAX_PIN, Y_MAX_ENDSTOP_INVERTING, carriage[B_AXIS] >= trigger[B_AXIS]);
+    SET_ENDSTOP(Z_MAX_PIN, Z_MAX_ENDSTOP_INVERTING, carriage[C_AXIS] >= trigger[C_AXIS]);
+    double x, y, z;
+    const bool probe_hit = effector(x, y, z) && z + (Z_PROBE_OFFSET_FROM_EXTRUDER) <= 0;
+    #if ENABLED(Z_MIN_PROBE_USES_Z_MIN_ENDSTOP_PIN)
+      SET_ENDSTOP(Z_MIN_PIN, Z_MIN_ENDSTOP_INVERTING, probe_hit);
+    #elif HAS_Z_MIN_PROBE_PIN
+      SET_ENDSTOP(Z_MIN_PROBE_PIN, Z_MIN_PROBE_ENDSTOP_INVERTING, probe_hit);
+    #endif
+  }
+
+#else
+
+  // Cartesian axes on a bed at 0, each stopping at the end it homes to.
+  // They start where the firmware takes them to be before G28, so a job
+  // that doesn't home stays inside the endstops.
+  static void motion_init() {
+    carriage[X_AXIS] = carriage[Y_AXIS] = carriage[Z_AXIS] = 0;
+  }
+
+  static void update_switches() {
+    #if HAS_X_MIN
+      SET_ENDSTOP(X_MIN_PIN, X_MIN_ENDSTOP_INVERTING, carriage[X_AXIS] <= X_MIN_POS);
+    #endif
+    #if HAS_X_MAX
+      SET_ENDSTOP(X_MAX_PIN, X_MAX_ENDSTOP_INVERTING, carriage[X_AXIS] >= X_MAX_POS);
+    #endif
+    #if HAS_Y_MIN
+      SET_ENDSTOP(Y_MIN_PIN, Y_MIN_ENDSTOP_INVERTING, carriage[Y_AXIS] <= Y_MIN_POS);
+    #endif
+    #if HAS_Y_MAX
+      SET_ENDSTOP(Y_MAX_PIN, Y_MAX_ENDSTOP_INVERTING, carriage[Y_AXIS] >= Y_MAX_POS);
+    #endif
+    #if HAS_Z_MIN
+      SET_ENDSTOP(Z_MIN_PIN, Z_MIN_ENDSTOP_INVERTING, carriage[Z_AXIS] <= 0);
+    #endif
+    #if HAS_Z_MAX
+      SET_ENDSTOP(Z_MAX_PIN, Z_MAX_ENDSTOP_INVERTING, carriage[Z_AXIS] >= Z_MAX_POS);
+    #endif
+  }
+
+#endif
+
+// The steps taken inside the interrupt moved the axes, a set_position() in between did not
+void printer_step_isr(const bool done) {
+  for (uint8_t i = 0; i < XYZ; i++) {
+    const long count = stepper.position((AxisEnum)i);
+    if (done) carriage[i] += (count - last_count[i]) / planner.axis_steps_per_mm[i];
+    last_count[i] = count;
+  }
+  if (done) update_switches();
+}
+
+void printer_init(const char *opts) {
+  parse_options(opts);
+  if (printer_option("lag") <= 0) host_fatal("lag must be above 0");
+  hotend.temp = hotend.sensed = bed.temp = bed.sensed = printer_option("ambient");
+  host_adc[TEMP_0_PIN] = thermistor_adc(hotend.sensed);
+  #if HAS_TEMP_BED
+    host_adc[TEMP_BED_PIN] = thermistor_adc(bed.sensed);
+  #endif
+  motion_init();
+  update_switches();
+  #if ENABLED(SDSUPPORT) && PIN_EXISTS(SD_DETECT)
+    host_set_input(SD_DETECT_PIN, !sdcard_present());
+  #endif
+}
@@ -0,0 +1,155 @@
+/**
+ * Host build of the firmware: replay of a G-code file
+ *
+ * -g maps the file and hands each line to process_command() where it lies,
+ * without a copy into the command queue and without the serial or SD card
+ * byte path. With the free running clock of -s 0 a file of hundreds of MB
+ * goes through the parser and the planner as fast as the host computes,
+ * for regression and timing runs:
+ *
+ *   marlin_host -s 0 -g part.gcode
+ *
+ * Lines are taken like the SD card's: comments after ';' and blank lines
+ * are dropped. The mapping is private and writable, as process_command()
+ * wants the character past each line: only commands that take text
+ * (M23, M117, ...) write a nul there, and only their pages get copied.
+ *
+ * The host plans for free. To see whether the AVR would keep up, -m can give
+ * it the time to plan a block (plan=) and stream each line to it (baud=,
+ * turnaround=, see printer.cpp). The block buffer starves when it runs dry
+ * while the replay feeds moves, not while a command waits for them.
+ *
+ * Once the moves have run, a summary goes to stderr (host_report):
+ *
+ *   replay: <commands> lines, <blocks> blocks, <s> s simulated, <s> s on the host, <MB/s>
+ *   replay: <n> blocks/s peak, <n> starved, <n> steps/s peak, <n> capped
+ *
+ * The peak block rate is over any second of the run. Capped blocks were
+ * slowed to MAX_STEP_FREQUENCY by the planner.
+ */
+
+#include "host.h"
+
+#include "Marlin.h"
+#include "endstops.h"
+#include "planner.h"
+#include "stepper.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static bool replaying, feeding;
+static uint8_t last_head, last_tail;
+static double plan_us;
+static uint32_t blocks, starved, capped, peak_blocks, first_in_second;
+static uint16_t peak_rate;
+static uint64_t done_us[1 << 16];       // When each of the last blocks was done
+
+// Planning the blocks queued since the last tick takes time
+void replay_tick() {
+  if (!replaying || planner.block_buffer_head == last_head) return;
+  host_work_us(BLOCK_MOD(planner.block_buffer_head - last_head + BLOCK_BUFFER_SIZE) * plan_us);
+  last_head = planner.block_buffer_head;
+}
+
+void replay_step_isr() {
+  if (!replaying || planner.block_buffer_tail == last_tail) return;
+  const uint64_t now = host_micros();
+  for (; last_tail != planner.block_buffer_tail; last_tail = BLOCK_MOD(last_tail + 1)) {
+    const uint16_t rate = planner.block_buffer[last_tail].nominal_rate;
+    NOLESS(peak_rate, rate);
+    if (rate >= (MAX_STEP_FREQUENCY) - 1) capped++;
+    done_us[blocks++ % COUNT(done_us)] = now;
+  }
+  NOLESS(first_in_second, blocks > COUNT(done_us) ? blocks - COUNT(done_us) : 0);
+  while (done_us[first_in_second % COUNT(done_us)] + 1000000UL <= now) first_in_second++;
+  NOLESS(peak_blocks, blocks - first_in_second);
+  if (feeding && !planner.blocks_queued()) starved++;
+}
+
+static double cpu_seconds() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// G0 to G3, which never wait for the moves before them
+static bool is_move(const char *p, const char *end) {
+  if (p < end && (*p == 'N' || *p == 'n')) {
+    while (p < end && *p != ' ') p++;
+    while (p < end && *p == ' ') p++;
+  }
+  return end - p >= 2 && (*p == 'G' || *p == 'g') && p[1] >= '0' && p[1] <= '3' && (end - p == 2 || !NUMERIC(p[2]));
+}
+
+// One line, as the main loop runs a command from the queue. False if blank.
+static bool run(char *start, char *end) {
+  while (start < end && (*start == ' ' || *start == '\t')) start++;
+  while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+  if (start == end) return false;
+
+  // The line, the "ok" for it and the host's turnaround, when streamed
+  feeding = true;
+  const double baud = printer_option("baud");
+  if (baud) host_work_us((end - start + 4) * 10e6 / baud + printer_option("turnaround") * 1000);
+  host_work_done();
+
+  host_command_start();
+  feeding = is_move(start, end);
+  process_command(start, end);
+  refresh_cmd_timeout();
+  endstops.report_state();
+  idle();
+  printer_loop();
+  feeding = true;
+  host_work_done();
+  feeding = false;
+  return true;
+}
+
+void replay_file(const char *path) {
+  const int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st)) host_fatal("can't open the G-code file");
+  const size_t size = st.st_size;
+  char * const text = size ? (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : NULL;
+  if (text == MAP_FAILED) host_fatal("can't map the G-code file");
+  close(fd);
+  if (size) madvise(text, size, MADV_SEQUENTIAL);
+
+  const double started = cpu_seconds();
+  const uint64_t started_us = host_micros();
+  plan_us = printer_option("plan");
+  last_head = planner.block_buffer_head;
+  last_tail = planner.block_buffer_tail;
+  replaying = true;
+
+  uint32_t lines = 0;
+  for (char *line = text, * const text_end = text + size; line < text_end;) {
+    char *eol = (char*)memchr(line, '\n', text_end - line), *next = eol + 1;
+    char last[MAX_CMD_SIZE];            // The last line has no '\n' to end it at
+    if (!eol) {
+      const size_t n = min((size_t)(text_end - line), sizeof(last) - 1);
+      memcpy(last, line, n);
+      last[n] = '\0';
+      line = last;
+      eol = last + n;
+      next = text_end;
+    }
+    char *end = (char*)memchr(line, ';', eol - line);
+    if (run(line, end ? end : eol)) lines++;
+    line = next;
+  }
+  stepper.synchronize();
+  replaying = false;
+
+  const double seconds = cpu_seconds() - started;
+  fprintf(host_report, "replay: %u lines, %u blocks, %.3f s simulated, %.3f s on the host, %.1f MB/s\n",
+          lines, blocks, (host_micros() - started_us) / 1e6, seconds, seconds ? size / seconds / 1e6 : 0.0);
+  fprintf(host_report, "replay: %u blocks/s peak, %u starved, %u steps/s peak, %u capped\n", peak_blocks, starved, peak_rate, capped);
+  if (size) munmap(text, size);
+  host_exit();
+}
@@ -0,0 +1,229 @@
+/**
+ * Host build of the firmware: an SDHC card on the SPI bus
+ *
+ * The card answers the bytes Sd2Card.cpp clocks through SPDR the way a
+ * card in SPI mode does, with its blocks kept in an image file. So the
+ * firmware's own driver runs, multiple block writes and all, and a command
+ * sent where a card expects data goes as unanswered as it would on the
+ * real bus.
+ *
+ * Implemented: CMD0 CMD8 CMD9 CMD10 CMD12 CMD13 CMD16 CMD17 CMD18 CMD24
+ * CMD25 CMD32 CMD33 CMD38 CMD55 CMD58 CMD59, ACMD23 ACMD41.
+ */
+
+#include "host.h"
+
+#include "MarlinConfig.h"
+#include "SdInfo.h"
+
+#include <deque>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int image = -1;
+static uint32_t blocks;
+
+static std::deque<uint8_t> reply;       // Bytes the card clocks out next
+static uint8_t received;                // For the firmware to read from SPDR
+
+static uint8_t command[6], command_len;
+static bool app_command, ready;
+static uint32_t erase_first, erase_last;
+
+// A read of CMD18 runs until CMD12, a write of CMD25 until the stop token
+enum DataState { NO_DATA, READ_MULTIPLE, WRITE_SINGLE, WRITE_MULTIPLE };
+static DataState data_state;
+static uint32_t data_block;
+static uint8_t block[512 + 2];
+static uint16_t block_len;              // Bytes of a written block received, 0 while waiting for its token
+
+bool sdcard_open(const char *path) {
+  image = open(path, O_RDWR);
+  struct stat st;
+  if (image < 0 || fstat(image, &st)) return false;
+  blocks = st.st_size / 512;
+  return blocks > 0;
+}
+
+bool sdcard_present() { return image >= 0; }
+
+static uint16_t crc16(const uint8_t *data, const uint16_t n) {
+  uint16_t crc = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    crc ^= data[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// A data block: a little access time, the start token, the data and its CRC
+static void send_data(const uint8_t *data, const uint16_t n) {
+  reply.push_back(0xFF);
+  reply.push_back(0xFF);
+  reply.push_back(DATA_START_BLOCK);
+  reply.insert(reply.end(), data, data + n);
+  const uint16_t crc = crc16(data, n);
+  reply.push_back(crc >> 8);
+  reply.push_back(crc & 0xFF);
+}
+
+static bool read_block(const uint32_t b) {
+  uint8_t data[512];
+  if (b >= blocks || pread(image, data, 512, (off_t)b * 512) != 512) return false;
+  send_data(data, 512);
+  return true;
+}
+
+// Accepted, then busy programming for a moment
+static void send_data_response(const bool ok) {
+  reply.push_back(ok ? DATA_RES_ACCEPTED : 0x0D);
+  reply.push_back(0x00);
+  reply.push_back(0x00);
+}
+
+static void send_r1(const uint8_t r1) {
+  reply.push_back(0xFF);                // N_CR, one byte before the response
+  reply.push_back(r1);
+}
+
+static void run_command() {
+  const uint8_t cmd = command[0] & 0x3F;
+  const uint32_t arg = (uint32_t)command[1] << 24 | (uint32_t)command[2] << 16 | command[3] << 8 | command[4];
+  const bool acmd = app_command;
+  app_command = false;
+
+  if (cmd == CMD12) {                   // Ends a multiple block read, after a stuff byte
+    reply.clear();
+    data_state = NO_DATA;
+    reply.push_back(0xFF);
+    send_r1(R1_READY_STATE);
+    return;
+  }
+  reply.clear();
+
+  if (cmd == CMD0) {
+    ready = false;
+    data_state = NO_DATA;
+    send_r1(R1_IDLE_STATE);
+    return;
+  }
+  const uint8_t r1 = ready ? R1_READY_STATE : R1_IDLE_STATE;
+
+  if (acmd) switch (cmd) {
+    case ACMD41: ready = true; send_r1(R1_READY_STATE); return;
+    case ACMD23: send_r1(r1); return;
+  }
+
+  switch (cmd) {
+    case CMD8:                          // Voltage accepted, check pattern echoed
+      send_r1(r1);
+      reply.push_back(0x00); reply.push_back(0x00); reply.push_back(0x01); reply.push_back(arg & 0xFF);
+      break;
+    case CMD55: app_command = true; send_r1(r1); break;
+    case CMD58:                         // OCR: powered up, high capacity
+      send_r1(r1);
+      reply.push_back(0xC0); reply.push_back(0xFF); reply.push_back(0x80); reply.push_back(0x00);
+      break;
+    case CMD9: {                        // CSD version 2.0 with the size of the image
+      uint8_t csd[16] = { 0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, 0, 0, 0, 0x7F, 0x80, 0x0A, 0x40, 0x00, 0x01 };
+      const uint32_t c_size = blocks / 1024 ? blocks / 1024 - 1 : 0;
+      csd[7] = (c_size >> 16) & 0x3F;
+      csd[8] = (c_size >> 8) & 0xFF;
+      csd[9] = c_size & 0xFF;
+      send_r1(r1);
+      send_data(csd, 16);
+    } break;
+    case CMD10: {
+      const uint8_t cid[16] = { 0x00, 'M', 'H', 'H', 'O', 'S', 'T', ' ', 0x10, 0, 0, 0, 1, 0x01, 0x0A, 0x01 };
+      send_r1(r1);
+      send_data(cid, 16);
+    } break;
+    case CMD13: send_r1(r1); reply.push_back(0x00); break;
+    case 16: case 59: send_r1(r1); break; // SET_BLOCKLEN, CRC_ON_OFF
+    case CMD17:
+      if (arg >= blocks) { send_r1(0x40); break; }
+      send_r1(r1);
+      read_block(arg);
+      break;
+    case CMD18:
+      if (arg >= blocks) { send_r1(0x40); break; }
+      send_r1(r1);
+      data_state = READ_MULTIPLE;
+      data_block = arg;
+      break;
+    case CMD24:
+    case CMD25:
+      if (arg >= blocks) { send_r1(0x40); break; }
+      send_r1(r1);
+      data_state = cmd == CMD24 ? WRITE_SINGLE : WRITE_MULTIPLE;
+      data_block = arg;
+      block_len = 0;
+      break;
+    case CMD32: erase_first = arg; send_r1(r1); break;
+    case CMD33: erase_last = arg; send_r1(r1); break;
+    case CMD38: {
+      send_r1(r1);
+      const uint8_t zero[512] = { 0 };
+      for (uint32_t b = erase_first; b <= erase_last && b < blocks; b++)
+        if (pwrite(image, zero, 512, (off_t)b * 512) != 512) break;
+      reply.push_back(0x00);
+    } break;
+    default: send_r1(r1 | R1_ILLEGAL_COMMAND);
+  }
+}
+
+// One byte each way
+static uint8_t transfer(const uint8_t in) {
+  uint8_t out = 0xFF;
+  if (reply.empty() && data_state == READ_MULTIPLE && command_len == 0 && !read_block(data_block++))
+    data_state = NO_DATA;
+  if (!reply.empty()) { out = reply.front(); reply.pop_front(); }
+
+  // A block being written takes every byte, commands included
+  if ((data_state == WRITE_SINGLE || data_state == WRITE_MULTIPLE) && reply.empty()) {
+    if (block_len) {
+      block[block_len++ - 1] = in;
+      if (block_len == sizeof(block) + 1) {
+        const bool ok = pwrite(image, block, 512, (off_t)data_block * 512) == 512;
+        data_block++;
+        block_len = 0;
+        send_data_response(ok);
+        if (data_state == WRITE_SINGLE || !ok) data_state = NO_DATA;
+      }
+    }
+    else if (in == (data_state == WRITE_SINGLE ? DATA_START_BLOCK : WRITE_MULTIPLE_TOKEN))
+      block_len = 1;
+    else if (data_state == WRITE_MULTIPLE && in == STOP_TRAN_TOKEN) {
+      data_state = NO_DATA;
+      reply.push_back(0xFF);
+      reply.push_back(0x00);            // Busy for a byte
+    }
+    return out;
+  }
+
+  if (command_len || (in & 0xC0) == 0x40) {
+    command[command_len++] = in;
+    if (command_len == sizeof(command)) {
+      command_len = 0;
+      run_command();
+    }
+  }
+  return out;
+}
+
+HostSPDR SPDR;
+
+HostSPDR::operator uint8_t() const { return received; }
+
+HostSPDR& HostSPDR::operator=(const uint8_t b) {
+  // Deselected the card ignores the clock, but keeps its place in a transfer
+  if (image < 0 || host_output(SDSS)) {
+    received = 0xFF;
+    command_len = 0;
+  }
+  else
+    received = transfer(b);
+  SPSR |= _BV(SPIF);
+  return *this;
+}
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""
+Upload files with tools/sd_upload.py to the host build of the firmware.
+
+The firmware runs on its pseudo terminal with a FAT16 card image. Each case
+sends a generated G-code file with M1002 and then compares the file on the
+image with the original: plain, LZ compressed, into a folder, and once
+through a relay that corrupts a data packet, so the printer asks for a
+resend, drains the rest of the window and resyncs with the client. At the
+end the printer must not have moved: no G-code of the files may leak into
+the command queue.
+
+  tools/host/test_binary_transfer.py build/kossel_800/marlin_host
+"""
+
+import os
+import random
+import select
+import subprocess
+import sys
+import tempfile
+import threading
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+sys.path.insert(0, os.path.join(HERE, '..'))
+import fatimage  # noqa: E402
+import sd_upload  # noqa: E402
+
+UPLOAD = os.path.join(HERE, '..', 'sd_upload.py')
+
+
+def gcode(lines, seed):
+  rnd = random.Random(seed)
+  out = ['; test file %d' % seed, 'G28', 'G1 Z5 F3000']
+  e = 0.0
+  for _ in range(lines):
+    e += rnd.uniform(0.01, 0.5)
+    out.append('G1 X%.3f Y%.3f E%.5f F%d' % (rnd.uniform(-60, 60), rnd.uniform(-60, 60), e, rnd.choice((1800, 2400, 3600))))
+  return ('\n'.join(out) + '\n').encode()
+
+
+class Firmware:
+  def __init__(self, binary, card):
+    self.proc = subprocess.Popen([binary, '-p', '-c', card], stderr=subprocess.PIPE)
+    line = self.proc.stderr.readline().decode()
+    if not line.startswith('pty: '):
+      raise SystemExit('marlin_host did not start: %s' % line)
+    self.port = line[5:].strip()
+
+  def stop(self):
+    self.proc.terminate()
+    self.proc.wait()
+
+
+class CorruptingRelay(threading.Thread):
+  """A pseudo terminal for the client, wired to the printer's. Flips a byte
+  in the payload of one data packet of the binary stream."""
+
+  def __init__(self, port, nth_data_packet):
+    super().__init__(daemon=True)
+    self.printer = os.open(port, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(self.printer)
+    self.master, slave = os.openpty()
+    tty.setraw(slave)
+    self.port = os.ttyname(slave)
+    self.nth, self.seen, self.corrupted = nth_data_packet, 0, False
+    self.stream = bytearray()  # From the client, from M1002 on
+    self.binary, self.done = False, False
+
+  def to_printer(self, data):
+    if not self.binary:
+      if b'M1002\n' in data:
+        self.binary = True
+      return data
+    data = bytearray(data)
+    start = len(self.stream)
+    self.stream += data
+    # Walk the packets: A5 kind seq len payload crc32
+    pos = getattr(self, 'pos', 0)
+    while not self.corrupted and pos + 4 <= len(self.stream):
+      if self.stream[pos] != 0xA5:
+        pos += 1
+        continue
+      size = 4 + self.stream[pos + 3] + 4
+      if pos + size > len(self.stream):
+        break
+      if self.stream[pos + 1] == ord('D'):
+        self.seen += 1
+        if self.seen == self.nth:
+          at = pos + 4 + self.stream[pos + 3] // 2 - start
+          if 0 <= at < len(data):
+            data[at] ^= 0x55
+            self.corrupted = True
+      pos += size
+    self.pos = pos
+    return bytes(data)
+
+  def run(self):
+    while not self.done:
+      ready = select.select([self.master, self.printer], [], [], 0.1)[0]
+      if self.master in ready:
+        os.write(self.printer, self.to_printer(os.read(self.master, 4096)))
+      if self.printer in ready:
+        os.write(self.master, os.read(self.printer, 4096))
+
+  def stop(self):
+    self.done = True
+    self.join()
+    os.close(self.printer)
+    os.close(self.master)
+
+
+def upload(port, path, name, *options):
+  run = subprocess.run([sys.executable, UPLOAD, '-v', '-p', port, '--name', name, path] + list(options),
+                       stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=300)
+  return run.returncode, run.stdout.decode(), run.stderr.decode()
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  failures = 0
+  with tempfile.TemporaryDirectory() as tmp:
+    card = os.path.join(tmp, 'card.img')
+    vol = fatimage.Volume.make(32)
+    vol.mkdir('/JOBS')
+    fatimage.save(vol, card)
+
+    cases = [('/plain.gco', 1, ()), ('/lz.gco', 2, ('--lz',)), ('/jobs/lzsub.gco', 3, ('--lz',)), ('/resend.gco', 4, ())]
+    sources = {}
+    for name, seed, _ in cases:
+      sources[name] = os.path.join(tmp, 'src%d.gcode' % seed)
+      with open(sources[name], 'wb') as f:
+        f.write(gcode(1500, seed))
+
+    printer = Firmware(binary, card)
+    try:
+      for name, seed, options in cases:
+        port, relay = printer.port, None
+        if name == '/resend.gco':
+          relay = CorruptingRelay(printer.port, 5)
+          relay.start()
+          port = relay.port
+        code, out, err = upload(port, sources[name], name, *options)
+        ok = code == 0 and 'BFT done' in out
+        if relay:
+          relay.stop()
+          ok = ok and relay.corrupted and 'BFT resend' in err and 'BFT sync' in err
+        print('%-18s %s %s' % (name, 'ok  ' if ok else 'FAIL', out.strip()))
+        if not ok:
+          print(err[-2000:])
+          failures += 1
+      link = sd_upload.Link(sd_upload.open_port(printer.port, 115200), False)
+      where = [l for l in link.command('M114') if l.startswith('X:')]
+      still = bool(where) and where[0].startswith('X:0.00 Y:0.00 Z:0.00 ')
+      print('%-18s %s %s' % ('M114', 'ok  ' if still else 'FAIL', where[0] if where else 'no position'))
+      failures += not still
+    finally:
+      printer.stop()
+
+    vol = fatimage.load(card)
+    for name, _, _ in cases:
+      with open(sources[name], 'rb') as f:
+        want = f.read()
+      try:
+        got = vol.read(name)
+      except FileNotFoundError:
+        got = None
+      same = got == want
+      print('%-18s %s on the card' % (name, 'same' if same else 'DIFFERENT'))
+      failures += not same
+
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
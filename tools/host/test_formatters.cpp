@@ -0,0 +1,414 @@
+/**
+ * Decimal output of the serial port and the LCD against the code it replaced
+ *
+ * The firmware's MarlinSerial print() and the itostr/ftostr helpers of
+ * utility.cpp must put out the same bytes as the per-digit divisions and
+ * float loops they had before the shared ultostr()/ultodigits() core. Those
+ * are kept below as they were, and both run on the same numbers:
+ *
+ *   print(float, 0..6)    every float from 1e-4 to 70000 at a stride, +/-
+ *   print(long)           every 16 bit value, then the 32 bit range at a stride
+ *   itostr*               every 16 bit int
+ *   ftostr*               grids of hundredths and thousandths over each field,
+ *                         then random floats
+ *
+ * avr-gcc's double is float, so MarlinSerial.cpp is compiled here with
+ * double spelled float, as the board runs it. With "all" print(float) takes
+ * every float of the range instead (a few minutes).
+ *
+ *   make test   builds and runs build/<tree>/test_formatters
+ */
+
+// Everything with a double in it, ahead of the #define below
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <type_traits>
+
+#define double float
+#include "MarlinSerial.cpp"
+
+// As of 1.1.0-RC8 in this repository
+namespace Before {
+
+  std::string out;
+
+  void print(char c) { out += c; }
+
+  void printNumber(unsigned long n, uint8_t base) {
+    if (n) {
+      unsigned char buf[8 * sizeof(long)]; // Enough space for base 2
+      int8_t i = 0;
+      while (n) {
+        buf[i++] = n % base;
+        n /= base;
+      }
+      while (i--)
+        print((char)(buf[i] + (buf[i] < 10 ? '0' : 'A' - 10)));
+    }
+    else
+      print('0');
+  }
+
+  void print(long n) {
+    if (n < 0) {
+      print('-');
+      n = -n;
+    }
+    printNumber(n, 10);
+  }
+  void print(int n) { print((long)n); }
+  void print(unsigned long n) { printNumber(n, 10); }
+
+  void printFloat(double number, uint8_t digits) {
+    // Handle negative numbers
+    if (number < 0.0) {
+      print('-');
+      number = -number;
+    }
+
+    // Round correctly so that print(1.999, 2) prints as "2.00"
+    double rounding = 0.5;
+    for (uint8_t i = 0; i < digits; ++i)
+      rounding *= 0.1;
+
+    number += rounding;
+
+    // Extract the integer part of the number and print it
+    unsigned long int_part = (unsigned long)number;
+    double remainder = number - (double)int_part;
+    print(int_part);
+
+    // Print the decimal point, but only if there are digits beyond
+    if (digits) {
+      print('.');
+      // Extract digits from the remainder one at a time
+      while (digits--) {
+        remainder *= 10.0;
+        int toPrint = int(remainder);
+        print(toPrint);
+        remainder -= toPrint;
+      }
+    }
+  }
+
+  char conv[9];
+
+  #define DIGIT(n) ('0' + (n))
+  #define DIGIMOD(n, f) DIGIT((n)/(f) % 10)
+  #define RJDIGIT(n, f) ((n) >= (f) ? DIGIMOD(n, f) : ' ')
+  #define MINUSOR(n, alt) (n >= 0 ? (alt) : (n = -n, '-'))
+
+  char* itostr2(const uint8_t& x) {
+    int xx = x;
+    conv[0] = DIGIMOD(xx, 10);
+    conv[1] = DIGIMOD(xx, 1);
+    conv[2] = '\0';
+    return conv;
+  }
+
+  char* itostr3(const int& x) {
+    int xx = x;
+    conv[0] = MINUSOR(xx, RJDIGIT(xx, 100));
+    conv[1] = RJDIGIT(xx, 10);
+    conv[2] = DIGIMOD(xx, 1);
+    conv[3] = '\0';
+    return conv;
+  }
+
+  char* itostr3left(const int& xx) {
+    char *str = &conv[3];
+    *str = '\0';
+    *(--str) = DIGIMOD(xx, 1);
+    if (xx >= 10) {
+      *(--str) = DIGIMOD(xx, 10);
+      if (xx >= 100)
+        *(--str) = DIGIMOD(xx, 100);
+    }
+    return str;
+  }
+
+  char *itostr4sign(const int& x) {
+    int xx = abs(x);
+    if (x >= 1000) {
+      conv[0] = DIGIMOD(xx, 1000);
+      conv[1] = DIGIMOD(xx, 100);
+      conv[2] = DIGIMOD(xx, 10);
+    }
+    else {
+      if (xx >= 100) {
+        conv[0] = x < 0 ? '-' : ' ';
+        conv[1] = DIGIMOD(xx, 100);
+        conv[2] = DIGIMOD(xx, 10);
+      }
+      else {
+        conv[0] = ' ';
+        if (xx >= 10) {
+          conv[1] = x < 0 ? '-' : ' ';
+          conv[2] = DIGIMOD(xx, 10);
+        }
+        else {
+          conv[1] = ' ';
+          conv[2] = x < 0 ? '-' : ' ';
+        }
+      }
+    }
+    conv[3] = DIGIMOD(xx, 1);
+    conv[4] = '\0';
+    return conv;
+  }
+
+  char* ftostr12ns(const float& x) {
+    long xx = abs(x * 100);
+    conv[0] = DIGIMOD(xx, 100);
+    conv[1] = '.';
+    conv[2] = DIGIMOD(xx, 10);
+    conv[3] = DIGIMOD(xx, 1);
+    conv[4] = '\0';
+    return conv;
+  }
+
+  char *ftostr32(const float& x) {
+    long xx = x * 100;
+    conv[0] = MINUSOR(xx, DIGIMOD(xx, 10000));
+    conv[1] = DIGIMOD(xx, 1000);
+    conv[2] = DIGIMOD(xx, 100);
+    conv[3] = '.';
+    conv[4] = DIGIMOD(xx, 10);
+    conv[5] = DIGIMOD(xx, 1);
+    conv[6] = '\0';
+    return conv;
+  }
+
+  char *ftostr4sign(const float& fx) {
+    int x = fx * 10;
+    if (x <= -100 || x >= 1000) return itostr4sign((int)fx);
+    int xx = abs(x);
+    conv[0] = x < 0 ? '-' : (xx >= 100 ? DIGIMOD(xx, 100) : ' ');
+    conv[1] = DIGIMOD(xx, 10);
+    conv[2] = '.';
+    conv[3] = DIGIMOD(xx, 1);
+    conv[4] = '\0';
+    return conv;
+  }
+
+  char* ftostr41sign(const float& x) {
+    int xx = x * 10;
+    conv[0] = MINUSOR(xx, '+');
+    conv[1] = DIGIMOD(xx, 1000);
+    conv[2] = DIGIMOD(xx, 100);
+    conv[3] = DIGIMOD(xx, 10);
+    conv[4] = '.';
+    conv[5] = DIGIMOD(xx, 1);
+    conv[6] = '\0';
+    return conv;
+  }
+
+  char* ftostr43sign(const float& x, char plus=' ') {
+    long xx = x * 1000;
+    conv[0] = xx ? MINUSOR(xx, plus) : ' ';
+    conv[1] = DIGIMOD(xx, 1000);
+    conv[2] = '.';
+    conv[3] = DIGIMOD(xx, 100);
+    conv[4] = DIGIMOD(xx, 10);
+    conv[5] = DIGIMOD(xx, 1);
+    conv[6] = '\0';
+    return conv;
+  }
+
+  char* ftostr5rj(const float& x) {
+    long xx = abs(x);
+    conv[0] = RJDIGIT(xx, 10000);
+    conv[1] = RJDIGIT(xx, 1000);
+    conv[2] = RJDIGIT(xx, 100);
+    conv[3] = RJDIGIT(xx, 10);
+    conv[4] = DIGIMOD(xx, 1);
+    conv[5] = '\0';
+    return conv;
+  }
+
+  char* ftostr51sign(const float& x) {
+    long xx = x * 10;
+    conv[0] = MINUSOR(xx, '+');
+    conv[1] = DIGIMOD(xx, 10000);
+    conv[2] = DIGIMOD(xx, 1000);
+    conv[3] = DIGIMOD(xx, 100);
+    conv[4] = DIGIMOD(xx, 10);
+    conv[5] = '.';
+    conv[6] = DIGIMOD(xx, 1);
+    conv[7] = '\0';
+    return conv;
+  }
+
+  char* ftostr52sign(const float& x) {
+    long xx = x * 100;
+    conv[0] = MINUSOR(xx, '+');
+    conv[1] = DIGIMOD(xx, 10000);
+    conv[2] = DIGIMOD(xx, 1000);
+    conv[3] = DIGIMOD(xx, 100);
+    conv[4] = '.';
+    conv[5] = DIGIMOD(xx, 10);
+    conv[6] = DIGIMOD(xx, 1);
+    conv[7] = '\0';
+    return conv;
+  }
+
+  char* ftostr62sign(const float& x) {
+    long xx = abs(x * 100);
+    conv[0] = MINUSOR(xx, '+');
+    conv[1] = DIGIMOD(xx, 100000);
+    conv[2] = DIGIMOD(xx, 10000);
+    conv[3] = DIGIMOD(xx, 1000);
+    conv[4] = DIGIMOD(xx, 100);
+    conv[5] = '.';
+    conv[6] = DIGIMOD(xx, 10);
+    conv[7] = DIGIMOD(xx, 1);
+    conv[8] = '\0';
+    return conv;
+  }
+
+  char* ftostr52sp(const float& x) {
+    long xx = x * 100;
+    uint8_t dig;
+    conv[0] = MINUSOR(xx, RJDIGIT(xx, 10000));
+    conv[1] = RJDIGIT(xx, 1000);
+    conv[2] = DIGIMOD(xx, 100);
+
+    if ((dig = xx % 10)) {          // second digit after decimal point?
+      conv[3] = '.';
+      conv[4] = DIGIMOD(xx, 10);
+      conv[5] = DIGIT(dig);
+    }
+    else {
+      if ((dig = (xx / 10) % 10)) { // first digit after decimal point?
+        conv[3] = '.';
+        conv[4] = DIGIT(dig);
+      }
+      else                          // nothing after decimal point
+        conv[3] = conv[4] = ' ';
+      conv[5] = ' ';
+    }
+    conv[6] = '\0';
+    return conv;
+  }
+
+}
+
+#undef double
+
+#include "temperature.h"
+
+//
+// The UART of MarlinSerial.cpp, always ready, sending into a string
+//
+volatile uint8_t SREG, UCSR0B, UCSR0C, UBRR0H, UBRR0L;
+HostUDR UDR0;
+HostUCSRA UCSR0A;
+
+static std::string sent;
+HostUDR& HostUDR::operator=(const uint8_t c) { sent += (char)c; return *this; }
+HostUDR::operator uint8_t() const { return 0; }
+HostUCSRA::operator uint8_t() const { return bits | _BV(UDRE0); }
+
+// For safe_delay() of utility.cpp
+void delay(unsigned long) {}
+void Temperature::manage_heater() {}
+
+static long checked, failures;
+
+static bool same(const std::string &before, const std::string &now) {
+  checked++;
+  return before == now || failures++ >= 20;
+}
+
+static void compare(const char *what, const std::string &before, const std::string &now) {
+  if (!same(before, now)) printf("%s: \"%s\" before, \"%s\" now\n", what, before.c_str(), now.c_str());
+}
+
+static void serial_float(const float f, const uint8_t digits) {
+  Before::out.clear();
+  Before::printFloat(f, digits);
+  sent.clear();
+  MarlinSerial::print(f, digits);
+  if (!same(Before::out, sent))
+    printf("print(%.9g, %d): \"%s\" before, \"%s\" now\n", f, digits, Before::out.c_str(), sent.c_str());
+}
+
+static void serial_long(const long n) {
+  Before::out.clear();
+  Before::print(n);
+  sent.clear();
+  MarlinSerial::print(n);
+  compare("print(long)", Before::out, sent);
+}
+
+#define CHECK(F, ...) compare(#F, Before::F(__VA_ARGS__), F(__VA_ARGS__))
+
+static void lcd_int(const int i) {
+  if (i >= 0 && i < 256) CHECK(itostr2, (uint8_t)i);
+  if (i >= 0) CHECK(itostr3left, i);
+  CHECK(itostr3, i);
+  CHECK(itostr4sign, i);
+}
+
+static void lcd_float(const float x) {
+  CHECK(ftostr12ns, x);
+  CHECK(ftostr32, x);
+  CHECK(ftostr43sign, x);
+  CHECK(ftostr43sign, x, '+');
+  CHECK(ftostr5rj, x);
+  CHECK(ftostr51sign, x);
+  CHECK(ftostr52sign, x);
+  CHECK(ftostr62sign, x);
+  CHECK(ftostr52sp, x);
+  if (fabs(x) < 3276) {     // int is 16 bits on the board
+    CHECK(ftostr41sign, x);
+    #if ENABLED(LCD_DECIMAL_SMALL_XY)
+      CHECK(ftostr4sign, x);
+    #endif
+  }
+}
+
+static uint32_t float_bits(const float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static float bits_float(const uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+int main(int argc, char **argv) {
+  const bool all = argc > 1 && !strcmp(argv[1], "all");
+
+  for (uint32_t u = float_bits(1e-4f); u <= float_bits(70000.0f); u += all ? 1 : 97)
+    for (uint8_t digits = 0; digits <= 6; digits++) {
+      serial_float(bits_float(u), digits);
+      if (u % 7 == 0) serial_float(-bits_float(u), digits);
+    }
+  printf("print(float)  %ld checked\n", checked);
+  checked = 0;
+
+  for (long n = -65536; n <= 65536; n++) serial_long(n);
+  for (uint64_t n = 0; n <= 0xFFFFFFFF; n += 65521) serial_long(n);
+  serial_long(0x7FFFFFFF);
+  serial_long(-0x7FFFFFFF);
+  printf("print(long)   %ld checked\n", checked);
+  checked = 0;
+
+  #if ENABLED(ULTRA_LCD)
+    for (int i = -32767; i <= 32767; i++) lcd_int(i);
+    for (long i = -9999999; i <= 9999999; i += 7) lcd_float(i / 100.0f);
+    for (long i = -99999; i <= 99999; i++) lcd_float(i / 1000.0f);
+    std::mt19937 rnd(1);
+    std::uniform_real_distribution<float> wide(-99999, 99999), narrow(-10, 10);
+    for (long k = 0; k < 1000000; k++) { lcd_float(wide(rnd)); lcd_float(narrow(rnd)); }
+    printf("itostr/ftostr %ld checked\n", checked);
+  #endif
+
+  printf("%ld failures\n", failures);
+  return failures ? 1 : 0;
+}
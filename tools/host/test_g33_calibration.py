@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Calibrate the host build of a delta with G33 on miscalibrated machines.
+
+printer.cpp builds each machine with errors of its endstops, radius, rod
+and tower angles (-m e1=..,r=..,a1=..), the firmware keeps its configured
+geometry. G33 probes and fits; a dry run G33 D right after it, probing the
+recalibrated machine, must find it flat and at the right height. Each fit
+must converge in a few iterations.
+
+  tools/host/test_g33_calibration.py build/kossel_800/marlin_host
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..'))
+import sd_upload  # noqa: E402
+
+# Machine errors, factors to fit
+CASES = [
+  ('e1=0.8,e2=-0.5,e3=0.2', 3),
+  ('e1=0.8,e2=-0.5,e3=0.2,r=1.5', 4),
+  ('e1=0.3,e2=-0.2,a1=0.4,a2=-0.3', 6),
+  ('e1=0.5,e3=-0.4,r=-1,rod=1,a1=0.4,a2=-0.3,a3=0.2', 7),
+]
+FIT, FLAT, ITERATIONS = 0.01, 0.02, 5     # mm RMS, mm RMS, at most
+
+DEVIATION = re.compile(r'Deviation before: ([-\d.]+) after: ([-\d.]+) iterations: (\d+)')
+
+
+def calibrate(binary, errors, factors):
+  proc = subprocess.Popen([binary, '-p', '-s', '10', '-m', errors], stderr=subprocess.PIPE)
+  try:
+    line = proc.stderr.readline().decode()
+    if not line.startswith('pty: '):
+      raise SystemExit('marlin_host did not start: %s' % line)
+    link = sd_upload.Link(sd_upload.open_port(line[5:].strip(), 115200), False)
+    if not any('M665' in l for l in link.command('M503')):
+      return None
+    link.command('G28')
+    found = []
+    for gcode in ('G33 F%d' % factors, 'G33 F%d D' % factors):
+      lines = link.command(gcode)
+      match = [m for m in map(DEVIATION.match, lines) if m]
+      if not match:
+        raise SystemExit('no deviation from %s' % gcode)
+      found.append(tuple(float(g) for g in match[0].groups()))
+    return found
+  finally:
+    proc.terminate()
+    proc.wait()
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  failures = 0
+  for errors, factors in CASES:
+    found = calibrate(binary, errors, factors)
+    if not found:
+      print('no G33, not a delta')
+      break
+    (before, after, iterations), (again, _, _) = found
+    ok = after < FIT and iterations <= ITERATIONS and again < FLAT
+    print('F%d %-48s %s %.3f -> %.3f in %d, then %.3f' % (factors, errors, 'ok  ' if ok else 'FAIL',
+                                                          before, after, iterations, again))
+    failures += not ok
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
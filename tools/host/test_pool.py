@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Many replays at once (marlin_pool, make pool).
+
+Jobs of different sizes go through marlin_pool on as many threads as
+there are jobs, each in its own copy of the firmware, and one by one
+through marlin_host -s 0 -g. Every job must give the same summary both
+ways: the copies must not share a planner, a stepper or a clock. A file
+that isn't there must end its own replay only, with what marlin_host
+says of it.
+
+  tools/host/test_pool.py build/kossel_800/marlin_host
+"""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+SIZES = (10, 20, 30, 40, 50)
+SUMMARY_RE = re.compile(r'replay: (\d+) lines, (\d+) blocks, ([\d.]+) s simulated.*\n'
+                        r'replay: (\d+) blocks/s peak, (\d+) starved, (\d+) steps/s peak, (\d+) capped')
+
+
+def job(size):
+  """Squares from X0 Y0, on the bed of both kinds of machine"""
+  lines = ['M302 S0', 'G28', 'G90', 'M82', 'G92 E0', 'G1 Z5 F3000']
+  e = 0
+  for layer in range(4):
+    for x, y in ((size, 0), (size, size), (0, size), (0, 0)):
+      e += size * 0.05
+      lines.append('G1 X%d Y%d E%.2f F%d' % (x, y, e, 1200 + 600 * layer))
+  return '\n'.join(lines) + '\n'
+
+
+def summary(text):
+  found = SUMMARY_RE.search(text)
+  return found and [float(v) if '.' in v else int(v) for v in found.groups()]
+
+
+def same(a, b):
+  """The clock runs on a timer signal, so the simulated time may be off a little"""
+  return a and b and a[:2] == b[:2] and a[3:] == b[3:] and abs(a[2] - b[2]) <= 0.01 * b[2]
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  pool = os.path.join(os.path.dirname(binary), 'marlin_pool')
+  with tempfile.TemporaryDirectory() as tmp:
+    files = []
+    for size in SIZES:
+      files.append(os.path.join(tmp, 'square%d.gcode' % size))
+      with open(files[-1], 'w') as f:
+        f.write(job(size))
+    missing = os.path.join(tmp, 'missing.gcode')
+    alone = [summary(subprocess.run([binary, '-s', '0', '-g', f], stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                                    timeout=300).stderr.decode()) for f in files]
+    proc = subprocess.run([pool, '-j', str(len(files) + 1)] + files[:2] + [missing] + files[2:],
+                          stdout=subprocess.PIPE, timeout=300)
+
+  sections = re.split('^(%s)$' % '|'.join(re.escape(f) for f in files + [missing]), proc.stdout.decode(), flags=re.M)[1:]
+  reports = dict(zip(sections[0::2], sections[1::2]))
+  failures = 0
+  for size, f, expected in zip(SIZES, files, alone):
+    found = summary(reports.get(f, ''))
+    ok = same(found, expected)
+    print('%-10s %s %s' % ('square%d' % size, 'ok  ' if ok else 'FAIL',
+                           '%d blocks, %.3f s' % (found[1], found[2]) if ok else '%s, alone %s' % (found, expected)))
+    failures += not ok
+  ended = reports.get(missing, '').strip()
+  for name, ok, text in [('missing', ended == "host: can't open the G-code file", ended or 'no report'),
+                         ('exit', proc.returncode == 2, 'status %d' % proc.returncode)]:
+    print('%-10s %s %s' % (name, 'ok  ' if ok else 'FAIL', text))
+    failures += not ok
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,93 @@
+/**
+ * Combined step/dir port writes (COMBINED_STEP_WRITES) against the pin tables
+ *
+ * stepper_indirection.h groups the step and dir pins of the board's pins_*.h
+ * by port through fastio.h. Here the pins are looked up in the Arduino Mega
+ * 2560 table instead, and every write of every set of axes to every levels
+ * must drive exactly those pins and leave the rest of each port alone.
+ *
+ *   make test   builds and runs build/<tree>/test_port_writes
+ */
+
+#include "Marlin.h"
+#include "stepper_indirection.h"
+
+#include <stdio.h>
+
+#define HOST_PORT(P) volatile uint8_t PORT##P, DDR##P; HostPIN PIN##P = { PORT##P, 0 };
+HOST_PORT(A) HOST_PORT(B) HOST_PORT(C) HOST_PORT(D) HOST_PORT(E) HOST_PORT(F)
+HOST_PORT(G) HOST_PORT(H) HOST_PORT(J) HOST_PORT(K) HOST_PORT(L)
+volatile uint8_t SREG;
+
+#if ENABLED(COMBINED_STEP_WRITES)
+
+  static volatile uint8_t * const port[] = { &PORTA, &PORTB, &PORTC, &PORTD, &PORTE, &PORTF, &PORTG, &PORTH, &PORTJ, &PORTK, &PORTL };
+  static const char port_name[] = "ABCDEFGHJKL";
+  #define PORT_COUNT COUNT(port)
+
+  // Port and bit of each Arduino pin, digital_pin_to_port_PGM and
+  // digital_pin_to_bit_mask_PGM of the Mega's pins_arduino.h
+  static const char pin_port[] = "EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK";
+  static const uint8_t pin_bit[] = {
+    0, 1, 4, 5, 5, 3, 3, 4, 5, 6, 4, 5, 6, 7, 1, 0, 1, 0, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 7, 6, 5, 4, 3, 2, 1, 0,
+    7, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7
+  };
+
+  static uint8_t port_of(const uint8_t pin) { return strchr(port_name, pin_port[pin]) - port_name; }
+
+  // Start each write from a different pattern on each port
+  static void fill(const uint8_t seed) {
+    for (uint8_t p = 0; p < PORT_COUNT; p++) *port[p] = seed * 29 + p * 71;
+  }
+
+  // The write must leave the ports as setting each flagged pin on its own would
+  static int check(const char *name, const uint8_t pins[NUM_AXIS], const uint8_t axes, const uint8_t levels, const uint8_t seed) {
+    fill(seed);
+    for (uint8_t a = 0; a < NUM_AXIS; a++) if (TEST(axes & (PORT_WRITE_AXES), a)) {
+      volatile uint8_t &reg = *port[port_of(pins[a])];
+      if (TEST(levels, a)) SBI(reg, pin_bit[pins[a]]); else CBI(reg, pin_bit[pins[a]]);
+    }
+    uint8_t expected[PORT_COUNT];
+    for (uint8_t p = 0; p < PORT_COUNT; p++) expected[p] = *port[p];
+
+    fill(seed);
+    if (name[0] == 'S') PORTS_WRITE(STEP, axes, levels); else PORTS_WRITE(DIR, axes, levels);
+
+    int failures = 0;
+    for (uint8_t p = 0; p < PORT_COUNT; p++) if (*port[p] != expected[p]) {
+      printf("%s axes 0x%X levels 0x%X: PORT%c 0x%02X, not 0x%02X\n", name, axes, levels, port_name[p], *port[p], expected[p]);
+      failures++;
+    }
+    return failures;
+  }
+
+  // The port and mask of each pin, by the table
+  static void masks(const char *name, const uint8_t pins[NUM_AXIS]) {
+    printf("%-4s", name);
+    for (uint8_t a = 0; a < NUM_AXIS; a++) if (TEST(PORT_WRITE_AXES, a))
+      printf(" %c=PORT%c:0x%02X", "XYZE"[a], port_name[port_of(pins[a])], _BV(pin_bit[pins[a]]));
+    putchar('\n');
+  }
+
+  int main() {
+    static const uint8_t step[NUM_AXIS] = { X_STEP_PIN, Y_STEP_PIN, Z_STEP_PIN, E0_STEP_PIN },
+                         dir[NUM_AXIS] = { X_DIR_PIN, Y_DIR_PIN, Z_DIR_PIN, E0_DIR_PIN };
+    masks("STEP", step);
+    masks("DIR", dir);
+    int failures = 0;
+    for (uint8_t axes = 0; axes < _BV(NUM_AXIS); axes++)
+      for (uint8_t levels = 0; levels < _BV(NUM_AXIS); levels++)
+        for (uint8_t seed = 0; seed < 4; seed++)
+          failures += check("STEP", step, axes, levels, seed) + check("DIR", dir, axes, levels, seed);
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+  }
+
+#else
+
+  int main() {
+    puts("COMBINED_STEP_WRITES is off");
+    return 0;
+  }
+
+#endif
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Replay of a G-code file in place (marlin_host -g, see replay.cpp).
+
+The lines go to the parser as spans of the mapped file, without a nul of
+their own, so each must stop where its line does: before a comment, a
+checksum, trailing blanks or a CR, and the last line without a newline.
+The positions M114 reports after the moves and the text of an unknown
+command show where the parser stopped. The file itself must not change,
+though the unknown command writes a nul into its page of the mapping.
+
+  tools/host/test_replay.py build/kossel_800/marlin_host
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+JOB = (b'; a comment line\n'
+       b'G28\n'
+       b'M302 S0 ; cold extrusion for the E moves\n'
+       b'G90\n'
+       b'N10 G1 X10 Y5 Z20 F3000*93\n'
+       b'G1 X12E1.5  \r\n'
+       b'   G1 Y4\t\n'
+       b'\n'
+       b'G1 Z15;no blank before the comment\n'
+       b'X5 some text ; not a command\n'
+       b'M114')
+
+CHECKS = [
+  ('position', b'X:12.00 Y:4.00 Z:15.00 E:1.50'),
+  ('unknown', b'echo:Unknown command: "X5 some text"'),
+]
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  with tempfile.TemporaryDirectory() as tmp:
+    job = os.path.join(tmp, 'job.gcode')
+    with open(job, 'wb') as f:
+      f.write(JOB)
+    proc = subprocess.run([binary, '-s', '0', '-g', job], stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=300)
+    with open(job, 'rb') as f:
+      unchanged = f.read() == JOB
+
+  output = proc.stdout.splitlines()
+  summary = proc.stderr.decode().strip()
+  failures = 0
+  for name, expected in CHECKS:
+    found = [l for l in output if l.startswith(expected)]
+    print('%-10s %s %s' % (name, 'ok  ' if found else 'FAIL', (found or [b'no line starts with ' + expected])[0].decode()))
+    failures += not found
+  for name, ok, text in [('file', unchanged, 'unchanged on disk'),
+                         ('exit', proc.returncode == 0 and summary.startswith('replay: 9 lines'), summary)]:
+    print('%-10s %s %s' % (name, 'ok  ' if ok else 'FAIL', text))
+    failures += not ok
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Walk the "Print from SD" menu of the host build on the LCD of panel.cpp.
+
+The card has files around a subfolder with files of its own. The menu of
+the root must list the files and the folder and nothing of the folder's
+contents, the menu of the folder just its own files: the folder index
+(SDCARD_DIR_INDEX) holds the entries of one folder, not of the ones below.
+
+  tools/host/test_sd_folder_index.py build/kossel_800/marlin_host
+"""
+
+import os
+import select
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+import fatimage  # noqa: E402
+
+CARD = {'/A.GCO': b'G28\n', '/SUB/X.GCO': b'G28\n', '/SUB/Y.GCO': b'G28\n', '/SUB/Z.GCO': b'G28\n', '/B.GCO': b'G28\n'}
+
+
+class Panel:
+  def __init__(self, binary, card, pipe):
+    os.mkfifo(pipe)
+    self.proc = subprocess.Popen([binary, '-p', '-c', card, '-m', 'panel=' + pipe], stderr=subprocess.PIPE)
+    if not self.proc.stderr.readline().startswith(b'pty: '):
+      raise SystemExit('marlin_host did not start')
+    self.keys = os.open(pipe, os.O_WRONLY)
+
+  def stop(self):
+    os.close(self.keys)
+    self.proc.terminate()
+    self.proc.wait()
+
+  def screen(self, keys=''):
+    """Press the keys, then the four rows of the LCD."""
+    os.write(self.keys, (keys + 's').encode())
+    if not select.select([self.proc.stderr], [], [], 60)[0]:
+      raise SystemExit('no screen from marlin_host')
+    line = self.proc.stderr.readline().decode().rstrip('\n')
+    if not line.startswith('lcd: |'):
+      raise SystemExit('marlin_host: %s' % line)
+    return line[6:-1].split('|')
+
+  def selected(self, keys=''):
+    """Press the keys, then the item the cursor is on, folders with a '/'."""
+    row = [r for r in self.screen(keys) if r[0] != ' '][0]
+    return row[1:19].strip() + ('/' if row[-1] == '@' else '')
+
+  def menu(self):
+    """Scroll the open menu to its end, the items under the back item. A
+    detent moves the count less than an item, so give it three."""
+    items, at, still = [], self.selected(), 0
+    while still < 3:
+      now = self.selected('+')
+      if now == at:
+        still += 1
+      else:
+        items.append(now)
+        at, still = now, 0
+    return items
+
+  def enter(self, item):
+    """Scroll down, then up, to the item and click it."""
+    at = self.selected()
+    for key in '+-':
+      still = 0
+      while still < 3:
+        if at == item:
+          self.screen('c')
+          return
+        now = self.selected(key)
+        still = still + 1 if now == at else 0
+        at = now
+    raise SystemExit('no "%s" in the menu' % item)
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  failures = 0
+  with tempfile.TemporaryDirectory() as tmp:
+    card = os.path.join(tmp, 'card.img')
+    vol = fatimage.Volume.make(32)
+    for path, content in CARD.items():
+      vol.write(path, content)
+    fatimage.save(vol, card)
+
+    panel = Panel(binary, card, os.path.join(tmp, 'keys'))
+    try:
+      for _ in range(100):              # Past the boot screen
+        if 'marlinfw.org' not in ''.join(panel.screen()):
+          break
+      panel.screen('c')                 # Status screen to the main menu
+      panel.enter('Print from SD')
+
+      root = panel.menu()
+      ok = sorted(root) == ['A.GCO', 'B.GCO', 'SUB/']
+      print('%-6s %s %s' % ('/', 'ok  ' if ok else 'FAIL', ' '.join(root)))
+      failures += not ok
+
+      if 'SUB/' in root:
+        panel.enter('SUB/')
+        sub = panel.menu()
+        ok = sorted(sub) == ['@..', 'X.GCO', 'Y.GCO', 'Z.GCO']   # '..' after its up-level sign
+        print('%-6s %s %s' % ('/SUB', 'ok  ' if ok else 'FAIL', ' '.join(sub)))
+        failures += not ok
+    finally:
+      panel.stop()
+
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
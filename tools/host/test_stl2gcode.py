@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+G-code of tools/stl2gcode.py through the firmware (marlin_host -s 0 -g).
+
+A tube, its outside and its hole cut into flat facets, goes to the slicer
+as a binary and as an ASCII STL, with G2/G3 arcs fitted over the facets.
+Both files must give the same job. The firmware must run all of it:
+heat, home, take every arc and short segment without an error, an
+unknown command or an endstop hit, and end up at the position of the
+generator's last move. Each arc must extrude for the length the firmware
+draws it (plan_arc(): G2 clockwise, I J from the start), at the
+filament per mm of the straight moves of its layer.
+
+  tools/host/test_stl2gcode.py build/kossel_800/marlin_host
+"""
+
+import math
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SLICER = os.path.join(HERE, '..', 'stl2gcode.py')
+
+SIDES, OUTER, INNER, HEIGHT = 48, 10.0, 5.0, 2.0
+WORD_RE = re.compile(r'([XYZEIJ])(-?[\d.]+)')
+
+
+def f32(v):
+  return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def tube():
+  """Triangles of a closed tube standing on Z=0, in floats both STL kinds hold exactly."""
+  ring = lambda r, z: [(f32(r * math.cos(2 * math.pi * i / SIDES)), f32(r * math.sin(2 * math.pi * i / SIDES)), z) for i in range(SIDES)]
+  ob, ot, ib, it = ring(OUTER, 0), ring(OUTER, HEIGHT), ring(INNER, 0), ring(INNER, HEIGHT)
+  triangles = []
+  for i in range(SIDES):
+    j = (i + 1) % SIDES
+    triangles += [(ob[i], ob[j], ot[j]), (ob[i], ot[j], ot[i]),     # Outside
+                  (ib[j], ib[i], it[i]), (ib[j], it[i], it[j]),     # Hole
+                  (ot[i], ot[j], it[j]), (ot[i], it[j], it[i]),     # Top
+                  (ob[j], ob[i], ib[i]), (ob[j], ib[i], ib[j])]     # Bottom
+  return triangles
+
+
+def write_stl(filename, triangles, ascii):
+  with open(filename, 'wb') as f:
+    if ascii:
+      f.write(b'solid tube\n')
+      for t in triangles:
+        f.write(b'facet normal 0 0 0\nouter loop\n')
+        for v in t:
+          f.write(('vertex %r %r %r\n' % v).encode())
+        f.write(b'endloop\nendfacet\n')
+      f.write(b'endsolid tube\n')
+    else:
+      f.write(b'tube'.ljust(80, b' ') + struct.pack('<I', len(triangles)))
+      for t in triangles:
+        f.write(struct.pack('<12fH', 0, 0, 0, *[c for v in t for c in v], 0))
+
+
+def slice(stl, tree):
+  return subprocess.run([sys.executable, SLICER, '-t', tree, '--arcs', '--bed-temp', '0', stl],
+                        stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, check=True).stdout.decode()
+
+
+def moves(gcode):
+  """(code, start, end, I J) of the generator's moves, all of them absolute (G90, M82)."""
+  pos = {}
+  for line in gcode.splitlines():
+    line = line.split(';', 1)[0]
+    if re.match(r'G[0-3] ', line):
+      words = dict((a, float(v)) for a, v in WORD_RE.findall(line))
+      start = dict(pos)
+      pos.update((a, v) for a, v in words.items() if a in 'XYZE')
+      yield line[:2], start, dict(pos), (words.get('I', 0), words.get('J', 0))
+
+
+def arc_length(start, end, ij, clockwise):
+  """As plan_arc() draws it"""
+  cx, cy = start['X'] + ij[0], start['Y'] + ij[1]
+  rx, ry, tx, ty = -ij[0], -ij[1], end['X'] - cx, end['Y'] - cy
+  angular = math.atan2(rx * ty - ry * tx, rx * tx + ry * ty)
+  if angular < 0:
+    angular += 2 * math.pi
+  if clockwise:
+    angular -= 2 * math.pi
+  return abs(angular) * math.hypot(rx, ry)
+
+
+def arc_flow_errors(gcode):
+  """Arcs whose filament per mm is off that of the straight extrusions on their layer."""
+  layer, lines, arcs = None, [], []
+  for code, start, end, ij in moves(gcode):
+    if 'E' not in start or end['E'] <= start['E'] or end['Z'] != start['Z']:
+      continue
+    if end['Z'] != layer:
+      layer, lines = end['Z'], []
+    if code == 'G1':
+      length = math.hypot(end['X'] - start['X'], end['Y'] - start['Y'])
+      if length > 1:
+        lines.append((end['E'] - start['E']) / length)
+    else:
+      arcs.append((layer, (end['E'] - start['E']) / arc_length(start, end, ij, code == 'G2'), lines))
+  return [a for a in arcs if a[2] and abs(a[1] / (sum(a[2]) / len(a[2])) - 1) > 0.02]
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  tree = os.path.basename(os.path.dirname(os.path.abspath(binary)))
+  triangles = tube()
+  with tempfile.TemporaryDirectory() as tmp:
+    jobs = []
+    for kind in ('binary', 'ascii'):
+      os.mkdir(os.path.join(tmp, kind))
+      stl = os.path.join(tmp, kind, 'tube.stl')
+      write_stl(stl, triangles, kind == 'ascii')
+      jobs.append(slice(stl, tree))
+    gcode = jobs[0]
+    job = os.path.join(tmp, 'tube.gcode')
+    with open(job, 'w') as f:
+      f.write(gcode + 'M114\n')
+    proc = subprocess.run([binary, '-s', '0', '-g', job], stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=600)
+
+  output = proc.stdout.decode(errors='replace').splitlines()
+  summary = proc.stderr.decode(errors='replace').strip()
+  end = list(moves(gcode))[-1][2]
+  expected = 'X:%.2f Y:%.2f Z:%.2f E:%.2f' % (end['X'], end['Y'], end['Z'], end['E'])
+  arcs = len(re.findall(r'^G[23] ', gcode, re.M))
+  off = arc_flow_errors(gcode)
+  bad = [l for l in output if l.startswith('Error:') or 'Unknown command' in l or 'endstops hit' in l]
+  found = [l for l in output if l.startswith('X:')]
+
+  failures = 0
+  for name, ok, text in [('stl', jobs[0] == jobs[1], 'binary and ASCII give the same %d lines' % len(gcode.splitlines())),
+                         ('arcs', arcs > 0, '%d G2/G3' % arcs),
+                         ('arc E', not off, '%d arcs off their layer\'s flow' % len(off)),
+                         ('errors', not bad, bad[0] if bad else 'none'),
+                         ('position', found and found[-1].startswith(expected), found[-1] if found else 'no M114 reply, expected ' + expected),
+                         ('exit', proc.returncode == 0 and summary.startswith('replay: '), summary.split('\n')[0])]:
+    print('%-10s %s %s' % (name, 'ok  ' if ok else 'FAIL', text))
+    failures += not ok
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Hotend regulation of the host build on the thermal model of printer.cpp.
+
+Heats to 200 °C with M109 and holds it through three windows of simulated
+time, reading the block temperature at the thermistor from the machine's
+log (-m log=path):
+
+  idle   a minute of G4, nothing else to do
+  load   hundreds of short moves keeping the planner full
+  fan    the part fan switched on at 40%
+
+The main loop is held busy for 2.5s after each of its runs (-m busy=),
+as slow LCD draws and blocking commands hold it on the board. G4 keeps
+calling manage_heater() while it waits, the moves don't. Heating must not
+overshoot much, the hold must stay in a narrow band, and the load window
+must regulate as tightly as the idle one: the PID runs in the temperature
+interrupt (PID_IN_ISR) and doesn't wait for the main loop. Run from
+manage_heater() the load band grows to about 2 °C.
+The model's thermistor isn't the firmware's table, so the bands are taken
+around the idle mean rather than the target.
+
+  tools/host/test_thermal.py build/kossel_800/marlin_host
+"""
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..'))
+import sd_upload  # noqa: E402
+
+OVERSHOOT, BAND, SHIFT, DROOP = 3.0, 1.0, 0.5, 3.0     # °C
+BUSY = 2500                                             # ms, see above
+
+
+def log_rows(path):
+  """(seconds, block °C, thermistor °C, heater duty) of each complete line"""
+  with open(path) as f:
+    rows = [l.split() for l in f if l.endswith('\n')]
+  return [tuple(map(float, r)) for r in rows if len(r) == 4]
+
+
+def sensed(rows, start, end):
+  return [r[2] for r in rows if start <= r[0] < end]
+
+
+def main(argv):
+  binary = argv[0] if argv else os.path.join(HERE, 'build', 'kossel_800', 'marlin_host')
+  with tempfile.TemporaryDirectory() as tmp:
+    log = os.path.join(tmp, 'thermal.log')
+    proc = subprocess.Popen([binary, '-p', '-s', '20', '-m', 'busy=%d,log=%s' % (BUSY, log)], stderr=subprocess.PIPE)
+    try:
+      line = proc.stderr.readline().decode()
+      if not line.startswith('pty: '):
+        raise SystemExit('marlin_host did not start: %s' % line)
+      link = sd_upload.Link(sd_upload.open_port(line[5:].strip(), 115200), False)
+
+      def run(*gcodes):
+        for gcode in gcodes:
+          link.command(gcode, timeout=60)
+        return log_rows(log)[-1][0]   # Simulated time once done
+
+      run('M109 S200', 'G4 S60')
+      idle = run('G4 S60')
+      rnd = random.Random(1)
+      run('G28', 'G1 Z20 F6000')
+      loaded = run(*['G1 X%.1f Y%.1f F9000' % (rnd.uniform(-50, 50), rnd.uniform(-50, 50)) for _ in range(200)] + ['M400'])
+      run('M106 S102', 'G4 S30')
+      fan = run('G4 S30')
+      run('M107')
+    finally:
+      proc.terminate()
+      proc.wait()
+    rows = log_rows(log)
+
+  start = idle - 60
+  idle_temps, load_temps = sensed(rows, start, idle), sensed(rows, idle, loaded)
+  fan_temps, fan_settled = sensed(rows, loaded, fan), sensed(rows, fan - 10, fan)
+  mean = sum(idle_temps) / len(idle_temps)
+  load_mean = sum(load_temps) / len(load_temps)
+  checks = [
+    ('overshoot', max(sensed(rows, 0, start)) - mean, OVERSHOOT),
+    ('idle band', max(idle_temps) - min(idle_temps), BAND),
+    ('load band', max(load_temps) - min(load_temps), BAND),
+    ('load shift', abs(load_mean - mean), SHIFT),
+    ('fan droop', mean - min(fan_temps), DROOP),
+    ('fan settled', max(abs(t - mean) for t in fan_settled), BAND),
+  ]
+  failures = 0
+  for name, value, limit in checks:
+    ok = value <= limit
+    print('%-12s %s %.2f °C (at most %.1f)' % (name, 'ok  ' if ok else 'FAIL', value, limit))
+    failures += not ok
+  print('%d failures' % failures)
+  sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
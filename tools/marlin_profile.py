@@ -0,0 +1,703 @@
+#!/usr/bin/env python3
+"""
+Machine profiles and a host model of the Marlin motion planner.
+
+A profile is read straight from a firmware tree's Configuration.h and
+Configuration_adv.h, so the model always uses the values that would be
+flashed. The planner follows Marlin 1.1 (planner.cpp): the same step
+rounding, MIN_STEPS_PER_SEGMENT dropping, SLOWDOWN, per-axis feedrate and
+acceleration limits, MAX_STEP_FREQUENCY cap, jerk junction speeds and
+look-ahead passes. DELTA moves are segmented like prepare_kinematic_move_to().
+
+The older 1.0.x planner (prusa_i3) is run through the same code with its
+own limits; its junction handling differs slightly, so treat its times as
+an approximation.
+
+Files are replayed through a read-only mmap (Replay.run_file): lines are
+parsed in place from the mapping, so memory use does not grow with the
+size of the file.
+"""
+
+import math
+import mmap
+import os
+import re
+import warnings
+from collections import deque
+
+TREES = ('dbot', 'kossel_800', 'ultimaker2_al', 'prusa_i3')
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+
+def tree_path(tree):
+  return os.path.join(ROOT, tree, 'Firmware', 'Marlin')
+
+
+#
+# Configuration.h reader
+#
+
+DIRECTIVE_RE = re.compile(r'^\s*#\s*(\w+)\s*(.*)$')
+DEFINE_RE = re.compile(r'^(\w+)(\([^)]*\))?\s*(.*)$')
+IDENT_RE = re.compile(r'\b[A-Za-z_]\w*\b')
+
+
+def strip_comments(text):
+  text = re.sub(r'/\*.*?\*/', ' ', text, flags=re.S)
+  return re.sub(r'//.*', '', text)
+
+
+class Config(object):
+  """Active #defines of a configuration, with #if blocks evaluated."""
+
+  def __init__(self):
+    self.defs = {}
+
+  def load(self, filename):
+    with open(filename, encoding='utf-8', errors='replace') as f:
+      lines = strip_comments(f.read()).splitlines()
+    stack = []  # (this branch active, some branch taken, parent active)
+    active = True
+    for line in lines:
+      m = DIRECTIVE_RE.match(line)
+      if not m:
+        continue
+      d, rest = m.group(1), m.group(2).strip()
+      if d in ('if', 'ifdef', 'ifndef'):
+        if d == 'ifdef':
+          cond = rest in self.defs
+        elif d == 'ifndef':
+          cond = rest not in self.defs
+        else:
+          cond = active and self.condition(rest)
+        stack.append((active and cond, cond, active))
+        active = active and cond
+      elif d == 'elif' and stack:
+        _, taken, parent = stack.pop()
+        cond = not taken and parent and self.condition(rest)
+        stack.append((cond, taken or cond, parent))
+        active = cond
+      elif d == 'else' and stack:
+        _, taken, parent = stack.pop()
+        stack.append((parent and not taken, True, parent))
+        active = parent and not taken
+      elif d == 'endif' and stack:
+        active = stack.pop()[2]
+      elif d == 'define' and active:
+        dm = DEFINE_RE.match(rest)
+        if dm and not dm.group(2):
+          self.defs[dm.group(1)] = dm.group(3).strip()
+      elif d == 'undef' and active:
+        self.defs.pop(rest, None)
+    return self
+
+  def enabled(self, name):
+    return name in self.defs
+
+  def expand(self, text, depth=0):
+    if depth > 20:
+      return text
+    def sub(m):
+      name = m.group(0)
+      if name in self.defs:
+        return '(' + self.expand(self.defs[name] or '1', depth + 1) + ')'
+      return name
+    return IDENT_RE.sub(sub, text)
+
+  def condition(self, text):
+    text = re.sub(r'\b(?:defined|ENABLED)\s*\(\s*(\w+)\s*\)|\bdefined\s+(\w+)',
+                  lambda m: '1' if (m.group(1) or m.group(2)) in self.defs else '0', text)
+    text = re.sub(r'\bDISABLED\s*\(\s*(\w+)\s*\)',
+                  lambda m: '0' if m.group(1) in self.defs else '1', text)
+    try:
+      return bool(self.eval(text, undefined=0))
+    except Exception:
+      return False
+
+  def eval(self, text, undefined=None):
+    expr = self.expand(text)
+    expr = expr.replace('&&', ' and ').replace('||', ' or ')
+    expr = re.sub(r'!(?!=)', ' not ', expr)
+    expr = expr.replace('{', '[').replace('}', ']')
+    expr = re.sub(r'(\d\.?\d*)[fFlLuU]+\b', r'\1', expr)
+    if undefined is not None:
+      expr = IDENT_RE.sub(lambda m: m.group(0) if m.group(0) in ('and', 'or', 'not') else str(undefined), expr)
+    with warnings.catch_warnings():
+      warnings.simplefilter('ignore')
+      return eval(expr, {'__builtins__': {}}, {})
+
+  def get(self, name, default=None):
+    if name not in self.defs:
+      return default
+    try:
+      return self.eval(self.defs[name])
+    except Exception:
+      return default
+
+
+#
+# Machine profile
+#
+
+class Machine(object):
+  """Kinematics and planner limits of one firmware tree."""
+
+  def __init__(self, tree, cfg):
+    self.name = tree
+    self.cfg = cfg
+    get = cfg.get
+    self.kinematics = 'delta' if cfg.enabled('DELTA') else 'corexy' if cfg.enabled('COREXY') else 'cartesian'
+    self.steps_per_mm = [float(v) for v in get('DEFAULT_AXIS_STEPS_PER_UNIT')[:4]]
+    self.max_feedrate = [float(v) for v in get('DEFAULT_MAX_FEEDRATE')[:4]]
+    self.max_acceleration = [float(v) for v in get('DEFAULT_MAX_ACCELERATION')[:4]]
+    self.acceleration = float(get('DEFAULT_ACCELERATION'))
+    self.retract_acceleration = float(get('DEFAULT_RETRACT_ACCELERATION', self.acceleration))
+    self.travel_acceleration = float(get('DEFAULT_TRAVEL_ACCELERATION', self.acceleration))
+    xy_jerk = get('DEFAULT_XYJERK', 20.0)
+    self.max_jerk = [float(get('DEFAULT_XJERK', xy_jerk)), float(get('DEFAULT_YJERK', xy_jerk)),
+                     float(get('DEFAULT_ZJERK', 0.4)), float(get('DEFAULT_EJERK', 5.0))]
+    self.min_feedrate = float(get('DEFAULT_MINIMUMFEEDRATE', 0.0))
+    self.min_travel_feedrate = float(get('DEFAULT_MINTRAVELFEEDRATE', 0.0))
+    self.min_segment_time = float(get('DEFAULT_MINSEGMENTTIME', 20000))
+    self.slowdown = cfg.enabled('SLOWDOWN')
+    self.minimum_planner_speed = float(get('MINIMUM_PLANNER_SPEED', 0.05))
+    self.min_steps_per_segment = int(get('MIN_STEPS_PER_SEGMENT', get('dropsegments', 6)))
+    self.block_buffer_size = int(get('BLOCK_BUFFER_SIZE', 16))
+    self.baudrate = int(get('BAUDRATE', 115200))
+    self.max_step_frequency = float(get('MAX_STEP_FREQUENCY', 40000))
+    self.arc_support = cfg.enabled('ARC_SUPPORT')
+    self.mm_per_arc_segment = float(get('MM_PER_ARC_SEGMENT', 1))
+    self.center = ((get('X_MIN_POS', 0) + get('X_MAX_POS', 200)) / 2.0,
+                   (get('Y_MIN_POS', 0) + get('Y_MAX_POS', 200)) / 2.0)
+    if self.kinematics == 'delta':
+      self.segments_per_second = float(get('DELTA_SEGMENTS_PER_SECOND', 200))
+      self.diagonal_rod = float(get('DELTA_DIAGONAL_ROD'))
+      radius = float(get('DELTA_RADIUS'))
+      self.towers = [(radius * math.cos(math.radians(a)), radius * math.sin(math.radians(a)))
+                     for a in (210, 330, 90)]
+
+  def motor_position(self, pos):
+    """Logical XYZ to the positions the planner steps (carriage heights on DELTA)."""
+    if self.kinematics == 'delta':
+      rod2 = self.diagonal_rod ** 2
+      return [pos[2] + math.sqrt(max(0.0, rod2 - (tx - pos[0]) ** 2 - (ty - pos[1]) ** 2))
+              for tx, ty in self.towers]
+    return list(pos[:3])
+
+
+def apply_settings(machine, lines):
+  """
+  Override the configuration with a printer's stored settings, given as
+  the output of M503 (M92, M203, M201, M204, M205 and M665 lines).
+  """
+  m = machine
+  for text in lines:
+    text = text.split(';', 1)[0].replace('echo:', '').strip().upper()
+    words = WORD_RE.findall(text)
+    if not words:
+      continue
+    code, args = words[0][0] + words[0][1], dict((k, float(v)) for k, v in words[1:])
+    axes = dict((a, i) for i, a in enumerate('XYZE'))
+    if code in ('M92', 'M203', 'M201'):
+      target = {'M92': m.steps_per_mm, 'M203': m.max_feedrate, 'M201': m.max_acceleration}[code]
+      for a, v in args.items():
+        if a in axes:
+          target[axes[a]] = v
+    elif code == 'M204':
+      if 'S' in args:
+        m.acceleration = m.travel_acceleration = args['S']
+      m.acceleration = args.get('P', m.acceleration)
+      m.retract_acceleration = args.get('R', m.retract_acceleration)
+      m.travel_acceleration = args.get('T', m.travel_acceleration)
+    elif code == 'M205':
+      m.min_feedrate = args.get('S', m.min_feedrate)
+      m.min_travel_feedrate = args.get('T', m.min_travel_feedrate)
+      if 'B' in args:
+        m.min_segment_time = args['B']
+      for a in 'XYZE':
+        if a in args:
+          m.max_jerk[axes[a]] = args[a]
+      if 'X' in args and 'Y' not in args:
+        m.max_jerk[1] = args['X']  # 1.0.x: X is the XY jerk
+    elif code == 'M665' and m.kinematics == 'delta':
+      m.diagonal_rod = args.get('L', m.diagonal_rod)
+      m.segments_per_second = args.get('S', m.segments_per_second)
+      if 'R' in args:
+        m.towers = [(args['R'] * math.cos(math.radians(a)), args['R'] * math.sin(math.radians(a)))
+                    for a in (210, 330, 90)]
+  return m
+
+
+def load_machine(tree, path=None):
+  path = path or tree_path(tree)
+  cfg = Config()
+  for name in ('Configuration.h', 'Configuration_adv.h'):
+    filename = os.path.join(path, name)
+    if os.path.exists(filename):
+      cfg.load(filename)
+  # 1.0.x keeps the drop threshold in a constant instead of a #define
+  if 'MIN_STEPS_PER_SEGMENT' not in cfg.defs:
+    with open(os.path.join(path, 'Configuration_adv.h'), encoding='utf-8', errors='replace') as f:
+      m = re.search(r'dropsegments\s*=\s*(\d+)', f.read())
+    if m:
+      cfg.defs['dropsegments'] = m.group(1)
+  # ...and always has G2/G3
+  if 'ARC_SUPPORT' not in cfg.defs and 'MM_PER_ARC_SEGMENT' in cfg.defs and 'N_ARC_CORRECTION' in cfg.defs:
+    with open(os.path.join(path, 'Configuration_adv.h'), encoding='utf-8', errors='replace') as f:
+      if 'ARC_SUPPORT' not in f.read():
+        cfg.defs['ARC_SUPPORT'] = ''
+  return Machine(tree, cfg)
+
+
+#
+# Planner model
+#
+
+def max_allowable_speed(accel, target_velocity, distance):
+  return math.sqrt(max(0.0, target_velocity * target_velocity - 2 * accel * distance))
+
+
+def trapezoid_time(length, v0, v1, vn, accel):
+  """Seconds to run a block entering at v0, cruising at vn, leaving at v1."""
+  if accel <= 0:
+    return length / vn
+  accel_dist = (vn * vn - v0 * v0) / (2 * accel)
+  decel_dist = (vn * vn - v1 * v1) / (2 * accel)
+  if accel_dist + decel_dist <= length:
+    return (vn - v0) / accel + (vn - v1) / accel + (length - accel_dist - decel_dist) / vn
+  peak = max(v0, v1, math.sqrt(max(0.0, (2 * accel * length + v0 * v0 + v1 * v1) / 2)))
+  return (2 * peak - v0 - v1) / accel
+
+
+class Block(object):
+  __slots__ = ('millimeters', 'nominal_speed', 'nominal_rate', 'acceleration', 'entry_speed',
+               'max_entry_speed', 'nominal_length', 'locked', 'step_event_count', 'line', 'tag')
+
+
+class Planner(object):
+  """
+  Block planning as done by Planner::_buffer_line(), plus a small
+  discrete-time model of the stepper draining the block buffer.
+
+  plan_us is the time the firmware spends planning one block and ik_us the
+  extra inverse kinematics time per DELTA segment. When baudrate is set,
+  every G-code line also costs its transfer time, the "ok" reply and the
+  host's turnaround (host_ms), as when streaming; set it to None to model
+  SD printing.
+  """
+
+  def __init__(self, machine, plan_us=700, ik_us=400, baudrate=None, host_ms=1.0):
+    self.m = machine
+    self.plan_s = plan_us * 1e-6
+    self.ik_s = ik_us * 1e-6 if machine.kinematics == 'delta' else 0.0
+    self.byte_s = 10.0 / baudrate if baudrate else 0.0
+    self.turnaround_s = (3 * self.byte_s + host_ms * 1e-3) if baudrate else 0.0
+    self.position = None           # planner position in steps (motors + E)
+    self.previous_speed = [0.0] * 4
+    self.previous_nominal_speed = 0.0
+    self.previous_safe_speed = 0.0
+    self.queue = deque()           # planned, not yet running
+    self.running = None            # block in the stepper
+    self.running_end = 0.0
+    self.now = 0.0                 # firmware clock
+    self.line_cost = 0.0
+    # Statistics
+    self.blocks = 0
+    self.starved = 0
+    self.capped = 0
+    self.peak_step_rate = 0.0
+    self.block_starts = []
+    self.input_done = False
+    # Set trace to a list to get (start, seconds, entry, exit, nominal, mm, tag, line)
+    # for every block as it runs; tag and line are copied from the planner when queued.
+    self.trace = None
+    self.tag = 0
+    self.line = 0
+
+  # Stepper side
+
+  def _start(self, t):
+    b = self.queue.popleft()
+    exit_speed = self.queue[0].entry_speed if self.queue else self.m.minimum_planner_speed
+    if self.queue:
+      self.queue[0].locked = True
+    self.running = b
+    seconds = trapezoid_time(b.millimeters, b.entry_speed, exit_speed, b.nominal_speed, b.acceleration)
+    self.running_end = t + seconds
+    self.block_starts.append(t)
+    if self.trace is not None:
+      self.trace.append((t, seconds, b.entry_speed, exit_speed, b.nominal_speed, b.millimeters, b.tag, b.line))
+
+  def _advance(self, t):
+    while self.running is not None and self.running_end <= t:
+      end = self.running_end
+      self.running = None
+      if self.queue:
+        self._start(end)
+      elif not self.input_done:
+        self.starved += 1
+
+  def moves_planned(self):
+    return len(self.queue) + (1 if self.running is not None else 0)
+
+  def synchronize(self):
+    while self.running is not None:
+      self.now = max(self.now, self.running_end)
+      self._advance(self.now)
+
+  def dwell(self, seconds):
+    self.synchronize()
+    self.now += seconds
+
+  def finish(self):
+    self.input_done = True
+    self.synchronize()
+    return self.now
+
+  # Planner side
+
+  def set_position(self, motor_pos, e):
+    m = self.m
+    self.position = [int(round(motor_pos[i] * m.steps_per_mm[i])) for i in range(3)]
+    self.position.append(int(round(e * m.steps_per_mm[3])))
+    self.previous_speed = [0.0] * 4
+    self.previous_nominal_speed = 0.0
+
+  def charge_line(self, nbytes):
+    """Account for receiving one G-code line of nbytes characters."""
+    self.line_cost = nbytes * self.byte_s + self.turnaround_s
+
+  def buffer_line(self, motor_pos, e, fr_mm_s):
+    m = self.m
+    target = [int(round(motor_pos[i] * m.steps_per_mm[i])) for i in range(3)]
+    target.append(int(round(e * m.steps_per_mm[3])))
+    if self.position is None:
+      self.position = target
+      return
+
+    # Wait for a free slot, as buffer_line() does
+    cost = self.plan_s + self.ik_s + self.line_cost
+    self.line_cost = 0.0
+    while self.moves_planned() >= m.block_buffer_size - 1:
+      self.now = max(self.now, self.running_end)
+      self._advance(self.now)
+    self.now += cost
+    self._advance(self.now)
+
+    da, db, dc, de = [target[i] - self.position[i] for i in range(4)]
+    if m.kinematics == 'corexy':
+      steps = [abs(da + db), abs(da - db), abs(dc), abs(de)]
+      head_mm = [da / m.steps_per_mm[0], db / m.steps_per_mm[1], dc / m.steps_per_mm[2]]
+      delta_mm = [(da + db) / m.steps_per_mm[0], (da - db) / m.steps_per_mm[1], head_mm[2]]
+    else:
+      steps = [abs(da), abs(db), abs(dc), abs(de)]
+      delta_mm = [da / m.steps_per_mm[0], db / m.steps_per_mm[1], dc / m.steps_per_mm[2]]
+      head_mm = delta_mm
+    delta_mm.append(de / m.steps_per_mm[3])
+
+    step_event_count = max(steps)
+    if step_event_count < m.min_steps_per_segment:
+      return
+    self.position = target
+
+    fr_mm_s = max(fr_mm_s, m.min_feedrate if de else m.min_travel_feedrate)
+    if max(steps[:3]) < m.min_steps_per_segment:
+      millimeters = abs(delta_mm[3])
+    else:
+      millimeters = math.sqrt(sum(v * v for v in head_mm))
+    inverse_mm_s = fr_mm_s / millimeters
+
+    moves_queued = self.moves_planned()
+    if m.slowdown and 1 < moves_queued < m.block_buffer_size // 2:
+      segment_time = round(1e6 / inverse_mm_s)
+      if segment_time < m.min_segment_time:
+        inverse_mm_s = 1e6 / (segment_time + round(2 * (m.min_segment_time - segment_time) / moves_queued))
+
+    nominal_speed = millimeters * inverse_mm_s
+    nominal_rate = math.ceil(step_event_count * inverse_mm_s)
+
+    current_speed = [d * inverse_mm_s for d in delta_mm]
+    speed_factor = 1.0
+    for i in range(4):
+      cs = abs(current_speed[i])
+      if cs > m.max_feedrate[i]:
+        speed_factor = min(speed_factor, m.max_feedrate[i] / cs)
+    if nominal_rate * speed_factor > m.max_step_frequency:
+      speed_factor = m.max_step_frequency / nominal_rate
+      self.capped += 1
+    if speed_factor < 1.0:
+      current_speed = [v * speed_factor for v in current_speed]
+      nominal_speed *= speed_factor
+      nominal_rate *= speed_factor
+    self.peak_step_rate = max(self.peak_step_rate, nominal_rate)
+
+    steps_per_mm = step_event_count / millimeters
+    if not any(steps[:3]):
+      accel = math.ceil(m.retract_acceleration * steps_per_mm)
+    else:
+      accel = math.ceil((m.acceleration if de else m.travel_acceleration) * steps_per_mm)
+      for i in range(4):
+        limit = m.max_acceleration[i] * m.steps_per_mm[i]
+        if steps[i] and limit < accel and accel * steps[i] > limit * step_event_count:
+          accel = limit * step_event_count / steps[i]
+    acceleration = accel / steps_per_mm
+
+    # Jerk: safe entry/exit speed and the junction with the previous block
+    safe_speed = nominal_speed
+    limited = False
+    for i in range(4):
+      jerk = abs(current_speed[i])
+      if jerk > m.max_jerk[i]:
+        if limited:
+          jerk *= safe_speed
+          mjerk = m.max_jerk[i] * nominal_speed
+          if jerk > mjerk:
+            safe_speed *= mjerk / jerk
+        else:
+          safe_speed = m.max_jerk[i]
+          limited = True
+
+    if moves_queued > 1 and self.previous_nominal_speed > 0.0001:
+      prev_larger = self.previous_nominal_speed > nominal_speed
+      smaller_factor = nominal_speed / self.previous_nominal_speed if prev_larger else self.previous_nominal_speed / nominal_speed
+      vmax_junction = nominal_speed if prev_larger else self.previous_nominal_speed
+      v_factor = 1.0
+      limited = False
+      for i in range(4):
+        v_exit, v_entry = self.previous_speed[i], current_speed[i]
+        if prev_larger:
+          v_exit *= smaller_factor
+        if limited:
+          v_exit *= v_factor
+          v_entry *= v_factor
+        if v_exit > v_entry:
+          jerk = (v_exit - v_entry) if (v_entry > 0 or v_exit < 0) else max(v_exit, -v_entry)
+        else:
+          jerk = (v_entry - v_exit) if (v_entry < 0 or v_exit > 0) else max(-v_exit, v_entry)
+        if jerk > m.max_jerk[i]:
+          v_factor *= m.max_jerk[i] / jerk
+          limited = True
+      if limited:
+        vmax_junction *= v_factor
+      threshold = vmax_junction * 0.99
+      if self.previous_safe_speed > threshold and safe_speed > threshold:
+        vmax_junction = safe_speed
+    else:
+      vmax_junction = safe_speed
+
+    b = Block()
+    b.millimeters = millimeters
+    b.nominal_speed = nominal_speed
+    b.nominal_rate = nominal_rate
+    b.acceleration = acceleration
+    b.step_event_count = step_event_count
+    b.tag = self.tag
+    b.line = self.line
+    b.max_entry_speed = vmax_junction
+    v_allowable = max_allowable_speed(-acceleration, m.minimum_planner_speed, millimeters)
+    b.entry_speed = min(vmax_junction, v_allowable)
+    b.nominal_length = nominal_speed <= v_allowable
+    b.locked = self.running is not None and not self.queue
+
+    self.previous_speed = current_speed
+    self.previous_nominal_speed = nominal_speed
+    self.previous_safe_speed = safe_speed
+
+    self.queue.append(b)
+    self.blocks += 1
+    self._recalculate()
+    if self.running is None:
+      self._start(self.now)
+
+  def _recalculate(self):
+    q = self.queue
+    # Reverse pass
+    for i in range(len(q) - 2, -1, -1):
+      cur, nxt = q[i], q[i + 1]
+      if cur.locked or cur.entry_speed == cur.max_entry_speed:
+        continue
+      if not cur.nominal_length and cur.max_entry_speed > nxt.entry_speed:
+        cur.entry_speed = min(cur.max_entry_speed, max_allowable_speed(-cur.acceleration, nxt.entry_speed, cur.millimeters))
+      else:
+        cur.entry_speed = cur.max_entry_speed
+    # Forward pass
+    for i in range(1, len(q)):
+      prev, cur = q[i - 1], q[i]
+      if not prev.nominal_length and prev.entry_speed < cur.entry_speed:
+        entry = min(cur.entry_speed, max_allowable_speed(-prev.acceleration, prev.entry_speed, prev.millimeters))
+        if entry < cur.entry_speed:
+          cur.entry_speed = entry
+
+
+#
+# G-code replay
+#
+
+WORD_RE = re.compile(r'([A-Z])\s*([-+]?[0-9]*\.?[0-9]+)')
+SPAN_WORD_RE = re.compile(rb'([A-Za-z])[ \t]*([-+]?[0-9]*\.?[0-9]+)')
+SPACE = b' \t\r'
+
+
+class Replay(object):
+  """Feeds G-code lines through a Planner, like the firmware's command loop."""
+
+  def __init__(self, planner):
+    self.p = planner
+    self.m = planner.m
+    self.pos = [self.m.center[0], self.m.center[1], 10.0, 0.0]
+    self.feedrate = 25.0
+    self.relative = False
+    self.relative_e = False
+    self.lines = 0
+    self.index = -1
+    self.layer_z = []              # Z of each layer, a layer starting at the first extrusion above the last
+    self.p.set_position(self.m.motor_position(self.pos), self.pos[3])
+
+  def line(self, text):
+    self.index += 1
+    self.p.line = self.index
+    text = text.split(';', 1)[0].strip().upper()
+    if not text:
+      return
+    self.lines += 1
+    self.p.charge_line(len(text) + 1)
+    words = WORD_RE.findall(text)
+    if words:
+      self.command(words[0][0] + str(int(float(words[0][1]))), dict((k, float(v)) for k, v in words[1:]))
+
+  def span(self, buf, start, end):
+    """Like line() for buf[start:end] of a bytes-like buffer, without copying the line out."""
+    self.index += 1
+    self.p.line = self.index
+    comment = buf.find(b';', start, end)
+    if comment >= 0:
+      end = comment
+    while start < end and buf[start] in SPACE:
+      start += 1
+    while end > start and buf[end - 1] in SPACE:
+      end -= 1
+    if start == end:
+      return
+    self.lines += 1
+    self.p.charge_line(end - start + 1)
+    words = SPAN_WORD_RE.findall(buf, start, end)
+    if words:
+      self.command(words[0][0].upper().decode() + str(int(float(words[0][1]))),
+                   dict((k.upper().decode(), float(v)) for k, v in words[1:]))
+
+  def command(self, code, args):
+    if code in ('G0', 'G1'):
+      self.move(args)
+    elif code in ('G2', 'G3') and self.m.arc_support:
+      self.arc(args, code == 'G2')
+    elif code == 'G4':
+      self.p.dwell(args.get('P', 0) / 1000.0 + args.get('S', 0))
+    elif code == 'G28':
+      self.p.synchronize()
+      self.pos[:3] = [self.m.center[0], self.m.center[1], 10.0]
+      self.p.set_position(self.m.motor_position(self.pos), self.pos[3])
+    elif code == 'G90':
+      self.relative = self.relative_e = False
+    elif code == 'G91':
+      self.relative = self.relative_e = True
+    elif code == 'M82':
+      self.relative_e = False
+    elif code == 'M83':
+      self.relative_e = True
+    elif code == 'G92':
+      for i, axis in enumerate('XYZE'):
+        if axis in args:
+          self.pos[i] = args[axis]
+      self.p.set_position(self.m.motor_position(self.pos), self.pos[3])
+    elif code == 'M400':
+      self.p.synchronize()
+
+  def destination(self, args):
+    if 'F' in args:
+      self.feedrate = args['F'] / 60.0
+    target = list(self.pos)
+    for i, axis in enumerate('XYZE'):
+      if axis in args:
+        rel = self.relative_e if axis == 'E' else self.relative
+        target[i] = self.pos[i] + args[axis] if rel else args[axis]
+    if target[3] > self.pos[3] and (not self.layer_z or target[2] > self.layer_z[-1] + 0.0001):
+      self.layer_z.append(target[2])
+      self.p.tag = len(self.layer_z) - 1
+    return target
+
+  def arc(self, args, clockwise):
+    """G2/G3 with I J or R, cut into MM_PER_ARC_SEGMENT chords like plan_arc()"""
+    target = self.destination(args)
+    x1, y1 = self.pos[0], self.pos[1]
+    if 'R' in args:
+      r, x2, y2 = args['R'], target[0], target[1]
+      if not r or (x1 == x2 and y1 == y2):
+        return
+      e = -1 if clockwise ^ (r < 0) else 1
+      dx, dy = x2 - x1, y2 - y1
+      d = math.hypot(dx, dy)
+      h = math.sqrt(max(0.0, r * r - d * d / 4))
+      i, j = (x1 + x2) / 2 - e * h * dy / d - x1, (y1 + y2) / 2 + e * h * dx / d - y1
+    else:
+      i, j = args.get('I', 0.0), args.get('J', 0.0)
+    if not i and not j:
+      return
+    radius = math.hypot(i, j)
+    cx, cy = x1 + i, y1 + j
+    rx, ry, tx, ty = -i, -j, target[0] - cx, target[1] - cy
+    angular = math.atan2(rx * ty - ry * tx, rx * tx + ry * ty)
+    if angular < 0:
+      angular += 2 * math.pi
+    if clockwise:
+      angular -= 2 * math.pi
+    if angular == 0 and x1 == target[0] and y1 == target[1]:
+      angular = 2 * math.pi
+    linear = target[2] - self.pos[2]
+    mm_of_travel = math.hypot(angular * radius, abs(linear))
+    if mm_of_travel < 0.001:
+      return
+    segments = max(1, int(mm_of_travel / self.m.mm_per_arc_segment))
+    start = list(self.pos)
+    for s in range(1, segments):
+      a = angular * s / segments
+      seg = [cx + rx * math.cos(a) - ry * math.sin(a), cy + rx * math.sin(a) + ry * math.cos(a),
+             start[2] + linear * s / segments, start[3] + (target[3] - start[3]) * s / segments]
+      self.p.buffer_line(self.m.motor_position(seg), seg[3], self.feedrate)
+    self.p.buffer_line(self.m.motor_position(target), target[3], self.feedrate)
+    self.pos = target
+
+  def move(self, args):
+    target = self.destination(args)
+    if self.m.kinematics == 'delta' and (target[0] != self.pos[0] or target[1] != self.pos[1]):
+      diff = [target[i] - self.pos[i] for i in range(4)]
+      cartesian_mm = math.sqrt(diff[0] ** 2 + diff[1] ** 2 + diff[2] ** 2) or abs(diff[3])
+      segments = max(1, int(self.m.segments_per_second * cartesian_mm / self.feedrate))
+      for s in range(1, segments + 1):
+        seg = [self.pos[i] + diff[i] * s / segments for i in range(4)]
+        self.p.buffer_line(self.m.motor_position(seg), seg[3], self.feedrate)
+    else:
+      self.p.buffer_line(self.m.motor_position(target), target[3], self.feedrate)
+    self.pos = target
+
+  def run(self, lines):
+    for text in lines:
+      self.line(text)
+    return self.p.finish()
+
+  def run_file(self, filename):
+    """
+    Replay a G-code file through a read-only mapping of it. Lines are
+    parsed in place, so files of any size run in constant memory.
+    """
+    with open(filename, 'rb') as f:
+      if not os.fstat(f.fileno()).st_size:
+        return self.p.finish()
+      with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        size, start = len(data), 0
+        while start < size:
+          end = data.find(b'\n', start)
+          if end < 0:
+            end = size
+          self.span(data, start, end)
+          start = end + 1
+    return self.p.finish()
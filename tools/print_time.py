@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Print time estimate of a G-code file for one of the machines.
+
+The file runs through the same planner model as profile_bench.py, so
+acceleration, jerk, look-ahead and DELTA segmentation are accounted for
+the way the firmware plans them. Settings come from the tree's
+Configuration.h, optionally overridden by the printer's EEPROM values
+saved from M503.
+
+  tools/print_time.py -t ultimaker2_al part.gcode
+  tools/print_time.py -t kossel_800 --m503 k800.txt --layers part.gcode
+  tools/print_time.py -t kossel_800 --profile speed.csv part.gcode
+  tools/print_time.py -t kossel_800 --annotate part_eta.gcode part.gcode
+
+--annotate writes a copy of the file with "M73 P<percent> R<minutes>"
+marks, which firmware built with SD_PRINT_TIME_ESTIMATE shows on the LCD
+and reports with M27 while printing from SD.
+"""
+
+import argparse
+import sys
+
+from marlin_profile import TREES, apply_settings, load_machine, Planner, Replay
+
+
+def hms(seconds):
+  seconds = int(round(seconds))
+  return '%d:%02d:%02d' % (seconds // 3600, seconds // 60 % 60, seconds % 60)
+
+
+def estimate(machine, filename, args):
+  planner = Planner(machine, args.plan_us, args.ik_us, machine.baudrate if args.stream else None)
+  planner.trace = []
+  replay = Replay(planner)
+  total = replay.run_file(filename)
+  return total, planner, replay
+
+
+def layer_times(trace, total):
+  """Seconds per layer, from the start of its first block to the start of the next layer."""
+  starts = {}
+  for t, _, _, _, _, _, tag, _ in trace:
+    starts.setdefault(tag, t)
+  tags = sorted(starts)
+  return [(tag, (starts[tags[i + 1]] if i + 1 < len(tags) else total) - starts[tag]) for i, tag in enumerate(tags)]
+
+
+def annotate(lines, trace, total, out):
+  """Copy lines (any iterable) to out with M73 marks where the percentage or the minutes left change."""
+  marks, last = {}, None
+  for t, _, _, _, _, _, _, line in trace:
+    mark = (int(100 * t / total) if total else 100, int((total - t) / 60 + 0.5))
+    if mark != last and line not in marks:
+      marks[line] = mark
+      last = mark
+  for i, text in enumerate(lines):
+    if i in marks:
+      out.write('M73 P%d R%d\n' % marks[i])
+    out.write(text.rstrip('\r\n') + '\n')
+  out.write('M73 P100 R0\n')
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+  parser.add_argument('gcode')
+  parser.add_argument('-t', '--tree', choices=TREES, required=True)
+  parser.add_argument('--m503', help='file with the printer\'s M503 output')
+  parser.add_argument('--layers', action='store_true', help='print the time of every layer')
+  parser.add_argument('--profile', metavar='CSV', help='write the velocity profile of every block')
+  parser.add_argument('--annotate', metavar='OUT', help='write a copy with M73 progress marks')
+  parser.add_argument('--stream', action='store_true', help='streamed over serial instead of printed from SD')
+  parser.add_argument('--plan-us', type=float, default=700, help='firmware time to plan one block (us)')
+  parser.add_argument('--ik-us', type=float, default=400, help='extra DELTA kinematics time per segment (us)')
+  args = parser.parse_args(argv)
+
+  machine = load_machine(args.tree)
+  if args.m503:
+    with open(args.m503, encoding='utf-8', errors='replace') as f:
+      apply_settings(machine, f.read().splitlines())
+  total, planner, replay = estimate(machine, args.gcode, args)
+  trace = planner.trace
+
+  print('%s on %s: %s (%d layers, %d blocks, %d buffer stalls)' %
+        (args.gcode, machine.name, hms(total), len(replay.layer_z), planner.blocks, planner.starved))
+
+  if args.layers:
+    elapsed = 0.0
+    print('%6s %8s %9s %9s' % ('layer', 'z', 'time', 'elapsed'))
+    for tag, seconds in layer_times(trace, total):
+      elapsed += seconds
+      z = replay.layer_z[tag] if tag < len(replay.layer_z) else 0.0
+      print('%6d %8.2f %9s %9s' % (tag, z, hms(seconds), hms(elapsed)))
+
+  if args.profile:
+    with open(args.profile, 'w') as f:
+      f.write('start_s,seconds,layer,line,mm,entry_mm_s,nominal_mm_s,exit_mm_s\n')
+      for t, seconds, entry, exit_speed, nominal, mm, tag, line in trace:
+        f.write('%.4f,%.5f,%d,%d,%.4f,%.2f,%.2f,%.2f\n' % (t, seconds, tag, line + 1, mm, entry, nominal, exit_speed))
+
+  if args.annotate:
+    with open(args.gcode, encoding='utf-8', errors='replace', newline='') as src, open(args.annotate, 'w') as f:
+      annotate(src, trace, total, f)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""
+Benchmark matrix of the machine profiles in this repository.
+
+Replays a fixed G-code corpus through the motion core of every firmware
+tree and reports per machine and job:
+
+  blocks     Planner blocks queued (after DELTA segmentation and dropping)
+  blk/s      Average and peak (1 s window) blocks the planner must supply
+  starved    Times the stepper drained the block buffer mid-print
+  time       Estimated print time, stalls included
+  peak step  Highest nominal step rate, '*' when MAX_STEP_FREQUENCY capped it
+
+The 1.1.0-RC8 trees (kossel_800, ultimaker2_al) run their own firmware:
+tools/host is built with the tree's Configuration.h and
+Configuration_adv.h, and each job goes through the real parser, planner
+and stepper interrupt on the free running clock (marlin_host -s 0 -g, see
+tools/host/replay.cpp). dbot (RC7) and prusa_i3 (1.0.x) don't build on the
+host; they run on the planner model of marlin_profile.py, as does every
+tree with --model. The 'replay' column tells which.
+
+Run it before and after a configuration change and compare, e.g.
+
+  tools/profile_bench.py                      all trees, built-in corpus
+  tools/profile_bench.py -t kossel_800 -g part.gcode
+  tools/profile_bench.py --sd --csv > after.csv
+
+Every --set adds a variant of each machine with those settings given as
+M503 style lines (see print_time.py --m503), so one run sweeps a
+parameter. The firmware takes them as commands ahead of the job:
+
+  tools/profile_bench.py -t kossel_800 --set 'M204 P1000' --set 'M204 P3000'
+
+The host plans for free, so the AVR's time per block (--plan-us, plus
+--ik-us per DELTA segment) and the streaming of each line at the tree's
+BAUDRATE (unless --sd) are charged to the clock of either replay.
+
+Each machine and job gets its own replay, so -j runs them in parallel:
+the firmware ones on the threads of tools/host/marlin_pool, each in its own
+copy of the firmware, the model ones in processes.
+
+Usage: profile_bench.py [-t TREE]... [-g GCODE]... [--set LINES]... [-j N] [--sd] [--model] [--plan-us N] [--ik-us N] [--host-ms N] [--csv]
+"""
+
+import argparse
+import copy
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ProcessPoolExecutor
+
+from marlin_profile import ROOT, TREES, apply_settings, load_machine, Planner, Replay
+
+HOST = os.path.join(ROOT, 'tools', 'host')
+HOST_TREES = ('kossel_800', 'ultimaker2_al')
+SUMMARY_RE = re.compile(r'replay: (\d+) lines, (\d+) blocks, ([\d.]+) s simulated.*\n'
+                        r'replay: (\d+) blocks/s peak, (\d+) starved, (\d+) steps/s peak, (\d+) capped')
+
+FILAMENT_AREA = math.pi * 0.875 ** 2  # 1.75 mm filament
+
+
+def extrusion(length, layer=0.2, width=0.4):
+  return length * layer * width / FILAMENT_AREA
+
+
+def polygon(points, z, feedrate, lines, e):
+  """Travel to the first point, then extrude around a closed polygon."""
+  lines.append('G1 Z%.2f F1200' % z)
+  lines.append('G1 X%.3f Y%.3f F9000' % points[0])
+  last = points[0]
+  for p in points[1:] + points[:1]:
+    e += extrusion(math.hypot(p[0] - last[0], p[1] - last[1]))
+    lines.append('G1 X%.3f Y%.3f E%.5f F%d' % (p[0], p[1], e, feedrate))
+    last = p
+  return e
+
+
+def circle(cx, cy, r, segment):
+  n = max(8, int(2 * math.pi * r / segment))
+  return [(cx + r * math.cos(2 * math.pi * i / n), cy + r * math.sin(2 * math.pi * i / n)) for i in range(n)]
+
+
+def corpus(center):
+  """The fixed jobs, centered on the bed. Deterministic so results compare."""
+  cx, cy = center
+  jobs = []
+
+  lines, e = ['G90', 'M82', 'G92 E0'], 0.0
+  for layer in range(20):
+    for inset in range(3):
+      h = 20 - inset * 0.4
+      e = polygon([(cx - h, cy - h), (cx + h, cy - h), (cx + h, cy + h), (cx - h, cy + h)],
+                  0.2 * (layer + 1), 2400, lines, e)
+  jobs.append(('perimeters', lines))
+
+  lines, e = ['G90', 'M82', 'G92 E0'], 0.0
+  for layer in range(10):
+    e = polygon(circle(cx, cy, 25, 1.0), 0.2 * (layer + 1), 2400, lines, e)
+    e = polygon(circle(cx, cy, 4, 0.2), 0.2 * (layer + 1), 1200, lines, e)
+  jobs.append(('arcs', lines))
+
+  lines, e = ['G90', 'M83', 'G1 Z0.2 F1200'], 0.0
+  for layer in range(3):
+    y = cy - 20
+    lines.append('G1 X%.3f Y%.3f F9000' % (cx - 20, y))
+    row = 0
+    while y < cy + 20:
+      x = cx + 20 if row % 2 == 0 else cx - 20
+      lines.append('G1 X%.3f Y%.3f E%.5f F3600' % (x, y, extrusion(40)))
+      y += 0.4
+      lines.append('G1 X%.3f Y%.3f E%.5f F3600' % (x, y, extrusion(0.4)))
+      row += 1
+    lines.append('G1 Z%.2f F1200' % (0.2 * (layer + 2)))
+  jobs.append(('infill', lines))
+
+  lines, seed = ['G90', 'M83', 'G1 Z0.3 F1200'], 1
+  for i in range(200):
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff
+    x = cx - 30 + (seed % 6000) / 100.0
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff
+    y = cy - 30 + (seed % 6000) / 100.0
+    lines += ['G1 E-4 F2400', 'G1 X%.2f Y%.2f F9000' % (x, y), 'G1 E4 F2400',
+              'G1 X%.2f Y%.2f E%.5f F1800' % (x + 2, y, extrusion(2))]
+  jobs.append(('travel', lines))
+
+  return jobs
+
+
+def host_build(tree):
+  """Make marlin_pool of the tree if it is out of date."""
+  proc = subprocess.run(['make', '-s', '-C', HOST, 'TREE=' + tree, 'pool'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+  if proc.returncode:
+    sys.exit('%s\nprofile_bench.py: the host build of %s failed' % (proc.stdout.decode(errors='replace'), tree))
+
+
+def bench_firmware(tasks, args):
+  """
+  The tasks of one tree through its firmware, each in its own copy of it
+  on marlin_pool's threads; settings are the --set lines.
+  """
+  machine = tasks[0][0]
+  plan_us = args.plan_us + (args.ik_us if machine.kinematics == 'delta' else 0)
+  costs = 'plan=%g,baud=%d,turnaround=%g' % (plan_us, 0 if args.sd else machine.baudrate, args.host_ms)
+  with tempfile.TemporaryDirectory() as tmp:
+    filenames, headers = [], []
+    for i, (m, settings, name, job, _) in enumerate(tasks):
+      header = ['M302 S0'] + settings   # The corpus extrudes cold
+      filenames.append(os.path.join(tmp, '%d.gcode' % i))
+      headers.append(len(header))
+      with open(filenames[-1], 'wb') as f:
+        f.write(('\n'.join(header) + '\n').encode())
+        if isinstance(job, str):
+          with open(job, 'rb') as source:
+            shutil.copyfileobj(source, f)
+        else:
+          f.write(('\n'.join(job) + '\n').encode())
+    pool = [os.path.join(HOST, 'build', machine.tree, 'marlin_pool'), '-m', costs] + (['-j', str(args.jobs)] if args.jobs else [])
+    output = subprocess.run(pool + filenames, stdout=subprocess.PIPE).stdout.decode(errors='replace')
+
+  # Each file's name, then its summary
+  reports = re.split('^(%s)$' % '|'.join(re.escape(f) for f in filenames), output, flags=re.M)[1:]
+  reports = dict(zip(reports[0::2], reports[1::2]))
+  results = []
+  for (m, settings, name, job, _), filename, header in zip(tasks, filenames, headers):
+    summary = reports.get(filename, '')
+    found = SUMMARY_RE.search(summary)
+    if not found:
+      raise RuntimeError('%s %s: %s' % (m.name, name, summary.strip() or 'no summary'))
+    lines, blocks, seconds, peak, starved, peak_step_rate, capped = [float(v) if '.' in v else int(v) for v in found.groups()]
+    results.append({
+      'machine': m.name, 'kinematics': m.kinematics, 'replay': 'firmware', 'job': name,
+      'lines': lines - header, 'blocks': blocks,
+      'avg_bps': blocks / seconds if seconds else 0.0, 'peak_bps': peak,
+      'starved': starved, 'seconds': seconds,
+      'peak_step_rate': peak_step_rate, 'capped': capped
+    })
+  return results
+
+
+def bench(machine, settings, name, job, args):
+  """On the model; job is a list of lines or the name of a G-code file."""
+  planner = Planner(machine, args.plan_us, args.ik_us, None if args.sd else machine.baudrate, args.host_ms)
+  replay = Replay(planner)
+  seconds = replay.run_file(job) if isinstance(job, str) else replay.run(job)
+  starts, peak, lo = planner.block_starts, 0, 0
+  for hi in range(len(starts)):
+    while starts[hi] - starts[lo] > 1.0:
+      lo += 1
+    peak = max(peak, hi - lo + 1)
+  return {
+    'machine': machine.name, 'kinematics': machine.kinematics, 'replay': 'model', 'job': name,
+    'lines': replay.lines, 'blocks': planner.blocks,
+    'avg_bps': planner.blocks / seconds if seconds else 0.0, 'peak_bps': peak,
+    'starved': planner.starved, 'seconds': seconds,
+    'peak_step_rate': planner.peak_step_rate, 'capped': planner.capped
+  }
+
+
+def bench_task(task):
+  return bench(*task)
+
+
+def variants(tree, settings):
+  """(machine, --set lines): the machine as configured, then one copy per --set."""
+  machine = load_machine(tree)
+  machine.tree = tree
+  machines = [(machine, [])]
+  for text in settings:
+    lines = [l.strip() for l in text.split(';')]
+    variant = apply_settings(copy.deepcopy(machine), lines)
+    variant.name = '%s %s' % (tree, text)
+    machines.append((variant, lines))
+  return machines
+
+
+def hms(seconds):
+  seconds = int(round(seconds))
+  return '%d:%02d:%02d' % (seconds // 3600, seconds // 60 % 60, seconds % 60)
+
+
+def report(rows, csv):
+  keys = ('machine', 'kinematics', 'replay', 'job', 'lines', 'blocks', 'avg_bps', 'peak_bps', 'starved', 'seconds', 'peak_step_rate', 'capped')
+  if csv:
+    print(','.join(keys))
+    for r in rows:
+      print(','.join(('%.1f' % r[k]) if isinstance(r[k], float) else str(r[k]) for k in keys))
+    return
+  width = max([14] + [len(r['machine']) for r in rows])
+  print('%-*s %-10s %-8s %-11s %7s %7s %6s %8s %9s %11s' %
+        (width, 'machine', 'kinematics', 'replay', 'job', 'blocks', 'blk/s', 'peak', 'starved', 'time', 'peak step'))
+  for r in rows:
+    print('%-*s %-10s %-8s %-11s %7d %7.1f %6d %8d %9s %10d%s' %
+          (width, r['machine'], r['kinematics'], r['replay'], r['job'], r['blocks'], r['avg_bps'], r['peak_bps'],
+           r['starved'], hms(r['seconds']), r['peak_step_rate'], '*' if r['capped'] else ' '))
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[1].strip())
+  parser.add_argument('-t', '--tree', action='append', choices=TREES, help='firmware tree (default: all)')
+  parser.add_argument('-g', '--gcode', action='append', default=[], help='G-code file to add to the corpus')
+  parser.add_argument('--set', action='append', default=[], metavar='LINES',
+                      help='also bench each machine with these M503 style settings (\';\' separates lines)')
+  parser.add_argument('-j', '--jobs', type=int, default=1, help='parallel replays (0: one per CPU)')
+  parser.add_argument('--sd', action='store_true', help='print from SD: no serial transfer time')
+  parser.add_argument('--model', action='store_true', help='run the RC8 trees on the planner model too')
+  parser.add_argument('--plan-us', type=float, default=700, help='firmware time to plan one block (us)')
+  parser.add_argument('--ik-us', type=float, default=400, help='extra DELTA kinematics time per segment (us)')
+  parser.add_argument('--host-ms', type=float, default=1.0, help='host turnaround per line when streaming (ms)')
+  parser.add_argument('--csv', action='store_true', help='machine readable output')
+  args = parser.parse_args(argv)
+
+  files = [(os.path.basename(filename), filename) for filename in args.gcode]
+
+  trees = args.tree or TREES
+  firmware = [] if args.model else [tree for tree in trees if tree in HOST_TREES]
+  for tree in firmware:
+    host_build(tree)
+  machines = [m for tree in trees for m in variants(tree, args.set)]
+  tasks = [[(m, settings, name, job, args) for name, job in corpus(m.center) + files] for m, settings in machines]
+  flat = [t for machine_tasks in tasks for t in machine_tasks]
+  results = [None] * len(flat)
+  for tree in firmware:
+    index = [i for i, t in enumerate(flat) if t[0].tree == tree]
+    for i, r in zip(index, bench_firmware([flat[i] for i in index], args)):
+      results[i] = r
+  index = [i for i, r in enumerate(results) if r is None]
+  if args.jobs == 1:
+    model = [bench_task(flat[i]) for i in index]
+  else:
+    with ProcessPoolExecutor(args.jobs or None) as pool:
+      model = list(pool.map(bench_task, [flat[i] for i in index]))
+  for i, r in zip(index, model):
+    results[i] = r
+
+  rows = []
+  for machine_tasks in tasks:
+    machine_rows, results = results[:len(machine_tasks)], results[len(machine_tasks):]
+    total = dict(machine_rows[0], job='total')
+    for k in ('lines', 'blocks', 'starved', 'seconds', 'capped'):
+      total[k] = sum(r[k] for r in machine_rows)
+    total['avg_bps'] = total['blocks'] / total['seconds'] if total['seconds'] else 0.0
+    for k in ('peak_bps', 'peak_step_rate'):
+      total[k] = max(r[k] for r in machine_rows)
+    rows += machine_rows + [total]
+  report(rows, args.csv)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+"""
+Send a file to the printer's SD card with the binary transfer of M1002.
+
+The file goes in packets with a CRC32, several on their way at once and
+optionally LZ compressed, instead of one G-code line per "ok". Needs
+firmware built with BINARY_FILE_TRANSFER (M115 reports
+Cap:BINARY_FILE_TRANSFER:1); the protocol is described in the firmware's
+file_transfer.h. Linux only, nothing else may use the port meanwhile.
+
+  tools/sd_upload.py -p /dev/ttyACM0 part.gcode
+  tools/sd_upload.py -p /dev/ttyUSB0 -b 250000 --lz --name /jobs/part.gco part.gcode
+"""
+
+import argparse
+import array
+import fcntl
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+import zlib
+
+SYNC = 0xA5
+FLAG_LZ = 1
+MIN_MATCH, MAX_MATCH, WINDOW = 3, 258, 256
+
+
+def open_port(port, baud):
+  fd = os.open(port, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+  tty.setraw(fd)
+  attrs = termios.tcgetattr(fd)
+  attrs[2] |= termios.CLOCAL | termios.CREAD
+  attrs[2] &= ~termios.HUPCL
+  speed = getattr(termios, 'B%d' % baud, None)
+  if speed is not None:
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+  else:
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    set_custom_baud(fd, baud)
+  termios.tcflush(fd, termios.TCIOFLUSH)
+  return fd
+
+
+def set_custom_baud(fd, baud):
+  """Rates like 250000 that have no B constant, through struct termios2."""
+  TCGETS2, TCSETS2, BOTHER, CBAUD = 0x802C542A, 0x402C542B, 0o010000, 0o010017
+  buf = array.array('I', [0] * 64)
+  fcntl.ioctl(fd, TCGETS2, buf)
+  buf[2] = (buf[2] & ~CBAUD) | BOTHER  # c_cflag
+  buf[9] = buf[10] = baud              # c_ispeed, c_ospeed after c_line and c_cc[19]
+  fcntl.ioctl(fd, TCSETS2, buf)
+
+
+class Link:
+  """Lines from the printer and raw bytes to it."""
+
+  def __init__(self, fd, verbose):
+    self.fd, self.verbose, self.pending = fd, verbose, b''
+
+  def write(self, data):
+    while data:
+      select.select([], [self.fd], [])
+      try:
+        data = data[os.write(self.fd, data):]
+      except BlockingIOError:
+        pass
+
+  def line(self, timeout):
+    """The next line from the printer, or None after timeout seconds."""
+    end = time.monotonic() + timeout
+    while b'\n' not in self.pending:
+      left = end - time.monotonic()
+      if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+        return None
+      try:
+        self.pending += os.read(self.fd, 4096)
+      except BlockingIOError:
+        pass
+    text, self.pending = self.pending.split(b'\n', 1)
+    text = text.decode('ascii', 'replace').strip()
+    if self.verbose:
+      print('<', text, file=sys.stderr)
+    return text
+
+  def command(self, gcode, want=None, timeout=5.0):
+    """Send a G-code line, return the lines up to 'ok' (or up to one starting with want)."""
+    self.write(gcode.encode('ascii') + b'\n')
+    lines = []
+    while True:
+      text = self.line(timeout)
+      if text is None:
+        raise SystemExit('no answer to %s' % gcode)
+      lines.append(text)
+      if want and text.startswith(want) or not want and text.startswith('ok'):
+        return lines
+
+
+def compress(data, chunk):
+  """LZ payloads of whole flag groups, each at most chunk bytes (see file_transfer.h)."""
+  payloads, payload, flag_at, items = [], bytearray(), 0, 8
+  heads = {}
+  i, n = 0, len(data)
+  while i < n:
+    best, dist = 0, 0
+    if i + MIN_MATCH <= n:
+      key = data[i:i + MIN_MATCH]
+      limit = min(MAX_MATCH, n - i)
+      for j in reversed(heads.get(key, ())):
+        if i - j > WINDOW:
+          break
+        k = MIN_MATCH
+        while k < limit and data[j + k] == data[i + k]:
+          k += 1
+        if k > best:
+          best, dist = k, i - j
+          if k == limit:
+            break
+    item = bytes((dist - 1, best - MIN_MATCH)) if best else data[i:i + 1]
+    if len(payload) + (items == 8) + len(item) > chunk:
+      payloads.append(bytes(payload))
+      payload, items = bytearray(), 8
+    if items == 8:
+      flag_at, items = len(payload), 0
+      payload.append(0)
+    if best:
+      payload[flag_at] |= 1 << items
+    payload += item
+    items += 1
+    for p in range(i, i + (best or 1)):
+      if p + MIN_MATCH <= n:
+        chain = heads.setdefault(data[p:p + MIN_MATCH], [])
+        chain.append(p)
+        if len(chain) > 16:
+          del chain[0]
+    i += best or 1
+  if payload:
+    payloads.append(bytes(payload))
+  return payloads
+
+
+def packet(kind, seq, payload=b''):
+  body = bytes((ord(kind), seq & 0xFF, len(payload))) + payload
+  return bytes((SYNC,)) + body + struct.pack('<I', zlib.crc32(body))
+
+
+def find(seq, first, end):
+  """Index of the packet with this seq among those in flight."""
+  for k in range(first, end):
+    if k & 0xFF == seq:
+      return k
+  return None
+
+
+def wait_sync(link, timeout):
+  """After resend or error the printer drains its input, then says "BFT sync"."""
+  while True:
+    text = link.line(timeout)
+    if text is None or text.startswith('BFT sync'):
+      return
+
+
+def transfer(link, packets, window, timeout):
+  """Send packets with at most window bytes unacknowledged. Returns the final reply."""
+  base = sent = 0   # first unacknowledged, next to send
+  flight = 0        # bytes sent and not acknowledged
+  last = time.monotonic()
+  while True:
+    while sent < len(packets) - 1 and (flight == 0 or flight + len(packets[sent]) <= window):
+      link.write(packets[sent])
+      flight += len(packets[sent])
+      sent += 1
+    if base == len(packets) - 1 and sent == base:
+      link.write(packets[sent])  # Close once all data is in
+      flight += len(packets[sent])
+      sent += 1
+    text = link.line(0.05)
+    if text is None:
+      if time.monotonic() - last > timeout:  # Packets or acks lost: go back
+        sent, flight, last = base, 0, time.monotonic()
+      continue
+    if text.startswith('BFT ack:'):
+      k = find(int(text[8:]), base, sent)
+      if k is not None:
+        base = k + 1
+        flight = sum(len(p) for p in packets[base:sent])
+        last = time.monotonic()
+    elif text.startswith('BFT resend:'):
+      k = find(int(text[11:]), base, sent)
+      if k is not None:
+        base = k
+      wait_sync(link, timeout)  # The printer skips what is still on its way
+      sent, flight, last = base, 0, time.monotonic()
+    elif text.startswith('BFT error:'):
+      wait_sync(link, timeout)
+      return text
+    elif text.startswith('BFT done'):
+      return text
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+  parser.add_argument('file')
+  parser.add_argument('-p', '--port', required=True, help='serial device of the printer')
+  parser.add_argument('-b', '--baud', type=int, default=115200)
+  parser.add_argument('--name', help='path on the card (default: the file name in lower case)')
+  parser.add_argument('--lz', action='store_true', help='compress, if the firmware accepts it')
+  parser.add_argument('--timeout', type=float, default=2.0, help='seconds without an ack before sending again')
+  parser.add_argument('-v', '--verbose', action='store_true', help='show the printer\'s replies')
+  args = parser.parse_args(argv)
+
+  with open(args.file, 'rb') as f:
+    data = f.read()
+  name = args.name or os.path.basename(args.file).lower()
+
+  link = Link(open_port(args.port, args.baud), args.verbose)
+  if not any(l.startswith('Cap:BINARY_FILE_TRANSFER:1') for l in link.command('M115')):
+    raise SystemExit('the firmware has no BINARY_FILE_TRANSFER')
+  ready = link.command('M1002', 'BFT:')[-1]
+  info = dict(field.split(':') for field in ready.split()[1:])
+  window, chunk, lz = int(info['window']), int(info['chunk']), args.lz and info.get('lz') == '1'
+  if args.lz and not lz:
+    print('the firmware takes no LZ data, sending it plain', file=sys.stderr)
+
+  start = time.monotonic()
+  payloads = compress(data, chunk) if lz else [data[i:i + chunk] for i in range(0, len(data), chunk)]
+  packets = [packet('O', 0, struct.pack('<IB', len(data), FLAG_LZ if lz else 0) + name.encode('ascii'))]
+  packets += [packet('D', seq, p) for seq, p in enumerate(payloads, 1)]
+  packets.append(packet('C', len(packets), struct.pack('<I', zlib.crc32(data))))
+
+  try:
+    result = transfer(link, packets, window, args.timeout)
+  except KeyboardInterrupt:
+    link.write(packet('A', 0))
+    wait_sync(link, args.timeout)
+    raise SystemExit('aborted')
+  while True:  # The "ok" of M1002
+    text = link.line(args.timeout)
+    if text is None or text.startswith('ok'):
+      break
+  seconds = time.monotonic() - start
+  wire = sum(len(p) for p in packets)
+  print('%s -> %s: %s, %d bytes (%d on the wire) in %.1f s, %.0f bytes/s' %
+        (args.file, name, result, len(data), wire, seconds, len(data) / seconds if seconds else 0))
+  if not result.startswith('BFT done'):
+    sys.exit(1)
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
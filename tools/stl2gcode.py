@@ -0,0 +1,443 @@
+#!/usr/bin/env python3
+"""
+Turn the STL models in 打印模型 into G-code workloads.
+
+This is a deliberately small slicer. It cuts planar layers, prints
+perimeters and a zig-zag infill, retracts on long travels, and can fit
+G2/G3 arcs over the curved parts of perimeters. The output is shaped like
+a production job (segment lengths, arcs, retracts, layer changes), which
+is what the planner, parser and SD streaming benchmarks need. Do not use
+it to print parts. tools/host/test_stl2gcode.py runs its output through
+the firmware to keep it honest.
+
+  tools/stl2gcode.py model.stl -o model.gcode
+  tools/stl2gcode.py -t kossel_800 --arcs model.stl -o model.gcode
+  tools/stl2gcode.py --all out/       every model in 打印模型
+
+Usage: stl2gcode.py [options] STL... [-o OUT.gcode] | --all DIR
+"""
+
+import argparse
+import math
+import mmap
+import os
+import re
+import struct
+import sys
+import time
+
+from marlin_profile import ROOT, TREES, load_machine
+
+MODELS = os.path.join(ROOT, '打印模型')
+FILAMENT_AREA = math.pi * (1.75 / 2) ** 2
+
+
+#
+# STL reader
+#
+
+VERTEX_RE = re.compile(rb'vertex\s+(\S+)\s+(\S+)\s+(\S+)')
+
+
+def load_stl(filename):
+  """Triangles as 9-tuples of floats. Binary and ASCII files are mapped, not read."""
+  with open(filename, 'rb') as f:
+    size = os.fstat(f.fileno()).st_size
+    if size < 84:
+      return []
+    with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+      count = struct.unpack_from('<I', data, 80)[0]
+      # Some binary files start with "solid" too, so trust the size first
+      if size == 84 + 50 * count:
+        return [t[3:12] for t in struct.iter_unpack('<12fH', data[84:84 + 50 * count])]
+      v = [float(n) for m in VERTEX_RE.finditer(data) for n in m.groups()]
+      return [tuple(v[i:i + 9]) for i in range(0, len(v) - 8, 9)]
+
+
+def place(triangles, center, scale=1.0):
+  """Scale, center on the bed and put the lowest point at Z=0."""
+  xs = [t[i] for t in triangles for i in (0, 3, 6)]
+  ys = [t[i] for t in triangles for i in (1, 4, 7)]
+  zs = [t[i] for t in triangles for i in (2, 5, 8)]
+  ox = center[0] - (min(xs) + max(xs)) / 2 * scale
+  oy = center[1] - (min(ys) + max(ys)) / 2 * scale
+  oz = -min(zs) * scale
+  return [tuple(t[i] * scale + (ox, oy, oz)[i % 3] for i in range(9)) for t in triangles]
+
+
+#
+# Slicing
+#
+
+def slice_layers(triangles, layer_height, first_layer):
+  """Yield (z, loops) per layer. Triangles are swept in Z order, so each is visited for its own layers only."""
+  tris = sorted(triangles, key=lambda t: min(t[2], t[5], t[8]))
+  top = max(max(t[2], t[5], t[8]) for t in tris)
+  active, nxt = [], 0
+  z = first_layer
+  while z - layer_height / 2 < top:
+    cut = z - min(layer_height, first_layer) / 2  # cut through the middle of the layer
+    while nxt < len(tris) and min(tris[nxt][2], tris[nxt][5], tris[nxt][8]) <= cut:
+      active.append(tris[nxt])
+      nxt += 1
+    active = [t for t in active if max(t[2], t[5], t[8]) > cut]
+    segments = []
+    for t in active:
+      pts = []
+      for a, b in ((0, 3), (3, 6), (6, 0)):
+        za, zb = t[a + 2], t[b + 2]
+        if (za <= cut) != (zb <= cut):
+          k = (cut - za) / (zb - za)
+          pts.append((t[a] + (t[b] - t[a]) * k, t[a + 1] + (t[b + 1] - t[a + 1]) * k))
+      if len(pts) == 2 and pts[0] != pts[1]:
+        segments.append(pts)
+    yield z, chain(segments)
+    z += layer_height
+
+
+def chain(segments):
+  """Join intersection segments into closed loops by their shared end points."""
+  key = lambda p: (round(p[0] * 1000), round(p[1] * 1000))
+  ends = {}
+  for i, (a, b) in enumerate(segments):
+    ends.setdefault(key(a), []).append(i)
+    ends.setdefault(key(b), []).append(i)
+  used = [False] * len(segments)
+  loops = []
+  for i in range(len(segments)):
+    if used[i]:
+      continue
+    used[i] = True
+    loop = list(segments[i])
+    while True:
+      tail = key(loop[-1])
+      for j in ends.get(tail, ()):
+        if not used[j]:
+          used[j] = True
+          a, b = segments[j]
+          loop.append(b if key(a) == tail else a)
+          break
+      else:
+        break
+    if key(loop[0]) == key(loop[-1]):
+      loop.pop()
+    if len(loop) >= 3:
+      loops.append(loop)
+  return loops
+
+
+def area(loop):
+  return sum(loop[i - 1][0] * loop[i][1] - loop[i][0] * loop[i - 1][1] for i in range(len(loop))) / 2
+
+
+def inside(p, loop):
+  x, y, c = p[0], p[1], False
+  for i in range(len(loop)):
+    (x1, y1), (x2, y2) = loop[i - 1], loop[i]
+    if (y1 > y) != (y2 > y) and x < x1 + (y - y1) * (x2 - x1) / (y2 - y1):
+      c = not c
+  return c
+
+
+def simplify(loop, min_segment):
+  out = [loop[0]]
+  for p in loop[1:]:
+    if math.hypot(p[0] - out[-1][0], p[1] - out[-1][1]) >= min_segment:
+      out.append(p)
+  while len(out) > 1 and math.hypot(out[0][0] - out[-1][0], out[0][1] - out[-1][1]) < min_segment:
+    out.pop()
+  # Points in the middle of straight edges would make the insets overshoot corners
+  i = 0
+  while len(out) > 3 and i < len(out):
+    (ax, ay), (bx, by), (cx, cy) = out[i - 1], out[i], out[(i + 1) % len(out)]
+    l = math.hypot(cx - ax, cy - ay)
+    if l and abs((bx - ax) * (cy - ay) - (by - ay) * (cx - ax)) / l < 0.005:
+      del out[i]
+    else:
+      i += 1
+  return out
+
+
+def orient(loops):
+  """Outer contours counter-clockwise and holes clockwise, so material is always on the left."""
+  result = []
+  for loop in loops:
+    depth = sum(1 for other in loops if other is not loop and inside(loop[0], other))
+    if (area(loop) > 0) == (depth % 2 == 1):
+      loop = loop[::-1]
+    result.append(loop)
+  return result
+
+
+def inset(loop, d):
+  """Offset a loop d mm to its left with mitred corners. None when it collapses."""
+  n = len(loop)
+  normals = []
+  for i in range(n):
+    (x1, y1), (x2, y2) = loop[i], loop[(i + 1) % n]
+    l = math.hypot(x2 - x1, y2 - y1) or 1.0
+    normals.append((-(y2 - y1) / l, (x2 - x1) / l))
+  out = []
+  for i in range(n):
+    (ax, ay), (bx, by) = normals[i - 1], normals[i]
+    mx, my = ax + bx, ay + by
+    dot = (mx * bx + my * by) or 1.0
+    k = min(d / dot, 3 * d)  # limit long mitres on sharp corners
+    out.append((loop[i][0] + mx * k, loop[i][1] + my * k))
+  a0, a1 = area(loop), area(out)
+  if a0 * a1 <= 0 or abs(a1) < d * d or abs(a1) > abs(a0) and a0 > 0:
+    return None
+  return out
+
+
+def infill(loops, spacing, angle):
+  """Zig-zag lines at angle, clipped even-odd against loops."""
+  c, s = math.cos(angle), math.sin(angle)
+  rot = [[(x * c + y * s, -x * s + y * c) for x, y in loop] for loop in loops]
+  ys = [p[1] for loop in rot for p in loop]
+  if not ys:
+    return []
+  lines, row = [], 0
+  y = min(ys) + spacing / 2
+  while y < max(ys):
+    xs = []
+    for loop in rot:
+      for i in range(len(loop)):
+        (x1, y1), (x2, y2) = loop[i - 1], loop[i]
+        if (y1 > y) != (y2 > y):
+          xs.append(x1 + (y - y1) * (x2 - x1) / (y2 - y1))
+    xs.sort()
+    pairs = [(xs[i], xs[i + 1]) for i in range(0, len(xs) - 1, 2)]
+    if row % 2:
+      pairs = [(b, a) for a, b in reversed(pairs)]
+    for a, b in pairs:
+      lines.append(((a * c - y * s, a * s + y * c), (b * c - y * s, b * s + y * c)))
+    y += spacing
+    row += 1
+  return lines
+
+
+#
+# Arc fitting
+#
+
+def circle_through(a, b, c):
+  d = 2 * (a[0] * (b[1] - c[1]) + b[0] * (c[1] - a[1]) + c[0] * (a[1] - b[1]))
+  if abs(d) < 1e-9:
+    return None
+  sa, sb, sc = a[0] ** 2 + a[1] ** 2, b[0] ** 2 + b[1] ** 2, c[0] ** 2 + c[1] ** 2
+  x = (sa * (b[1] - c[1]) + sb * (c[1] - a[1]) + sc * (a[1] - b[1])) / d
+  y = (sa * (c[0] - b[0]) + sb * (a[0] - c[0]) + sc * (b[0] - a[0])) / d
+  return x, y, math.hypot(a[0] - x, a[1] - y)
+
+
+def fit_arcs(path, tolerance, min_points=4, max_points=64, max_radius=200):
+  """
+  Split a polyline into ('L', p) and ('A', p, center, clockwise) moves,
+  replacing runs of at least min_points points on a common circle.
+  """
+  moves, i, n = [], 1, len(path)
+  while i < n:
+    best = None
+    j = i + min_points - 2
+    while j < n and j - i < max_points:
+      circle = circle_through(path[i - 1], path[(i - 1 + j) // 2], path[j])
+      if not circle or circle[2] > max_radius:
+        break
+      x, y, r = circle
+      if any(abs(math.hypot(p[0] - x, p[1] - y) - r) > tolerance for p in path[i - 1:j + 1]):
+        break
+      # The chords must hug the circle too, or a polygon's corners would pass
+      if any(r - math.sqrt(max(0.0, r * r - ((path[k][0] - path[k - 1][0]) ** 2 + (path[k][1] - path[k - 1][1]) ** 2) / 4)) > tolerance
+             for k in range(i, j + 1)):
+        break
+      cross = [(path[k][0] - path[k - 1][0]) * (path[k + 1][1] - path[k][1]) -
+               (path[k][1] - path[k - 1][1]) * (path[k + 1][0] - path[k][0]) for k in range(i, j)]
+      if not (all(v > 0 for v in cross) or all(v < 0 for v in cross)):
+        break
+      best = (j, (x, y), cross[0] < 0)
+      j += 1
+    if best:
+      moves.append(('A', path[best[0]], best[1], best[2]))
+      i = best[0] + 1
+    else:
+      moves.append(('L', path[i]))
+      i += 1
+  return moves
+
+
+#
+# G-code output
+#
+
+class Writer(object):
+
+  def __init__(self, out, args):
+    self.out = out
+    self.args = args
+    self.e = 0.0
+    self.x = self.y = None
+    self.lines = 0
+
+  def emit(self, text):
+    self.out.write(text + '\n')
+    self.lines += 1
+
+  def header(self, name):
+    a = self.args
+    self.emit('; generated by stl2gcode.py from %s' % name)
+    self.emit('; layer %.2f mm, %d perimeters, infill %d%%' % (a.layer_height, a.perimeters, a.infill))
+    for line in ('M140 S%d' % a.bed_temp, 'M104 S%d' % a.temp, 'G28', 'M190 S%d' % a.bed_temp,
+                 'M109 S%d' % a.temp, 'G21', 'G90', 'M82', 'G92 E0'):
+      self.emit(line)
+
+  def footer(self):
+    for line in ('G1 E%.5f F2400' % (self.e - self.args.retract), 'M104 S0', 'M140 S0', 'M84'):
+      self.emit(line)
+
+  def travel(self, p, z=None):
+    a = self.args
+    far = self.x is not None and math.hypot(p[0] - self.x, p[1] - self.y) > a.retract_min_travel
+    if far:
+      self.emit('G1 E%.5f F2400' % (self.e - a.retract))
+    if z is not None:
+      self.emit('G1 Z%.3f F1200' % z)
+    self.emit('G0 X%.3f Y%.3f F%d' % (p[0], p[1], a.travel_speed * 60))
+    if far:
+      self.emit('G1 E%.5f F2400' % self.e)
+    self.x, self.y = p
+
+  def extrude(self, p, speed, height, center=None, clockwise=False):
+    a = self.args
+    if center:
+      r = math.hypot(self.x - center[0], self.y - center[1])
+      a0 = math.atan2(self.y - center[1], self.x - center[0])
+      a1 = math.atan2(p[1] - center[1], p[0] - center[0])
+      sweep = (a0 - a1) % (2 * math.pi) if clockwise else (a1 - a0) % (2 * math.pi)
+      length = r * sweep
+    else:
+      length = math.hypot(p[0] - self.x, p[1] - self.y)
+    self.e += length * a.line_width * height / FILAMENT_AREA * a.flow / 100.0
+    if center:
+      self.emit('G%d X%.3f Y%.3f I%.3f J%.3f E%.5f F%d' % (2 if clockwise else 3, p[0], p[1],
+                center[0] - self.x, center[1] - self.y, self.e, speed * 60))
+    else:
+      self.emit('G1 X%.3f Y%.3f E%.5f F%d' % (p[0], p[1], self.e, speed * 60))
+    self.x, self.y = p
+
+  def loop(self, loop, speed, height, z):
+    self.travel(loop[0], z)
+    path = loop + loop[:1]
+    if self.args.arcs:
+      for m in fit_arcs(path, self.args.arc_tolerance):
+        if m[0] == 'A':
+          self.extrude(m[1], speed, height, m[2], m[3])
+        else:
+          self.extrude(m[1], speed, height)
+    else:
+      for p in path[1:]:
+        if p != (self.x, self.y):
+          self.extrude(p, speed, height)
+
+
+def slice_model(filename, out, args, center):
+  a = args
+  triangles = place(load_stl(filename), center, a.scale)
+  w = Writer(out, a)
+  w.header(os.path.basename(filename))
+  layers = 0
+  for z, loops in slice_layers(triangles, a.layer_height, a.first_layer):
+    height = a.first_layer if layers == 0 else a.layer_height
+    speed_scale = a.first_layer_speed / a.perimeter_speed if layers == 0 else 1.0
+    w.emit(';LAYER:%d' % layers)
+    loops = orient([s for s in (simplify(l, a.min_segment) for l in loops) if len(s) >= 3])
+    shells, innermost = [], list(loops)
+    for k in range(a.perimeters):
+      ring = [inset(l, a.line_width * (k + 0.5)) for l in loops]
+      ring = [l for l in ring if l]
+      shells.append(ring)
+      innermost = [inset(l, a.line_width * (k + 1)) for l in loops]
+      innermost = [l for l in innermost if l]
+    # Inner perimeters first, the outer one last and slower
+    for k in range(len(shells) - 1, -1, -1):
+      speed = (a.outer_speed if k == 0 else a.perimeter_speed) * speed_scale
+      for l in shells[k]:
+        w.loop(l, speed, height, z)
+        z = None
+    if a.infill > 0 and innermost:
+      spacing = a.line_width * 100.0 / a.infill
+      angle = math.radians(45 if layers % 2 == 0 else 135)
+      for p0, p1 in infill(innermost, spacing, angle):
+        w.travel(p0, z)
+        z = None
+        w.extrude(p1, a.infill_speed * speed_scale, height)
+    layers += 1
+  w.footer()
+  return len(triangles), layers, w.lines
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+  parser.add_argument('stl', nargs='*', help='STL file(s)')
+  parser.add_argument('-o', '--output', help='G-code file (default: stdout)')
+  parser.add_argument('--all', metavar='DIR', help='slice every model in 打印模型 into DIR')
+  parser.add_argument('-t', '--tree', choices=TREES, help='center on this machine\'s bed')
+  parser.add_argument('--center', default=None, help='bed center X,Y (default 100,100)')
+  parser.add_argument('--scale', type=float, default=1.0)
+  parser.add_argument('--layer-height', type=float, default=0.2)
+  parser.add_argument('--first-layer', type=float, default=0.3)
+  parser.add_argument('--line-width', type=float, default=0.4)
+  parser.add_argument('--perimeters', type=int, default=2)
+  parser.add_argument('--infill', type=int, default=20, help='percent, 0 for none')
+  parser.add_argument('--flow', type=float, default=100, help='percent')
+  parser.add_argument('--perimeter-speed', type=float, default=40, help='mm/s')
+  parser.add_argument('--outer-speed', type=float, default=30, help='mm/s')
+  parser.add_argument('--infill-speed', type=float, default=60, help='mm/s')
+  parser.add_argument('--travel-speed', type=float, default=150, help='mm/s')
+  parser.add_argument('--first-layer-speed', type=float, default=20, help='mm/s')
+  parser.add_argument('--retract', type=float, default=4, help='mm')
+  parser.add_argument('--retract-min-travel', type=float, default=2, help='mm')
+  parser.add_argument('--min-segment', type=float, default=0.05, help='drop shorter outline segments (mm)')
+  parser.add_argument('--arcs', action='store_true', help='fit G2/G3 over curved perimeters')
+  parser.add_argument('--arc-tolerance', type=float, default=0.02, help='mm')
+  parser.add_argument('--temp', type=int, default=200)
+  parser.add_argument('--bed-temp', type=int, default=60)
+  args = parser.parse_args(argv)
+
+  if args.center:
+    center = tuple(float(v) for v in args.center.split(','))
+  elif args.tree:
+    center = load_machine(args.tree).center
+  else:
+    center = (100.0, 100.0)
+
+  if args.all:
+    os.makedirs(args.all, exist_ok=True)
+    jobs = []
+    for folder, _, names in os.walk(MODELS):
+      for name in sorted(names):
+        if name.lower().endswith('.stl'):
+          src = os.path.join(folder, name)
+          rel = os.path.relpath(src, MODELS)
+          jobs.append((src, os.path.join(args.all, os.path.splitext(rel.replace(os.sep, '_'))[0] + '.gcode')))
+  elif args.stl:
+    jobs = [(src, args.output) for src in args.stl]
+    if args.output and len(jobs) > 1:
+      parser.error('-o takes a single STL')
+  else:
+    parser.error('no STL given')
+
+  for src, dst in sorted(jobs):
+    start = time.time()
+    out = open(dst, 'w') if dst else sys.stdout
+    try:
+      triangles, layers, lines = slice_model(src, out, args, center)
+    finally:
+      if dst:
+        out.close()
+    sys.stderr.write('%s: %d triangles, %d layers, %d lines in %.1fs\n' %
+                     (os.path.basename(src), triangles, layers, lines, time.time() - start))
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
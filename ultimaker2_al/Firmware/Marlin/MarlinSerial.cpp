@@ -42,6 +42,10 @@
   ring_buffer_r rx_buffer  =  { { 0 }, 0, 0 };
   #if TX_BUFFER_SIZE > 0
     ring_buffer_t tx_buffer  =  { { 0 }, 0, 0 };
+  #elif TX_QUEUE_SIZE > 0
+    tx_queue_t tx_queue;
+  #endif
+  #if TX_BUFFER_SIZE > 0 || TX_QUEUE_SIZE > 0
     static bool _written;
   #endif
 #endif
@@ -89,13 +93,43 @@ FORCE_INLINE void store_char(unsigned char c) {
     }
   }
 
+#elif TX_QUEUE_SIZE > 0
+
+  FORCE_INLINE void _tx_udr_empty_irq(void) {
+    // Send the next byte of the entry at the tail. The entry is
+    // done at its last inline byte or at the NUL of its string.
+    const uint8_t t = tx_queue.tail;
+    const tx_entry_t &e = tx_queue.entry[t];
+    uint8_t p = tx_queue.pos;
+
+    M_UDRx = e.len ? e.data[p] : pgm_read_byte(e.pgm + p);
+
+    // clear the TXC bit, see above
+    SBI(M_UCSRxA, M_TXCx);
+
+    p++;
+    if (e.len ? p < e.len : pgm_read_byte(e.pgm + p) != 0) {
+      tx_queue.pos = p;
+      return;
+    }
+    tx_queue.pos = 0;
+    tx_queue.tail = (t + 1) & (TX_QUEUE_SIZE - 1);
+
+    if (tx_queue.head == tx_queue.tail) {
+      // Queue empty, so disable interrupts
+      CBI(M_UCSRxB, M_UDRIEx);
+    }
+  }
+
+#endif // TX_QUEUE_SIZE
+
+#if TX_BUFFER_SIZE > 0 || TX_QUEUE_SIZE > 0
   #if defined(M_USARTx_UDRE_vect)
     ISR(M_USARTx_UDRE_vect) {
       _tx_udr_empty_irq();
     }
   #endif
-
-#endif // TX_BUFFER_SIZE
+#endif
 
 #if defined(M_USARTx_RX_vect)
   ISR(M_USARTx_RX_vect) {
@@ -139,7 +173,7 @@ void MarlinSerial::begin(long baud) {
   SBI(M_UCSRxB, M_RXENx);
   SBI(M_UCSRxB, M_TXENx);
   SBI(M_UCSRxB, M_RXCIEx);
-  #if TX_BUFFER_SIZE > 0
+  #if TX_BUFFER_SIZE > 0 || TX_QUEUE_SIZE > 0
     CBI(M_UCSRxB, M_UDRIEx);
     _written = false;
   #endif
@@ -252,6 +286,89 @@ void MarlinSerial::flush(void) {
     return;
   }
 
+#elif TX_QUEUE_SIZE > 0
+
+  // Wait for a free entry and return it. It is sent after tx_push().
+  static tx_entry_t& tx_reserve() {
+    const uint8_t i = (tx_queue.head + 1) & (TX_QUEUE_SIZE - 1);
+
+    // If the queue is full, wait for the interrupt handler to send
+    // an entry, or send it here if interrupts are disabled
+    while (i == tx_queue.tail) {
+      if (!TEST(SREG, SREG_I) && TEST(M_UCSRxA, M_UDREx))
+        _tx_udr_empty_irq();
+    }
+    return tx_queue.entry[tx_queue.head];
+  }
+
+  static void tx_push() {
+    CRITICAL_SECTION_START;
+      tx_queue.head = (tx_queue.head + 1) & (TX_QUEUE_SIZE - 1);
+      SBI(M_UCSRxB, M_UDRIEx);
+    CRITICAL_SECTION_END;
+  }
+
+  void MarlinSerial::write(uint8_t c) {
+    _written = true;
+    bool sent = false;
+    CRITICAL_SECTION_START;
+      const uint8_t h = tx_queue.head;
+      if (h == tx_queue.tail) {
+        // Nothing queued and the data register is free: just write the byte
+        if (TEST(M_UCSRxA, M_UDREx)) {
+          M_UDRx = c;
+          SBI(M_UCSRxA, M_TXCx);
+          sent = true;
+        }
+      }
+      else {
+        // Still queued and not full: add the byte to the last entry.
+        // The interrupt handler can't finish the entry meanwhile.
+        tx_entry_t &last = tx_queue.entry[(h - 1) & (TX_QUEUE_SIZE - 1)];
+        if (last.len && last.len < TX_INLINE_BYTES) {
+          last.data[last.len++] = c;
+          sent = true;
+        }
+      }
+    CRITICAL_SECTION_END;
+    if (sent) return;
+
+    tx_entry_t &e = tx_reserve();
+    e.data[0] = c;
+    e.len = 1;
+    tx_push();
+  }
+
+  void MarlinSerial::writePGM(const char* str) {
+    char c = pgm_read_byte(str);
+    if (!c) return;
+    _written = true;
+    CRITICAL_SECTION_START;
+      // Start right away if idle, the interrupt sends the rest
+      if (tx_queue.head == tx_queue.tail && TEST(M_UCSRxA, M_UDREx)) {
+        M_UDRx = c;
+        SBI(M_UCSRxA, M_TXCx);
+        c = pgm_read_byte(++str);
+      }
+    CRITICAL_SECTION_END;
+    if (!c) return;
+
+    tx_entry_t &e = tx_reserve();
+    e.pgm = str;
+    e.len = 0;
+    tx_push();
+  }
+
+#else
+  void MarlinSerial::write(uint8_t c) {
+    while (!TEST(M_UCSRxA, M_UDREx))
+      ;
+    M_UDRx = c;
+  }
+#endif
+
+#if TX_BUFFER_SIZE > 0 || TX_QUEUE_SIZE > 0
+
   void MarlinSerial::flushTX(void) {
     // TX
     // If we have never written a byte, no need to flush. This special
@@ -270,14 +387,8 @@ void MarlinSerial::flush(void) {
     }
     // If we get here, nothing is queued anymore (DRIE is disabled) and
     // the hardware finished tranmission (TXC is set).
-}
-
-#else
-  void MarlinSerial::write(uint8_t c) {
-    while (!TEST(M_UCSRxA, M_UDREx))
-      ;
-    M_UDRx = c;
   }
+
 #endif
 
 // end NEW
@@ -379,7 +490,12 @@ void MarlinSerial::println(double n, int digits) {
 // Private Methods /////////////////////////////////////////////////////////////
 
 void MarlinSerial::printNumber(unsigned long n, uint8_t base) {
-  if (n) {
+  if (base == 10) {
+    char buf[10];
+    char *p = ultostr(n, buf + sizeof(buf));
+    write((uint8_t*)p, buf + sizeof(buf) - p);
+  }
+  else if (n) {
     unsigned char buf[8 * sizeof(long)]; // Enough space for base 2
     int8_t i = 0;
     while (n) {
@@ -415,6 +531,20 @@ void MarlinSerial::printFloat(double number, uint8_t digits) {
   // Print the decimal point, but only if there are digits beyond
   if (digits) {
     print('.');
+    // Up to 3 digits, one multiply of the remainder gives the same digits
+    // as the loop below, unless the result is near a digit boundary where
+    // the rounding of the loop decides. Those few keep using the loop.
+    if (digits <= 3) {
+      const float scaled = remainder * (digits == 1 ? 10 : digits == 2 ? 100 : 1000);
+      const uint16_t n = scaled;
+      const float frac = scaled - n;
+      if (frac > 1.0 / 64 && frac < 63.0 / 64) {
+        char buf[3];
+        ultodigits(n, buf + digits, digits);
+        write((uint8_t*)buf, digits);
+        return;
+      }
+    }
     // Extract digits from the remainder one at a time
     while (digits--) {
       remainder *= 10.0;
@@ -90,12 +90,21 @@
 #ifndef TX_BUFFER_SIZE
   #define TX_BUFFER_SIZE 32
 #endif
+#ifndef TX_QUEUE_SIZE
+  #define TX_QUEUE_SIZE 0
+#endif
 #if !((RX_BUFFER_SIZE == 256) ||(RX_BUFFER_SIZE == 128) ||(RX_BUFFER_SIZE == 64) ||(RX_BUFFER_SIZE == 32) ||(RX_BUFFER_SIZE == 16) ||(RX_BUFFER_SIZE == 8) ||(RX_BUFFER_SIZE == 4) ||(RX_BUFFER_SIZE == 2))
   #error "RX_BUFFER_SIZE has to be a power of 2 and >= 2"
 #endif
 #if !((TX_BUFFER_SIZE == 256) ||(TX_BUFFER_SIZE == 128) ||(TX_BUFFER_SIZE == 64) ||(TX_BUFFER_SIZE == 32) ||(TX_BUFFER_SIZE == 16) ||(TX_BUFFER_SIZE == 8) ||(TX_BUFFER_SIZE == 4) ||(TX_BUFFER_SIZE == 2) ||(TX_BUFFER_SIZE == 0))
   #error TX_BUFFER_SIZE has to be a power of 2 or 0
 #endif
+#if !((TX_QUEUE_SIZE == 128) ||(TX_QUEUE_SIZE == 64) ||(TX_QUEUE_SIZE == 32) ||(TX_QUEUE_SIZE == 16) ||(TX_QUEUE_SIZE == 8) ||(TX_QUEUE_SIZE == 4) ||(TX_QUEUE_SIZE == 2) ||(TX_QUEUE_SIZE == 0))
+  #error TX_QUEUE_SIZE has to be a power of 2 or 0
+#endif
+#if TX_QUEUE_SIZE > 0 && TX_BUFFER_SIZE > 0
+  #error Set either TX_BUFFER_SIZE or TX_QUEUE_SIZE to 0
+#endif
 
 struct ring_buffer_r {
   unsigned char buffer[RX_BUFFER_SIZE];
@@ -111,10 +120,32 @@ struct ring_buffer_r {
   };
 #endif
 
+#if TX_QUEUE_SIZE > 0
+  #define TX_INLINE_BYTES 4
+
+  // A PROGMEM string (len == 0) or len bytes held in the entry itself
+  struct tx_entry_t {
+    union {
+      const char* pgm;
+      unsigned char data[TX_INLINE_BYTES];
+    };
+    uint8_t len;
+  };
+
+  struct tx_queue_t {
+    tx_entry_t entry[TX_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint8_t pos;   // Next byte of the entry at tail
+  };
+#endif
+
 #if UART_PRESENT(SERIAL_PORT)
   extern ring_buffer_r rx_buffer;
   #if TX_BUFFER_SIZE > 0
     extern ring_buffer_t tx_buffer;
+  #elif TX_QUEUE_SIZE > 0
+    extern tx_queue_t tx_queue;
   #endif
 #endif
 
@@ -137,8 +168,13 @@ class MarlinSerial { //: public Stream
     static void write(uint8_t c);
     #if TX_BUFFER_SIZE > 0
       static uint8_t availableForWrite(void);
+    #endif
+    #if TX_BUFFER_SIZE > 0 || TX_QUEUE_SIZE > 0
       static void flushTX(void);
     #endif
+    #if TX_QUEUE_SIZE > 0
+      static void writePGM(const char* str);
+    #endif
 
   private:
     static void printNumber(unsigned long, uint8_t);
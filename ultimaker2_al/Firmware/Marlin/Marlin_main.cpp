@@ -64,6 +64,7 @@
  * G30 - Single Z probe, probes bed at X Y location (defaults to current XY location)
  * G31 - Dock sled (Z_PROBE_SLED only)
  * G32 - Undock sled (Z_PROBE_SLED only)
+ * G33 - Delta auto-calibration: probe and fit endstops, radius, tower angles and rod (Requires DELTA_AUTO_CALIBRATION)
  * G38 - Probe target - similar to G28 except it uses the Z_MIN endstop for all three axes
  * G90 - Use Absolute Coordinates
  * G91 - Use Relative Coordinates
@@ -82,8 +83,8 @@
  * M24  - Start/resume SD print. (Requires SDSUPPORT)
  * M25  - Pause SD print. (Requires SDSUPPORT)
  * M26  - Set SD position in bytes: "M26 S12345". (Requires SDSUPPORT)
- * M27  - Report SD print status. (Requires SDSUPPORT)
- * M28  - Start SD write: "M28 /path/file.gco". (Requires SDSUPPORT)
+ * M27  - Report SD print status. S<seconds> sets the auto-report interval. (Requires SDSUPPORT; S requires AUTO_REPORT_SD_STATUS)
+ * M28  - Start SD write: "M28 /path/file.gco". With SD_FAST_UPLOAD "M28 S<bytes> /path/file.gco" preallocates the file. (Requires SDSUPPORT)
  * M29  - Stop SD write. (Requires SDSUPPORT)
  * M30  - Delete file from SD: "M30 /path/file.gco"
  * M31  - Report time since last M109 or SD card start to serial.
@@ -94,6 +95,7 @@
  * M42  - Change pin status via gcode: M42 P<pin> S<value>. LED pin assumed if P is omitted.
  * M43  - Monitor pins & report changes - report active pins
  * M48  - Measure Z Probe repeatability: M48 P<points> X<pos> Y<pos> V<level> E<engage> L<legs>. (Requires Z_MIN_PROBE_REPEATABILITY_TEST)
+ * M73  - Set SD print progress: "M73 P<percent> R<minutes left>". (Requires SD_PRINT_TIME_ESTIMATE)
  * M75  - Start the print job timer.
  * M76  - Pause the print job timer.
  * M77  - Stop the print job timer.
@@ -132,6 +134,7 @@
  * M145 - Set heatup values for materials on the LCD. H<hotend> B<bed> F<fan speed> for S<material> (0=PLA, 1=ABS)
  * M149 - Set temperature units. (Requires TEMPERATURE_UNITS_SUPPORT)
  * M150 - Set Status LED Color as R<red> U<green> B<blue>. Values 0-255. (Requires BLINKM or RGB_LED)
+ * M154 - Auto-report the position with interval of S<seconds>. (Requires AUTO_REPORT_POSITION)
  * M155 - Auto-report temperatures with interval of S<seconds>. (Requires AUTO_REPORT_TEMPERATURES)
  * M163 - Set a single proportion for a mixing extruder. (Requires MIXING_EXTRUDER)
  * M164 - Save the mix as a virtual extruder. (Requires MIXING_EXTRUDER and MIXING_VIRTUAL_TOOLS)
@@ -167,6 +170,7 @@
  * M302 - Allow cold extrudes, or set the minimum extrude S<temperature>. (Requires PREVENT_COLD_EXTRUSION)
  * M303 - PID relay autotune S<temperature> sets the target temperature. Default 150C. (Requires PIDTEMP)
  * M304 - Set bed PID parameters P I and D. (Requires PIDTEMPBED)
+ * M306 - Set hotend feed-forward E (per mm/s of filament) and F (at full fan). (Requires PID_FEEDFORWARD)
  * M355 - Turn the Case Light on/off and set its brightness. (Requires CASE_LIGHT_PIN)
  * M380 - Activate solenoid on active extruder. (Requires EXT_SOLENOID)
  * M381 - Disable all solenoids. (Requires EXT_SOLENOID)
@@ -208,8 +212,12 @@
  *
  * ************ Custom codes - This can change to suit future G-code regulations
  * M100 - Watch Free Memory (For Debugging). (Requires M100_FREE_MEMORY_WATCHER)
+ * M102 - Report idle task run time statistics. "M102 R" resets them. (Requires IDLE_TASK_SCHEDULER)
  * M928 - Start SD logging: "M928 filename.gco". Stop with M29. (Requires SDSUPPORT)
  * M999 - Restart after being stopped by error
+ * M1000 - Resume an interrupted SD print from its checkpoint. "M1000 C" discards it. (Requires SD_CHECKPOINT)
+ * M1001 - Print the jobs of a manifest on the SD card back to back: "M1001 [manifest]". "M1001 C" ends the queue. (Requires SD_JOB_QUEUE)
+ * M1002 - Receive a file to the SD card in binary packets. (Requires BINARY_FILE_TRANSFER)
  *
  * "T" Codes
  *
@@ -235,13 +243,14 @@
 
 #if HAS_ABL
   #include "vector_3.h"
-  #if ENABLED(AUTO_BED_LEVELING_LINEAR)
-    #include "qr_solve.h"
-  #endif
 #elif ENABLED(MESH_BED_LEVELING)
   #include "mesh_bed_leveling.h"
 #endif
 
+#if ENABLED(AUTO_BED_LEVELING_LINEAR) || ENABLED(DELTA_AUTO_CALIBRATION)
+  #include "qr_solve.h"
+#endif
+
 #if ENABLED(BEZIER_CURVE_SUPPORT)
   #include "planner_bezier.h"
 #endif
@@ -279,6 +288,10 @@
   #include "endstop_interrupts.h"
 #endif
 
+#if ENABLED(BINARY_FILE_TRANSFER)
+  #include "file_transfer.h"
+#endif
+
 #if ENABLED(M100_FREE_MEMORY_WATCHER)
   void gcode_M100();
 #endif
@@ -348,12 +361,27 @@ static uint8_t cmd_queue_index_r = 0, // Ring buffer read position
                cmd_queue_index_w = 0, // Ring buffer write position
                commands_in_queue = 0; // Count of commands in the queue
 
+#if ENABLED(SD_CHECKPOINT)
+  // SD file offset and M32 procedure depth of each queued command read from the card.
+  // Commands from other sources have NO_SD_POS.
+  static uint32_t command_sdpos[BUFSIZE];
+  static uint8_t command_sddepth[BUFSIZE];
+#endif
+
+#if ENABLED(SD_JOB_QUEUE)
+  // Which queued commands came from the card, and whether the one running did.
+  // Only the job file's own cooldown is held back for the next job.
+  static bool command_from_sd[BUFSIZE];
+  static bool current_command_from_sd = false;
+#endif
+
 /**
  * Current GCode Command
  * When a GCode handler is running, these will be set
  */
 static char *current_command,      // The command currently being executed
             *current_command_args, // The address where arguments begin
+            *current_command_end,  // Just past the last argument, see process_command()
             *seen_pointer;         // Set by code_seen(), used by the code_value functions
 
 /**
@@ -546,7 +574,8 @@ static uint8_t target_extruder;
   #define COS_60 0.5
 
   float delta[ABC],
-        endstop_adj[ABC] = { 0 };
+        endstop_adj[ABC] = { 0 },
+        delta_tower_angle_trim[ABC] = { DELTA_TOWER_ANGLE_TRIM_1, DELTA_TOWER_ANGLE_TRIM_2, DELTA_TOWER_ANGLE_TRIM_3 };
 
   // these are the default values, can be overriden with M665
   float delta_radius = DELTA_RADIUS,
@@ -815,6 +844,12 @@ void enqueue_and_echo_commands_P(const char* pgcode) {
 void clear_command_queue() {
   cmd_queue_index_r = cmd_queue_index_w;
   commands_in_queue = 0;
+  #if ENABLED(SD_CHECKPOINT)
+    for (uint8_t i = 0; i < BUFSIZE; i++) command_sdpos[i] = NO_SD_POS;
+  #endif
+  #if ENABLED(SD_JOB_QUEUE)
+    ZERO(command_from_sd);
+  #endif
 }
 
 /**
@@ -978,6 +1013,11 @@ inline void get_serial_commands() {
     }
   #endif
 
+  // M1002 reads its packets itself, also while it calls idle()
+  #if ENABLED(BINARY_FILE_TRANSFER)
+    if (FileTransfer::receiving) return;
+  #endif
+
   /**
    * Loop while serial characters are incoming and the queue is not full
    */
@@ -1104,6 +1144,10 @@ inline void get_serial_commands() {
     static bool stop_buffering = false,
                 sd_comment_mode = false;
 
+    #if ENABLED(SD_CHECKPOINT)
+      static uint32_t sd_line_pos = 0; // Where the command being read starts
+    #endif
+
     if (!card.sdprinting) return;
 
     /**
@@ -1143,6 +1187,14 @@ inline void get_serial_commands() {
         command_queue[cmd_queue_index_w][sd_count] = '\0'; //terminate string
         sd_count = 0; //clear buffer
 
+        #if ENABLED(SD_CHECKPOINT)
+          command_sdpos[cmd_queue_index_w] = sd_line_pos;
+          command_sddepth[cmd_queue_index_w] = card.procedureDepth();
+        #endif
+        #if ENABLED(SD_JOB_QUEUE)
+          command_from_sd[cmd_queue_index_w] = true;
+        #endif
+
         _commit_command(false);
       }
       else if (sd_count >= MAX_CMD_SIZE - 1) {
@@ -1153,7 +1205,12 @@ inline void get_serial_commands() {
       }
       else {
         if (sd_char == ';') sd_comment_mode = true;
-        if (!sd_comment_mode) command_queue[cmd_queue_index_w][sd_count++] = sd_char;
+        if (!sd_comment_mode) {
+          #if ENABLED(SD_CHECKPOINT)
+            if (!sd_count) sd_line_pos = card.getIndex();
+          #endif
+          command_queue[cmd_queue_index_w][sd_count++] = sd_char;
+        }
       }
     }
   }
@@ -1188,15 +1245,15 @@ inline bool code_has_value() {
 }
 
 inline float code_value_float() {
-  float ret;
-  char* e = strchr(seen_pointer, 'E');
+  char *end;
+  float ret = strtod(seen_pointer + 1, &end);
+  // An 'E' read as the exponent is the next parameter: parse again without it
+  char* e = (char*)memchr(seen_pointer + 1, 'E', end - (seen_pointer + 1));
   if (e) {
     *e = 0;
     ret = strtod(seen_pointer + 1, NULL);
     *e = 'E';
   }
-  else
-    ret = strtod(seen_pointer + 1, NULL);
   return ret;
 }
 
@@ -1278,7 +1335,7 @@ FORCE_INLINE millis_t code_value_millis() { return code_value_ulong(); }
 inline millis_t code_value_millis_from_seconds() { return code_value_float() * 1000; }
 
 bool code_seen(char code) {
-  seen_pointer = strchr(current_command_args, code);
+  seen_pointer = (char*)memchr(current_command_args, code, current_command_end - current_command_args);
   return (seen_pointer != NULL); // Return TRUE if the code-letter was found
 }
 
@@ -1581,13 +1638,13 @@ inline void set_destination_to_current() { memcpy(destination, current_position,
  *  Plan a move to (X, Y, Z) and set the current_position
  *  The final current_position may not be the one that was requested
  */
-void do_blocking_move_to(const float &x, const float &y, const float &z, const float &fr_mm_s /*=0.0*/) {
+/**
+ * Queue a move to the given XYZ, raising Z before the XY move
+ * and lowering it after. Doesn't wait for the move to complete.
+ */
+static void queue_move_to(const float &x, const float &y, const float &z, const float &fr_mm_s=0.0) {
   float old_feedrate_mm_s = feedrate_mm_s;
 
-  #if ENABLED(DEBUG_LEVELING_FEATURE)
-    if (DEBUGGING(LEVELING)) print_xyz(PSTR(">>> do_blocking_move_to"), NULL, x, y, z);
-  #endif
-
   #if ENABLED(DELTA)
 
     feedrate_mm_s = fr_mm_s ? fr_mm_s : XY_PROBE_FEEDRATE_MM_S;
@@ -1608,6 +1665,7 @@ void do_blocking_move_to(const float &x, const float &y, const float &z, const f
         #if ENABLED(DEBUG_LEVELING_FEATURE)
           if (DEBUGGING(LEVELING)) DEBUG_POS("danger zone move", current_position);
         #endif
+        feedrate_mm_s = old_feedrate_mm_s;
         return;
       }
       else {
@@ -1685,9 +1743,17 @@ void do_blocking_move_to(const float &x, const float &y, const float &z, const f
 
   #endif
 
-  stepper.synchronize();
-
   feedrate_mm_s = old_feedrate_mm_s;
+}
+
+void do_blocking_move_to(const float &x, const float &y, const float &z, const float &fr_mm_s /*=0.0*/) {
+  #if ENABLED(DEBUG_LEVELING_FEATURE)
+    if (DEBUGGING(LEVELING)) print_xyz(PSTR(">>> do_blocking_move_to"), NULL, x, y, z);
+  #endif
+
+  queue_move_to(x, y, z, fr_mm_s);
+
+  stepper.synchronize();
 
   #if ENABLED(DEBUG_LEVELING_FEATURE)
     if (DEBUGGING(LEVELING)) SERIAL_ECHOLNPGM("<<< do_blocking_move_to");
@@ -2214,6 +2280,81 @@ static void clean_up_after_endstop_or_probe_move() {
     return measured_z;
   }
 
+  #if ENABLED(PROBE_PIPELINE)
+
+    //
+    // Probe the next point of a planned route with a deployed probe
+    // - Queue the raise, the XY travel and a fast approach to
+    //   PROBE_APPROACH_MARGIN above the expected Z (if known)
+    // - Wait once, then do the slow probe
+    // - If the probe triggered early, fall back to probe_pt()
+    // - Return the probed Z position
+    //
+    static float probe_pt_pipelined(const float &x, const float &y, const float &expected_z, int verbose_level = 1) {
+      #if ENABLED(DEBUG_LEVELING_FEATURE)
+        if (DEBUGGING(LEVELING)) {
+          SERIAL_ECHOPAIR(">>> probe_pt_pipelined(", x);
+          SERIAL_ECHOPAIR(", ", y);
+          SERIAL_ECHOLNPAIR(", ", expected_z);
+          DEBUG_POS("", current_position);
+        }
+      #endif
+
+      // The height do_probe_raise() would move to
+      float z_travel = LOGICAL_Z_POSITION(Z_CLEARANCE_BETWEEN_PROBES);
+      if (zprobe_zoffset < 0) z_travel -= zprobe_zoffset;
+      NOLESS(z_travel, current_position[Z_AXIS]);
+
+      const float nx = x - (X_PROBE_OFFSET_FROM_EXTRUDER),
+                  ny = y - (Y_PROBE_OFFSET_FROM_EXTRUDER);
+
+      endstops.hit_on_purpose();
+
+      queue_move_to(nx, ny, z_travel);
+
+      const float z_approach = expected_z + (PROBE_APPROACH_MARGIN);
+      if (!isnan(expected_z) && z_approach < z_travel)
+        queue_move_to(nx, ny, z_approach, MMM_TO_MMS(Z_PROBE_SPEED_FAST));
+
+      stepper.synchronize();
+
+      // Triggered before the slow probe? The bed is higher than expected.
+      if (endstops.endstop_hit_bits) {
+        endstops.hit_on_purpose();
+        set_current_from_steppers_for_axis(ALL_AXES);
+        SYNC_PLAN_POSITION_KINEMATIC();
+        #if ENABLED(DEBUG_LEVELING_FEATURE)
+          if (DEBUGGING(LEVELING)) DEBUG_POS("<<< probe_pt_pipelined early trigger", current_position);
+        #endif
+        return probe_pt(x, y, false, verbose_level);
+      }
+
+      refresh_cmd_timeout();
+
+      // Move down slowly to find the bed
+      do_probe_move(-(Z_MAX_LENGTH) - 10, Z_PROBE_SPEED_SLOW);
+
+      const float measured_z = current_position[Z_AXIS];
+
+      if (verbose_level > 2) {
+        SERIAL_PROTOCOLPGM("Bed X: ");
+        SERIAL_PROTOCOL_F(x, 3);
+        SERIAL_PROTOCOLPGM(" Y: ");
+        SERIAL_PROTOCOL_F(y, 3);
+        SERIAL_PROTOCOLPGM(" Z: ");
+        SERIAL_PROTOCOL_F(measured_z, 3);
+        SERIAL_EOL;
+      }
+
+      #if ENABLED(DEBUG_LEVELING_FEATURE)
+        if (DEBUGGING(LEVELING)) SERIAL_ECHOLNPGM("<<< probe_pt_pipelined");
+      #endif
+
+      return measured_z;
+    }
+
+  #endif // PROBE_PIPELINE
+
 #endif // HAS_BED_PROBE
 
 #if PLANNER_LEVELING
@@ -2851,7 +2992,18 @@ void gcode_get_destination() {
   #endif
 }
 
+/**
+ * The arguments as a string, for handlers that take text (file names,
+ * messages). A command from process_command() may be a span of a larger
+ * buffer, so it gets its nul here.
+ */
+inline char* command_text() {
+  *current_command_end = '\0';
+  return current_command_args;
+}
+
 void unknown_command_error() {
+  command_text();
   SERIAL_ECHO_START;
   SERIAL_ECHOPAIR(MSG_UNKNOWN_COMMAND, current_command);
   SERIAL_CHAR('"');
@@ -3993,6 +4145,8 @@ inline void gcode_G28() {
 
     setup_for_endstop_or_probe_move();
 
+    const millis_t probe_start_ms = millis();
+
     // Deploy the probe. Probe will raise if needed.
     if (DEPLOY_PROBE()) {
       planner.abl_enabled = abl_should_enable;
@@ -4063,6 +4217,11 @@ inline void gcode_G28() {
         #define PR_INNER_END abl_grid_points_x
       #endif
 
+      // Plan the serpentine probe route up front
+      uint8_t route_x[abl_grid_points_x * abl_grid_points_y],
+              route_y[abl_grid_points_x * abl_grid_points_y];
+      int route_len = 0;
+
       bool zig = PR_OUTER_END & 1;  // Always end at RIGHT and BACK_PROBE_BED_POSITION
 
       // Outer loop is Y with PROBE_Y_FIRST disabled
@@ -4086,47 +4245,127 @@ inline void gcode_G28() {
         // Inner loop is Y with PROBE_Y_FIRST enabled
         for (int8_t PR_INNER_VAR = inStart; PR_INNER_VAR != inStop; PR_INNER_VAR += inInc) {
 
-          float xBase = left_probe_bed_position + xGridSpacing * xCount,
-                yBase = front_probe_bed_position + yGridSpacing * yCount;
-
-          xProbe = floor(xBase + (xBase < 0 ? 0 : 0.5));
-          yProbe = floor(yBase + (yBase < 0 ? 0 : 0.5));
-
-          #if ENABLED(AUTO_BED_LEVELING_LINEAR)
-            indexIntoAB[xCount][yCount] = ++probePointCounter;
-          #endif
-
           #if IS_KINEMATIC
             // Avoid probing outside the round or hexagonal area
-            float pos[XYZ] = { xProbe, yProbe, 0 };
+            float xBase = left_probe_bed_position + xGridSpacing * xCount,
+                  yBase = front_probe_bed_position + yGridSpacing * yCount;
+            float pos[XYZ] = { floor(xBase + (xBase < 0 ? 0 : 0.5)), floor(yBase + (yBase < 0 ? 0 : 0.5)), 0 };
             if (!position_is_reachable(pos, true)) continue;
           #endif
 
+          route_x[route_len] = xCount;
+          route_y[route_len] = yCount;
+          route_len++;
+
+        } //xProbe
+      } //yProbe
+
+      // Probed heights, for verification and for the results below
+      float probed_z[abl_grid_points_x][abl_grid_points_y];
+
+      #if ENABLED(PROBE_PIPELINE)
+        float expected_z = NAN; // Unknown until the first point is probed
+      #endif
+
+      for (int r = 0; r < route_len; r++) {
+
+        const uint8_t xCount = route_x[r], yCount = route_y[r];
+
+        float xBase = left_probe_bed_position + xGridSpacing * xCount,
+              yBase = front_probe_bed_position + yGridSpacing * yCount;
+
+        xProbe = floor(xBase + (xBase < 0 ? 0 : 0.5));
+        yProbe = floor(yBase + (yBase < 0 ? 0 : 0.5));
+
+        #if ENABLED(PROBE_PIPELINE)
+          // The route is serpentine, so the last point is a neighbor
+          measured_z = stow_probe_after_each
+            ? probe_pt(xProbe, yProbe, true, verbose_level)
+            : probe_pt_pipelined(xProbe, yProbe, expected_z, verbose_level);
+          expected_z = measured_z;
+        #else
           measured_z = probe_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
+        #endif
+
+        if (isnan(measured_z)) {
+          planner.abl_enabled = abl_should_enable;
+          return;
+        }
+
+        probed_z[xCount][yCount] = measured_z;
+
+        idle();
+
+      } // route
+
+      #ifdef PROBE_VERIFY_DEVIATION
+
+        // Find the points whose height differs from the mean of their probed
+        // neighbors by more than PROBE_VERIFY_DEVIATION, using the heights of
+        // the single-pass probes. Probe those twice more and keep the median.
+        uint8_t reprobed = 0;
+        for (int r = 0; r < route_len; r++) {
+          const uint8_t xCount = route_x[r], yCount = route_y[r];
+          float sum = 0;
+          uint8_t neighbors = 0;
+          for (int r2 = 0; r2 < route_len; r2++) {
+            if (abs(route_x[r2] - xCount) + abs(route_y[r2] - yCount) == 1) {
+              sum += probed_z[route_x[r2]][route_y[r2]];
+              neighbors++;
+            }
+          }
+          if (neighbors < 2 || fabs(probed_z[xCount][yCount] - sum / neighbors) <= PROBE_VERIFY_DEVIATION) continue;
+
+          float xBase = left_probe_bed_position + xGridSpacing * xCount,
+                yBase = front_probe_bed_position + yGridSpacing * yCount;
+
+          xProbe = floor(xBase + (xBase < 0 ? 0 : 0.5));
+          yProbe = floor(yBase + (yBase < 0 ? 0 : 0.5));
 
-          if (measured_z == NAN) {
+          const float z0 = probed_z[xCount][yCount],
+                      z1 = probe_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
+          measured_z = probe_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
+          if (isnan(z1) || isnan(measured_z)) {
             planner.abl_enabled = abl_should_enable;
             return;
           }
+          probed_z[xCount][yCount] = max(min(z0, z1), min(max(z0, z1), measured_z)); // median
+          reprobed++;
+        }
 
-          #if ENABLED(AUTO_BED_LEVELING_LINEAR)
+        if (verbose_level > 0 && reprobed) {
+          SERIAL_PROTOCOLPAIR("Re-probed ", (int)reprobed);
+          SERIAL_PROTOCOLLNPGM(" outlier point(s).");
+        }
 
-            mean += measured_z;
-            eqnBVector[probePointCounter] = measured_z;
-            eqnAMatrix[probePointCounter + 0 * abl2] = xProbe;
-            eqnAMatrix[probePointCounter + 1 * abl2] = yProbe;
-            eqnAMatrix[probePointCounter + 2 * abl2] = 1;
+      #endif // PROBE_VERIFY_DEVIATION
 
-          #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
+      // Store the results. xProbe, yProbe and measured_z keep the last probe taken.
+      for (int r = 0; r < route_len; r++) {
 
-            bed_level_grid[xCount][yCount] = measured_z + zoffset;
+        const uint8_t xCount = route_x[r], yCount = route_y[r];
+        const float z = probed_z[xCount][yCount];
 
-          #endif
+        #if ENABLED(AUTO_BED_LEVELING_LINEAR)
+
+          float xBase = left_probe_bed_position + xGridSpacing * xCount,
+                yBase = front_probe_bed_position + yGridSpacing * yCount;
 
-          idle();
+          indexIntoAB[xCount][yCount] = ++probePointCounter;
 
-        } //xProbe
-      } //yProbe
+          mean += z;
+          eqnBVector[probePointCounter] = z;
+          eqnAMatrix[probePointCounter + 0 * abl2] = floor(xBase + (xBase < 0 ? 0 : 0.5));
+          eqnAMatrix[probePointCounter + 1 * abl2] = floor(yBase + (yBase < 0 ? 0 : 0.5));
+          eqnAMatrix[probePointCounter + 2 * abl2] = 1;
+
+        #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
+
+          bed_level_grid[xCount][yCount] = z + zoffset;
+
+        #endif
+
+      } // route
 
     #elif ENABLED(AUTO_BED_LEVELING_3POINT)
 
@@ -4174,6 +4413,12 @@ inline void gcode_G28() {
       return;
     }
 
+    if (verbose_level > 0) {
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPAIR("Probing done in ", millis() - probe_start_ms);
+      SERIAL_ECHOLNPGM("ms");
+    }
+
     //
     // Unless this is a dry run, auto bed leveling will
     // definitely be enabled after this point
@@ -4453,6 +4698,271 @@ inline void gcode_G28() {
 
 #endif // HAS_BED_PROBE
 
+#if ENABLED(DELTA_AUTO_CALIBRATION)
+
+  // Fitted parameters, in the order they are added by the F factor count
+  enum DeltaCalParam {
+    DCAL_ADJ_A, DCAL_ADJ_B, DCAL_ADJ_C, // 3 factors: M666 XYZ
+    DCAL_RADIUS,                        // 4 factors: M665 R
+    DCAL_ANGLE_A, DCAL_ANGLE_B,         // 6 factors: M665 XY
+    DCAL_ROD,                           // 7 factors: M665 L
+    DCAL_PARAMS
+  };
+
+  /**
+   * Carriage heights of the effector at home for the current geometry.
+   * G28 sets the carriages to these, whatever the endstops.
+   */
+  static void delta_cal_home(float home[ABC]) {
+    const float top[XYZ] = { LOGICAL_X_POSITION(0), LOGICAL_Y_POSITION(0), LOGICAL_Z_POSITION(base_home_pos(Z_AXIS)) };
+    inverse_kinematics(top);
+    LOOP_XYZ(i) home[i] = delta[i];
+  }
+
+  /**
+   * Raw Z of the nozzle for carriage heights h[] (probed with endstop_adj[]
+   * after homing to home[]) once the machine is homed again with the
+   * geometry p[]. Changes the delta geometry globals.
+   */
+  static float delta_cal_height(const float h[ABC], const float home[ABC], const float p[DCAL_PARAMS]) {
+    delta_tower_angle_trim[A_AXIS] = p[DCAL_ANGLE_A];
+    delta_tower_angle_trim[B_AXIS] = p[DCAL_ANGLE_B];
+    recalc_delta_settings(p[DCAL_RADIUS], p[DCAL_ROD]);
+    // The new geometry puts the carriages somewhere else at home, too
+    float new_home[ABC];
+    delta_cal_home(new_home);
+    forward_kinematics_DELTA(
+      h[A_AXIS] + endstop_adj[A_AXIS] - p[DCAL_ADJ_A] + new_home[A_AXIS] - home[A_AXIS],
+      h[B_AXIS] + endstop_adj[B_AXIS] - p[DCAL_ADJ_B] + new_home[B_AXIS] - home[B_AXIS],
+      h[C_AXIS] + endstop_adj[C_AXIS] - p[DCAL_ADJ_C] + new_home[C_AXIS] - home[C_AXIS]
+    );
+    return cartes[Z_AXIS];
+  }
+
+  /**
+   * Root mean square of the height error over all probed points
+   */
+  static float delta_cal_deviation(const float h[][ABC], const float home[ABC], const uint8_t points, const float p[DCAL_PARAMS], const float target) {
+    float sum = 0;
+    for (uint8_t i = 0; i < points; i++) sum += sq(delta_cal_height(h[i], home, p) - target);
+    return sqrt(sum / points);
+  }
+
+  /**
+   * G33: Delta auto-calibration
+   *
+   * Probes the center and one or two rings of points, then fits the
+   * delta geometry to the probed heights with an iterative (Gauss-Newton)
+   * least-squares solver, applies it and re-homes. Bed leveling is left
+   * disabled since any existing grid no longer matches the geometry.
+   *
+   * Parameters:
+   *
+   *  F<3|4|6|7> Number of factors to calibrate:
+   *     3: Endstop adjustments (M666 XYZ)
+   *     4: And delta radius (M665 R)
+   *     6: And tower angle trims of towers 1 and 2 (M665 XY)
+   *     7: And diagonal rod (M665 L)
+   *  P<n>  Points on the outer ring
+   *  Q<n>  Points on the inner ring, at half the radius
+   *  R<r>  Radius of the outer ring
+   *  D     Dry run. Report the fit without applying it.
+   *  V<0-2> Verbose level. V2 reports each point's residual.
+   */
+  inline void gcode_G33() {
+
+    if (axis_unhomed_error(true, true, true)) return;
+
+    const int8_t factors = code_seen('F') ? code_value_int() : DELTA_CALIBRATION_DEFAULT_FACTORS;
+    if (factors != 3 && factors != 4 && factors != 6 && factors != 7) {
+      SERIAL_PROTOCOLLNPGM("?(F)actors must be 3, 4, 6 or 7.");
+      return;
+    }
+
+    const int outer = code_seen('P') ? code_value_int() : DELTA_CALIBRATION_OUTER_POINTS,
+              inner = code_seen('Q') ? code_value_int() : DELTA_CALIBRATION_INNER_POINTS;
+    if (outer < 3 || inner < 0 || 1 + outer + inner > DELTA_CALIBRATION_MAX_POINTS) {
+      SERIAL_PROTOCOLLNPGM("?(P) must be 3 or more and 1+P+Q at most " STRINGIFY(DELTA_CALIBRATION_MAX_POINTS) ".");
+      return;
+    }
+
+    const float radius = code_seen('R') ? code_value_linear_units() : DELTA_CALIBRATION_RADIUS;
+    const bool dryrun = code_seen('D');
+    const int8_t verbose_level = code_seen('V') ? code_value_int() : 1;
+
+    // Plan the probe points, center first
+    float probe_x[DELTA_CALIBRATION_MAX_POINTS], probe_y[DELTA_CALIBRATION_MAX_POINTS];
+    uint8_t points = 0;
+    for (uint8_t i = 0; i < 1 + outer + inner; i++) {
+      float r = 0, a = 0;
+      if (i > outer) {                   // inner ring, offset by half a step
+        r = radius * 0.5;
+        a = RADIANS(90 + 360.0 * (i - outer - 0.5) / inner);
+      }
+      else if (i > 0) {                  // outer ring, starting at tower 3
+        r = radius;
+        a = RADIANS(90 + 360.0 * (i - 1) / outer);
+      }
+      float pos[XYZ] = { LOGICAL_X_POSITION(r * cos(a)), LOGICAL_Y_POSITION(r * sin(a)), 0 };
+      if (!position_is_reachable(pos, true)) continue;
+      probe_x[points] = pos[X_AXIS];
+      probe_y[points] = pos[Y_AXIS];
+      points++;
+    }
+    if (points <= factors) {
+      SERIAL_PROTOCOLLNPGM("?Too few reachable points for the factors. Reduce (R) or (F).");
+      return;
+    }
+
+    if (verbose_level > 0) {
+      SERIAL_PROTOCOLPAIR("G33 Delta calibration, points: ", (int)points);
+      SERIAL_PROTOCOLLNPAIR(" factors: ", (int)factors);
+    }
+
+    #if PLANNER_LEVELING
+      set_bed_leveling_enabled(false);
+    #endif
+
+    setup_for_endstop_or_probe_move();
+
+    // Probe, keeping the carriage heights where the probe triggered
+    float h[DELTA_CALIBRATION_MAX_POINTS][ABC];
+    for (uint8_t i = 0; i < points; i++) {
+      const float measured_z = probe_pt(probe_x[i], probe_y[i], i == points - 1, verbose_level > 1 ? 3 : 0);
+      if (isnan(measured_z)) {
+        clean_up_after_endstop_or_probe_move();
+        return;
+      }
+      const float nozzle[XYZ] = {
+        probe_x[i] - (X_PROBE_OFFSET_FROM_EXTRUDER),
+        probe_y[i] - (Y_PROBE_OFFSET_FROM_EXTRUDER),
+        measured_z
+      };
+      inverse_kinematics(nozzle);
+      LOOP_XYZ(j) h[i][j] = delta[j];
+      idle();
+    }
+
+    clean_up_after_endstop_or_probe_move();
+
+    // With the bed at Z=0 the nozzle is -zprobe_zoffset above it on trigger
+    const float target = RAW_Z_POSITION(-zprobe_zoffset);
+
+    float home[ABC];
+    delta_cal_home(home);
+
+    float p[DCAL_PARAMS] = {
+      endstop_adj[A_AXIS], endstop_adj[B_AXIS], endstop_adj[C_AXIS],
+      delta_radius,
+      delta_tower_angle_trim[A_AXIS], delta_tower_angle_trim[B_AXIS],
+      delta_diagonal_rod
+    };
+    const float saved_angle_trim_a = delta_tower_angle_trim[A_AXIS],
+                saved_angle_trim_b = delta_tower_angle_trim[B_AXIS],
+                deviation_before = delta_cal_deviation(h, home, points, p, target);
+
+    // Gauss-Newton: linearize with numeric derivatives, solve the least
+    // squares step with qr_solve(), repeat until the step is negligible or
+    // no longer improves the fit. The rod and radius nearly trade off
+    // against each other, so with F7 the steps along that line stay large
+    // while the heights hardly change.
+    float jacobian[DELTA_CALIBRATION_MAX_POINTS * DCAL_PARAMS],
+          residual[DELTA_CALIBRATION_MAX_POINTS],
+          step[DCAL_PARAMS],
+          deviation = deviation_before;
+    uint8_t iterations = 0;
+    while (iterations < DELTA_CALIBRATION_MAX_ITERATIONS) {
+      iterations++;
+      for (uint8_t i = 0; i < points; i++) {
+        const float z = delta_cal_height(h[i], home, p);
+        residual[i] = target - z;
+        for (uint8_t j = 0; j < factors; j++) {
+          const float pj = p[j];
+          p[j] += 0.1;
+          jacobian[i + j * points] = (delta_cal_height(h[i], home, p) - z) / 0.1;
+          p[j] = pj;
+        }
+      }
+
+      qr_solve(step, points, factors, jacobian, residual);
+
+      float largest = 0;
+      for (uint8_t j = 0; j < factors; j++) {
+        p[j] += step[j];
+        NOLESS(largest, fabs(step[j]));
+      }
+      const float stepped = delta_cal_deviation(h, home, points, p, target);
+      if (stepped > deviation)
+        for (uint8_t j = 0; j < factors; j++) p[j] -= step[j];
+      if (largest < 0.001 || stepped > deviation - 0.001) break;
+      deviation = stepped;
+
+      // Service the heaters and LCD between iterations, with the
+      // machine's own geometry in place rather than the trial one
+      delta_tower_angle_trim[A_AXIS] = saved_angle_trim_a;
+      delta_tower_angle_trim[B_AXIS] = saved_angle_trim_b;
+      recalc_delta_settings(delta_radius, delta_diagonal_rod);
+      idle();
+    }
+
+    const float deviation_after = delta_cal_deviation(h, home, points, p, target);
+
+    if (verbose_level > 0) {
+      SERIAL_PROTOCOLPGM("Deviation before: ");
+      SERIAL_PROTOCOL_F(deviation_before, 3);
+      SERIAL_PROTOCOLPGM(" after: ");
+      SERIAL_PROTOCOL_F(deviation_after, 3);
+      SERIAL_PROTOCOLLNPAIR(" iterations: ", (int)iterations);
+      if (verbose_level > 1) {
+        for (uint8_t i = 0; i < points; i++) {
+          SERIAL_PROTOCOLPGM("Residual X: ");
+          SERIAL_PROTOCOL_F(probe_x[i], 1);
+          SERIAL_PROTOCOLPGM(" Y: ");
+          SERIAL_PROTOCOL_F(probe_y[i], 1);
+          SERIAL_PROTOCOLPGM(" Z: ");
+          SERIAL_PROTOCOL_F(delta_cal_height(h[i], home, p) - target, 3);
+          SERIAL_EOL;
+        }
+      }
+    }
+
+    if (dryrun || !(deviation_after < deviation_before)) {
+      if (!dryrun) SERIAL_PROTOCOLLNPGM("Fit is no better. Settings unchanged.");
+      // Put back the geometry the solver changed
+      delta_tower_angle_trim[A_AXIS] = saved_angle_trim_a;
+      delta_tower_angle_trim[B_AXIS] = saved_angle_trim_b;
+      recalc_delta_settings(delta_radius, delta_diagonal_rod);
+      return;
+    }
+
+    // Apply the fit. The highest endstop stays at 0 and the difference
+    // goes into the Z home offset so the homed height stays consistent.
+    const float adj_max = max(max(p[DCAL_ADJ_A], p[DCAL_ADJ_B]), p[DCAL_ADJ_C]);
+    LOOP_XYZ(i) endstop_adj[i] = p[DCAL_ADJ_A + i] - adj_max;
+    set_home_offset(Z_AXIS, home_offset[Z_AXIS] - adj_max);
+    delta_radius = p[DCAL_RADIUS];
+    delta_diagonal_rod = p[DCAL_ROD];
+    delta_tower_angle_trim[A_AXIS] = p[DCAL_ANGLE_A];
+    delta_tower_angle_trim[B_AXIS] = p[DCAL_ANGLE_B];
+    recalc_delta_settings(delta_radius, delta_diagonal_rod);
+
+    gcode_G28();
+
+    SERIAL_PROTOCOLPGM("M666");
+    SERIAL_PROTOCOLPAIR(" X", endstop_adj[X_AXIS]);
+    SERIAL_PROTOCOLPAIR(" Y", endstop_adj[Y_AXIS]);
+    SERIAL_PROTOCOLLNPAIR(" Z", endstop_adj[Z_AXIS]);
+    SERIAL_PROTOCOLPGM("M665");
+    SERIAL_PROTOCOLPAIR(" L", delta_diagonal_rod);
+    SERIAL_PROTOCOLPAIR(" R", delta_radius);
+    SERIAL_PROTOCOLPAIR(" X", delta_tower_angle_trim[A_AXIS]);
+    SERIAL_PROTOCOLLNPAIR(" Y", delta_tower_angle_trim[B_AXIS]);
+    SERIAL_PROTOCOLLNPAIR("M206 Z", home_offset[Z_AXIS]);
+    SERIAL_PROTOCOLLNPGM("Use M500 to save.");
+  }
+
+#endif // DELTA_AUTO_CALIBRATION
+
 #if ENABLED(G38_PROBE_TARGET)
 
   static bool G38_run_probe() {
@@ -4584,7 +5094,7 @@ inline void gcode_G92() {
    * M1: Conditional stop   - Wait for user button press on LCD
    */
   inline void gcode_M0_M1() {
-    char* args = current_command_args;
+    char* args = command_text();
 
     millis_t codenum = 0;
     bool hasP = false, hasS = false;
@@ -4676,7 +5186,7 @@ inline void gcode_M17() {
   /**
    * M23: Open a file
    */
-  inline void gcode_M23() { card.openFile(current_command_args, true); }
+  inline void gcode_M23() { card.openFile(command_text(), true); }
 
   /**
    * M24: Start SD Print
@@ -4699,15 +5209,57 @@ inline void gcode_M17() {
       card.setIndex(code_value_long());
   }
 
+  #if ENABLED(AUTO_REPORT_SD_STATUS)
+
+    static uint8_t auto_report_sd_interval;
+    static millis_t next_sd_report_ms;
+
+    inline void auto_report_sd_status() {
+      if (auto_report_sd_interval && card.isFileOpen() && ELAPSED(millis(), next_sd_report_ms)) {
+        next_sd_report_ms = millis() + 1000UL * auto_report_sd_interval;
+        card.getStatus();
+      }
+    }
+
+  #endif
+
   /**
    * M27: Get SD Card status
+   *
+   *  S<seconds> Report it while printing at this interval instead. S0 stops.
    */
-  inline void gcode_M27() { card.getStatus(); }
+  inline void gcode_M27() {
+    #if ENABLED(AUTO_REPORT_SD_STATUS)
+      if (code_seen('S')) {
+        auto_report_sd_interval = code_value_byte();
+        NOMORE(auto_report_sd_interval, 60);
+        next_sd_report_ms = millis() + 1000UL * auto_report_sd_interval;
+        return;
+      }
+    #endif
+    card.getStatus();
+  }
 
   /**
    * M28: Start SD Write
+   *
+   *  S<bytes> Size of the upload, counting "\r\n" per line (SD_FAST_UPLOAD)
    */
-  inline void gcode_M28() { card.openFile(current_command_args, false); }
+  inline void gcode_M28() {
+    #if ENABLED(SD_FAST_UPLOAD)
+      // "M28 S<bytes> <file>" allocates the file up front
+      char *name = command_text();
+      if (name[0] == 'S' && NUMERIC(name[1])) {
+        const uint32_t size = strtoul(name + 1, &name, 10);
+        if (*name == ' ') {
+          while (*name == ' ') name++;
+          card.openUpload(name, size);
+          return;
+        }
+      }
+    #endif
+    card.openFile(command_text(), false);
+  }
 
   /**
    * M29: Stop SD Write
@@ -4723,7 +5275,7 @@ inline void gcode_M17() {
   inline void gcode_M30() {
     if (card.cardOK) {
       card.closefile();
-      card.removeFile(current_command_args);
+      card.removeFile(command_text());
     }
   }
 
@@ -4756,7 +5308,7 @@ inline void gcode_M31() {
     if (card.sdprinting)
       stepper.synchronize();
 
-    char* namestartpos = strchr(current_command_args, '!');  // Find ! to indicate filename string start.
+    char* namestartpos = strchr(command_text(), '!');  // Find ! to indicate filename string start.
     if (!namestartpos)
       namestartpos = current_command_args; // Default name position, 4 letters after the M
     else
@@ -4792,7 +5344,7 @@ inline void gcode_M31() {
      *   /Miscellaneous/Armchair/Armchair.gcode
      */
     inline void gcode_M33() {
-      card.printLongPath(current_command_args);
+      card.printLongPath(command_text());
     }
 
   #endif
@@ -4801,7 +5353,7 @@ inline void gcode_M31() {
    * M928: Start SD Write
    */
   inline void gcode_M928() {
-    card.openLogFile(current_command_args);
+    card.openLogFile(command_text());
   }
 
 #endif // SDSUPPORT
@@ -5184,6 +5736,25 @@ inline void gcode_M42() {
 
 #endif // Z_MIN_PROBE_REPEATABILITY_TEST
 
+#if ENABLED(SD_PRINT_TIME_ESTIMATE)
+
+  /**
+   * M73: Set the progress of the SD print
+   *
+   *  P<percent>  Percent done
+   *  R<minutes>  Minutes remaining
+   *
+   * Written into the file by tools/print_time.py --annotate.
+   */
+  inline void gcode_M73() {
+    if (code_seen('P')) {
+      const uint8_t percent = code_value_byte();
+      card.setEstimate(percent, code_seen('R') ? code_value_ushort() : 0);
+    }
+  }
+
+#endif
+
 /**
  * M75: Start print timer
  */
@@ -5219,6 +5790,11 @@ inline void gcode_M104() {
   if (get_target_extruder_from_command(104)) return;
   if (DEBUGGING(DRYRUN)) return;
 
+  #if ENABLED(SD_JOB_QUEUE)
+    // Keep the hotend hot for the next job in the queue. The host can still turn it off.
+    if (current_command_from_sd && card.jobQueueHoldsHeat() && code_seen('S') && !code_value_temp_abs()) return;
+  #endif
+
   #if ENABLED(SINGLENOZZLE)
     if (target_extruder != active_extruder) return;
   #endif
@@ -5347,19 +5923,194 @@ inline void gcode_M105() {
 
 #endif // AUTO_REPORT_TEMPERATURES
 
-#if FAN_COUNT > 0
+#if ENABLED(AUTO_REPORT_POSITION)
+
+  static uint8_t auto_report_pos_interval;
+  static millis_t next_pos_report_ms;
 
   /**
-   * M106: Set Fan Speed
-   *
-   *  S<int>   Speed between 0-255
-   *  P<index> Fan index, if more than one fan
+   * M154: Set position auto-report interval. M154 S<seconds>
    */
-  inline void gcode_M106() {
-    uint16_t s = code_seen('S') ? code_value_ushort() : 255,
-             p = code_seen('P') ? code_value_ushort() : 0;
-    NOMORE(s, 255);
-    if (p < FAN_COUNT) fanSpeeds[p] = s;
+  inline void gcode_M154() {
+    if (code_seen('S')) {
+      auto_report_pos_interval = code_value_byte();
+      NOMORE(auto_report_pos_interval, 60);
+      next_pos_report_ms = millis() + 1000UL * auto_report_pos_interval;
+    }
+  }
+
+  /**
+   * Report where the steppers are now, as "X: Y: Z: E:".
+   * Unlike M114 this follows the nozzle while it moves.
+   */
+  inline void auto_report_position() {
+    if (auto_report_pos_interval && ELAPSED(millis(), next_pos_report_ms)) {
+      next_pos_report_ms = millis() + 1000UL * auto_report_pos_interval;
+      get_cartesian_from_steppers();
+      SERIAL_PROTOCOLPGM("X:");
+      SERIAL_PROTOCOL(cartes[X_AXIS]);
+      SERIAL_PROTOCOLPGM(" Y:");
+      SERIAL_PROTOCOL(cartes[Y_AXIS]);
+      SERIAL_PROTOCOLPGM(" Z:");
+      SERIAL_PROTOCOL(cartes[Z_AXIS]);
+      SERIAL_PROTOCOLPGM(" E:");
+      SERIAL_PROTOCOLLN(stepper.get_axis_position_mm(E_AXIS));
+    }
+  }
+
+#endif // AUTO_REPORT_POSITION
+
+#if HAS_AUTO_REPORTING
+
+  /**
+   * Send the reports the host subscribed to with M155, M154 and M27 S
+   */
+  static void auto_report() {
+    #if ENABLED(AUTO_REPORT_TEMPERATURES) && (HAS_TEMP_HOTEND || HAS_TEMP_BED)
+      auto_report_temperatures();
+    #endif
+    #if ENABLED(AUTO_REPORT_POSITION)
+      auto_report_position();
+    #endif
+    #if ENABLED(AUTO_REPORT_SD_STATUS)
+      auto_report_sd_status();
+    #endif
+  }
+
+#endif
+
+#if ENABLED(IDLE_TASK_SCHEDULER)
+
+  /**
+   * Tasks visited by idle(), in priority order. Tasks before
+   * IDLE_TASK_FIRST_DEFERRABLE run whenever they are due. The
+   * rest can be postponed, but never past their deadline.
+   */
+  enum IdleTask {
+    IDLE_TASK_HEATER,
+    IDLE_TASK_INACTIVITY,
+    IDLE_TASK_KEEPALIVE,
+    #if HAS_AUTO_REPORTING
+      IDLE_TASK_AUTOREPORT,
+    #endif
+    #if HAS_BUZZER && DISABLED(LCD_USE_I2C_BUZZER)
+      IDLE_TASK_BUZZER,
+    #endif
+    IDLE_TASK_FIRST_DEFERRABLE,
+    IDLE_TASK_LCD = IDLE_TASK_FIRST_DEFERRABLE,
+    #if ENABLED(PRINTCOUNTER)
+      IDLE_TASK_PRINTCOUNTER,
+    #endif
+    IDLE_TASK_COMMANDS, // Accounted by loop(), never dispatched by idle()
+    IDLE_TASK_COUNT
+  };
+
+  struct idle_task_stats_t {
+    uint32_t runs,      // Number of times the task ran
+             total_us,  // Accumulated run time
+             max_us,    // Longest single run
+             deferred,  // Times the task was due but postponed
+             forced;    // Times the task ran only because its deadline passed
+  };
+
+  static idle_task_stats_t idle_task_stats[IDLE_TASK_COUNT];
+  static millis_t idle_task_last_ms[IDLE_TASK_COUNT];
+
+  // Set while loop() runs a command handler. Nothing more is parsed until
+  // the handler returns, so there is no reason to starve the LCD meanwhile.
+  static bool command_in_progress = false;
+
+  /**
+   * Minimum time between two runs of a task. Tasks that pace
+   * themselves (heater, LCD, buzzer) are offered every pass.
+   */
+  static millis_t idle_task_period(const uint8_t t) {
+    switch (t) {
+      case IDLE_TASK_KEEPALIVE:
+      #if HAS_AUTO_REPORTING
+        case IDLE_TASK_AUTOREPORT:
+      #endif
+      #if ENABLED(PRINTCOUNTER)
+        case IDLE_TASK_PRINTCOUNTER:
+      #endif
+        return 250;
+      default:
+        return 0;
+    }
+  }
+
+  /**
+   * Longest time a deferrable task may be postponed
+   */
+  static millis_t idle_task_deadline(const uint8_t t) {
+    return t == IDLE_TASK_LCD ? (IDLE_LCD_MAX_DEFER) : 1000;
+  }
+
+  static const char* idle_task_name(const uint8_t t) {
+    switch (t) {
+      case IDLE_TASK_HEATER:       return PSTR("heater");
+      case IDLE_TASK_INACTIVITY:   return PSTR("inactivity");
+      case IDLE_TASK_KEEPALIVE:    return PSTR("keepalive");
+      #if HAS_AUTO_REPORTING
+        case IDLE_TASK_AUTOREPORT: return PSTR("autoreport");
+      #endif
+      #if HAS_BUZZER && DISABLED(LCD_USE_I2C_BUZZER)
+        case IDLE_TASK_BUZZER:     return PSTR("buzzer");
+      #endif
+      case IDLE_TASK_LCD:          return PSTR("lcd");
+      #if ENABLED(PRINTCOUNTER)
+        case IDLE_TASK_PRINTCOUNTER: return PSTR("printcounter");
+      #endif
+      default:                     return PSTR("commands");
+    }
+  }
+
+  static void idle_task_account(const uint8_t t, const uint32_t start_us) {
+    const uint32_t us = micros() - start_us;
+    idle_task_stats_t &stats = idle_task_stats[t];
+    stats.runs++;
+    stats.total_us += us;
+    NOLESS(stats.max_us, us);
+  }
+
+  /**
+   * M102: Report idle task run time statistics. M102 R resets them.
+   *
+   *  The "commands" line covers command handlers run from loop(),
+   *  including any time they spend waiting inside idle().
+   */
+  inline void gcode_M102() {
+    if (code_seen('R')) {
+      ZERO(idle_task_stats);
+      return;
+    }
+    for (uint8_t t = 0; t < IDLE_TASK_COUNT; t++) {
+      const idle_task_stats_t &stats = idle_task_stats[t];
+      SERIAL_ECHO_START;
+      serialprintPGM(idle_task_name(t));
+      SERIAL_ECHOPAIR(" runs:", stats.runs);
+      SERIAL_ECHOPAIR(" avg:", stats.runs ? stats.total_us / stats.runs : 0UL);
+      SERIAL_ECHOPAIR("us max:", stats.max_us);
+      SERIAL_ECHOPAIR("us deferred:", stats.deferred);
+      SERIAL_ECHOLNPAIR(" forced:", stats.forced);
+    }
+  }
+
+#endif // IDLE_TASK_SCHEDULER
+
+#if FAN_COUNT > 0
+
+  /**
+   * M106: Set Fan Speed
+   *
+   *  S<int>   Speed between 0-255
+   *  P<index> Fan index, if more than one fan
+   */
+  inline void gcode_M106() {
+    uint16_t s = code_seen('S') ? code_value_ushort() : 255,
+             p = code_seen('P') ? code_value_ushort() : 0;
+    NOMORE(s, 255);
+    if (p < FAN_COUNT) fanSpeeds[p] = s;
   }
 
   /**
@@ -5394,6 +6145,49 @@ inline void gcode_M105() {
    */
   inline void gcode_M410() { quickstop_stepper(); }
 
+#endif
+
+#if ENABLED(HEATUP_PLANNER)
+
+  /**
+   * Set the targets of the M104/M109/M140/M190 queued behind a waiting
+   * M109 or M190, up to the next G command, so the heaters warm up
+   * together. The bed starts at once, hotends when the planner says.
+   * The commands themselves still run in order, and the heater being
+   * waited for (-1 for the bed) keeps the target it is waited for.
+   */
+  static void plan_queued_heatup(const int8_t waiting) {
+    #if ENABLED(TEMPERATURE_UNITS_SUPPORT)
+      if (input_temp_units != TEMPUNIT_C) return;
+    #endif
+    for (uint8_t i = 1; i < commands_in_queue; i++) {
+      const char *cmd = command_queue[(cmd_queue_index_r + i) % BUFSIZE];
+      while (*cmd == ' ') cmd++;
+      if (*cmd == 'N') { // Skip the line number
+        do cmd++; while (NUMERIC(*cmd));
+        while (*cmd == ' ') cmd++;
+      }
+      if (*cmd == 'G') break;
+      if (*cmd != 'M') continue;
+
+      const int code = atoi(cmd + 1);
+      if (code != 104 && code != 109 && code != 140 && code != 190) continue;
+      const char *value = strchr(cmd, 'S');
+      if (!value) value = strchr(cmd, 'R');
+      if (!value) continue;
+      const float celsius = strtod(value + 1, NULL);
+
+      if (code == 140 || code == 190) {
+        if (waiting >= 0 && celsius > thermalManager.degTargetBed()) thermalManager.setTargetBed(celsius);
+      }
+      else {
+        const char *tool = strchr(cmd, 'T');
+        const uint8_t e = tool ? atoi(tool + 1) : active_extruder;
+        if (e < HOTENDS && e != waiting) thermalManager.planTargetHotend(celsius, e);
+      }
+    }
+  }
+
 #endif
 
   #ifndef MIN_COOLING_SLOPE_DEG
@@ -5479,6 +6273,9 @@ inline void gcode_M109() {
     if (ELAPSED(now, next_temp_ms)) { //Print temp & remaining time every 1s while waiting
       next_temp_ms = now + 1000UL;
       print_heaterstates();
+      #if ENABLED(HEATUP_PLANNER)
+        plan_queued_heatup(target_extruder);
+      #endif
       #if TEMP_RESIDENCY_TIME > 0
         SERIAL_PROTOCOLPGM(" W:");
         if (residency_start_ms) {
@@ -5598,6 +6395,9 @@ inline void gcode_M109() {
       if (ELAPSED(now, next_temp_ms)) { //Print Temp Reading every 1 second while heating up.
         next_temp_ms = now + 1000UL;
         print_heaterstates();
+        #if ENABLED(HEATUP_PLANNER)
+          plan_queued_heatup(-1);
+        #endif
         #if TEMP_BED_RESIDENCY_TIME > 0
           SERIAL_PROTOCOLPGM(" W:");
           if (residency_start_ms) {
@@ -5748,6 +6548,9 @@ inline void gcode_M111() {
  */
 inline void gcode_M140() {
   if (DEBUGGING(DRYRUN)) return;
+  #if ENABLED(SD_JOB_QUEUE)
+    if (current_command_from_sd && card.jobQueueHoldsHeat() && code_seen('S') && !code_value_temp_abs()) return;
+  #endif
   if (code_seen('S')) thermalManager.setTargetBed(code_value_temp_abs());
 }
 
@@ -5991,6 +6794,20 @@ inline void gcode_M115() {
       SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_TEMP:0");
     #endif
 
+    // AUTOREPORT_POS (M154)
+    #if ENABLED(AUTO_REPORT_POSITION)
+      SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_POS:1");
+    #else
+      SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_POS:0");
+    #endif
+
+    // AUTOREPORT_SD_STATUS (M27 S)
+    #if ENABLED(AUTO_REPORT_SD_STATUS)
+      SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_SD_STATUS:1");
+    #else
+      SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_SD_STATUS:0");
+    #endif
+
     // PROGRESS (M530 S L, M531 <file>, M532 X L)
     SERIAL_PROTOCOLLNPGM("Cap:PROGRESS:0");
 
@@ -6029,6 +6846,13 @@ inline void gcode_M115() {
       SERIAL_PROTOCOLLNPGM("Cap:EMERGENCY_PARSER:0");
     #endif
 
+    // BINARY_FILE_TRANSFER (M1002)
+    #if ENABLED(BINARY_FILE_TRANSFER)
+      SERIAL_PROTOCOLLNPGM("Cap:BINARY_FILE_TRANSFER:1");
+    #else
+      SERIAL_PROTOCOLLNPGM("Cap:BINARY_FILE_TRANSFER:0");
+    #endif
+
   #endif // EXTENDED_CAPABILITIES_REPORT
 }
 
@@ -6036,7 +6860,7 @@ inline void gcode_M115() {
  * M117: Set LCD Status Message
  */
 inline void gcode_M117() {
-  lcd_setstatus(current_command_args);
+  lcd_setstatus(command_text());
 }
 
 /**
@@ -6301,6 +7125,9 @@ inline void gcode_M206() {
    *    A = Alpha (Tower 1) diagonal rod trim
    *    B = Beta (Tower 2) diagonal rod trim
    *    C = Gamma (Tower 3) diagonal rod trim
+   *    X = Alpha (Tower 1) angle trim
+   *    Y = Beta (Tower 2) angle trim
+   *    Z = Gamma (Tower 3) angle trim
    */
   inline void gcode_M665() {
     if (code_seen('L')) delta_diagonal_rod = code_value_linear_units();
@@ -6309,6 +7136,9 @@ inline void gcode_M206() {
     if (code_seen('A')) delta_diagonal_rod_trim_tower_1 = code_value_linear_units();
     if (code_seen('B')) delta_diagonal_rod_trim_tower_2 = code_value_linear_units();
     if (code_seen('C')) delta_diagonal_rod_trim_tower_3 = code_value_linear_units();
+    if (code_seen('X')) delta_tower_angle_trim[A_AXIS] = code_value_float();
+    if (code_seen('Y')) delta_tower_angle_trim[B_AXIS] = code_value_float();
+    if (code_seen('Z')) delta_tower_angle_trim[C_AXIS] = code_value_float();
     recalc_delta_settings(delta_radius, delta_diagonal_rod);
   }
   /**
@@ -6659,6 +7489,24 @@ inline void gcode_M226() {
 
 #endif // PIDTEMP
 
+#if ENABLED(PID_FEEDFORWARD)
+
+  /**
+   * M306: Set the hotend feed-forward, in PID output units (0-PID_MAX)
+   *
+   *   E<power>  per mm/s of filament fed
+   *   F<power>  with the part fan at full speed
+   */
+  inline void gcode_M306() {
+    if (code_seen('E')) thermalManager.ff_extrusion = code_value_float();
+    if (code_seen('F')) thermalManager.ff_fan = code_value_float();
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR(" e:", thermalManager.ff_extrusion);
+    SERIAL_ECHOLNPAIR(" f:", thermalManager.ff_fan);
+  }
+
+#endif
+
 #if ENABLED(PIDTEMPBED)
 
   inline void gcode_M304() {
@@ -7583,6 +8431,255 @@ inline void gcode_M999() {
   FlushSerialRequestResend();
 }
 
+#if ENABLED(SD_CHECKPOINT)
+
+  static millis_t next_checkpoint_ms = 0;
+
+  /**
+   * Save the state of the SD print to SD_CHECKPOINT_FILE
+   *
+   * The file offset, feedrate and fans are those of the command whose
+   * block the stepper is running, or of the last command run when no
+   * block is queued. The position is read from the steppers after the
+   * block, so it lies on the path of that command and M1000 continues
+   * the command from there. Nothing is saved while a command that
+   * didn't come from the printed files is running.
+   *
+   * With 'stop' the steppers are halted right after the block is read,
+   * as when the print is stopped from the LCD.
+   */
+  void save_sd_checkpoint(const bool stop/*=false*/) {
+    next_checkpoint_ms = millis() + (SD_CHECKPOINT_INTERVAL) * 1000UL;
+
+    sd_checkpoint_t state;
+    uint16_t block_feedrate_mm_m = 0;
+
+    CRITICAL_SECTION_START;
+    const bool moving = planner.blocks_queued();
+    const block_plan_t &plan = planner.block_plan[planner.block_buffer_tail];
+    state.sdpos = moving ? plan.sdpos : planner.command_sdpos;
+    state.depth = moving ? plan.sddepth : planner.command_sddepth;
+    if (moving) block_feedrate_mm_m = plan.feedrate_mm_m;
+    #if FAN_COUNT > 0
+      for (uint8_t i = 0; i < FAN_COUNT; i++) state.fan_speed[i] = moving ? plan.fan_speed[i] : fanSpeeds[i];
+    #endif
+    CRITICAL_SECTION_END;
+
+    if (stop) quickstop_stepper();
+
+    if (state.sdpos == NO_SD_POS) return; // Not running a command from the file
+
+    state.magic = SD_CHECKPOINT_MAGIC;
+
+    // Blocks carry the feedrate scaled by M220, the file has the plain one
+    state.feedrate_mm_s = moving ? MMM_TO_MMS(block_feedrate_mm_m) * 100.0 / feedrate_percentage : feedrate_mm_s;
+
+    get_cartesian_from_steppers();
+    #if PLANNER_LEVELING
+      if (
+        #if ENABLED(MESH_BED_LEVELING)
+          mbl.active()
+        #else
+          planner.abl_enabled
+        #endif
+      ) planner.unapply_leveling(cartes);
+    #endif
+    LOOP_XYZ(i) state.position[i] = cartes[i];
+    state.position[E_AXIS] = stepper.get_axis_position_mm(E_AXIS);
+
+    HOTEND_LOOP() state.target_temperature[e] = thermalManager.degTargetHotend(e);
+    state.target_temperature_bed =
+      #if HAS_TEMP_BED
+        thermalManager.degTargetBed()
+      #else
+        0
+      #endif
+    ;
+
+    state.active_extruder = active_extruder;
+    state.relative_mode = relative_mode;
+    LOOP_XYZE(i) state.axis_relative_modes[i] = axis_relative_modes[i];
+
+    card.writeCheckpoint(state);
+  }
+
+  static bool checkpoint_heating() {
+    HOTEND_LOOP()
+      if (thermalManager.degTargetHotend(e) && thermalManager.degHotend(e) < thermalManager.degTargetHotend(e) - (TEMP_WINDOW))
+        return true;
+    #if HAS_TEMP_BED
+      if (thermalManager.degTargetBed() && thermalManager.degBed() < thermalManager.degTargetBed() - (TEMP_BED_WINDOW))
+        return true;
+    #endif
+    return false;
+  }
+
+  /**
+   * M1000: Resume the SD print saved by SD_CHECKPOINT
+   *
+   *  C  Discard the checkpoint instead
+   *
+   * Reheats, homes the axes that home away from the print and moves
+   * back in from SD_CHECKPOINT_Z_CLEARANCE above the saved position.
+   * The saved command then runs again from there and the print goes on.
+   * Machines that home Z toward the bed take Z from the checkpoint.
+   *
+   * An interrupted relative move (G91, M83) or arc is redone in full
+   * from the saved position.
+   */
+  inline void gcode_M1000() {
+    if (card.isFileOpen()) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_CHECKPOINT_BUSY);
+      return;
+    }
+
+    if (code_seen('C')) {
+      card.clearCheckpoint();
+      return;
+    }
+
+    sd_checkpoint_t state;
+    char path[SD_PROCEDURE_DEPTH + 1][MAXPATHNAMELENGTH];
+    if (!card.readCheckpoint(state, path)) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_CHECKPOINT_NONE);
+      return;
+    }
+
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR(MSG_SD_CHECKPOINT_RESUME, path[state.depth]);
+    SERIAL_ECHOLNPAIR(" pos ", state.sdpos);
+
+    // Reheat
+    HOTEND_LOOP() thermalManager.setTargetHotend(state.target_temperature[e], e);
+    #if HAS_TEMP_BED
+      thermalManager.setTargetBed(state.target_temperature_bed);
+    #endif
+
+    LCD_MESSAGEPGM(MSG_HEATING);
+    KEEPALIVE_STATE(NOT_BUSY);
+    wait_for_heatup = true;
+    while (wait_for_heatup && checkpoint_heating()) {
+      idle();
+      refresh_cmd_timeout();
+    }
+    KEEPALIVE_STATE(IN_HANDLER);
+    if (!wait_for_heatup) return; // Cancelled from the LCD
+    LCD_MESSAGEPGM(MSG_HEATING_COMPLETE);
+
+    #if EXTRUDERS > 1
+      tool_change(state.active_extruder, 0, true);
+    #endif
+
+    // Home the axes that move away from the print
+    setup_for_endstop_or_probe_move();
+    endstops.enable(true);
+    #if ENABLED(DELTA)
+      home_delta();
+    #else
+      #if Z_HOME_DIR > 0
+        HOMEAXIS(Z);
+      #else
+        // Z can't home through the print. Trust the checkpoint and lift clear.
+        current_position[Z_AXIS] = state.position[Z_AXIS];
+        SYNC_PLAN_POSITION_KINEMATIC();
+        axis_homed[Z_AXIS] = axis_known_position[Z_AXIS] = true;
+        do_blocking_move_to_z(state.position[Z_AXIS] + (SD_CHECKPOINT_Z_CLEARANCE));
+      #endif
+      HOMEAXIS(X);
+      HOMEAXIS(Y);
+      SYNC_PLAN_POSITION_KINEMATIC();
+    #endif
+    endstops.not_homing();
+    clean_up_after_endstop_or_probe_move();
+
+    // Prime above the print, then go down onto it
+    do_blocking_move_to(state.position[X_AXIS], state.position[Y_AXIS], state.position[Z_AXIS] + (SD_CHECKPOINT_Z_CLEARANCE));
+    #if defined(SD_CHECKPOINT_PURGE) && SD_CHECKPOINT_PURGE > 0
+      current_position[E_AXIS] += SD_CHECKPOINT_PURGE;
+      planner.buffer_line_kinematic(current_position, 3.0, active_extruder); // (mm/s)
+      stepper.synchronize();
+    #endif
+    do_blocking_move_to_z(state.position[Z_AXIS]);
+
+    current_position[E_AXIS] = state.position[E_AXIS];
+    SYNC_PLAN_POSITION_KINEMATIC();
+
+    feedrate_mm_s = state.feedrate_mm_s;
+    #if FAN_COUNT > 0
+      for (uint8_t i = 0; i < FAN_COUNT; i++) fanSpeeds[i] = state.fan_speed[i];
+    #endif
+    relative_mode = state.relative_mode;
+    LOOP_XYZE(i) axis_relative_modes[i] = state.axis_relative_modes[i];
+
+    // Reopen the calling files as M32 P left them, then continue with the saved command
+    for (uint8_t i = 0; i <= state.depth; i++) {
+      card.openFile(path[i], true, i > 0);
+      if (!card.isFileOpen()) return;
+      card.setIndex(i < state.depth ? state.return_sdpos[i] : state.sdpos);
+    }
+    card.startFileprint();
+    print_job_timer.start();
+
+    planner.command_sdpos = state.sdpos;
+    planner.command_sddepth = state.depth;
+    save_sd_checkpoint(); // Resumable again right away
+  }
+
+#endif // SD_CHECKPOINT
+
+#if ENABLED(SD_JOB_QUEUE)
+
+  /**
+   * M1001: Print the jobs listed in a manifest on the SD card
+   *
+   *  M1001           Use SD_JOB_MANIFEST
+   *  M1001 <file>    Use another manifest in the root folder
+   *  M1001 C         End the queue after the current job
+   *
+   * Each line of the manifest is "<file> [copies]", with the 8.3 name of
+   * a file in the root folder. Jobs follow each other without releasing
+   * the steppers, see SD_JOB_QUEUE.
+   */
+  inline void gcode_M1001() {
+    command_text();
+    if (current_command_args[0] == 'C' && current_command_args[1] <= ' ') {
+      card.endJobQueue();
+      return;
+    }
+    if (card.isFileOpen()) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_JOB_BUSY);
+      return;
+    }
+    card.startJobQueue(current_command_args[0] ? current_command_args : SD_JOB_MANIFEST);
+  }
+
+#endif // SD_JOB_QUEUE
+
+#if ENABLED(BINARY_FILE_TRANSFER)
+
+  /**
+   * M1002: Receive a file to the SD card in binary packets
+   *
+   * The protocol is described in file_transfer.h. The receiver lives
+   * on the stack, so its buffers only take RAM during the transfer.
+   */
+  inline void gcode_M1002() {
+    if (IS_SD_PRINTING) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_BFT_BUSY);
+      return;
+    }
+    FileTransfer transfer;
+    KEEPALIVE_STATE(NOT_BUSY);
+    transfer.receive();
+    KEEPALIVE_STATE(IN_HANDLER);
+  }
+
+#endif // BINARY_FILE_TRANSFER
+
 #if ENABLED(SWITCHING_EXTRUDER)
   inline void move_extruder_servo(uint8_t e) {
     const int angles[2] = SWITCHING_EXTRUDER_SERVO_ANGLES;
@@ -7935,13 +9032,29 @@ inline void gcode_T(uint8_t tmp_extruder) {
 }
 
 /**
- * Process a single command and dispatch it to its handler
+ * Process the next command of the queue
  * This is called from the main loop()
  */
 void process_next_command() {
-  current_command = command_queue[cmd_queue_index_r];
+  char* const cmd = command_queue[cmd_queue_index_r];
+  process_command(cmd, cmd + strlen(cmd));
+  ok_to_send();
+}
+
+/**
+ * Process a single command and dispatch it to its handler
+ *
+ * The command runs from cmd to end and needn't be nul-terminated, so the
+ * host build can hand over lines of a mapped G-code file in place. The
+ * character at end must not continue a number (a nul, '\n', ';' or '*'
+ * all stop one) and must be writable: handlers that take text end their
+ * arguments there, see command_text().
+ */
+void process_command(char* cmd, char* end) {
+  current_command = cmd;
 
   if (DEBUGGING(ECHO)) {
+    *end = '\0';
     SERIAL_ECHO_START;
     SERIAL_ECHOLN(current_command);
   }
@@ -7949,15 +9062,19 @@ void process_next_command() {
   // Sanitize the current command:
   //  - Skip leading spaces
   //  - Bypass N[-0-9][0-9]*[ ]*
-  //  - Overwrite * with nul to mark the end
+  //  - End it at the *
   while (*current_command == ' ') ++current_command;
   if (*current_command == 'N' && NUMERIC_SIGNED(current_command[1])) {
     current_command += 2; // skip N[-0-9]
     while (NUMERIC(*current_command)) ++current_command; // skip [0-9]*
     while (*current_command == ' ') ++current_command; // skip [ ]*
   }
-  char* starpos = strchr(current_command, '*');  // * should always be the last parameter
-  if (starpos) while (*starpos == ' ' || *starpos == '*') *starpos-- = '\0'; // nullify '*' and ' '
+  char* starpos = (char*)memchr(current_command, '*', end - current_command);  // * should always be the last parameter
+  if (starpos) {
+    end = starpos;
+    while (end > current_command && end[-1] == ' ') --end; // drop ' ' before the '*'
+  }
+  current_command_end = end;
 
   char *cmd_ptr = current_command;
 
@@ -7993,8 +9110,8 @@ void process_next_command() {
     }
   #endif
 
-  // Skip all spaces to get to the first argument, or nul
-  while (*cmd_ptr == ' ') cmd_ptr++;
+  // Skip all spaces to get to the first argument, or the end
+  while (cmd_ptr < end && *cmd_ptr == ' ') cmd_ptr++;
 
   // The command's arguments (if any) start here, for sure!
   current_command_args = cmd_ptr;
@@ -8093,6 +9210,12 @@ void process_next_command() {
         #endif // Z_PROBE_SLED
       #endif // HAS_BED_PROBE
 
+      #if ENABLED(DELTA_AUTO_CALIBRATION)
+        case 33: // G33: Delta auto-calibration
+          gcode_G33();
+          break;
+      #endif
+
       #if ENABLED(G38_PROBE_TARGET)
         case 38: // G38.2 & G38.3
           if (subcode == 2 || subcode == 3)
@@ -8177,6 +9300,11 @@ void process_next_command() {
           break;
       #endif // Z_MIN_PROBE_REPEATABILITY_TEST
 
+      #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+        case 73: // M73: Set SD print progress
+          gcode_M73(); break;
+      #endif
+
       case 75: // M75: Start print timer
         gcode_M75(); break;
       case 76: // M76: Pause print timer
@@ -8195,6 +9323,12 @@ void process_next_command() {
           break;
       #endif
 
+      #if ENABLED(IDLE_TASK_SCHEDULER)
+        case 102: // M102: Report idle task statistics
+          gcode_M102();
+          break;
+      #endif
+
       case 104: // M104: Set hot end temperature
         gcode_M104();
         break;
@@ -8238,6 +9372,12 @@ void process_next_command() {
         KEEPALIVE_STATE(NOT_BUSY);
         return; // "ok" already printed
 
+      #if ENABLED(AUTO_REPORT_POSITION)
+        case 154: // M154: Set position auto-report interval
+          gcode_M154();
+          break;
+      #endif
+
       #if ENABLED(AUTO_REPORT_TEMPERATURES) && (HAS_TEMP_HOTEND || HAS_TEMP_BED)
         case 155: // M155: Set temperature auto-report interval
           gcode_M155();
@@ -8470,6 +9610,12 @@ void process_next_command() {
           break;
       #endif // PIDTEMPBED
 
+      #if ENABLED(PID_FEEDFORWARD)
+        case 306: // M306: Set hotend feed-forward
+          gcode_M306();
+          break;
+      #endif
+
       #if defined(CHDK) || HAS_PHOTOGRAPH
         case 240: // M240: Trigger a camera by emulating a Canon RC-1 : http://www.doc-diy.net/photo/rc-1_hacked/
           gcode_M240();
@@ -8656,6 +9802,24 @@ void process_next_command() {
       case 999: // M999: Restart after being Stopped
         gcode_M999();
         break;
+
+      #if ENABLED(SD_CHECKPOINT)
+        case 1000: // M1000: Resume the SD print from its checkpoint
+          gcode_M1000();
+          break;
+      #endif
+
+      #if ENABLED(SD_JOB_QUEUE)
+        case 1001: // M1001: Print the jobs of an SD manifest
+          gcode_M1001();
+          break;
+      #endif
+
+      #if ENABLED(BINARY_FILE_TRANSFER)
+        case 1002: // M1002: Binary file transfer to SD
+          gcode_M1002();
+          break;
+      #endif
     }
     break;
 
@@ -8672,8 +9836,6 @@ ExitUnknownCommand:
 
   // Still unknown command? Throw an error
   if (!code_is_good) unknown_command_error();
-
-  ok_to_send();
 }
 
 /**
@@ -8818,12 +9980,15 @@ void ok_to_send() {
    * settings have been changed (e.g., by M665).
    */
   void recalc_delta_settings(float radius, float diagonal_rod) {
-    delta_tower1_x = -SIN_60 * (radius + DELTA_RADIUS_TRIM_TOWER_1);  // front left tower
-    delta_tower1_y = -COS_60 * (radius + DELTA_RADIUS_TRIM_TOWER_1);
-    delta_tower2_x =  SIN_60 * (radius + DELTA_RADIUS_TRIM_TOWER_2);  // front right tower
-    delta_tower2_y = -COS_60 * (radius + DELTA_RADIUS_TRIM_TOWER_2);
-    delta_tower3_x = 0.0;                                             // back middle tower
-    delta_tower3_y = (radius + DELTA_RADIUS_TRIM_TOWER_3);
+    const float a1 = RADIANS(210 + delta_tower_angle_trim[A_AXIS]),    // front left tower
+                a2 = RADIANS(330 + delta_tower_angle_trim[B_AXIS]),    // front right tower
+                a3 = RADIANS( 90 + delta_tower_angle_trim[C_AXIS]);    // back middle tower
+    delta_tower1_x = cos(a1) * (radius + DELTA_RADIUS_TRIM_TOWER_1);
+    delta_tower1_y = sin(a1) * (radius + DELTA_RADIUS_TRIM_TOWER_1);
+    delta_tower2_x = cos(a2) * (radius + DELTA_RADIUS_TRIM_TOWER_2);
+    delta_tower2_y = sin(a2) * (radius + DELTA_RADIUS_TRIM_TOWER_2);
+    delta_tower3_x = cos(a3) * (radius + DELTA_RADIUS_TRIM_TOWER_3);
+    delta_tower3_y = sin(a3) * (radius + DELTA_RADIUS_TRIM_TOWER_3);
     delta_diagonal_rod_2_tower_1 = sq(diagonal_rod + delta_diagonal_rod_trim_tower_1);
     delta_diagonal_rod_2_tower_2 = sq(diagonal_rod + delta_diagonal_rod_trim_tower_2);
     delta_diagonal_rod_2_tower_3 = sq(diagonal_rod + delta_diagonal_rod_trim_tower_3);
@@ -10085,6 +11250,36 @@ void manage_inactivity(bool ignore_stepper_queue/*=false*/) {
   planner.check_axes_activity();
 }
 
+#if ENABLED(IDLE_TASK_SCHEDULER)
+
+  static void run_idle_task(const uint8_t t, const bool no_stepper_sleep) {
+    UNUSED(no_stepper_sleep);
+    switch (t) {
+      case IDLE_TASK_HEATER: thermalManager.manage_heater(); break;
+      case IDLE_TASK_INACTIVITY:
+        manage_inactivity(
+          #if ENABLED(FILAMENT_CHANGE_FEATURE)
+            no_stepper_sleep
+          #endif
+        );
+        break;
+      case IDLE_TASK_KEEPALIVE: host_keepalive(); break;
+      #if HAS_AUTO_REPORTING
+        case IDLE_TASK_AUTOREPORT: auto_report(); break;
+      #endif
+      #if HAS_BUZZER && DISABLED(LCD_USE_I2C_BUZZER)
+        case IDLE_TASK_BUZZER: buzzer.tick(); break;
+      #endif
+      case IDLE_TASK_LCD: lcd_update(); break;
+      #if ENABLED(PRINTCOUNTER)
+        case IDLE_TASK_PRINTCOUNTER: print_job_timer.tick(); break;
+      #endif
+      default: break;
+    }
+  }
+
+#endif // IDLE_TASK_SCHEDULER
+
 /**
  * Standard idle routine keeps the machine alive
  */
@@ -10093,29 +11288,66 @@ void idle(
     bool no_stepper_sleep/*=false*/
   #endif
 ) {
-  lcd_update();
+  #if ENABLED(IDLE_TASK_SCHEDULER)
 
-  host_keepalive();
+    #if DISABLED(FILAMENT_CHANGE_FEATURE)
+      const bool no_stepper_sleep = false;
+    #endif
 
-  #if ENABLED(AUTO_REPORT_TEMPERATURES) && (HAS_TEMP_HOTEND || HAS_TEMP_BED)
-    auto_report_temperatures();
-  #endif
+    const millis_t ms = millis();
+    const uint32_t idle_start_us = micros();
+
+    // Let parsing and planning have the CPU while the planner is about to run dry
+    const bool starving = !command_in_progress && commands_in_queue
+                          && planner.movesplanned() < (IDLE_PLANNER_LOW_WATER);
+
+    for (uint8_t t = 0; t < IDLE_TASK_COMMANDS; t++) {
+      const millis_t since = ms - idle_task_last_ms[t];
+      if (since < idle_task_period(t)) continue;
+
+      if (t >= IDLE_TASK_FIRST_DEFERRABLE
+        && (starving || micros() - idle_start_us >= (IDLE_TIME_BUDGET_US))
+      ) {
+        if (since < idle_task_deadline(t)) {
+          idle_task_stats[t].deferred++;
+          continue;
+        }
+        idle_task_stats[t].forced++;
+      }
+
+      const uint32_t task_start_us = micros();
+      run_idle_task(t, no_stepper_sleep);
+      idle_task_account(t, task_start_us);
+      idle_task_last_ms[t] = ms;
+    }
+
+  #else
+
+    lcd_update();
 
-  manage_inactivity(
-    #if ENABLED(FILAMENT_CHANGE_FEATURE)
-      no_stepper_sleep
+    host_keepalive();
+
+    #if HAS_AUTO_REPORTING
+      auto_report();
     #endif
-  );
 
-  thermalManager.manage_heater();
+    manage_inactivity(
+      #if ENABLED(FILAMENT_CHANGE_FEATURE)
+        no_stepper_sleep
+      #endif
+    );
 
-  #if ENABLED(PRINTCOUNTER)
-    print_job_timer.tick();
-  #endif
+    thermalManager.manage_heater();
 
-  #if HAS_BUZZER && DISABLED(LCD_USE_I2C_BUZZER)
-    buzzer.tick();
-  #endif
+    #if ENABLED(PRINTCOUNTER)
+      print_job_timer.tick();
+    #endif
+
+    #if HAS_BUZZER && DISABLED(LCD_USE_I2C_BUZZER)
+      buzzer.tick();
+    #endif
+
+  #endif // !IDLE_TASK_SCHEDULER
 }
 
 /**
@@ -10231,10 +11463,13 @@ void setup() {
 
   SERIAL_ECHO_START;
   SERIAL_ECHOPAIR(MSG_FREE_MEMORY, freeMemory());
-  SERIAL_ECHOLNPAIR(MSG_PLANNER_BUFFER_BYTES, (int)sizeof(block_t)*BLOCK_BUFFER_SIZE);
+  SERIAL_ECHOLNPAIR(MSG_PLANNER_BUFFER_BYTES, (int)(sizeof(block_t) + sizeof(block_plan_t)) * (BLOCK_BUFFER_SIZE));
 
   // Send "ok" after commands by default
   for (int8_t i = 0; i < BUFSIZE; i++) send_ok[i] = true;
+  #if ENABLED(SD_CHECKPOINT)
+    for (int8_t i = 0; i < BUFSIZE; i++) command_sdpos[i] = NO_SD_POS;
+  #endif
 
   // Load data from EEPROM if available (or use defaults)
   // This also updates variables in the planner, elsewhere
@@ -10349,10 +11584,31 @@ void loop() {
 
   #if ENABLED(SDSUPPORT)
     card.checkautostart(false);
+    #if ENABLED(SD_JOB_QUEUE)
+      card.checkJobQueue();
+    #endif
   #endif
 
   if (commands_in_queue) {
 
+    #if ENABLED(IDLE_TASK_SCHEDULER)
+      const uint32_t command_start_us = micros();
+      command_in_progress = true;
+    #endif
+
+    #if ENABLED(SD_CHECKPOINT)
+      // Blocks planned by this command remember where it is in the file.
+      // Those of commands from elsewhere get NO_SD_POS.
+      planner.command_sdpos = command_sdpos[cmd_queue_index_r];
+      planner.command_sddepth = command_sddepth[cmd_queue_index_r];
+      command_sdpos[cmd_queue_index_r] = NO_SD_POS;
+    #endif
+
+    #if ENABLED(SD_JOB_QUEUE)
+      current_command_from_sd = command_from_sd[cmd_queue_index_r];
+      command_from_sd[cmd_queue_index_r] = false;
+    #endif
+
     #if ENABLED(SDSUPPORT)
 
       if (card.saving) {
@@ -10381,12 +11637,21 @@ void loop() {
 
     #endif // SDSUPPORT
 
+    #if ENABLED(IDLE_TASK_SCHEDULER)
+      command_in_progress = false;
+      idle_task_account(IDLE_TASK_COMMANDS, command_start_us);
+    #endif
+
     // The queue may be reset by a command handler or by code invoked by idle() within a handler
     if (commands_in_queue) {
       --commands_in_queue;
       cmd_queue_index_r = (cmd_queue_index_r + 1) % BUFSIZE;
     }
   }
+  #if ENABLED(SD_CHECKPOINT)
+    if (IS_SD_PRINTING && ELAPSED(millis(), next_checkpoint_ms)) save_sd_checkpoint();
+  #endif
+
   endstops.report_state();
   idle();
 }
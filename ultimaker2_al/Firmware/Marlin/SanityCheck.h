@@ -191,6 +191,19 @@
   #error "Z_DUAL_STEPPER_DRIVERS requires Z2 pins (and an extra E plug)."
 #endif
 
+/**
+ * Combined step/dir port writes
+ */
+#if ENABLED(COMBINED_STEP_WRITES)
+  #if ENABLED(X_DUAL_STEPPER_DRIVERS) || ENABLED(Y_DUAL_STEPPER_DRIVERS) || ENABLED(Z_DUAL_STEPPER_DRIVERS) || ENABLED(DUAL_X_CARRIAGE)
+    #error "COMBINED_STEP_WRITES is not compatible with dual stepper drivers or DUAL_X_CARRIAGE."
+  #elif ENABLED(HAVE_L6470DRIVER)
+    #error "COMBINED_STEP_WRITES is not compatible with L6470 drivers."
+  #elif !HAS_X_STEP || !HAS_Y_STEP || !HAS_Z_STEP || !HAS_X_DIR || !HAS_Y_DIR || !HAS_Z_DIR
+    #error "COMBINED_STEP_WRITES requires X, Y and Z step and dir pins."
+  #endif
+#endif
+
 /**
  * Progress Bar
  */
@@ -204,6 +217,66 @@
   #endif
 #endif
 
+/**
+ * SD print time estimate
+ */
+#if ENABLED(SD_PRINT_TIME_ESTIMATE) && DISABLED(SDSUPPORT)
+  #error "SD_PRINT_TIME_ESTIMATE requires SDSUPPORT."
+#endif
+
+/**
+ * SD print checkpoints
+ */
+#if ENABLED(SD_CHECKPOINT)
+  #if DISABLED(SDSUPPORT)
+    #error "SD_CHECKPOINT requires SDSUPPORT."
+  #elif !defined(SD_CHECKPOINT_FILE) || !defined(SD_CHECKPOINT_INTERVAL) || !defined(SD_CHECKPOINT_Z_CLEARANCE)
+    #error "SD_CHECKPOINT requires SD_CHECKPOINT_FILE, SD_CHECKPOINT_INTERVAL and SD_CHECKPOINT_Z_CLEARANCE."
+  #elif SD_CHECKPOINT_INTERVAL < 1
+    #error "SD_CHECKPOINT_INTERVAL must be at least 1 second."
+  #endif
+#endif
+
+/**
+ * SD status auto-report
+ */
+#if ENABLED(AUTO_REPORT_SD_STATUS) && DISABLED(SDSUPPORT)
+  #error "AUTO_REPORT_SD_STATUS requires SDSUPPORT."
+#endif
+
+/**
+ * SD fast upload
+ */
+#if ENABLED(SD_FAST_UPLOAD) && DISABLED(SDSUPPORT)
+  #error "SD_FAST_UPLOAD requires SDSUPPORT."
+#endif
+
+/**
+ * Binary file transfer
+ */
+#if ENABLED(BINARY_FILE_TRANSFER)
+  #if DISABLED(SDSUPPORT)
+    #error "BINARY_FILE_TRANSFER requires SDSUPPORT."
+  #elif ENABLED(EMERGENCY_PARSER)
+    #error "BINARY_FILE_TRANSFER is incompatible with EMERGENCY_PARSER, which would act on commands inside the data."
+  #elif !defined(BINARY_FILE_TRANSFER_CHUNK) || !defined(BINARY_FILE_TRANSFER_TIMEOUT)
+    #error "BINARY_FILE_TRANSFER requires BINARY_FILE_TRANSFER_CHUNK and BINARY_FILE_TRANSFER_TIMEOUT."
+  #elif BINARY_FILE_TRANSFER_CHUNK < 8
+    #error "BINARY_FILE_TRANSFER_CHUNK must be at least 8."
+  #endif
+#endif
+
+/**
+ * SD job queue
+ */
+#if ENABLED(SD_JOB_QUEUE)
+  #if DISABLED(SDSUPPORT)
+    #error "SD_JOB_QUEUE requires SDSUPPORT."
+  #elif !defined(SD_JOB_MANIFEST) || !defined(SD_JOB_PREHEAT_PERCENT) || !defined(SD_JOB_HEADER_BYTES)
+    #error "SD_JOB_QUEUE requires SD_JOB_MANIFEST, SD_JOB_PREHEAT_PERCENT and SD_JOB_HEADER_BYTES."
+  #endif
+#endif
+
 /**
  * Delta requirements
  */
@@ -220,6 +293,21 @@
   #endif
 #endif
 
+/**
+ * Delta auto-calibration
+ */
+#if ENABLED(DELTA_AUTO_CALIBRATION)
+  #if DISABLED(DELTA)
+    #error "DELTA_AUTO_CALIBRATION requires DELTA."
+  #elif !HAS_BED_PROBE
+    #error "DELTA_AUTO_CALIBRATION requires a bed probe."
+  #elif DELTA_CALIBRATION_DEFAULT_FACTORS != 3 && DELTA_CALIBRATION_DEFAULT_FACTORS != 4 && DELTA_CALIBRATION_DEFAULT_FACTORS != 6 && DELTA_CALIBRATION_DEFAULT_FACTORS != 7
+    #error "DELTA_CALIBRATION_DEFAULT_FACTORS must be 3, 4, 6 or 7."
+  #elif DELTA_CALIBRATION_MAX_POINTS <= DELTA_CALIBRATION_DEFAULT_FACTORS || DELTA_CALIBRATION_MAX_POINTS > 255
+    #error "DELTA_CALIBRATION_MAX_POINTS must be more than the number of factors and at most 255."
+  #endif
+#endif
+
 /**
  * Babystepping
  */
@@ -338,6 +426,44 @@
   #error "You must set DISPLAY_CHARSET_HD44780 to JAPANESE, WESTERN or CYRILLIC for your LCD controller."
 #endif
 
+/**
+ * Hotend PID in the temperature ISR
+ */
+#if ENABLED(PID_IN_ISR)
+  #if DISABLED(PIDTEMP)
+    #error "PID_IN_ISR requires PIDTEMP."
+  #elif ENABLED(PID_OPENLOOP) || ENABLED(PID_DEBUG) || ENABLED(PID_EXTRUSION_SCALING)
+    #error "PID_IN_ISR is not compatible with PID_OPENLOOP, PID_DEBUG or PID_EXTRUSION_SCALING."
+  #elif DISABLED(HEATER_0_USES_THERMISTOR) \
+     || (HOTENDS > 1 && DISABLED(HEATER_1_USES_THERMISTOR)) \
+     || (HOTENDS > 2 && DISABLED(HEATER_2_USES_THERMISTOR)) \
+     || (HOTENDS > 3 && DISABLED(HEATER_3_USES_THERMISTOR))
+    #error "PID_IN_ISR requires a thermistor (TEMP_SENSOR_n > 0) on every hotend."
+  #endif
+#endif
+
+/**
+ * Hotend feed-forward
+ */
+#if ENABLED(PID_FEEDFORWARD)
+  #if DISABLED(PIDTEMP)
+    #error "PID_FEEDFORWARD requires PIDTEMP."
+  #elif ENABLED(PID_EXTRUSION_SCALING)
+    #error "PID_FEEDFORWARD replaces PID_EXTRUSION_SCALING. Enable only one of them."
+  #endif
+#endif
+
+/**
+ * Heat-up planner
+ */
+#if ENABLED(HEATUP_PLANNER)
+  #if !HAS_TEMP_BED || !HAS_HEATER_BED
+    #error "HEATUP_PLANNER requires a heated bed with a temperature sensor."
+  #elif HEATER_POWER_BUDGET < HOTENDS * (HOTEND_HEATER_POWER)
+    #error "HEATER_POWER_BUDGET must cover all hotend heaters at full duty."
+  #endif
+#endif
+
 /**
  * Bed Heating Options - PID vs Limit Switching
  */
@@ -535,6 +661,19 @@
     #endif
   #endif
 
+  /**
+   * Pipelined grid probing
+   */
+  #if ENABLED(PROBE_PIPELINE)
+    #if !ABL_GRID
+      #error "PROBE_PIPELINE requires AUTO_BED_LEVELING_LINEAR or AUTO_BED_LEVELING_BILINEAR."
+    #elif ENABLED(PROBE_DOUBLE_TOUCH)
+      #error "PROBE_PIPELINE replaces the fast first touch of PROBE_DOUBLE_TOUCH. Disable one of them."
+    #elif !defined(PROBE_APPROACH_MARGIN) || PROBE_APPROACH_MARGIN < 1
+      #error "PROBE_APPROACH_MARGIN must be at least 1mm."
+    #endif
+  #endif
+
   /**
    * Check if Probe_Offset * Grid Points is greater than Probing Range
    */
@@ -784,6 +923,21 @@
   #error "TEMP_SENSOR_1 is required with TEMP_SENSOR_1_AS_REDUNDANT."
 #endif
 
+/**
+ * Custom thermistor
+ */
+#if TEMP_SENSOR_0 == 1000 || TEMP_SENSOR_1 == 1000 || TEMP_SENSOR_2 == 1000 || TEMP_SENSOR_3 == 1000 || TEMP_SENSOR_BED == 1000
+  #if !defined(CUSTOM_THERMISTOR_PULLUP) || !defined(CUSTOM_THERMISTOR_MINTEMP) || !defined(CUSTOM_THERMISTOR_MAXTEMP) || !defined(CUSTOM_THERMISTOR_MAX_ERROR)
+    #error "TEMP_SENSOR 1000 requires CUSTOM_THERMISTOR_PULLUP, _MINTEMP, _MAXTEMP and _MAX_ERROR."
+  #elif defined(CUSTOM_THERMISTOR_SH_A) && (!defined(CUSTOM_THERMISTOR_SH_B) || !defined(CUSTOM_THERMISTOR_SH_C))
+    #error "CUSTOM_THERMISTOR_SH_A requires CUSTOM_THERMISTOR_SH_B and CUSTOM_THERMISTOR_SH_C."
+  #elif !defined(CUSTOM_THERMISTOR_SH_A) && (!defined(CUSTOM_THERMISTOR_R25) || !defined(CUSTOM_THERMISTOR_BETA))
+    #error "TEMP_SENSOR 1000 requires CUSTOM_THERMISTOR_R25 and CUSTOM_THERMISTOR_BETA, or CUSTOM_THERMISTOR_SH_A/B/C."
+  #elif CUSTOM_THERMISTOR_MINTEMP >= CUSTOM_THERMISTOR_MAXTEMP
+    #error "CUSTOM_THERMISTOR_MINTEMP must be below CUSTOM_THERMISTOR_MAXTEMP."
+  #endif
+#endif
+
 /**
  * Temperature status LEDs
  */
@@ -223,6 +223,10 @@ class Sd2Card {
   bool writeData(const uint8_t* src);
   bool writeStart(uint32_t blockNumber, uint32_t eraseCount);
   bool writeStop();
+#if ENABLED(HEATER_0_USES_MAX6675)
+  /** Set while the card uses the SPI bus. The thermocouple ISR waits for it. */
+  static volatile bool spiBusy;
+#endif
  private:
   //----------------------------------------------------------------------------
   uint8_t chipSelectPin_;
@@ -230,6 +234,10 @@ class Sd2Card {
   uint8_t spiRate_;
   uint8_t status_;
   uint8_t type_;
+#if ENABLED(SD_FAST_UPLOAD)
+  bool writeStreaming_;         // Between writeStart() and writeStop()
+  uint32_t writeStreamBlock_;   // Next block of the multiple block write
+#endif
   // private functions
   uint8_t cardAcmd(uint8_t cmd, uint32_t arg) {
     cardCommand(CMD55, 0);
@@ -25,6 +25,8 @@
 #include "ultralcd.h"
 #include "stepper.h"
 #include "language.h"
+#include "duration_t.h"
+#include "temperature.h"
 
 #include "Marlin.h"
 
@@ -36,8 +38,27 @@ CardReader::CardReader() {
   sdpos = 0;
   workDirDepth = 0;
   file_subcall_ctr = 0;
+  fileInRoot = false;
   ZERO(workDirParents);
 
+  #if ENABLED(SDCARD_DIR_INDEX)
+    dirIndexCount = 0;
+    dirIndexValid = false;
+  #endif
+
+  #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+    clearEstimate();
+  #endif
+
+  #if ENABLED(SD_JOB_QUEUE)
+    jobQueueActive = nextJobReady = false;
+    jobCopies = 0;
+  #endif
+
+  #if ENABLED(SD_FAST_UPLOAD)
+    uploadSize = 0;
+  #endif
+
   autostart_stilltocheck = true; //the SD start is delayed, because otherwise the serial cannot answer fast enough to make contact with the host software.
   autostart_index = 0;
 
@@ -60,21 +81,40 @@ char *createFilename(char *buffer, const dir_t &p) { //buffer > 12characters
   return buffer;
 }
 
+#if ENABLED(SDCARD_DIR_INDEX)
+
+  /**
+   * Case-insensitive 8-bit hash of an 8.3 filename
+   */
+  static uint8_t filenameHash(const char *name) {
+    uint8_t hash = 0;
+    while (*name) hash = ((hash << 1) | (hash >> 7)) ^ toupper(*name++);
+    return hash;
+  }
+
+#endif
+
 /**
  * Dive into a folder and recurse depth-first to perform a pre-set operation lsAction:
  *   LS_Count       - Add +1 to nrFiles for every file within the parent
  *   LS_GetFilename - Get the filename of the file indexed by nrFiles
  *   LS_SerialPrint - Print the full path of each file to serial output
+ *   LS_Index       - Add every file within the parent to dirIndex
  */
 void CardReader::lsDive(const char *prepend, SdFile parent, const char * const match/*=NULL*/) {
   dir_t p;
   uint8_t cnt = 0;
 
   // Read the next entry from a directory
-  while (parent.readDir(p, longFilename) > 0) {
+  #if ENABLED(SDCARD_DIR_INDEX)
+    // Track where each item starts, before any long name entries
+    for (uint32_t pos = parent.curPosition(); parent.readDir(p, longFilename) > 0; pos = parent.curPosition()) {
+  #else
+    while (parent.readDir(p, longFilename) > 0) {
+  #endif
 
     // If the entry is a directory and the action is LS_SerialPrint
-    if (DIR_IS_SUBDIR(&p) && lsAction != LS_Count && lsAction != LS_GetFilename) {
+    if (DIR_IS_SUBDIR(&p) && lsAction != LS_Count && lsAction != LS_GetFilename && lsAction != LS_Index) {
 
       // Get the short name for the item, which we know is a folder
       char lfilename[FILENAME_LENGTH];
@@ -136,6 +176,15 @@ void CardReader::lsDive(const char *prepend, SdFile parent, const char * const m
           else if (cnt == nrFiles) return;
           cnt++;
           break;
+        case LS_Index:
+          #if ENABLED(SDCARD_DIR_INDEX)
+            if (nrFiles < SD_DIR_INDEX_SIZE) {
+              dirIndex[nrFiles].entry = pos >> 5;
+              dirIndex[nrFiles].hash = filenameHash(createFilename(filename, p));
+            }
+            nrFiles++;
+          #endif
+          break;
       }
 
     }
@@ -243,6 +292,9 @@ void CardReader::initsd() {
   }
   workDir = root;
   curDir = &root;
+  #if ENABLED(SDCARD_DIR_INDEX)
+    invalidateDirIndex();
+  #endif
   /**
   if (!workDir.openRoot(&volume)) {
     SERIAL_ECHOLNPGM(MSG_SD_WORKDIR_FAIL);
@@ -256,11 +308,23 @@ void CardReader::setroot() {
   }*/
   workDir = root;
   curDir = &workDir;
+  #if ENABLED(SDCARD_DIR_INDEX)
+    invalidateDirIndex();
+  #endif
 }
 
 void CardReader::release() {
   sdprinting = false;
   cardOK = false;
+  #if ENABLED(SD_FAST_UPLOAD)
+    uploadSize = 0;
+  #endif
+  #if ENABLED(SD_JOB_QUEUE)
+    endJobQueue();
+  #endif
+  #if ENABLED(SDCARD_DIR_INDEX)
+    invalidateDirIndex();
+  #endif
 }
 
 void CardReader::openAndPrintFile(const char *name) {
@@ -272,12 +336,23 @@ void CardReader::openAndPrintFile(const char *name) {
 }
 
 void CardReader::startFileprint() {
-  if (cardOK) sdprinting = true;
+  if (cardOK) {
+    sdprinting = true;
+    #if ENABLED(SD_CHECKPOINT)
+      openCheckpoint();
+    #endif
+  }
 }
 
 void CardReader::stopSDPrint() {
   sdprinting = false;
   if (isFileOpen()) file.close();
+  #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+    clearEstimate();
+  #endif
+  #if ENABLED(SD_CHECKPOINT)
+    if (checkpointFile.isOpen()) checkpointFile.close(); // Keep the last state for M1000
+  #endif
 }
 
 void CardReader::openLogFile(char* name) {
@@ -288,7 +363,8 @@ void CardReader::openLogFile(char* name) {
 void CardReader::getAbsFilename(char *t) {
   uint8_t cnt = 0;
   *t = '/'; t++; cnt++;
-  for (uint8_t i = 0; i < workDirDepth; i++) {
+  const uint8_t depth = fileInRoot ? 0 : workDirDepth; // Job files live in the root
+  for (uint8_t i = 0; i < depth; i++) {
     workDirParents[i].getFilename(t); //SDBaseFile.getfilename!
     while (*t && cnt < MAXPATHNAMELENGTH) { t++; cnt++; } //crawl counter forward.
   }
@@ -300,7 +376,12 @@ void CardReader::getAbsFilename(char *t) {
 
 void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
 
-  if (!cardOK) return;
+  if (!cardOK) {
+    #if ENABLED(SD_FAST_UPLOAD)
+      uploadSize = uploadFill = 0; // No upload without a file
+    #endif
+    return;
+  }
 
   uint8_t doing = 0;
   if (isFileOpen()) { //replacing current file by new file, or subfile call
@@ -339,6 +420,10 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
     SERIAL_ECHOLNPAIR(" file: ", name);
   }
 
+  #if ENABLED(SD_JOB_QUEUE)
+    if (!push_current) endJobQueue(); // Another file replaces the queue
+  #endif
+
   stopSDPrint();
 
   SdFile myDir;
@@ -361,6 +446,9 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
           SERIAL_PROTOCOLPGM(MSG_SD_OPEN_FILE_FAIL);
           SERIAL_PROTOCOL(subdirname);
           SERIAL_PROTOCOLCHAR('.');
+          #if ENABLED(SD_FAST_UPLOAD)
+            uploadSize = uploadFill = 0;
+          #endif
           return;
         }
         else {
@@ -381,13 +469,18 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
   else { //relative path
     curDir = &workDir;
   }
+  fileInRoot = (curDir == &root);
 
   if (read) {
     if (file.open(curDir, fname, O_READ)) {
+      file.buildSeekIndex();
       filesize = file.fileSize();
       SERIAL_PROTOCOLPAIR(MSG_SD_FILE_OPENED, fname);
       SERIAL_PROTOCOLLNPAIR(MSG_SD_SIZE, filesize);
       sdpos = 0;
+      #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+        clearEstimate(); // M73 marks belong to the file they came from
+      #endif
 
       SERIAL_PROTOCOLLNPGM(MSG_SD_FILE_SELECTED);
       getfilename(0, fname);
@@ -400,7 +493,15 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
     }
   }
   else { //write
-    if (!file.open(curDir, fname, O_CREAT | O_APPEND | O_WRITE | O_TRUNC)) {
+    #if ENABLED(SDCARD_DIR_INDEX)
+      invalidateDirIndex(); // A new entry may be created
+    #endif
+    const bool opened =
+      #if ENABLED(SD_FAST_UPLOAD)
+        (uploadSize && startUpload(fname)) ||
+      #endif
+      file.open(curDir, fname, O_CREAT | O_APPEND | O_WRITE | O_TRUNC);
+    if (!opened) {
       SERIAL_PROTOCOLPAIR(MSG_SD_OPEN_FILE_FAIL, fname);
       SERIAL_PROTOCOLCHAR('.');
       SERIAL_EOL;
@@ -413,6 +514,91 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
   }
 }
 
+#if ENABLED(SD_FAST_UPLOAD)
+
+  /**
+   * Open a file for M28 that will receive about 'size' bytes
+   */
+  void CardReader::openUpload(char* name, const uint32_t size) {
+    uploadSize = size;
+    openFile(name, false);
+  }
+
+  /**
+   * Replace fname in curDir by a file of uploadSize bytes in consecutive
+   * clusters and start a multiple block write over all of it. The card
+   * erases the blocks ahead. Without room in one piece the file is
+   * written through the FAT as usual.
+   */
+  bool CardReader::startUpload(const char* fname) {
+    uint32_t bgnBlock, endBlock;
+    SdBaseFile::remove(curDir, fname);
+    if (!file.createContiguous(curDir, fname, uploadSize)) {
+      uploadSize = 0;
+      return false;
+    }
+    // Blocks are written past the cache from here
+    if (!file.contiguousRange(&bgnBlock, &endBlock) || !volume.cacheClear()
+        || !card.writeStart(bgnBlock, endBlock - bgnBlock + 1)) {
+      file.remove();
+      uploadSize = 0;
+      return false;
+    }
+    uploadBlock = bgnBlock;
+    uploadFill = 0;
+    uploadPos = 0;
+    return true;
+  }
+
+  /**
+   * Collect received bytes in the volume cache, as SdBaseFile::write()
+   * does for a partial block, and send each full block to the card
+   */
+  void CardReader::uploadWrite(const char* buf, uint16_t len) {
+    uploadPos += len;
+    while (len) {
+      uint8_t *block = file.streamCache(uploadBlock, uploadFill);
+      if (!block) {
+        file.writeError = true;
+        return;
+      }
+      const uint16_t n = min(len, (uint16_t)(512 - uploadFill));
+      memcpy(&block[uploadFill], buf, n);
+      buf += n;
+      len -= n;
+      uploadFill += n;
+      if (uploadFill == 512) {
+        if (!file.streamCachedBlock()) file.writeError = true;
+        uploadBlock++;
+        uploadFill = 0;
+      }
+    }
+  }
+
+  /**
+   * Write the last partial block, end the multiple block write and cut
+   * the file to the bytes received. This is the only FAT and folder
+   * update since startUpload(). The file stays open at its end.
+   */
+  bool CardReader::finishUpload() {
+    bool ok = true;
+    if (uploadFill) {
+      uint8_t *block = file.streamCache(uploadBlock, true);
+      if (block) {
+        memset(&block[uploadFill], 0, 512 - uploadFill);
+        ok = file.streamCachedBlock();
+      }
+      else
+        ok = false;
+    }
+    ok = card.writeStop() && ok;
+    ok = file.truncate(uploadPos) && file.seekEnd() && ok;
+    uploadSize = 0;
+    return ok;
+  }
+
+#endif // SD_FAST_UPLOAD
+
 void CardReader::removeFile(char* name) {
   if (!cardOK) return;
 
@@ -459,6 +645,10 @@ void CardReader::removeFile(char* name) {
     curDir = &workDir;
   }
 
+  #if ENABLED(SDCARD_DIR_INDEX)
+    invalidateDirIndex();
+  #endif
+
   if (file.remove(curDir, fname)) {
     SERIAL_PROTOCOLPGM("File deleted:");
     SERIAL_PROTOCOLLN(fname);
@@ -477,12 +667,304 @@ void CardReader::getStatus() {
     SERIAL_PROTOCOL(sdpos);
     SERIAL_PROTOCOLCHAR('/');
     SERIAL_PROTOCOLLN(filesize);
+    #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+      if (estimateValid && estimateMinutes) {
+        char buffer[10];
+        duration_t(remainingSeconds()).toDigital(buffer);
+        SERIAL_PROTOCOLPGM(MSG_SD_REMAINING_TIME);
+        SERIAL_PROTOCOLLN(buffer);
+      }
+    #endif
   }
   else {
     SERIAL_PROTOCOLLNPGM(MSG_SD_NOT_PRINTING);
   }
 }
 
+#if ENABLED(SD_PRINT_TIME_ESTIMATE)
+
+  /**
+   * Store a progress mark of the file being printed. The remaining
+   * time counts down from here until the next mark.
+   */
+  void CardReader::setEstimate(const uint8_t percent, const uint16_t minutes) {
+    if (!isFileOpen()) return;
+    estimatePercent = min(percent, 100);
+    estimateMinutes = minutes;
+    estimateMillis = millis();
+    estimateValid = true;
+  }
+
+  uint32_t CardReader::remainingSeconds() {
+    if (!estimateValid) return 0;
+    const uint32_t total = estimateMinutes * 60UL,
+                   elapsed = (millis() - estimateMillis) / 1000UL;
+    return elapsed < total ? total - elapsed : 0;
+  }
+
+#endif // SD_PRINT_TIME_ESTIMATE
+
+#if ENABLED(SD_JOB_QUEUE)
+
+  /**
+   * Print the files listed in a manifest in the root folder back to back.
+   * Each line is "<file> [copies]", where ';' starts a comment. SdBaseFile
+   * opens by the short name only, so <file> is the 8.3 name of a root file.
+   */
+  void CardReader::startJobQueue(const char *manifest) {
+    if (!cardOK) return;
+    endJobQueue();
+    if (!jobManifest.open(&root, manifest, O_READ)) {
+      SERIAL_PROTOCOLPAIR(MSG_SD_OPEN_FILE_FAIL, manifest);
+      SERIAL_PROTOCOLCHAR('.');
+      SERIAL_EOL;
+      return;
+    }
+    jobQueueActive = true;
+    if (loadNextJob())
+      startNextJob();
+    else
+      endJobQueue();
+  }
+
+  /**
+   * Let the current job finish, then stop
+   */
+  void CardReader::endJobQueue() {
+    if (jobManifest.isOpen()) jobManifest.close();
+    if (nextJob.isOpen()) nextJob.close();
+    jobQueueActive = nextJobReady = false;
+    jobCopies = 0;
+  }
+
+  /**
+   * Open the file of the next manifest line into nextJob.
+   * Files that fail to open are reported and skipped.
+   */
+  bool CardReader::loadNextJob() {
+    char line[FILENAME_LENGTH + 8];
+    while (jobManifest.isOpen()) {
+      uint8_t n = 0;
+      int16_t c;
+      while ((c = jobManifest.read()) >= 0 && c != '\n')
+        if (c != '\r' && n < sizeof(line) - 1) line[n++] = c;
+      if (c < 0 && !n) break;
+      line[n] = '\0';
+
+      char *name = line, *end = strchr(line, ';');
+      if (end) *end = '\0';
+      while (*name == ' ') name++;
+      if (!*name) continue;
+
+      long copies = 1;
+      for (end = name; *end && *end != ' '; end++) { /* nada */ }
+      if (*end) {
+        *end++ = '\0';
+        copies = atol(end);
+      }
+
+      if (!nextJob.open(&root, name, O_READ)) {
+        SERIAL_PROTOCOLPAIR(MSG_SD_OPEN_FILE_FAIL, name);
+        SERIAL_PROTOCOLCHAR('.');
+        SERIAL_EOL;
+        continue;
+      }
+      strncpy(nextJobName, name, FILENAME_LENGTH - 1);
+      nextJobName[FILENAME_LENGTH - 1] = '\0';
+      nextJobCopies = copies > 1 ? copies - 1 : 0;
+      readJobTemperatures();
+      return (nextJobReady = true);
+    }
+    jobManifest.close();
+    return false;
+  }
+
+  /**
+   * Take the first hotend and bed temperatures (M104/M109, M140/M190)
+   * from the first SD_JOB_HEADER_BYTES of nextJob
+   */
+  void CardReader::readJobTemperatures() {
+    nextJobHotend = nextJobBed = 0;
+    char line[16];
+    uint8_t n = 0;
+    for (uint16_t i = 0; i < (SD_JOB_HEADER_BYTES) && !(nextJobHotend && nextJobBed); i++) {
+      const int16_t c = nextJob.read();
+      if (c < 0) break;
+      if (c != '\n' && c != '\r') {
+        if (n < sizeof(line) - 1) line[n++] = c;
+        continue;
+      }
+      line[n] = '\0';
+      n = 0;
+      const char *temp = strchr(line, 'S');
+      if (line[0] != 'M' || !temp) continue;
+      const int code = atoi(&line[1]);
+      if ((code == 104 || code == 109) && !nextJobHotend)
+        nextJobHotend = atoi(temp + 1);
+      else if ((code == 140 || code == 190) && !nextJobBed)
+        nextJobBed = atoi(temp + 1);
+    }
+    nextJob.rewind();
+  }
+
+  /**
+   * Start the next run, of the current file again or of nextJob.
+   * The card stays initialized and the steppers stay on, and the
+   * next file is opened right away while there is time.
+   */
+  void CardReader::startNextJob() {
+    if (jobCopies)
+      jobCopies--;
+    else {
+      if (isFileOpen()) file.close();
+      file = nextJob;
+      fileInRoot = true; // Manifest entries are in the root folder
+      nextJob.close();
+      file.buildSeekIndex();
+      filesize = file.fileSize();
+      jobCopies = nextJobCopies;
+      nextJobReady = false;
+      #if HAS_TEMP_HOTEND
+        if (nextJobHotend) thermalManager.setTargetHotend(nextJobHotend, 0);
+      #endif
+      #if HAS_TEMP_BED
+        if (nextJobBed) thermalManager.setTargetBed(nextJobBed);
+      #endif
+      lcd_setstatus(nextJobName);
+    }
+    setIndex(0);
+
+    SERIAL_ECHO_START;
+    char name[FILENAME_LENGTH];
+    file.getFilename(name);
+    SERIAL_ECHOPAIR(MSG_SD_JOB_START, name);
+    SERIAL_ECHOLNPAIR(MSG_SD_JOB_COPIES, jobCopies);
+
+    #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+      clearEstimate();
+    #endif
+    #if ENABLED(SD_CHECKPOINT)
+      clearCheckpoint(); // startFileprint() opens it for this file
+    #endif
+    jobPreheated = false;
+
+    print_job_timer.stop(); // Count every run as a print
+    startFileprint();
+    print_job_timer.start();
+
+    if (!jobCopies) loadNextJob();
+  }
+
+  /**
+   * Near the end of a job, heat up for the next file. Targets are only
+   * raised, so the job that is printing never gets cooler.
+   */
+  void CardReader::checkJobQueue() {
+    if (!jobQueueActive || !sdprinting || !nextJobReady || jobPreheated
+      || percentDone() < (SD_JOB_PREHEAT_PERCENT)
+    ) return;
+    jobPreheated = true;
+    #if HAS_TEMP_HOTEND
+      if (nextJobHotend > thermalManager.degTargetHotend(0)) thermalManager.setTargetHotend(nextJobHotend, 0);
+    #endif
+    #if HAS_TEMP_BED
+      if (nextJobBed > thermalManager.degTargetBed()) thermalManager.setTargetBed(nextJobBed);
+    #endif
+  }
+
+#endif // SD_JOB_QUEUE
+
+#if ENABLED(SD_CHECKPOINT)
+
+  /**
+   * Open the checkpoint file for a print that is starting. A new print
+   * invalidates the last checkpoint. Calls and returns of M32 P, and
+   * M1000, start at a set position and keep it.
+   */
+  void CardReader::openCheckpoint() {
+    if (checkpointFile.isOpen()) return; // Resumed after a pause
+
+    if (!checkpointFile.open(&root, SD_CHECKPOINT_FILE, O_CREAT | O_RDWR)) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_CHECKPOINT_ERR_WRITE);
+      return;
+    }
+
+    if (!file_subcall_ctr && !sdpos) {
+      planner.command_sdpos = NO_SD_POS;
+      const uint16_t magic = 0;
+      checkpointFile.seekSet(0);
+      checkpointFile.write(&magic, sizeof(magic));
+      checkpointFile.sync();
+    }
+  }
+
+  /**
+   * Overwrite the checkpoint with 'state' and the paths of the files
+   * down to state.depth, with the positions the calling files return
+   * to. The path and the position always come from the same file. The
+   * file keeps its size, so sync() writes back just the one cached block.
+   *
+   * Returns false if the file at state.depth was already left, as when
+   * blocks of an M32 P procedure still run after its return.
+   */
+  bool CardReader::writeCheckpoint(sd_checkpoint_t &state) {
+    if (!checkpointFile.isOpen() || state.depth > file_subcall_ctr) return false;
+
+    char path[SD_PROCEDURE_DEPTH + 1][MAXPATHNAMELENGTH];
+    ZERO(path);
+    ZERO(state.return_sdpos);
+    for (uint8_t i = 0; i < state.depth; i++) {
+      strcpy(path[i], proc_filenames[i]);
+      state.return_sdpos[i] = filespos[i];
+    }
+    if (state.depth < file_subcall_ctr)
+      strcpy(path[state.depth], proc_filenames[state.depth]);
+    else
+      getAbsFilename(path[state.depth]);
+
+    if (!checkpointFile.seekSet(0)
+      || checkpointFile.write(&state, sizeof(state)) < 0
+      || checkpointFile.write(path, sizeof(path)) < 0
+      || !checkpointFile.sync()
+    ) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_CHECKPOINT_ERR_WRITE);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Read a valid checkpoint and the paths of its files
+   */
+  bool CardReader::readCheckpoint(sd_checkpoint_t &state, char path[][MAXPATHNAMELENGTH]) {
+    if (!cardOK) return false;
+    SdFile f;
+    if (!f.open(&root, SD_CHECKPOINT_FILE, O_READ)) return false;
+    const int16_t paths = (SD_PROCEDURE_DEPTH + 1) * (MAXPATHNAMELENGTH);
+    const bool ok = f.read(&state, sizeof(state)) == (int16_t)sizeof(state)
+                    && state.magic == SD_CHECKPOINT_MAGIC
+                    && state.depth <= SD_PROCEDURE_DEPTH
+                    && f.read(path, paths) == paths;
+    f.close();
+    for (uint8_t i = 0; i <= SD_PROCEDURE_DEPTH; i++) path[i][MAXPATHNAMELENGTH - 1] = '\0';
+    return ok;
+  }
+
+  /**
+   * Invalidate the checkpoint once the print is finished or discarded
+   */
+  void CardReader::clearCheckpoint() {
+    if (!checkpointFile.isOpen() && !(cardOK && checkpointFile.open(&root, SD_CHECKPOINT_FILE, O_RDWR))) return;
+    const uint16_t magic = 0;
+    checkpointFile.seekSet(0);
+    checkpointFile.write(&magic, sizeof(magic));
+    checkpointFile.close();
+  }
+
+#endif // SD_CHECKPOINT
+
 void CardReader::write_command(char *buf) {
   char* begin = buf;
   char* npos = 0;
@@ -496,13 +978,28 @@ void CardReader::write_command(char *buf) {
   end[1] = '\r';
   end[2] = '\n';
   end[3] = '\0';
-  file.write(begin);
-  if (file.writeError) {
+  if (!write_data(begin, strlen(begin))) {
     SERIAL_ERROR_START;
     SERIAL_ERRORLNPGM(MSG_SD_ERR_WRITE_TO_FILE);
   }
 }
 
+/**
+ * Append bytes to the file being saved
+ */
+bool CardReader::write_data(const char *buf, const uint16_t len) {
+  file.writeError = false;
+  #if ENABLED(SD_FAST_UPLOAD)
+    if (uploadSize && uploadPos + len > uploadSize && !finishUpload())
+      file.writeError = true; // More than announced, the rest goes through the FAT
+    if (uploadSize)
+      uploadWrite(buf, len);
+    else
+  #endif
+      if (file.write(buf, len) != (int16_t)len) file.writeError = true;
+  return !file.writeError;
+}
+
 void CardReader::checkautostart(bool force) {
   if (!force && (!autostart_stilltocheck || ELAPSED(millis(), next_autostart_ms)))
     return;
@@ -537,6 +1034,12 @@ void CardReader::checkautostart(bool force) {
 }
 
 void CardReader::closefile(bool store_location) {
+  #if ENABLED(SD_FAST_UPLOAD)
+    if (uploadSize && !finishUpload()) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_ERR_WRITE_TO_FILE);
+    }
+  #endif
   file.sync();
   file.close();
   saving = logging = false;
@@ -547,10 +1050,53 @@ void CardReader::closefile(bool store_location) {
   }
 }
 
+#if ENABLED(SDCARD_DIR_INDEX)
+
+  /**
+   * Index the items of the current directory in one pass
+   */
+  void CardReader::buildDirIndex() {
+    curDir = &workDir;
+    lsAction = LS_Index;
+    nrFiles = 0;
+    curDir->rewind();
+    lsDive("", *curDir);
+    dirIndexCount = nrFiles;
+    dirIndexValid = true;
+  }
+
+  /**
+   * Read an indexed item into filename, longFilename and filenameIsDir
+   */
+  bool CardReader::readIndexedEntry(const uint16_t i) {
+    dir_t p;
+    if (!workDir.seekSet((uint32_t)dirIndex[i].entry << 5) || workDir.readDir(p, longFilename) <= 0) return false;
+    createFilename(filename, p);
+    filenameIsDir = DIR_IS_SUBDIR(&p);
+    return true;
+  }
+
+#endif // SDCARD_DIR_INDEX
+
 /**
  * Get the name of a file in the current directory by index
  */
 void CardReader::getfilename(uint16_t nr, const char * const match/*=NULL*/) {
+  #if ENABLED(SDCARD_DIR_INDEX)
+    if (!dirIndexValid) buildDirIndex();
+    const uint16_t indexed = min(dirIndexCount, SD_DIR_INDEX_SIZE);
+    if (match != NULL) {
+      const uint8_t hash = filenameHash(match);
+      for (uint16_t i = 0; i < indexed; i++)
+        if (dirIndex[i].hash == hash && readIndexedEntry(i) && strcasecmp(match, filename) == 0) return;
+      if (dirIndexCount <= SD_DIR_INDEX_SIZE) { // Not in the directory
+        longFilename[0] = '\0';
+        return;
+      }
+    }
+    else if (nr < indexed && readIndexedEntry(nr))
+      return;
+  #endif
   curDir = &workDir;
   lsAction = LS_GetFilename;
   nrFiles = nr;
@@ -559,13 +1105,18 @@ void CardReader::getfilename(uint16_t nr, const char * const match/*=NULL*/) {
 }
 
 uint16_t CardReader::getnrfilenames() {
-  curDir = &workDir;
-  lsAction = LS_Count;
-  nrFiles = 0;
-  curDir->rewind();
-  lsDive("", *curDir);
-  //SERIAL_ECHOLN(nrFiles);
-  return nrFiles;
+  #if ENABLED(SDCARD_DIR_INDEX)
+    if (!dirIndexValid) buildDirIndex();
+    return dirIndexCount;
+  #else
+    curDir = &workDir;
+    lsAction = LS_Count;
+    nrFiles = 0;
+    curDir->rewind();
+    lsDive("", *curDir);
+    //SERIAL_ECHOLN(nrFiles);
+    return nrFiles;
+  #endif
 }
 
 void CardReader::chdir(const char * relpath) {
@@ -583,16 +1134,29 @@ void CardReader::chdir(const char * relpath) {
     if (workDirDepth < MAX_DIR_DEPTH)
       workDirParents[workDirDepth++] = *parent;
     workDir = newfile;
+    #if ENABLED(SDCARD_DIR_INDEX)
+      invalidateDirIndex();
+    #endif
   }
 }
 
 void CardReader::updir() {
-  if (workDirDepth > 0)
+  if (workDirDepth > 0) {
     workDir = workDirParents[--workDirDepth];
+    #if ENABLED(SDCARD_DIR_INDEX)
+      invalidateDirIndex();
+    #endif
+  }
 }
 
 void CardReader::printingHasFinished() {
   stepper.synchronize();
+  #if ENABLED(SD_JOB_QUEUE)
+    if (!file_subcall_ctr && (jobCopies || nextJobReady)) {
+      startNextJob();
+      return;
+    }
+  #endif
   file.close();
   if (file_subcall_ctr > 0) { // Heading up to a parent file that called current as a procedure.
     file_subcall_ctr--;
@@ -602,6 +1166,15 @@ void CardReader::printingHasFinished() {
   }
   else {
     sdprinting = false;
+    #if ENABLED(SD_PRINT_TIME_ESTIMATE)
+      clearEstimate();
+    #endif
+    #if ENABLED(SD_JOB_QUEUE)
+      endJobQueue();
+    #endif
+    #if ENABLED(SD_CHECKPOINT)
+      clearCheckpoint();
+    #endif
     if (SD_FINISHED_STEPPERRELEASE)
       enqueue_and_echo_commands_P(PSTR(SD_FINISHED_RELEASECOMMAND));
     print_job_timer.stop();
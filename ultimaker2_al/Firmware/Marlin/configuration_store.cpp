@@ -36,7 +36,7 @@
  *
  */
 
-#define EEPROM_VERSION "V27"
+#define EEPROM_VERSION "V29"
 
 // Change EEPROM version if these are changed:
 #define EEPROM_OFFSET 100
@@ -81,43 +81,47 @@
  *  289  M665 A    delta_diagonal_rod_trim_tower_1 (float)
  *  293  M665 B    delta_diagonal_rod_trim_tower_2 (float)
  *  297  M665 C    delta_diagonal_rod_trim_tower_3 (float)
+ *  301  M665 XYZ  delta_tower_angle_trim (float x3)
  *
  * Z_DUAL_ENDSTOPS:
- *  301  M666 Z    z_endstop_adj (float)
+ *  313  M666 Z    z_endstop_adj (float)
  *
  * ULTIPANEL:
- *  305  M145 S0 H lcd_preheat_hotend_temp (int x2)
- *  309  M145 S0 B lcd_preheat_bed_temp (int x2)
- *  313  M145 S0 F lcd_preheat_fan_speed (int x2)
+ *  317  M145 S0 H lcd_preheat_hotend_temp (int x2)
+ *  321  M145 S0 B lcd_preheat_bed_temp (int x2)
+ *  325  M145 S0 F lcd_preheat_fan_speed (int x2)
  *
  * PIDTEMP:
- *  317  M301 E0 PIDC  Kp[0], Ki[0], Kd[0], Kc[0] (float x4)
- *  333  M301 E1 PIDC  Kp[1], Ki[1], Kd[1], Kc[1] (float x4)
- *  349  M301 E2 PIDC  Kp[2], Ki[2], Kd[2], Kc[2] (float x4)
- *  365  M301 E3 PIDC  Kp[3], Ki[3], Kd[3], Kc[3] (float x4)
- *  381  M301 L        lpq_len (int)
+ *  329  M301 E0 PIDC  Kp[0], Ki[0], Kd[0], Kc[0] (float x4)
+ *  345  M301 E1 PIDC  Kp[1], Ki[1], Kd[1], Kc[1] (float x4)
+ *  361  M301 E2 PIDC  Kp[2], Ki[2], Kd[2], Kc[2] (float x4)
+ *  377  M301 E3 PIDC  Kp[3], Ki[3], Kd[3], Kc[3] (float x4)
+ *  393  M301 L        lpq_len (int)
  *
  * PIDTEMPBED:
- *  383  M304 PID  thermalManager.bedKp, thermalManager.bedKi, thermalManager.bedKd (float x3)
+ *  395  M304 PID  thermalManager.bedKp, thermalManager.bedKi, thermalManager.bedKd (float x3)
  *
  * DOGLCD:
- *  395  M250 C    lcd_contrast (int)
+ *  407  M250 C    lcd_contrast (int)
  *
  * FWRETRACT:
- *  397  M209 S    autoretract_enabled (bool)
- *  398  M207 S    retract_length (float)
- *  402  M207 W    retract_length_swap (float)
- *  406  M207 F    retract_feedrate_mm_s (float)
- *  410  M207 Z    retract_zlift (float)
- *  414  M208 S    retract_recover_length (float)
- *  418  M208 W    retract_recover_length_swap (float)
- *  422  M208 F    retract_recover_feedrate_mm_s (float)
+ *  409  M209 S    autoretract_enabled (bool)
+ *  410  M207 S    retract_length (float)
+ *  414  M207 W    retract_length_swap (float)
+ *  418  M207 F    retract_feedrate_mm_s (float)
+ *  422  M207 Z    retract_zlift (float)
+ *  426  M208 S    retract_recover_length (float)
+ *  430  M208 W    retract_recover_length_swap (float)
+ *  434  M208 F    retract_recover_feedrate_mm_s (float)
  *
  * Volumetric Extrusion:
- *  426  M200 D    volumetric_enabled (bool)
- *  427  M200 T D  filament_size (float x4) (T0..3)
+ *  438  M200 D    volumetric_enabled (bool)
+ *  439  M200 T D  filament_size (float x4) (T0..3)
  *
- *  443  This Slot is Available!
+ * PID_FEEDFORWARD:
+ *  455  M306 EF   thermalManager.ff_extrusion, thermalManager.ff_fan (float x2)
+ *
+ *  463  This Slot is Available!
  *
  */
 #include "Marlin.h"
@@ -255,7 +259,7 @@ void Config_Postprocess() {
     #endif
     EEPROM_WRITE(zprobe_zoffset);
 
-    // 9 floats for DELTA / Z_DUAL_ENDSTOPS
+    // 12 floats for DELTA / Z_DUAL_ENDSTOPS
     #if ENABLED(DELTA)
       EEPROM_WRITE(endstop_adj);               // 3 floats
       EEPROM_WRITE(delta_radius);              // 1 float
@@ -264,13 +268,14 @@ void Config_Postprocess() {
       EEPROM_WRITE(delta_diagonal_rod_trim_tower_1);  // 1 float
       EEPROM_WRITE(delta_diagonal_rod_trim_tower_2);  // 1 float
       EEPROM_WRITE(delta_diagonal_rod_trim_tower_3);  // 1 float
+      EEPROM_WRITE(delta_tower_angle_trim);    // 3 floats
     #elif ENABLED(Z_DUAL_ENDSTOPS)
       EEPROM_WRITE(z_endstop_adj);            // 1 float
       dummy = 0.0f;
-      for (uint8_t q = 8; q--;) EEPROM_WRITE(dummy);
+      for (uint8_t q = 11; q--;) EEPROM_WRITE(dummy);
     #else
       dummy = 0.0f;
-      for (uint8_t q = 9; q--;) EEPROM_WRITE(dummy);
+      for (uint8_t q = 12; q--;) EEPROM_WRITE(dummy);
     #endif
 
     #if DISABLED(ULTIPANEL)
@@ -356,6 +361,14 @@ void Config_Postprocess() {
       EEPROM_WRITE(dummy);
     }
 
+    #if ENABLED(PID_FEEDFORWARD)
+      EEPROM_WRITE(thermalManager.ff_extrusion);
+      EEPROM_WRITE(thermalManager.ff_fan);
+    #else
+      dummy = 0.0f;
+      for (uint8_t q = 2; q--;) EEPROM_WRITE(dummy);
+    #endif
+
     uint16_t final_checksum = eeprom_checksum,
              eeprom_size = eeprom_index;
 
@@ -450,13 +463,14 @@ void Config_Postprocess() {
         EEPROM_READ(delta_diagonal_rod_trim_tower_1);  // 1 float
         EEPROM_READ(delta_diagonal_rod_trim_tower_2);  // 1 float
         EEPROM_READ(delta_diagonal_rod_trim_tower_3);  // 1 float
+        EEPROM_READ(delta_tower_angle_trim);     // 3 floats
       #elif ENABLED(Z_DUAL_ENDSTOPS)
         EEPROM_READ(z_endstop_adj);
         dummy = 0.0f;
-        for (uint8_t q=8; q--;) EEPROM_READ(dummy);
+        for (uint8_t q=11; q--;) EEPROM_READ(dummy);
       #else
         dummy = 0.0f;
-        for (uint8_t q=9; q--;) EEPROM_READ(dummy);
+        for (uint8_t q=12; q--;) EEPROM_READ(dummy);
       #endif
 
       #if DISABLED(ULTIPANEL)
@@ -537,6 +551,13 @@ void Config_Postprocess() {
         if (q < COUNT(filament_size)) filament_size[q] = dummy;
       }
 
+      #if ENABLED(PID_FEEDFORWARD)
+        EEPROM_READ(thermalManager.ff_extrusion);
+        EEPROM_READ(thermalManager.ff_fan);
+      #else
+        for (uint8_t q = 2; q--;) EEPROM_READ(dummy); // ff_extrusion, ff_fan
+      #endif
+
       if (eeprom_checksum == stored_checksum) {
         Config_Postprocess();
         SERIAL_ECHO_START;
@@ -625,6 +646,9 @@ void Config_ResetDefault() {
     delta_diagonal_rod_trim_tower_1 = DELTA_DIAGONAL_ROD_TRIM_TOWER_1;
     delta_diagonal_rod_trim_tower_2 = DELTA_DIAGONAL_ROD_TRIM_TOWER_2;
     delta_diagonal_rod_trim_tower_3 = DELTA_DIAGONAL_ROD_TRIM_TOWER_3;
+    delta_tower_angle_trim[A_AXIS] = DELTA_TOWER_ANGLE_TRIM_1;
+    delta_tower_angle_trim[B_AXIS] = DELTA_TOWER_ANGLE_TRIM_2;
+    delta_tower_angle_trim[C_AXIS] = DELTA_TOWER_ANGLE_TRIM_3;
   #elif ENABLED(Z_DUAL_ENDSTOPS)
     z_endstop_adj = 0;
   #endif
@@ -659,6 +683,10 @@ void Config_ResetDefault() {
     #if ENABLED(PID_EXTRUSION_SCALING)
       lpq_len = 20; // default last-position-queue size
     #endif
+    #if ENABLED(PID_FEEDFORWARD)
+      thermalManager.ff_extrusion = DEFAULT_FF_EXTRUSION;
+      thermalManager.ff_fan = DEFAULT_FF_FAN;
+    #endif
   #endif // PIDTEMP
 
   #if ENABLED(PIDTEMPBED)
@@ -853,7 +881,7 @@ void Config_ResetDefault() {
       SERIAL_EOL;
       CONFIG_ECHO_START;
       if (!forReplay) {
-        SERIAL_ECHOLNPGM("Delta settings: L=diagonal_rod, R=radius, S=segments_per_second, ABC=diagonal_rod_trim_tower_[123]");
+        SERIAL_ECHOLNPGM("Delta settings: L=diagonal_rod, R=radius, S=segments_per_second, ABC=diagonal_rod_trim_tower_[123], XYZ=tower_angle_trim_[123]");
         CONFIG_ECHO_START;
       }
       SERIAL_ECHOPAIR("  M665 L", delta_diagonal_rod);
@@ -862,6 +890,9 @@ void Config_ResetDefault() {
       SERIAL_ECHOPAIR(" A", delta_diagonal_rod_trim_tower_1);
       SERIAL_ECHOPAIR(" B", delta_diagonal_rod_trim_tower_2);
       SERIAL_ECHOPAIR(" C", delta_diagonal_rod_trim_tower_3);
+      SERIAL_ECHOPAIR(" X", delta_tower_angle_trim[A_AXIS]);
+      SERIAL_ECHOPAIR(" Y", delta_tower_angle_trim[B_AXIS]);
+      SERIAL_ECHOPAIR(" Z", delta_tower_angle_trim[C_AXIS]);
       SERIAL_EOL;
     #elif ENABLED(Z_DUAL_ENDSTOPS)
       CONFIG_ECHO_START;
@@ -926,6 +957,13 @@ void Config_ResetDefault() {
         }
       #endif // PIDTEMP
 
+      #if ENABLED(PID_FEEDFORWARD)
+        CONFIG_ECHO_START;
+        SERIAL_ECHOPAIR("  M306 E", thermalManager.ff_extrusion);
+        SERIAL_ECHOPAIR(" F", thermalManager.ff_fan);
+        SERIAL_EOL;
+      #endif
+
       #if ENABLED(PIDTEMPBED)
         CONFIG_ECHO_START;
         SERIAL_ECHOPAIR("  M304 P", thermalManager.bedKp);
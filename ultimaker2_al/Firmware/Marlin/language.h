@@ -179,6 +179,21 @@
 #define MSG_SD_WRITE_TO_FILE                "Writing to file: "
 #define MSG_SD_PRINTING_BYTE                "SD printing byte "
 #define MSG_SD_NOT_PRINTING                 "Not SD printing"
+#define MSG_SD_REMAINING_TIME               "SD remaining time "
+#define MSG_SD_CHECKPOINT_NONE              "No SD checkpoint to resume"
+#define MSG_SD_CHECKPOINT_RESUME            "Resuming SD print "
+#define MSG_SD_CHECKPOINT_ERR_WRITE         "error writing SD checkpoint"
+#define MSG_SD_CHECKPOINT_BUSY              "Stop the SD print before M1000"
+#define MSG_SD_JOB_BUSY                     "Stop the SD print before M1001"
+#define MSG_SD_JOB_START                    "Starting job "
+#define MSG_SD_JOB_COPIES                   ", copies left "
+#define MSG_BFT_BUSY                        "Stop the SD print before M1002"
+#define MSG_BFT_READY                       "BFT:1 window:"
+#define MSG_BFT_ACK                         "BFT ack:"
+#define MSG_BFT_RESEND                      "BFT resend:"
+#define MSG_BFT_DONE                        "BFT done"
+#define MSG_BFT_ERROR                       "BFT error:"
+#define MSG_BFT_SYNC                        "BFT sync"
 #define MSG_SD_ERR_WRITE_TO_FILE            "error writing to file"
 #define MSG_SD_ERR_READ                     "SD read error"
 #define MSG_SD_CANT_ENTER_SUBDIR            "Cannot enter subdir: "
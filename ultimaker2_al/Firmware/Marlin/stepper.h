@@ -56,6 +56,7 @@ extern Stepper stepper;
 // uses:
 // r26 to store 0
 // r27 to store the byte 1 of the 24 bit result
+#ifdef __AVR__
 #define MultiU16X8toH16(intRes, charIn1, intIn2) \
   asm volatile ( \
                  "clr r26 \n\t" \
@@ -76,6 +77,9 @@ extern Stepper stepper;
                  : \
                  "r26" \
                )
+#else // The same in C, for the host build in tools/host
+  #define MultiU16X8toH16(intRes, charIn1, intIn2) intRes = ((uint32_t)(charIn1) * (intIn2) + 0x80) >> 8
+#endif
 
 class Stepper {
 
@@ -105,8 +109,10 @@ class Stepper {
     static volatile uint32_t step_events_completed; // The number of step events executed in the current block
 
     #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
-      static uint8_t old_OCR0A;
-      static volatile uint8_t eISR_Rate;
+      // Timer 1 intervals until the next main and the next E step,
+      // both served by the Timer 1 compare interrupt
+      #define ADV_NEVER 65535
+      static uint16_t nextMainISR, nextAdvanceISR, eISR_Rate;
       #if ENABLED(LIN_ADVANCE)
         static volatile int e_steps[E_STEPPERS];
         static int final_estep_rate;
@@ -177,6 +183,7 @@ class Stepper {
 
     #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
       static void advance_isr();
+      static void advance_isr_scheduler();
     #endif
 
     //
@@ -298,14 +305,14 @@ class Stepper {
       NOLESS(step_rate, F_CPU / 500000);
       step_rate -= F_CPU / 500000; // Correct for minimal speed
       if (step_rate >= (8 * 256)) { // higher step rate
-        unsigned short table_address = (unsigned short)&speed_lookuptable_fast[(unsigned char)(step_rate >> 8)][0];
+        uintptr_t table_address = (uintptr_t)&speed_lookuptable_fast[(unsigned char)(step_rate >> 8)][0];
         unsigned char tmp_step_rate = (step_rate & 0x00ff);
         unsigned short gain = (unsigned short)pgm_read_word_near(table_address + 2);
         MultiU16X8toH16(timer, tmp_step_rate, gain);
         timer = (unsigned short)pgm_read_word_near(table_address) - timer;
       }
       else { // lower step rates
-        unsigned short table_address = (unsigned short)&speed_lookuptable_slow[0][0];
+        uintptr_t table_address = (uintptr_t)&speed_lookuptable_slow[0][0];
         table_address += ((step_rate) >> 1) & 0xfffc;
         timer = (unsigned short)pgm_read_word_near(table_address);
         timer -= (((unsigned short)pgm_read_word_near(table_address + 2) * (unsigned char)(step_rate & 0x0007)) >> 3);
@@ -318,6 +325,19 @@ class Stepper {
       return timer;
     }
 
+    #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
+
+      // Timer 1 interval between E steps to spread 'steps' over 'loops' main steps
+      static FORCE_INLINE uint16_t adv_rate(const long steps, const uint16_t timer, const uint8_t loops) {
+        if (steps) {
+          const uint16_t rate = (timer * loops) / labs(steps);
+          return rate ? rate : 1;
+        }
+        return ADV_NEVER;
+      }
+
+    #endif
+
     // Initializes the trapezoid generator from the current block. Called whenever a new
     // block begins.
     static FORCE_INLINE void trapezoid_generator_reset() {
@@ -357,7 +377,11 @@ class Stepper {
       step_loops_nominal = step_loops;
       acc_step_rate = current_block->initial_rate;
       acceleration_time = calc_timer(acc_step_rate);
-      OCR1A = acceleration_time;
+      #if ENABLED(ADVANCE) || ENABLED(LIN_ADVANCE)
+        nextMainISR = acceleration_time;
+      #else
+        OCR1A = acceleration_time;
+      #endif
       
       #if ENABLED(LIN_ADVANCE)
         if (current_block->use_advance_lead) {
@@ -37,16 +37,32 @@
   #include "watchdog.h"
 #endif
 
+#if ENABLED(HEATER_0_USES_MAX6675) && ENABLED(SDSUPPORT)
+  #include "Sd2Card.h"
+#endif
+
 #ifdef K1 // Defined in Configuration.h in the PID settings
   #define K2 (1.0-K1)
 #endif
 
+#if ENABLED(PID_IN_ISR)
+  // Fixed-point formats for the ISR PID
+  #define PID_FX_TEMP_SHIFT 4                                           // Temperatures in 1/16 °C
+  #define PID_FX_GAIN_SHIFT 10                                          // Gains in 1/1024
+  #define PID_FX_OUT_SHIFT  (PID_FX_TEMP_SHIFT + PID_FX_GAIN_SHIFT)     // Gain x temperature
+  #define PID_FX_MAX        ((long)(PID_MAX) << (PID_FX_OUT_SHIFT))
+  #define PID_FX_K1         ((long)((K1) * 256.0 + 0.5))                // Smoothing factor in 1/256
+  #define PID_FX_K2         (256L - (PID_FX_K1))
+#endif
+
 #if ENABLED(TEMP_SENSOR_1_AS_REDUNDANT)
   static void* heater_ttbl_map[2] = {(void*)HEATER_0_TEMPTABLE, (void*)HEATER_1_TEMPTABLE };
   static uint8_t heater_ttbllen_map[2] = { HEATER_0_TEMPTABLE_LEN, HEATER_1_TEMPTABLE_LEN };
+  static uint8_t heater_ttblshift_map[2] = { HEATER_0_TEMPTABLE_SHIFT, HEATER_1_TEMPTABLE_SHIFT };
 #else
   static void* heater_ttbl_map[HOTENDS] = ARRAY_BY_HOTENDS((void*)HEATER_0_TEMPTABLE, (void*)HEATER_1_TEMPTABLE, (void*)HEATER_2_TEMPTABLE, (void*)HEATER_3_TEMPTABLE);
   static uint8_t heater_ttbllen_map[HOTENDS] = ARRAY_BY_HOTENDS(HEATER_0_TEMPTABLE_LEN, HEATER_1_TEMPTABLE_LEN, HEATER_2_TEMPTABLE_LEN, HEATER_3_TEMPTABLE_LEN);
+  static uint8_t heater_ttblshift_map[HOTENDS] = ARRAY_BY_HOTENDS(HEATER_0_TEMPTABLE_SHIFT, HEATER_1_TEMPTABLE_SHIFT, HEATER_2_TEMPTABLE_SHIFT, HEATER_3_TEMPTABLE_SHIFT);
 #endif
 
 Temperature thermalManager;
@@ -86,6 +102,10 @@ uint8_t Temperature::soft_pwm_bed;
       float Temperature::Kc = DEFAULT_Kc;
     #endif
   #endif
+  #if ENABLED(PID_FEEDFORWARD)
+    float Temperature::ff_extrusion = DEFAULT_FF_EXTRUSION,
+          Temperature::ff_fan = DEFAULT_FF_FAN;
+  #endif
 #endif
 
 #if ENABLED(PIDTEMPBED)
@@ -138,6 +158,22 @@ volatile bool Temperature::temp_meas_ready = false;
 
   float Temperature::pid_error[HOTENDS];
   bool Temperature::pid_reset[HOTENDS];
+
+  #if ENABLED(PID_IN_ISR)
+    long Temperature::Kp_fx[HOTENDS],
+         Temperature::Ki_fx[HOTENDS],
+         Temperature::Kd_fx[HOTENDS],
+         Temperature::iState_fx[HOTENDS] = { 0 },
+         Temperature::iStateMax_fx[HOTENDS],
+         Temperature::dTerm_fx[HOTENDS] = { 0 },
+         Temperature::dStepMax_fx[HOTENDS];
+    int Temperature::dState_fx[HOTENDS] = { 0 };
+    volatile bool Temperature::pid_isr_hold = false;
+  #endif
+
+  #if ENABLED(PID_FEEDFORWARD)
+    uint8_t Temperature::feedforward[HOTENDS] = { 0 };
+  #endif
 #endif
 
 #if ENABLED(PIDTEMPBED)
@@ -186,6 +222,14 @@ int Temperature::minttemp_raw[HOTENDS] = ARRAY_BY_HOTENDS(HEATER_0_RAW_LO_TEMP ,
 
 uint8_t Temperature::soft_pwm[HOTENDS];
 
+#if ENABLED(HEATUP_PLANNER)
+  int Temperature::heatup_target[HOTENDS] = { 0 };
+  float Temperature::bed_heating_rate = 0.0,
+        Temperature::last_bed_temp = 0.0;
+  millis_t Temperature::next_heatup_ms = 0;
+  uint8_t Temperature::bed_pwm_request = 0;
+#endif
+
 #if ENABLED(FAN_SOFT_PWM)
   uint8_t Temperature::soft_pwm_fan[FAN_COUNT];
 #endif
@@ -234,6 +278,10 @@ uint8_t Temperature::soft_pwm[HOTENDS];
 
     disable_all_heaters(); // switch off all heaters.
 
+    #if ENABLED(PID_IN_ISR)
+      pid_isr_hold = true; // soft_pwm is driven from here until tuning ends
+    #endif
+
     #if HAS_PID_FOR_BOTH
       if (hotend < 0)
         soft_pwm_bed = bias = d = (MAX_BED_POWER) >> 1;
@@ -365,7 +413,7 @@ uint8_t Temperature::soft_pwm[HOTENDS];
       #define MAX_OVERSHOOT_PID_AUTOTUNE 20
       if (input > temp + MAX_OVERSHOOT_PID_AUTOTUNE) {
         SERIAL_PROTOCOLLNPGM(MSG_PID_TEMP_TOO_HIGH);
-        return;
+        break;
       }
       // Every 2 seconds...
       if (ELAPSED(ms, temp_ms + 2000UL)) {
@@ -379,7 +427,7 @@ uint8_t Temperature::soft_pwm[HOTENDS];
       // Over 2 minutes?
       if (((ms - t1) + (ms - t2)) > (10L * 60L * 1000L * 2L)) {
         SERIAL_PROTOCOLLNPGM(MSG_PID_TIMEOUT);
-        return;
+        break;
       }
       if (cycles > ncycles) {
         SERIAL_PROTOCOLLNPGM(MSG_PID_AUTOTUNE_FINISHED);
@@ -424,11 +472,15 @@ uint8_t Temperature::soft_pwm[HOTENDS];
             _SET_BED_PID();
           #endif
         }
-        return;
+        break;
       }
       lcd_update();
     }
     if (!wait_for_heatup) disable_all_heaters();
+
+    #if ENABLED(PID_IN_ISR)
+      pid_isr_hold = false;
+    #endif
   }
 
 #endif // HAS_PID_HEATING
@@ -444,6 +496,21 @@ void Temperature::updatePID() {
     #if ENABLED(PID_EXTRUSION_SCALING)
       last_e_position = 0;
     #endif
+    #if ENABLED(PID_IN_ISR)
+      HOTEND_LOOP() {
+        // A Kd above full scale per 1/16 °C saturates on the smallest step anyway
+        const long kp = lround(PID_PARAM(Kp, e) * (1L << (PID_FX_GAIN_SHIFT))),
+                   ki = lround(PID_PARAM(Ki, e) * (1L << (PID_FX_GAIN_SHIFT))),
+                   kd = lround(min(PID_PARAM(Kd, e), (float)((PID_FX_MAX) >> (PID_FX_GAIN_SHIFT))) * (1L << (PID_FX_GAIN_SHIFT)));
+        CRITICAL_SECTION_START;
+        Kp_fx[e] = kp;
+        Ki_fx[e] = ki;
+        Kd_fx[e] = kd;
+        iStateMax_fx[e] = ki > 0 ? PID_FX_MAX / ki : 0; // Keeps Ki * iState within the output range
+        dStepMax_fx[e] = kd > 0 ? PID_FX_MAX / kd : 0;  // Keeps Kd * the step within the output range
+        CRITICAL_SECTION_END;
+      }
+    #endif
   #endif
 }
 
@@ -558,6 +625,10 @@ float Temperature::get_pid_output(int e) {
 
         pid_output = pTerm[HOTEND_INDEX] + iTerm[HOTEND_INDEX] - dTerm[HOTEND_INDEX];
 
+        #if ENABLED(PID_FEEDFORWARD)
+          pid_output += feedforward[HOTEND_INDEX];
+        #endif
+
         #if ENABLED(PID_EXTRUSION_SCALING)
           cTerm[HOTEND_INDEX] = 0;
           if (_HOTEND_TEST) {
@@ -677,6 +748,10 @@ void Temperature::manage_heater() {
     millis_t ms = millis();
   #endif
 
+  #if ENABLED(PID_FEEDFORWARD)
+    update_feedforward();
+  #endif
+
   // Loop through all hotends
   HOTEND_LOOP() {
 
@@ -684,10 +759,14 @@ void Temperature::manage_heater() {
       thermal_runaway_protection(&thermal_runaway_state_machine[e], &thermal_runaway_timer[e], current_temperature[e], target_temperature[e], e, THERMAL_PROTECTION_PERIOD, THERMAL_PROTECTION_HYSTERESIS);
     #endif
 
-    float pid_output = get_pid_output(e);
+    #if DISABLED(PID_IN_ISR) // Else soft_pwm is set by isr()
 
-    // Check if temperature is within the correct range
-    soft_pwm[e] = (current_temperature[e] > minttemp[e] || is_preheating(e)) && current_temperature[e] < maxttemp[e] ? (int)pid_output >> 1 : 0;
+      float pid_output = get_pid_output(e);
+
+      // Check if temperature is within the correct range
+      soft_pwm[e] = (current_temperature[e] > minttemp[e] || is_preheating(e)) && current_temperature[e] < maxttemp[e] ? (int)pid_output >> 1 : 0;
+
+    #endif
 
     // Check if the temperature is failing to increase
     #if ENABLED(THERMAL_PROTECTION_HOTENDS) && WATCH_TEMP_PERIOD > 0
@@ -755,6 +834,11 @@ void Temperature::manage_heater() {
     }
   #endif //FILAMENT_WIDTH_SENSOR
 
+  #if ENABLED(HEATUP_PLANNER)
+    update_heatup();
+    limit_bed_power(); // Hotend duty changes between bed checks
+  #endif
+
   #if DISABLED(PIDTEMPBED)
     if (PENDING(ms, next_bed_check_ms)) return;
     next_bed_check_ms = ms + BED_CHECK_INTERVAL;
@@ -793,11 +877,86 @@ void Temperature::manage_heater() {
         WRITE_HEATER_BED(LOW);
       }
     #endif
+
+    #if ENABLED(HEATUP_PLANNER)
+      bed_pwm_request = soft_pwm_bed;
+      limit_bed_power();
+    #endif
   #endif //TEMP_SENSOR_BED != 0
 }
 
+#if ENABLED(PID_FEEDFORWARD)
+
+  /**
+   * Heater power for the load the planner is about to put on the
+   * active hotend, so it is there before the temperature drops
+   */
+  void Temperature::update_feedforward() {
+    float e_rate, fan;
+    planner.upcoming_load(e_rate, fan);
+    const float ff = constrain(ff_extrusion * e_rate + ff_fan * fan * (1.0 / 255.0), 0, PID_MAX);
+    HOTEND_LOOP() feedforward[e] = e == active_extruder ? ff : 0;
+  }
+
+#endif // PID_FEEDFORWARD
+
+#if ENABLED(HEATUP_PLANNER)
+
+  void Temperature::planTargetHotend(const float& celsius, uint8_t e) {
+    if (celsius <= target_temperature[HOTEND_INDEX]) return; // Cooling waits its turn
+    if (isHeatingBed())
+      heatup_target[HOTEND_INDEX] = celsius;
+    else
+      setTargetHotend(celsius, e);
+  }
+
+  /**
+   * Once a second: measure the bed's heating rate and start each
+   * held back hotend when it needs as long as the bed has left.
+   */
+  void Temperature::update_heatup() {
+    const millis_t ms = millis();
+    if (PENDING(ms, next_heatup_ms)) return;
+    next_heatup_ms = ms + 1000UL;
+
+    bed_heating_rate += (current_temperature_bed - last_bed_temp - bed_heating_rate) * 0.25;
+    last_bed_temp = current_temperature_bed;
+
+    float bed_left = 0.0;
+    if (isHeatingBed())
+      bed_left = bed_heating_rate > 0.05 ? (target_temperature_bed - current_temperature_bed) / bed_heating_rate : 9999.0;
+
+    HOTEND_LOOP() {
+      if (heatup_target[e] && bed_left <= (heatup_target[e] - current_temperature[e]) * (1.0 / (HEATUP_HOTEND_RATE)) + (HEATUP_LEAD_TIME))
+        setTargetHotend(heatup_target[e], e);
+    }
+  }
+
+  /**
+   * Hotends get their duty, the bed what is left of HEATER_POWER_BUDGET.
+   * Duty 127 is full power.
+   */
+  void Temperature::limit_bed_power() {
+    long left = (long)(HEATER_POWER_BUDGET) * 127;
+    HOTEND_LOOP() left -= (long)soft_pwm[e] * (HOTEND_HEATER_POWER);
+    const uint8_t most = min(left / (BED_HEATER_POWER), 127);
+    soft_pwm_bed = min(bed_pwm_request, most);
+  }
+
+#endif // HEATUP_PLANNER
+
 #define PGM_RD_W(x)   (short)pgm_read_word(&x)
 
+/**
+ * The first table entry worth comparing with raw. Tables built by
+ * thermistorgen.h are evenly spaced, so their segment is found directly.
+ */
+static uint8_t ttbl_start(const short (*tt)[2], const long raw, const uint8_t len, const uint8_t shift) {
+  if (!shift) return 1;
+  const short r0 = PGM_RD_W(tt[0][0]);
+  return raw < r0 ? 1 : min(((raw - r0) >> shift) + 1, len);
+}
+
 // Derived from RepRap FiveD extruder::getTemperature()
 // For hot end temperature measurement.
 float Temperature::analog2temp(int raw, uint8_t e) {
@@ -823,7 +982,7 @@ float Temperature::analog2temp(int raw, uint8_t e) {
     uint8_t i;
     short(*tt)[][2] = (short(*)[][2])(heater_ttbl_map[e]);
 
-    for (i = 1; i < heater_ttbllen_map[e]; i++) {
+    for (i = ttbl_start(*tt, raw, heater_ttbllen_map[e], heater_ttblshift_map[e]); i < heater_ttbllen_map[e]; i++) {
       if (PGM_RD_W((*tt)[i][0]) > raw) {
         celsius = PGM_RD_W((*tt)[i - 1][1]) +
                   (raw - PGM_RD_W((*tt)[i - 1][0])) *
@@ -841,6 +1000,89 @@ float Temperature::analog2temp(int raw, uint8_t e) {
   return ((raw * ((5.0 * 100.0) / 1024.0) / OVERSAMPLENR) * (TEMP_SENSOR_AD595_GAIN)) + TEMP_SENSOR_AD595_OFFSET;
 }
 
+#if ENABLED(PID_IN_ISR)
+
+  /**
+   * Integer version of analog2temp() for the ISR.
+   * Returns the temperature in 1/16 °C.
+   */
+  int Temperature::analog2temp_fx(const long raw, const uint8_t e) {
+    short(*tt)[][2] = (short(*)[][2])(heater_ttbl_map[e]);
+    const uint8_t len = heater_ttbllen_map[e];
+    for (uint8_t i = ttbl_start(*tt, raw, len, heater_ttblshift_map[e]); i < len; i++) {
+      const short r1 = PGM_RD_W((*tt)[i][0]);
+      if (r1 > raw) {
+        const short r0 = PGM_RD_W((*tt)[i - 1][0]),
+                    t0 = PGM_RD_W((*tt)[i - 1][1]),
+                    t1 = PGM_RD_W((*tt)[i][1]);
+        return ((long)t0 << (PID_FX_TEMP_SHIFT)) + (((raw - r0) * (t1 - t0)) << (PID_FX_TEMP_SHIFT)) / (r1 - r0);
+      }
+    }
+    // Overflow: Set to last value in the table
+    return (long)PGM_RD_W((*tt)[len - 1][1]) << (PID_FX_TEMP_SHIFT);
+  }
+
+  /**
+   * Hotend PID in fixed point, called by isr() once per sample set
+   * so it always runs at the PID_dT the gains were scaled for.
+   * Same control law as get_pid_output(): bang-bang outside
+   * PID_FUNCTIONAL_RANGE, conditional un-integration at the limits.
+   */
+  void Temperature::pid_isr_update() {
+    if (pid_isr_hold) return;
+
+    HOTEND_LOOP() {
+      const int temp = analog2temp_fx(raw_temp_value[e], e),
+                target = target_temperature[e];
+      const long error = ((long)target << (PID_FX_TEMP_SHIFT)) - temp;
+
+      // Filtered derivative on the measurement. The step is bounded so
+      // Kd * step stays within full scale, as in 32 bits the product of
+      // a large Kd and a sensor glitch would overflow.
+      long d = Kd_fx[e] * constrain(temp - dState_fx[e], -dStepMax_fx[e], dStepMax_fx[e]);
+      d = ((PID_FX_K2) * d + (PID_FX_K1) * dTerm_fx[e]) >> 8;
+      dTerm_fx[e] = constrain(d, -(PID_FX_MAX), PID_FX_MAX);
+      dState_fx[e] = temp;
+
+      uint8_t output;
+      if (error > (long)(PID_FUNCTIONAL_RANGE) << (PID_FX_TEMP_SHIFT)) {
+        output = BANG_MAX;
+        pid_reset[e] = true;
+      }
+      else if (error < -((long)(PID_FUNCTIONAL_RANGE) << (PID_FX_TEMP_SHIFT)) || target == 0) {
+        output = 0;
+        pid_reset[e] = true;
+      }
+      else {
+        if (pid_reset[e]) {
+          iState_fx[e] = 0;
+          pid_reset[e] = false;
+        }
+        iState_fx[e] = constrain(iState_fx[e] + error, -iStateMax_fx[e], iStateMax_fx[e]);
+
+        long out = Kp_fx[e] * error + Ki_fx[e] * iState_fx[e] - dTerm_fx[e];
+        #if ENABLED(PID_FEEDFORWARD)
+          out += (long)feedforward[e] << (PID_FX_OUT_SHIFT);
+        #endif
+        if (out > PID_FX_MAX) {
+          if (error > 0) iState_fx[e] -= error; // conditional un-integration
+          out = PID_FX_MAX;
+        }
+        else if (out < 0) {
+          if (error < 0) iState_fx[e] -= error; // conditional un-integration
+          out = 0;
+        }
+        output = out >> (PID_FX_OUT_SHIFT);
+      }
+
+      // Check if temperature is within the correct range
+      soft_pwm[e] = (temp > ((long)minttemp[e] << (PID_FX_TEMP_SHIFT)) || is_preheating(e))
+                    && temp < ((long)maxttemp[e] << (PID_FX_TEMP_SHIFT)) ? output >> 1 : 0;
+    }
+  }
+
+#endif // PID_IN_ISR
+
 // Derived from RepRap FiveD extruder::getTemperature()
 // For bed temperature measurement.
 float Temperature::analog2tempBed(int raw) {
@@ -848,7 +1090,7 @@ float Temperature::analog2tempBed(int raw) {
     float celsius = 0;
     byte i;
 
-    for (i = 1; i < BEDTEMPTABLE_LEN; i++) {
+    for (i = ttbl_start(BEDTEMPTABLE, raw, BEDTEMPTABLE_LEN, BEDTEMPTABLE_SHIFT); i < BEDTEMPTABLE_LEN; i++) {
       if (PGM_RD_W(BEDTEMPTABLE[i][0]) > raw) {
         celsius  = PGM_RD_W(BEDTEMPTABLE[i - 1][1]) +
                    (raw - PGM_RD_W(BEDTEMPTABLE[i - 1][0])) *
@@ -1292,28 +1534,38 @@ void Temperature::disable_all_heaters() {
 #if ENABLED(HEATER_0_USES_MAX6675)
 
   #define MAX6675_HEAT_INTERVAL 250u
+  #define MAX6675_HEAT_TICKS ((MAX6675_HEAT_INTERVAL) * (F_CPU / 64 / 256) / 1000) // ISR ticks
 
   #if ENABLED(MAX6675_IS_MAX31855)
-    uint32_t max6675_temp = 2000;
+    typedef uint32_t max6675_t;
     #define MAX6675_ERROR_MASK 7
     #define MAX6675_DISCARD_BITS 18
-    #define MAX6675_SPEED_BITS (_BV(SPR1)) // clock ÷ 64
   #else
-    uint16_t max6675_temp = 2000;
+    typedef uint16_t max6675_t;
     #define MAX6675_ERROR_MASK 4
     #define MAX6675_DISCARD_BITS 3
-    #define MAX6675_SPEED_BITS (_BV(SPR0)) // clock ÷ 16
   #endif
+  #define MAX6675_SPEED_BITS (_BV(SPR0)) // clock ÷ 16
 
-  int Temperature::read_max6675() {
-
-    static millis_t next_max6675_ms = 0;
+  max6675_t max6675_temp = 2000;
+  static volatile max6675_t max6675_raw;
+  static volatile bool max6675_fresh = false;
 
-    millis_t ms = millis();
+  /**
+   * Called by the temperature ISR. Every MAX6675_HEAT_INTERVAL read the
+   * thermocouple in one short transfer (2 or 4 bytes, a few µs each) and
+   * leave it for read_max6675(). The SD card shares the bus, so a tick that
+   * finds it selected just tries again on the next one.
+   */
+  void Temperature::sample_max6675() {
+    static uint16_t ticks = 0;
+    if (ticks) { ticks--; return; }
 
-    if (PENDING(ms, next_max6675_ms)) return (int)max6675_temp;
+    #if ENABLED(SDSUPPORT)
+      if (Sd2Card::spiBusy) return;
+    #endif
 
-    next_max6675_ms = ms + MAX6675_HEAT_INTERVAL;
+    ticks = MAX6675_HEAT_TICKS;
 
     CBI(
       #ifdef PRR
@@ -1322,7 +1574,9 @@ void Temperature::disable_all_heaters() {
         PRR0
       #endif
         , PRSPI);
+    const uint8_t spcr = SPCR, spsr = SPSR; // The SD card's settings
     SPCR = _BV(MSTR) | _BV(SPE) | MAX6675_SPEED_BITS;
+    SPSR = 0;
 
     WRITE(MAX6675_SS, 0); // enable TT_MAX6675
 
@@ -1331,16 +1585,32 @@ void Temperature::disable_all_heaters() {
     asm("nop");//50ns on 20Mhz, 62.5ns on 16Mhz
 
     // Read a big-endian temperature value
-    max6675_temp = 0;
-    for (uint8_t i = sizeof(max6675_temp); i--;) {
+    max6675_t value = 0;
+    for (uint8_t i = sizeof(value); i--;) {
       SPDR = 0;
       for (;!TEST(SPSR, SPIF););
-      max6675_temp |= SPDR;
-      if (i > 0) max6675_temp <<= 8; // shift left if not the last byte
+      value |= SPDR;
+      if (i > 0) value <<= 8; // shift left if not the last byte
     }
 
     WRITE(MAX6675_SS, 1); // disable TT_MAX6675
 
+    SPCR = spcr;
+    SPSR = spsr;
+
+    max6675_raw = value;
+    max6675_fresh = true;
+  }
+
+  int Temperature::read_max6675() {
+
+    if (!max6675_fresh) return (int)max6675_temp;
+
+    CRITICAL_SECTION_START;
+    max6675_temp = max6675_raw;
+    max6675_fresh = false;
+    CRITICAL_SECTION_END;
+
     if (max6675_temp & MAX6675_ERROR_MASK) {
       SERIAL_ERROR_START;
       SERIAL_ERRORPGM("Temp measurement error! ");
@@ -1852,6 +2122,11 @@ void Temperature::isr() {
     // Update the raw values if they've been read. Else we could be updating them during reading.
     if (!temp_meas_ready) set_current_temp_raw();
 
+    #if ENABLED(PID_IN_ISR)
+      // Run the hotend PID on the sample set just completed
+      pid_isr_update();
+    #endif
+
     // Filament Sensor - can be read any time since IIR filtering is used
     #if ENABLED(FILAMENT_WIDTH_SENSOR)
       current_raw_filwidth = raw_filwidth_value >> 10;  // Divide to get to 0-16384 range since we used 1/128 IIR filter approach
@@ -1918,6 +2193,10 @@ void Temperature::isr() {
 
   } // temp_count >= OVERSAMPLENR
 
+  #if ENABLED(HEATER_0_USES_MAX6675)
+    sample_max6675();
+  #endif
+
   #if ENABLED(BABYSTEPPING)
     LOOP_XYZ(axis) {
       int curTodo = babystepsTodo[axis]; //get rid of volatile for performance
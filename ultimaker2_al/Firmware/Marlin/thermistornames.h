@@ -86,6 +86,10 @@
 #elif THERMISTOR_ID == 66
   #define THERMISTOR_NAME "Dyze 4.7M"
 
+// Built from Configuration.h constants
+#elif THERMISTOR_ID == 1000
+  #define THERMISTOR_NAME "Custom"
+
 // Dummies for dev testing
 #elif THERMISTOR_ID == 998
   #define THERMISTOR_NAME "Dummy 1"